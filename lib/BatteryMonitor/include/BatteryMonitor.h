@@ -12,16 +12,29 @@ public:
     // Read the battery voltage in millivolts (accounts for divider)
     uint16_t readMillivolts() const;
 
+    // Same, from the average of `samples` raw reads (quieter than a single read)
+    uint16_t readMillivoltsAveraged(uint8_t samples) const;
+
     // Read raw millivolts from ADC (doesn't account for divider)
     uint16_t readRawMillivolts() const;
 
     // Read the battery voltage in volts (accounts for divider)
     double readVolts() const;
 
-    // Percentage (0-100) from a millivolt value
+    // Percentage (0-100) from a millivolt value: integer lookup table built at compile
+    // time from the LiPo discharge polynomial (no floating point at run time)
     static uint16_t percentageFromMillivolts(uint16_t millivolts);
 
-    // Calibrate a raw ADC reading and return millivolts
+    // The discharge polynomial itself, for reference and table checks
+    static constexpr double percentageCurve(double volts)
+    {
+        return -144.9390 * volts * volts * volts +
+               1655.8629 * volts * volts -
+               6158.8520 * volts +
+               7501.3202;
+    }
+
+    // Calibrate a raw ADC reading and return millivolts (ADC characterized once)
     static uint16_t millivoltsFromRawAdc(uint16_t adc_raw);
 
 private:
@@ -2,9 +2,6 @@
 #include <driver/adc.h>
 #include <esp_adc_cal.h>
 
-inline float min(const float a, const float b) { return a < b ? a : b; }
-inline float max(const float a, const float b) { return a > b ? a : b; }
-
 BatteryMonitor::BatteryMonitor(uint8_t adcPin, float dividerMultiplier)
   : _adcPin(adcPin), _dividerMultiplier(dividerMultiplier)
 {
@@ -22,6 +19,17 @@ uint16_t BatteryMonitor::readMillivolts() const
     return static_cast<uint32_t>(mv * _dividerMultiplier);
 }
 
+uint16_t BatteryMonitor::readMillivoltsAveraged(uint8_t samples) const
+{
+    if (samples == 0) samples = 1;
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < samples; i++) {
+        sum += adc1_get_raw(ADC1_CHANNEL_0);
+    }
+    const uint32_t mv = millivoltsFromRawAdc((sum + samples / 2) / samples);
+    return static_cast<uint32_t>(mv * _dividerMultiplier);
+}
+
 uint16_t BatteryMonitor::readRawMillivolts() const
 {
     return adc1_get_raw(ADC1_CHANNEL_0);
@@ -32,25 +40,49 @@ double BatteryMonitor::readVolts() const
     return static_cast<double>(readMillivolts()) / 1000.0;
 }
 
-uint16_t BatteryMonitor::percentageFromMillivolts(uint16_t millivolts)
+// Percentage table: one entry per LUT_STEP_MV from LUT_MIN_MV, interpolated in between.
+// The polynomial has its minimum near 3.23 V and climbs again below it, so the table
+// starts at 3.2 V and anything lower reads 0%.
+static constexpr uint16_t LUT_MIN_MV = 3200;
+static constexpr uint16_t LUT_STEP_MV = 20;
+static constexpr int LUT_SIZE = 51;  // Up to 4.2 V
+
+struct PercentLut {
+    uint8_t pct[LUT_SIZE];
+};
+
+static constexpr PercentLut buildPercentLut()
 {
-    double volts = millivolts / 1000.0;
-    // Polynomial derived from LiPo samples
-    double y = -144.9390 * volts * volts * volts +
-               1655.8629 * volts * volts -
-               6158.8520 * volts +
-               7501.3202;
+    PercentLut lut{};
+    for (int i = 0; i < LUT_SIZE; i++) {
+        double y = BatteryMonitor::percentageCurve((LUT_MIN_MV + i * LUT_STEP_MV) / 1000.0);
+        y = y < 0.0 ? 0.0 : (y > 100.0 ? 100.0 : y);
+        lut.pct[i] = static_cast<uint8_t>(y + 0.5);
+    }
+    return lut;
+}
 
-    // Clamp to [0,100] and round
-    y = max(y, 0.0);
-    y = min(y, 100.0);
-    y = round(y);
-    return static_cast<int>(y);
+static constexpr PercentLut PERCENT_LUT = buildPercentLut();
+
+uint16_t BatteryMonitor::percentageFromMillivolts(uint16_t millivolts)
+{
+    if (millivolts <= LUT_MIN_MV) return PERCENT_LUT.pct[0];
+    const uint32_t offset = millivolts - LUT_MIN_MV;
+    const uint32_t i = offset / LUT_STEP_MV;
+    if (i >= LUT_SIZE - 1) return PERCENT_LUT.pct[LUT_SIZE - 1];
+    const uint32_t frac = offset % LUT_STEP_MV;
+    const uint32_t a = PERCENT_LUT.pct[i];
+    const uint32_t b = PERCENT_LUT.pct[i + 1];
+    return static_cast<uint16_t>((a * (LUT_STEP_MV - frac) + b * frac + LUT_STEP_MV / 2) / LUT_STEP_MV);
 }
 
 uint16_t BatteryMonitor::millivoltsFromRawAdc(uint16_t adc_raw)
 {
-    esp_adc_cal_characteristics_t adc_chars;
-    esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_12, ADC_WIDTH_BIT_12, 1100, &adc_chars);
+    // Characterizing reads eFuse calibration data — do it once, not on every read
+    static const esp_adc_cal_characteristics_t adc_chars = [] {
+        esp_adc_cal_characteristics_t chars;
+        esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_12, ADC_WIDTH_BIT_12, 1100, &chars);
+        return chars;
+    }();
     return esp_adc_cal_raw_to_voltage(adc_raw, &adc_chars);
 }
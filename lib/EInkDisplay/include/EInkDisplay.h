@@ -58,6 +58,10 @@ class EInkDisplay {
   // Power management
   void deepSleep();
 
+  // Running totals since boot: time spent clocking data out over SPI and waiting on BUSY
+  uint64_t getSpiMicros() const { return spiMicros; }
+  uint64_t getBusyMicros() const { return busyMicros; }
+
   // Access to frame buffer
   uint8_t* getFrameBuffer() const {
     return frameBuffer;
@@ -86,6 +90,8 @@ class EInkDisplay {
   bool customLutActive;
   bool inGrayscaleMode;
   bool drawGrayscale;
+  uint64_t spiMicros = 0;
+  uint64_t busyMicros = 0;
 
   // Low-level display control
   void resetDisplay();
@@ -98,4 +104,5 @@ class EInkDisplay {
   // Low-level display operations
   void setRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
   void writeRamBuffer(uint8_t ramBuffer, const uint8_t* data, uint32_t size);
+  void writeRamWindow(uint8_t ramBuffer, const uint8_t* source, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
 };
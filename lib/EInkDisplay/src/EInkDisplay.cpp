@@ -204,15 +204,18 @@ void EInkDisplay::sendData(uint8_t data) {
 }
 
 void EInkDisplay::sendData(const uint8_t* data, uint16_t length) {
+  const unsigned long startUs = micros();
   SPI.beginTransaction(spiSettings);
   digitalWrite(_dc, HIGH);       // Data mode
   digitalWrite(_cs, LOW);        // Select chip
   SPI.writeBytes(data, length);  // Transfer all bytes
   digitalWrite(_cs, HIGH);       // Deselect chip
   SPI.endTransaction();
+  spiMicros += micros() - startUs;
 }
 
 void EInkDisplay::waitWhileBusy(const char* comment) {
+  const unsigned long startUs = micros();
   unsigned long start = millis();
   while (digitalRead(_busy) == HIGH) {
     delay(1);
@@ -221,6 +224,7 @@ void EInkDisplay::waitWhileBusy(const char* comment) {
       break;
     }
   }
+  busyMicros += micros() - startUs;
   if (comment) {
     if (Serial) Serial.printf("[%lu]   Wait complete: %s (%lu ms)\n", millis(), comment, millis() - start);
   }
@@ -359,6 +363,16 @@ void EInkDisplay::writeRamBuffer(uint8_t ramBuffer, const uint8_t* data, uint32_
   if (Serial) Serial.printf("[%lu]   %s RAM write complete (%lu ms)\n", millis(), bufferName, duration);
 }
 
+// Window rows of `source` (x and w byte-aligned) to the RAM area set by setRamArea()
+void EInkDisplay::writeRamWindow(uint8_t ramBuffer, const uint8_t* source, uint16_t x, uint16_t y, uint16_t w,
+                                 uint16_t h) {
+  const uint16_t windowWidthBytes = w / 8;
+  sendCommand(ramBuffer);
+  for (uint16_t row = 0; row < h; row++) {
+    sendData(&source[(y + row) * DISPLAY_WIDTH_BYTES + x / 8], windowWidthBytes);
+  }
+}
+
 void EInkDisplay::setFramebuffer(const uint8_t* bwBuffer) const {
   memcpy(frameBuffer, bwBuffer, BUFFER_SIZE);
 }
@@ -486,39 +500,13 @@ void EInkDisplay::displayWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
     grayscaleRevert();
   }
 
-  // Calculate window buffer size
-  const uint16_t windowWidthBytes = w / 8;
-  const uint32_t windowBufferSize = windowWidthBytes * h;
-
-  if (Serial) Serial.printf("[%lu]   Window buffer size: %lu bytes (%d x %d pixels)\n", millis(), windowBufferSize, w, h);
-
-  // Allocate temporary buffer on stack
-  std::vector<uint8_t> windowBuffer(windowBufferSize);
-
-  // Extract window region from frame buffer
-  for (uint16_t row = 0; row < h; row++) {
-    const uint16_t srcY = y + row;
-    const uint16_t srcOffset = srcY * DISPLAY_WIDTH_BYTES + (x / 8);
-    const uint16_t dstOffset = row * windowWidthBytes;
-    memcpy(&windowBuffer[dstOffset], &frameBuffer[srcOffset], windowWidthBytes);
-  }
-
-  // Configure RAM area for window
+  // Rows go to the controller straight from the frame buffer(s), no staging copy
   setRamArea(x, y, w, h);
-
-  // Write to BW RAM (current frame)
-  writeRamBuffer(CMD_WRITE_RAM_BW, windowBuffer.data(), windowBufferSize);
+  writeRamWindow(CMD_WRITE_RAM_BW, frameBuffer, x, y, w, h);
 
 #ifndef EINK_DISPLAY_SINGLE_BUFFER_MODE
-  // Dual buffer: Extract window from frameBufferActive (previous frame)
-  std::vector<uint8_t> previousWindowBuffer(windowBufferSize);
-  for (uint16_t row = 0; row < h; row++) {
-    const uint16_t srcY = y + row;
-    const uint16_t srcOffset = srcY * DISPLAY_WIDTH_BYTES + (x / 8);
-    const uint16_t dstOffset = row * windowWidthBytes;
-    memcpy(&previousWindowBuffer[dstOffset], &frameBufferActive[srcOffset], windowWidthBytes);
-  }
-  writeRamBuffer(CMD_WRITE_RAM_RED, previousWindowBuffer.data(), windowBufferSize);
+  // Dual buffer: previous frame from frameBufferActive
+  writeRamWindow(CMD_WRITE_RAM_RED, frameBufferActive, x, y, w, h);
 #endif
 
   // Perform fast refresh
@@ -527,7 +515,7 @@ void EInkDisplay::displayWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
 #ifdef EINK_DISPLAY_SINGLE_BUFFER_MODE
   // Post-refresh: Sync RED RAM with current window (for next fast refresh)
   setRamArea(x, y, w, h);
-  writeRamBuffer(CMD_WRITE_RAM_RED, windowBuffer.data(), windowBufferSize);
+  writeRamWindow(CMD_WRITE_RAM_RED, frameBuffer, x, y, w, h);
 #endif
 
   if (Serial) Serial.printf("[%lu]   Window display complete\n", millis());
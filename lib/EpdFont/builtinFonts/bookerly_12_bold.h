@@ -4074,7 +4074,7 @@ static const EpdUnicodeInterval bookerly_12_boldIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_12_bold = {
+static constexpr EpdFontData bookerly_12_bold = {
     bookerly_12_boldBitmaps,
     bookerly_12_boldGlyphs,
     bookerly_12_boldIntervals,
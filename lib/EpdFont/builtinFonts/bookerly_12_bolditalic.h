@@ -4156,7 +4156,7 @@ static const EpdUnicodeInterval bookerly_12_bolditalicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_12_bolditalic = {
+static constexpr EpdFontData bookerly_12_bolditalic = {
     bookerly_12_bolditalicBitmaps,
     bookerly_12_bolditalicGlyphs,
     bookerly_12_bolditalicIntervals,
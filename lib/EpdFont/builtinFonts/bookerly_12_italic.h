@@ -3921,7 +3921,7 @@ static const EpdUnicodeInterval bookerly_12_italicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_12_italic = {
+static constexpr EpdFontData bookerly_12_italic = {
     bookerly_12_italicBitmaps,
     bookerly_12_italicGlyphs,
     bookerly_12_italicIntervals,
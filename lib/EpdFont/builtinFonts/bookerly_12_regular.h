@@ -3812,7 +3812,7 @@ static const EpdUnicodeInterval bookerly_12_regularIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_12_regular = {
+static constexpr EpdFontData bookerly_12_regular = {
     bookerly_12_regularBitmaps,
     bookerly_12_regularGlyphs,
     bookerly_12_regularIntervals,
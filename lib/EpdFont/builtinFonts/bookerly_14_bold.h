@@ -5075,7 +5075,7 @@ static const EpdUnicodeInterval bookerly_14_boldIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_14_bold = {
+static constexpr EpdFontData bookerly_14_bold = {
     bookerly_14_boldBitmaps,
     bookerly_14_boldGlyphs,
     bookerly_14_boldIntervals,
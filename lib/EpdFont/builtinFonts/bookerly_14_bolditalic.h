@@ -5264,7 +5264,7 @@ static const EpdUnicodeInterval bookerly_14_bolditalicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_14_bolditalic = {
+static constexpr EpdFontData bookerly_14_bolditalic = {
     bookerly_14_bolditalicBitmaps,
     bookerly_14_bolditalicGlyphs,
     bookerly_14_bolditalicIntervals,
@@ -4938,7 +4938,7 @@ static const EpdUnicodeInterval bookerly_14_italicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_14_italic = {
+static constexpr EpdFontData bookerly_14_italic = {
     bookerly_14_italicBitmaps,
     bookerly_14_italicGlyphs,
     bookerly_14_italicIntervals,
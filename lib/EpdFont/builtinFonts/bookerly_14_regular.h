@@ -4800,7 +4800,7 @@ static const EpdUnicodeInterval bookerly_14_regularIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_14_regular = {
+static constexpr EpdFontData bookerly_14_regular = {
     bookerly_14_regularBitmaps,
     bookerly_14_regularGlyphs,
     bookerly_14_regularIntervals,
@@ -6224,7 +6224,7 @@ static const EpdUnicodeInterval bookerly_16_boldIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_16_bold = {
+static constexpr EpdFontData bookerly_16_bold = {
     bookerly_16_boldBitmaps,
     bookerly_16_boldGlyphs,
     bookerly_16_boldIntervals,
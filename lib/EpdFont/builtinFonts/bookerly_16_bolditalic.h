@@ -6436,7 +6436,7 @@ static const EpdUnicodeInterval bookerly_16_bolditalicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_16_bolditalic = {
+static constexpr EpdFontData bookerly_16_bolditalic = {
     bookerly_16_bolditalicBitmaps,
     bookerly_16_bolditalicGlyphs,
     bookerly_16_bolditalicIntervals,
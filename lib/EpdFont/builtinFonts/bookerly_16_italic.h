@@ -6052,7 +6052,7 @@ static const EpdUnicodeInterval bookerly_16_italicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_16_italic = {
+static constexpr EpdFontData bookerly_16_italic = {
     bookerly_16_italicBitmaps,
     bookerly_16_italicGlyphs,
     bookerly_16_italicIntervals,
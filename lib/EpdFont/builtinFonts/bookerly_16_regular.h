@@ -5889,7 +5889,7 @@ static const EpdUnicodeInterval bookerly_16_regularIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_16_regular = {
+static constexpr EpdFontData bookerly_16_regular = {
     bookerly_16_regularBitmaps,
     bookerly_16_regularGlyphs,
     bookerly_16_regularIntervals,
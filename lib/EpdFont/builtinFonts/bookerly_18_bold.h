@@ -7952,7 +7952,7 @@ static const EpdUnicodeInterval bookerly_18_boldIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_18_bold = {
+static constexpr EpdFontData bookerly_18_bold = {
     bookerly_18_boldBitmaps,
     bookerly_18_boldGlyphs,
     bookerly_18_boldIntervals,
@@ -8160,7 +8160,7 @@ static const EpdUnicodeInterval bookerly_18_bolditalicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_18_bolditalic = {
+static constexpr EpdFontData bookerly_18_bolditalic = {
     bookerly_18_bolditalicBitmaps,
     bookerly_18_bolditalicGlyphs,
     bookerly_18_bolditalicIntervals,
@@ -7673,7 +7673,7 @@ static const EpdUnicodeInterval bookerly_18_italicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_18_italic = {
+static constexpr EpdFontData bookerly_18_italic = {
     bookerly_18_italicBitmaps,
     bookerly_18_italicGlyphs,
     bookerly_18_italicIntervals,
@@ -7495,7 +7495,7 @@ static const EpdUnicodeInterval bookerly_18_regularIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x2EA },
 };
 
-static const EpdFontData bookerly_18_regular = {
+static constexpr EpdFontData bookerly_18_regular = {
     bookerly_18_regularBitmaps,
     bookerly_18_regularGlyphs,
     bookerly_18_regularIntervals,
@@ -4078,7 +4078,7 @@ static const EpdUnicodeInterval notosans_12_boldIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36C },
 };
 
-static const EpdFontData notosans_12_bold = {
+static constexpr EpdFontData notosans_12_bold = {
     notosans_12_boldBitmaps,
     notosans_12_boldGlyphs,
     notosans_12_boldIntervals,
@@ -4285,7 +4285,7 @@ static const EpdUnicodeInterval notosans_12_bolditalicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36B },
 };
 
-static const EpdFontData notosans_12_bolditalic = {
+static constexpr EpdFontData notosans_12_bolditalic = {
     notosans_12_bolditalicBitmaps,
     notosans_12_bolditalicGlyphs,
     notosans_12_bolditalicIntervals,
@@ -3998,7 +3998,7 @@ static const EpdUnicodeInterval notosans_12_italicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36B },
 };
 
-static const EpdFontData notosans_12_italic = {
+static constexpr EpdFontData notosans_12_italic = {
     notosans_12_italicBitmaps,
     notosans_12_italicGlyphs,
     notosans_12_italicIntervals,
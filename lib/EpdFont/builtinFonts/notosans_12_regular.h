@@ -3795,7 +3795,7 @@ static const EpdUnicodeInterval notosans_12_regularIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36C },
 };
 
-static const EpdFontData notosans_12_regular = {
+static constexpr EpdFontData notosans_12_regular = {
     notosans_12_regularBitmaps,
     notosans_12_regularGlyphs,
     notosans_12_regularIntervals,
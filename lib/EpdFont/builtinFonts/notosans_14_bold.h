@@ -5200,7 +5200,7 @@ static const EpdUnicodeInterval notosans_14_boldIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36C },
 };
 
-static const EpdFontData notosans_14_bold = {
+static constexpr EpdFontData notosans_14_bold = {
     notosans_14_boldBitmaps,
     notosans_14_boldGlyphs,
     notosans_14_boldIntervals,
@@ -5467,7 +5467,7 @@ static const EpdUnicodeInterval notosans_14_bolditalicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36B },
 };
 
-static const EpdFontData notosans_14_bolditalic = {
+static constexpr EpdFontData notosans_14_bolditalic = {
     notosans_14_bolditalicBitmaps,
     notosans_14_bolditalicGlyphs,
     notosans_14_bolditalicIntervals,
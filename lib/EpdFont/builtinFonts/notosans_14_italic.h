@@ -5066,7 +5066,7 @@ static const EpdUnicodeInterval notosans_14_italicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36B },
 };
 
-static const EpdFontData notosans_14_italic = {
+static constexpr EpdFontData notosans_14_italic = {
     notosans_14_italicBitmaps,
     notosans_14_italicGlyphs,
     notosans_14_italicIntervals,
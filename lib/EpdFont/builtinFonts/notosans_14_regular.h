@@ -4816,7 +4816,7 @@ static const EpdUnicodeInterval notosans_14_regularIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36C },
 };
 
-static const EpdFontData notosans_14_regular = {
+static constexpr EpdFontData notosans_14_regular = {
     notosans_14_regularBitmaps,
     notosans_14_regularGlyphs,
     notosans_14_regularIntervals,
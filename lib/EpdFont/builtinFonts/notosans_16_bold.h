@@ -6458,7 +6458,7 @@ static const EpdUnicodeInterval notosans_16_boldIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36C },
 };
 
-static const EpdFontData notosans_16_bold = {
+static constexpr EpdFontData notosans_16_bold = {
     notosans_16_boldBitmaps,
     notosans_16_boldGlyphs,
     notosans_16_boldIntervals,
@@ -6809,7 +6809,7 @@ static const EpdUnicodeInterval notosans_16_bolditalicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36B },
 };
 
-static const EpdFontData notosans_16_bolditalic = {
+static constexpr EpdFontData notosans_16_bolditalic = {
     notosans_16_bolditalicBitmaps,
     notosans_16_bolditalicGlyphs,
     notosans_16_bolditalicIntervals,
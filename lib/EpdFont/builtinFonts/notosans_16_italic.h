@@ -6269,7 +6269,7 @@ static const EpdUnicodeInterval notosans_16_italicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36B },
 };
 
-static const EpdFontData notosans_16_italic = {
+static constexpr EpdFontData notosans_16_italic = {
     notosans_16_italicBitmaps,
     notosans_16_italicGlyphs,
     notosans_16_italicIntervals,
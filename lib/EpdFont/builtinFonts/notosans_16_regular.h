@@ -5921,7 +5921,7 @@ static const EpdUnicodeInterval notosans_16_regularIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36C },
 };
 
-static const EpdFontData notosans_16_regular = {
+static constexpr EpdFontData notosans_16_regular = {
     notosans_16_regularBitmaps,
     notosans_16_regularGlyphs,
     notosans_16_regularIntervals,
@@ -7811,7 +7811,7 @@ static const EpdUnicodeInterval notosans_18_boldIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36C },
 };
 
-static const EpdFontData notosans_18_bold = {
+static constexpr EpdFontData notosans_18_bold = {
     notosans_18_boldBitmaps,
     notosans_18_boldGlyphs,
     notosans_18_boldIntervals,
@@ -8266,7 +8266,7 @@ static const EpdUnicodeInterval notosans_18_bolditalicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36B },
 };
 
-static const EpdFontData notosans_18_bolditalic = {
+static constexpr EpdFontData notosans_18_bolditalic = {
     notosans_18_bolditalicBitmaps,
     notosans_18_bolditalicGlyphs,
     notosans_18_bolditalicIntervals,
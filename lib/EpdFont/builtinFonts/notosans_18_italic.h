@@ -7617,7 +7617,7 @@ static const EpdUnicodeInterval notosans_18_italicIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36B },
 };
 
-static const EpdFontData notosans_18_italic = {
+static constexpr EpdFontData notosans_18_italic = {
     notosans_18_italicBitmaps,
     notosans_18_italicGlyphs,
     notosans_18_italicIntervals,
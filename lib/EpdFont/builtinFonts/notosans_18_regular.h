@@ -7198,7 +7198,7 @@ static const EpdUnicodeInterval notosans_18_regularIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36C },
 };
 
-static const EpdFontData notosans_18_regular = {
+static constexpr EpdFontData notosans_18_regular = {
     notosans_18_regularBitmaps,
     notosans_18_regularGlyphs,
     notosans_18_regularIntervals,
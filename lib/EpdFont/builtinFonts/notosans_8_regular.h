@@ -1610,7 +1610,7 @@ static const EpdUnicodeInterval notosans_8_regularIntervals[] = {
     { 0xFFFD, 0xFFFD, 0x36C },
 };
 
-static const EpdFontData notosans_8_regular = {
+static constexpr EpdFontData notosans_8_regular = {
     notosans_8_regularBitmaps,
     notosans_8_regularGlyphs,
     notosans_8_regularIntervals,
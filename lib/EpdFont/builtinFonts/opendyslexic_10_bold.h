@@ -3506,7 +3506,7 @@ static const EpdUnicodeInterval opendyslexic_10_boldIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_10_bold = {
+static constexpr EpdFontData opendyslexic_10_bold = {
     opendyslexic_10_boldBitmaps,
     opendyslexic_10_boldGlyphs,
     opendyslexic_10_boldIntervals,
@@ -4080,7 +4080,7 @@ static const EpdUnicodeInterval opendyslexic_10_bolditalicIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_10_bolditalic = {
+static constexpr EpdFontData opendyslexic_10_bolditalic = {
     opendyslexic_10_bolditalicBitmaps,
     opendyslexic_10_bolditalicGlyphs,
     opendyslexic_10_bolditalicIntervals,
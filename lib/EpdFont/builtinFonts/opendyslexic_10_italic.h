@@ -3644,7 +3644,7 @@ static const EpdUnicodeInterval opendyslexic_10_italicIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_10_italic = {
+static constexpr EpdFontData opendyslexic_10_italic = {
     opendyslexic_10_italicBitmaps,
     opendyslexic_10_italicGlyphs,
     opendyslexic_10_italicIntervals,
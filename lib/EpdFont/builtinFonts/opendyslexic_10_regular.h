@@ -3176,7 +3176,7 @@ static const EpdUnicodeInterval opendyslexic_10_regularIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_10_regular = {
+static constexpr EpdFontData opendyslexic_10_regular = {
     opendyslexic_10_regularBitmaps,
     opendyslexic_10_regularGlyphs,
     opendyslexic_10_regularIntervals,
@@ -4673,7 +4673,7 @@ static const EpdUnicodeInterval opendyslexic_12_boldIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_12_bold = {
+static constexpr EpdFontData opendyslexic_12_bold = {
     opendyslexic_12_boldBitmaps,
     opendyslexic_12_boldGlyphs,
     opendyslexic_12_boldIntervals,
@@ -5494,7 +5494,7 @@ static const EpdUnicodeInterval opendyslexic_12_bolditalicIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_12_bolditalic = {
+static constexpr EpdFontData opendyslexic_12_bolditalic = {
     opendyslexic_12_bolditalicBitmaps,
     opendyslexic_12_bolditalicGlyphs,
     opendyslexic_12_bolditalicIntervals,
@@ -4766,7 +4766,7 @@ static const EpdUnicodeInterval opendyslexic_12_italicIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_12_italic = {
+static constexpr EpdFontData opendyslexic_12_italic = {
     opendyslexic_12_italicBitmaps,
     opendyslexic_12_italicGlyphs,
     opendyslexic_12_italicIntervals,
@@ -4161,7 +4161,7 @@ static const EpdUnicodeInterval opendyslexic_12_regularIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_12_regular = {
+static constexpr EpdFontData opendyslexic_12_regular = {
     opendyslexic_12_regularBitmaps,
     opendyslexic_12_regularGlyphs,
     opendyslexic_12_regularIntervals,
@@ -6037,7 +6037,7 @@ static const EpdUnicodeInterval opendyslexic_14_boldIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_14_bold = {
+static constexpr EpdFontData opendyslexic_14_bold = {
     opendyslexic_14_boldBitmaps,
     opendyslexic_14_boldGlyphs,
     opendyslexic_14_boldIntervals,
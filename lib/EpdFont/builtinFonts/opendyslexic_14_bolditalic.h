@@ -7083,7 +7083,7 @@ static const EpdUnicodeInterval opendyslexic_14_bolditalicIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_14_bolditalic = {
+static constexpr EpdFontData opendyslexic_14_bolditalic = {
     opendyslexic_14_bolditalicBitmaps,
     opendyslexic_14_bolditalicGlyphs,
     opendyslexic_14_bolditalicIntervals,
@@ -6132,7 +6132,7 @@ static const EpdUnicodeInterval opendyslexic_14_italicIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_14_italic = {
+static constexpr EpdFontData opendyslexic_14_italic = {
     opendyslexic_14_italicBitmaps,
     opendyslexic_14_italicGlyphs,
     opendyslexic_14_italicIntervals,
@@ -5235,7 +5235,7 @@ static const EpdUnicodeInterval opendyslexic_14_regularIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_14_regular = {
+static constexpr EpdFontData opendyslexic_14_regular = {
     opendyslexic_14_regularBitmaps,
     opendyslexic_14_regularGlyphs,
     opendyslexic_14_regularIntervals,
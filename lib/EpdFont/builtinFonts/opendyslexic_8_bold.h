@@ -2579,7 +2579,7 @@ static const EpdUnicodeInterval opendyslexic_8_boldIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_8_bold = {
+static constexpr EpdFontData opendyslexic_8_bold = {
     opendyslexic_8_boldBitmaps,
     opendyslexic_8_boldGlyphs,
     opendyslexic_8_boldIntervals,
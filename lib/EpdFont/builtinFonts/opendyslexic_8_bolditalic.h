@@ -2912,7 +2912,7 @@ static const EpdUnicodeInterval opendyslexic_8_bolditalicIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_8_bolditalic = {
+static constexpr EpdFontData opendyslexic_8_bolditalic = {
     opendyslexic_8_bolditalicBitmaps,
     opendyslexic_8_bolditalicGlyphs,
     opendyslexic_8_bolditalicIntervals,
@@ -2679,7 +2679,7 @@ static const EpdUnicodeInterval opendyslexic_8_italicIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_8_italic = {
+static constexpr EpdFontData opendyslexic_8_italic = {
     opendyslexic_8_italicBitmaps,
     opendyslexic_8_italicGlyphs,
     opendyslexic_8_italicIntervals,
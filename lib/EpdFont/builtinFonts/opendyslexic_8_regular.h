@@ -2360,7 +2360,7 @@ static const EpdUnicodeInterval opendyslexic_8_regularIntervals[] = {
     { 0x2264, 0x2265, 0x2D3 },
 };
 
-static const EpdFontData opendyslexic_8_regular = {
+static constexpr EpdFontData opendyslexic_8_regular = {
     opendyslexic_8_regularBitmaps,
     opendyslexic_8_regularGlyphs,
     opendyslexic_8_regularIntervals,
@@ -1513,7 +1513,7 @@ static const EpdUnicodeInterval ubuntu_10_boldIntervals[] = {
     { 0x2264, 0x2265, 0x24D },
 };
 
-static const EpdFontData ubuntu_10_bold = {
+static constexpr EpdFontData ubuntu_10_bold = {
     ubuntu_10_boldBitmaps,
     ubuntu_10_boldGlyphs,
     ubuntu_10_boldIntervals,
@@ -1427,7 +1427,7 @@ static const EpdUnicodeInterval ubuntu_10_regularIntervals[] = {
     { 0x2264, 0x2265, 0x24D },
 };
 
-static const EpdFontData ubuntu_10_regular = {
+static constexpr EpdFontData ubuntu_10_regular = {
     ubuntu_10_regularBitmaps,
     ubuntu_10_regularGlyphs,
     ubuntu_10_regularIntervals,
@@ -1823,7 +1823,7 @@ static const EpdUnicodeInterval ubuntu_12_boldIntervals[] = {
     { 0x2264, 0x2265, 0x24D },
 };
 
-static const EpdFontData ubuntu_12_bold = {
+static constexpr EpdFontData ubuntu_12_bold = {
     ubuntu_12_boldBitmaps,
     ubuntu_12_boldGlyphs,
     ubuntu_12_boldIntervals,
@@ -1715,7 +1715,7 @@ static const EpdUnicodeInterval ubuntu_12_regularIntervals[] = {
     { 0x2264, 0x2265, 0x24D },
 };
 
-static const EpdFontData ubuntu_12_regular = {
+static constexpr EpdFontData ubuntu_12_regular = {
     ubuntu_12_regularBitmaps,
     ubuntu_12_regularGlyphs,
     ubuntu_12_regularIntervals,
@@ -298,7 +298,7 @@ for i_start, i_end in intervals:
     offset += i_end - i_start + 1
 print ("};\n");
 
-print(f"static const EpdFontData {font_name} = {{")
+print(f"static constexpr EpdFontData {font_name} = {{")
 print(f"    {font_name}Bitmaps,")
 print(f"    {font_name}Glyphs,")
 print(f"    {font_name}Intervals,")
@@ -2,7 +2,28 @@
 
 #include <Utf8.h>
 
-void GfxRenderer::insertFont(const int fontId, EpdFontFamily font) { fontMap.insert({fontId, font}); }
+void GfxRenderer::insertFont(const int fontId, const EpdFontFamily& font) {
+  if (fontId < 0 || fontId >= MAX_FONTS) {
+    Serial.printf("[%lu] [GFX] Font id %d out of range\n", millis(), fontId);
+    return;
+  }
+  FontSlot& slot = fonts[fontId];
+  slot.family = font;
+  const EpdFontData* data = font.getData(EpdFontFamily::REGULAR);
+  slot.ascender = static_cast<int16_t>(data->ascender);
+  slot.lineHeight = data->advanceY;
+  const EpdGlyph* space = font.getGlyph(' ', EpdFontFamily::REGULAR);
+  slot.spaceWidth = space ? space->advanceX : 0;
+  slot.loaded = true;
+}
+
+const GfxRenderer::FontSlot* GfxRenderer::fontSlot(const int fontId) const {
+  if (fontId >= 0 && fontId < MAX_FONTS && fonts[fontId].loaded) {
+    return &fonts[fontId];
+  }
+  Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), fontId);
+  return nullptr;
+}
 
 void GfxRenderer::rotateCoordinates(const int x, const int y, int* rotatedX, int* rotatedY) const {
   switch (orientation) {
@@ -66,13 +87,13 @@ void GfxRenderer::drawPixel(const int x, const int y, const bool state) const {
 }
 
 int GfxRenderer::getTextWidth(const int fontId, const char* text, const EpdFontFamily::Style style) const {
-  if (fontMap.count(fontId) == 0) {
-    Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), fontId);
+  const FontSlot* slot = fontSlot(fontId);
+  if (!slot) {
     return 0;
   }
 
   int w = 0, h = 0;
-  fontMap.at(fontId).getTextDimensions(text, &w, &h, style);
+  slot->family.getTextDimensions(text, &w, &h, style);
   return w;
 }
 
@@ -84,25 +105,20 @@ void GfxRenderer::drawCenteredText(const int fontId, const int y, const char* te
 
 void GfxRenderer::drawText(const int fontId, const int x, const int y, const char* text, const bool black,
                            const EpdFontFamily::Style style) const {
-  const int yPos = y + getFontAscenderSize(fontId);
-  int xpos = x;
-
   // cannot draw a NULL / empty string
   if (text == nullptr || *text == '\0') {
     return;
   }
 
-  if (fontMap.count(fontId) == 0) {
-    Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), fontId);
-    return;
-  }
-  const auto font = fontMap.at(fontId);
-
-  // no printable characters
-  if (!font.hasPrintableChars(text, style)) {
+  const FontSlot* slot = fontSlot(fontId);
+  if (!slot) {
     return;
   }
+  const EpdFontFamily& font = slot->family;
+  const int yPos = y + slot->ascender;
+  int xpos = x;
 
+  // Single pass: glyphs without ink draw nothing, so no separate printable-chars scan
   uint32_t cp;
   while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&text)))) {
     renderChar(font, cp, &xpos, &yPos, black, style);
@@ -647,6 +663,135 @@ std::string GfxRenderer::truncatedText(const int fontId, const char* text, const
   return item.empty() ? ellipsis : item + ellipsis;
 }
 
+const char* GfxRenderer::truncatedText(const int fontId, const char* text, const int maxWidth, char* buf,
+                                       const size_t bufSize, const EpdFontFamily::Style style) const {
+  if (!text || maxWidth <= 0 || bufSize < 4) return "";
+  if (getTextWidth(fontId, text, style) <= maxWidth) return text;
+
+  // Anything longer than the buffer is far wider than the screen: start from what fits,
+  // cut on a codepoint boundary, with room left for the ellipsis
+  size_t len = strlen(text);
+  if (len > bufSize - 4) {
+    len = bufSize - 4;
+    while (len > 0 && (static_cast<unsigned char>(text[len]) & 0xC0) == 0x80) len--;
+  }
+  memcpy(buf, text, len);
+
+  while (len > 0) {
+    memcpy(buf + len, "...", 4);
+    if (getTextWidth(fontId, buf, style) < maxWidth) return buf;
+    len = utf8TrimLastChar(buf, len);
+  }
+  return "...";
+}
+
+namespace {
+// Ink bounds of a run, starting from the origin (the box EpdFont::getTextBounds builds)
+struct InkBox {
+  int minX = 0, maxX = 0, minY = 0, maxY = 0;
+
+  void add(const EpdGlyph* glyph, const int x) {
+    minX = std::min(minX, x + glyph->left);
+    maxX = std::max(maxX, x + glyph->left + glyph->width);
+    minY = std::min(minY, glyph->top - glyph->height);
+    maxY = std::max(maxY, static_cast<int>(glyph->top));
+  }
+};
+
+void storeBox(GfxRenderer::TextRun& run, const InkBox& box) {
+  run.minX = box.minX;
+  run.maxX = box.maxX;
+  run.minY = box.minY;
+  run.maxY = box.maxY;
+}
+}  // namespace
+
+bool GfxRenderer::layoutText(TextRun& run, const int fontId, const char* text, const EpdFontFamily::Style style) const {
+  run.count = 0;
+  run.advance = 0;
+  run.overflow = false;
+  run.data = nullptr;
+  InkBox box;
+  storeBox(run, box);
+
+  const FontSlot* slot = fontSlot(fontId);
+  if (!slot) {
+    return false;
+  }
+  run.data = slot->family.getData(style);
+  run.ascender = slot->ascender;
+  if (!text) {
+    return true;
+  }
+
+  const EpdFont font(run.data);
+  uint32_t cp;
+  while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&text)))) {
+    const EpdGlyph* glyph = font.getGlyph(cp);
+    if (!glyph) {
+      glyph = font.getGlyph(REPLACEMENT_GLYPH);
+    }
+    if (!glyph) {
+      continue;
+    }
+    if (run.count == TextRun::MAX_GLYPHS) {
+      run.overflow = true;
+      break;
+    }
+    run.items[run.count++] = {static_cast<uint16_t>(glyph - run.data->glyph), static_cast<int16_t>(run.advance)};
+    box.add(glyph, run.advance);
+    run.advance += glyph->advanceX;
+  }
+  storeBox(run, box);
+  return true;
+}
+
+void GfxRenderer::fitTextRun(TextRun& run, const int maxWidth) const {
+  if (!run.overflow && run.width() <= maxWidth) return;
+  run.overflow = false;
+  if (!run.data || maxWidth <= 0) {
+    run.count = 0;
+    run.advance = 0;
+    storeBox(run, InkBox());
+    return;
+  }
+
+  const EpdGlyph* dot = EpdFont(run.data).getGlyph('.');
+
+  // Longest prefix that is still narrower than maxWidth with "..." after it. The width
+  // only grows with the prefix, so one forward scan over the run finds it.
+  const int limit = std::min(run.count, TextRun::MAX_GLYPHS - 3);
+  InkBox prefix;
+  int keep = 0;
+  for (int k = 0; k <= limit; k++) {
+    if (k > 0) {
+      InkBox withDots = prefix;
+      const int pen = k < run.count ? run.items[k].x : run.advance;
+      for (int i = 0; dot && i < 3; i++) withDots.add(dot, pen + i * dot->advanceX);
+      if (withDots.maxX - withDots.minX < maxWidth) keep = k;
+    }
+    if (k < limit) prefix.add(&run.data->glyph[run.items[k].glyph], run.items[k].x);
+  }
+
+  InkBox box;
+  for (int i = 0; i < keep; i++) box.add(&run.data->glyph[run.items[i].glyph], run.items[i].x);
+  run.advance = keep < run.count ? run.items[keep].x : run.advance;
+  run.count = keep;
+  for (int i = 0; dot && i < 3; i++) {
+    run.items[run.count++] = {static_cast<uint16_t>(dot - run.data->glyph), static_cast<int16_t>(run.advance)};
+    box.add(dot, run.advance);
+    run.advance += dot->advanceX;
+  }
+  storeBox(run, box);
+}
+
+void GfxRenderer::drawTextRun(const TextRun& run, const int x, const int y, const bool black) const {
+  const int yPos = y + run.ascender;
+  for (int i = 0; i < run.count; i++) {
+    renderGlyph(run.data, &run.data->glyph[run.items[i].glyph], x + run.items[i].x, yPos, black);
+  }
+}
+
 // Note: Internal driver treats screen in command orientation; this library exposes a logical orientation
 int GfxRenderer::getScreenWidth() const {
   switch (orientation) {
@@ -677,52 +822,38 @@ int GfxRenderer::getScreenHeight() const {
 }
 
 int GfxRenderer::getSpaceWidth(const int fontId) const {
-  if (fontMap.count(fontId) == 0) {
-    Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), fontId);
-    return 0;
-  }
-
-  return fontMap.at(fontId).getGlyph(' ', EpdFontFamily::REGULAR)->advanceX;
+  const FontSlot* slot = fontSlot(fontId);
+  return slot ? slot->spaceWidth : 0;
 }
 
 int GfxRenderer::getTextAdvanceX(const int fontId, const char* text) const {
-  if (fontMap.count(fontId) == 0) {
-    Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), fontId);
+  const FontSlot* slot = fontSlot(fontId);
+  if (!slot) {
     return 0;
   }
+  const EpdFontFamily& font = slot->family;
 
   uint32_t cp;
   int width = 0;
   while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&text)))) {
-    width += fontMap.at(fontId).getGlyph(cp, EpdFontFamily::REGULAR)->advanceX;
+    width += font.getGlyph(cp, EpdFontFamily::REGULAR)->advanceX;
   }
   return width;
 }
 
 int GfxRenderer::getFontAscenderSize(const int fontId) const {
-  if (fontMap.count(fontId) == 0) {
-    Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), fontId);
-    return 0;
-  }
-
-  return fontMap.at(fontId).getData(EpdFontFamily::REGULAR)->ascender;
+  const FontSlot* slot = fontSlot(fontId);
+  return slot ? slot->ascender : 0;
 }
 
 int GfxRenderer::getLineHeight(const int fontId) const {
-  if (fontMap.count(fontId) == 0) {
-    Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), fontId);
-    return 0;
-  }
-
-  return fontMap.at(fontId).getData(EpdFontFamily::REGULAR)->advanceY;
+  const FontSlot* slot = fontSlot(fontId);
+  return slot ? slot->lineHeight : 0;
 }
 
 int GfxRenderer::getTextHeight(const int fontId) const {
-  if (fontMap.count(fontId) == 0) {
-    Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), fontId);
-    return 0;
-  }
-  return fontMap.at(fontId).getData(EpdFontFamily::REGULAR)->ascender;
+  const FontSlot* slot = fontSlot(fontId);
+  return slot ? slot->ascender : 0;
 }
 
 void GfxRenderer::drawTextRotated90CW(const int fontId, const int x, const int y, const char* text, const bool black,
@@ -732,16 +863,11 @@ void GfxRenderer::drawTextRotated90CW(const int fontId, const int x, const int y
     return;
   }
 
-  if (fontMap.count(fontId) == 0) {
-    Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), fontId);
-    return;
-  }
-  const auto font = fontMap.at(fontId);
-
-  // No printable characters
-  if (!font.hasPrintableChars(text, style)) {
+  const FontSlot* slot = fontSlot(fontId);
+  if (!slot) {
     return;
   }
+  const EpdFontFamily& font = slot->family;
 
   // For 90° clockwise rotation:
   // Original (glyphX, glyphY) -> Rotated (glyphY, -glyphX)
@@ -941,21 +1067,27 @@ void GfxRenderer::renderChar(const EpdFontFamily& fontFamily, const uint32_t cp,
     return;
   }
 
-  const int is2Bit = fontFamily.getData(style)->is2Bit;
+  renderGlyph(fontFamily.getData(style), glyph, *x, *y, pixelState);
+  *x += glyph->advanceX;
+}
+
+void GfxRenderer::renderGlyph(const EpdFontData* data, const EpdGlyph* glyph, const int x, const int y,
+                              const bool pixelState) const {
+  const int is2Bit = data->is2Bit;
   const uint32_t offset = glyph->dataOffset;
   const uint8_t width = glyph->width;
   const uint8_t height = glyph->height;
   const int left = glyph->left;
 
   const uint8_t* bitmap = nullptr;
-  bitmap = &fontFamily.getData(style)->bitmap[offset];
+  bitmap = &data->bitmap[offset];
 
   if (bitmap != nullptr) {
     for (int glyphY = 0; glyphY < height; glyphY++) {
-      const int screenY = *y - glyph->top + glyphY;
+      const int screenY = y - glyph->top + glyphY;
       for (int glyphX = 0; glyphX < width; glyphX++) {
         const int pixelPosition = glyphY * width + glyphX;
-        const int screenX = *x + left + glyphX;
+        const int screenX = x + left + glyphX;
 
         if (is2Bit) {
           const uint8_t byte = bitmap[pixelPosition / 4];
@@ -987,8 +1119,6 @@ void GfxRenderer::renderChar(const EpdFontFamily& fontFamily, const uint32_t cp,
       }
     }
   }
-
-  *x += glyph->advanceX;
 }
 
 void GfxRenderer::getOrientedViewableTRBL(int* outTop, int* outRight, int* outBottom, int* outLeft) const {
@@ -3,8 +3,6 @@
 #include <EpdFontFamily.h>
 #include <HalDisplay.h>
 
-#include <map>
-
 #include "Bitmap.h"
 
 // Color representation: uint8_t mapped to 4x4 Bayer matrix dithering levels
@@ -23,6 +21,9 @@ class GfxRenderer {
     LandscapeCounterClockwise  // 800x480 logical coordinates, native panel orientation
   };
 
+  // Font IDs are dense: 0 .. MAX_FONTS - 1
+  static constexpr int MAX_FONTS = 4;
+
  private:
   static constexpr size_t BW_BUFFER_CHUNK_SIZE = 8000;  // 8KB chunks to allow for non-contiguous memory
   static constexpr size_t BW_BUFFER_NUM_CHUNKS = HalDisplay::BUFFER_SIZE / BW_BUFFER_CHUNK_SIZE;
@@ -34,9 +35,21 @@ class GfxRenderer {
   Orientation orientation;
   bool fadingFix;
   uint8_t* bwBufferChunks[BW_BUFFER_NUM_CHUNKS] = {nullptr};
-  std::map<int, EpdFontFamily> fontMap;
+
+  // Font table: font IDs are small dense indices into a flat array, so every text call is
+  // a bounds check and an index. The per-line metrics are read once, at insertFont().
+  struct FontSlot {
+    EpdFontFamily family{nullptr};
+    int16_t ascender = 0;
+    uint8_t lineHeight = 0;
+    uint8_t spaceWidth = 0;
+    bool loaded = false;
+  };
+  FontSlot fonts[MAX_FONTS];
+  const FontSlot* fontSlot(int fontId) const;
   void renderChar(const EpdFontFamily& fontFamily, uint32_t cp, int* x, const int* y, bool pixelState,
                   EpdFontFamily::Style style) const;
+  void renderGlyph(const EpdFontData* data, const EpdGlyph* glyph, int x, int y, bool pixelState) const;
   void freeBwBufferChunks();
   void rotateCoordinates(int x, int y, int* rotatedX, int* rotatedY) const;
   void drawPixelDither(int x, int y, Color color) const;
@@ -53,7 +66,7 @@ class GfxRenderer {
   static constexpr int VIEWABLE_MARGIN_LEFT = 3;
 
   // Setup
-  void insertFont(int fontId, EpdFontFamily font);
+  void insertFont(int fontId, const EpdFontFamily& font);
 
   // Orientation control (affects logical width/height and coordinate transforms)
   void setOrientation(const Orientation o) { orientation = o; }
@@ -105,6 +118,38 @@ class GfxRenderer {
   int getLineHeight(int fontId) const;
   std::string truncatedText(int fontId, const char* text, int maxWidth,
                             EpdFontFamily::Style style = EpdFontFamily::REGULAR) const;
+  // Same, without the heap: returns `text` itself when it fits, else the truncated copy in `buf`
+  const char* truncatedText(int fontId, const char* text, int maxWidth, char* buf, size_t bufSize,
+                            EpdFontFamily::Style style = EpdFontFamily::REGULAR) const;
+
+  // Text runs: a string decoded once into its glyphs and pen positions, then measured,
+  // fitted and drawn from that without decoding it or looking a glyph up again. Runs are
+  // caller-owned and reusable; codepoints past MAX_GLYPHS are dropped and the run then
+  // never counts as fitting, so fitTextRun() ends it with an ellipsis.
+  struct TextRun {
+    static constexpr int MAX_GLYPHS = 256;
+    struct Item {
+      uint16_t glyph;  // Index into data->glyph
+      int16_t x;       // Pen x relative to the run origin
+    };
+    const EpdFontData* data = nullptr;
+    int ascender = 0;
+    int count = 0;
+    int advance = 0;  // Pen x after the last glyph
+    // Ink bounds, starting from the origin (the same box getTextWidth measures)
+    int minX = 0, maxX = 0, minY = 0, maxY = 0;
+    bool overflow = false;
+    Item items[MAX_GLYPHS];
+
+    int width() const { return maxX - minX; }
+  };
+  // False (and an empty run) if the font isn't registered
+  bool layoutText(TextRun& run, int fontId, const char* text,
+                  EpdFontFamily::Style style = EpdFontFamily::REGULAR) const;
+  // Same rule as truncatedText(): unchanged if it fits, else the longest prefix that is
+  // narrower than maxWidth with "..." appended
+  void fitTextRun(TextRun& run, int maxWidth) const;
+  void drawTextRun(const TextRun& run, int x, int y, bool black = true) const;
 
   // Helper for drawing rotated text (90 degrees clockwise, for side buttons)
   void drawTextRotated90CW(int fontId, int x, int y, const char* text, bool black = true,
@@ -4,14 +4,99 @@
 #include <vector>
 #include <string>
 #include <SdFat.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// --- Block I/O ---
+// All bulk file traffic goes through SdBlockReader / SdBlockWriter. Transfers are whole
+// 512-byte sectors at sector-aligned file offsets, which lets SdFat move them with
+// multi-sector commands straight to/from our buffer instead of through its one-sector cache.
+constexpr size_t SD_SECTOR_SIZE = 512;
+constexpr size_t SD_IO_BLOCK_SIZE = 4 * SD_SECTOR_SIZE;  // One read-ahead / write-behind block
+constexpr int SD_IO_POOL_BLOCKS = 3;                     // Static buffers shared by all readers/writers
+                                                          // (a save needs two, a sync transfer one)
+
+// Running totals since boot — diff two snapshots to measure one operation
+struct SdIoStats {
+  uint32_t readTransfers;
+  uint32_t readBytes;
+  uint32_t writeTransfers;
+  uint32_t writeBytes;
+  uint64_t busyMicros;  // Card time: block transfers plus mount / resume
+  uint32_t mounts;      // Wakes by full begin() ...
+  uint32_t resumes;     // ... and by resume() (volume kept mounted)
+  uint64_t mountMicros;
+  uint64_t resumeMicros;
+};
+
+class SdBlockReader {
+ public:
+  SdBlockReader() = default;
+  ~SdBlockReader() { close(); }
+  SdBlockReader(const SdBlockReader&) = delete;
+  SdBlockReader& operator=(const SdBlockReader&) = delete;
+
+  // readAhead = refill a whole block per card access (sequential scans);
+  // otherwise refill one sector at a time. Returns false if the file or a pool buffer is unavailable.
+  bool open(const char* path, bool readAhead = true);
+  bool isOpen() const { return buf != nullptr; }
+  size_t size() { return file.size(); }
+  // FAT modify stamp of the open file
+  bool modifyDateTime(uint16_t* date, uint16_t* time);
+  // Copy up to `len` bytes into `dst`. Whole sectors are read straight into `dst`.
+  // Returns bytes read (short only at EOF), -1 on error.
+  int read(void* dst, size_t len);
+  // Zero-copy: point `data` at the next buffered chunk. Returns its length, 0 at EOF, -1 on error.
+  int next(const uint8_t*& data);
+  // Random access. Stays inside the buffered block when it can, otherwise re-reads from
+  // the containing sector so later transfers stay aligned. False if `pos` is past EOF.
+  bool seek(uint32_t pos);
+  uint32_t position() { return static_cast<uint32_t>(file.curPosition()) - (bufLen - bufPos); }
+  void close();
+
+ private:
+  int fill();
+  FsFile file;
+  uint8_t* buf = nullptr;
+  size_t bufLen = 0;
+  size_t bufPos = 0;
+  bool readAhead = true;
+};
+
+class SdBlockWriter {
+ public:
+  SdBlockWriter() = default;
+  ~SdBlockWriter() { close(); }
+  SdBlockWriter(const SdBlockWriter&) = delete;
+  SdBlockWriter& operator=(const SdBlockWriter&) = delete;
+
+  // Create or truncate `path`. Returns false if the file or a pool buffer is unavailable.
+  bool open(const char* path);
+  // Buffered until a block fills; whole sectors arriving on an empty buffer skip the copy.
+  bool write(const void* src, size_t len);
+  // Flush and close. Returns false if any write came up short.
+  bool close();
+  size_t written() const { return total; }
+
+ private:
+  bool put(const uint8_t* data, size_t len);
+  FsFile file;
+  uint8_t* buf = nullptr;
+  size_t bufLen = 0;
+  size_t total = 0;
+  bool ok = true;
+};
 
 class SDCardManager {
  public:
   SDCardManager();
   bool begin();
   bool ready() const;
-  // Release the SPI bus to save power. Next access auto-reinitializes.
+  // Release the SPI bus to save power. The volume stays mounted; the next access only
+  // re-checks the card (CID) and does a full remount if it changed or stopped answering.
   void sleep();
+  // Force a full remount on the next access (called after an I/O error)
+  void markError();
   std::vector<String> listFiles(const char* path = "/", int maxFiles = 200);
   // Read the entire file at `path` into a String. Returns empty string on failure.
   String readFile(const char* path);
@@ -26,13 +111,36 @@ class SDCardManager {
   bool writeFile(const char* path, const String& content);
   // Ensure a directory exists, creating it if necessary. Returns true on success.
   bool ensureDirectoryExists(const char* path);
+  // Block I/O transfer counters (see SdBlockReader / SdBlockWriter)
+  static SdIoStats ioStats();
+
+  // Card ownership between tasks — SdFat and the I/O pool are not thread-safe. Held for
+  // one unit of SD work at a time, never across network I/O or a wait: every method here
+  // and in SdBlockReader / SdBlockWriter takes it, and code using an FsFile directly
+  // holds a Lock for the sequence. Recursive, so those nest.
+  void lock() { xSemaphoreTakeRecursive(mutex, portMAX_DELAY); }
+  void unlock() { xSemaphoreGiveRecursive(mutex); }
+
+  class Lock {
+   public:
+    Lock() { instance.lock(); }
+    ~Lock() { instance.unlock(); }
+    Lock(const Lock&) = delete;
+    Lock& operator=(const Lock&) = delete;
+  };
 
-  FsFile open(const char* path, const oflag_t oflag = O_RDONLY) { if (!ensureReady()) return FsFile(); return sd.open(path, oflag); }
-  bool mkdir(const char* path, const bool pFlag = true) { if (!ensureReady()) return false; return sd.mkdir(path, pFlag); }
-  bool exists(const char* path) { if (!ensureReady()) return false; return sd.exists(path); }
-  bool remove(const char* path) { if (!ensureReady()) return false; return sd.remove(path); }
-  bool rmdir(const char* path) { if (!ensureReady()) return false; return sd.rmdir(path); }
-  bool rename(const char* path, const char* newPath) { if (!ensureReady()) return false; return sd.rename(path, newPath); }
+  FsFile open(const char* path, const oflag_t oflag = O_RDONLY) {
+    Lock card;
+    if (!ensureReady()) return FsFile();
+    FsFile f = sd.open(path, oflag);
+    if (!f) checkCardError();
+    return f;
+  }
+  bool mkdir(const char* path, const bool pFlag = true) { Lock card; if (!ensureReady()) return false; return sd.mkdir(path, pFlag); }
+  bool exists(const char* path) { Lock card; if (!ensureReady()) return false; return sd.exists(path); }
+  bool remove(const char* path) { Lock card; if (!ensureReady()) return false; return sd.remove(path); }
+  bool rmdir(const char* path) { Lock card; if (!ensureReady()) return false; return sd.rmdir(path); }
+  bool rename(const char* path, const char* newPath) { Lock card; if (!ensureReady()) return false; return sd.rename(path, newPath); }
 
   bool openFileForRead(const char* moduleName, const char* path, FsFile& file);
   bool openFileForRead(const char* moduleName, const std::string& path, FsFile& file);
@@ -48,9 +156,16 @@ class SDCardManager {
   static SDCardManager instance;
 
   bool ensureReady();
+  bool resume();
+  void checkCardError();
   bool initialized = false;
   bool hasCard = false;  // true after first successful begin() — distinguishes sleep from no card
+  bool sleeping = false; // Mounted but idle — resume() instead of begin() on next access
+  cid_t mountedCid{};    // Identity of the mounted card, compared on resume to catch a swap
   SdFat sd;
+  StaticSemaphore_t mutexBuf;
+  SemaphoreHandle_t mutex;
 };
 
 #define SdMan SDCardManager::getInstance()
+using SdLock = SDCardManager::Lock;
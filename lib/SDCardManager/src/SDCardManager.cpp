@@ -3,18 +3,58 @@
 namespace {
 constexpr uint8_t SD_CS = 12;
 constexpr uint32_t SPI_FQ = 40000000;
+
+// Block I/O buffer pool — fixed at link time so bulk transfers never touch the heap
+alignas(4) uint8_t ioPool[SD_IO_POOL_BLOCKS][SD_IO_BLOCK_SIZE];
+bool ioPoolUsed[SD_IO_POOL_BLOCKS];
+SdIoStats ioCounters;
+
+// Adds the time until the end of the enclosing scope to the card busy total
+struct CardBusy {
+  const unsigned long startUs = micros();
+  ~CardBusy() { ioCounters.busyMicros += micros() - startUs; }
+};
+
+uint8_t* acquireIoBlock() {
+  SdMan.lock();
+  for (int i = 0; i < SD_IO_POOL_BLOCKS; i++) {
+    if (!ioPoolUsed[i]) {
+      ioPoolUsed[i] = true;
+      SdMan.unlock();
+      return ioPool[i];
+    }
+  }
+  SdMan.unlock();
+  if (Serial) Serial.printf("[%lu] [SD] I/O buffer pool exhausted\n", millis());
+  return nullptr;
+}
+
+void releaseIoBlock(uint8_t* block) {
+  SdMan.lock();
+  for (int i = 0; i < SD_IO_POOL_BLOCKS; i++) {
+    if (ioPool[i] == block) ioPoolUsed[i] = false;
+  }
+  SdMan.unlock();
 }
+}  // namespace
 
 SDCardManager SDCardManager::instance;
 
-SDCardManager::SDCardManager() : sd() {}
+SDCardManager::SDCardManager() : sd(), mutex(xSemaphoreCreateRecursiveMutexStatic(&mutexBuf)) {}
 
 bool SDCardManager::begin() {
+  SdLock card;
+  const unsigned long startUs = micros();
+  sleeping = false;
+  CardBusy busy;
   if (!sd.begin(SD_CS, SPI_FQ)) {
     if (Serial) Serial.printf("[%lu] [SD] SD card not detected\n", millis());
     initialized = false;
   } else {
-    if (Serial) Serial.printf("[%lu] [SD] SD card detected\n", millis());
+    if (!sd.card()->readCID(&mountedCid)) memset(&mountedCid, 0, sizeof(mountedCid));
+    ioCounters.mounts++;
+    ioCounters.mountMicros += micros() - startUs;
+    if (Serial) Serial.printf("[%lu] [SD] SD card detected, mounted in %lu us\n", millis(), micros() - startUs);
     initialized = true;
     hasCard = true;
   }
@@ -27,20 +67,55 @@ bool SDCardManager::ready() const {
 }
 
 void SDCardManager::sleep() {
+  SdLock card;
   if (!initialized) return;
   // Mark as sleeping — SD card enters standby naturally when CS is deasserted.
   // Cannot call SPI.end() because the display shares the same SPI bus.
-  // ensureReady() will re-init the SD card on next access.
+  // The mounted volume and SdFat's FAT cache stay valid, so ensureReady() only
+  // has to confirm the card is still there (resume) instead of re-running sd.begin().
+  sleeping = true;
+}
+
+void SDCardManager::markError() {
+  if (Serial) Serial.printf("[%lu] [SD] I/O error — full remount on next access\n", millis());
+  initialized = false;
+  sleeping = false;
+}
+
+// A failed open is usually just a missing file; only a card-level error code means
+// the mounted state can no longer be trusted.
+void SDCardManager::checkCardError() {
+  if (sd.card() && sd.card()->errorCode() != 0) markError();
+}
+
+// Wake from sleep(): one CMD10 (read CID) proves the card answers and is the same card
+// that was mounted. Anything else falls back to a full begin().
+bool SDCardManager::resume() {
+  const unsigned long startUs = micros();
+  CardBusy busy;
+  cid_t cid;
+  if (sd.card()->readCID(&cid) && memcmp(&cid, &mountedCid, sizeof(cid)) == 0) {
+    sleeping = false;
+    ioCounters.resumes++;
+    ioCounters.resumeMicros += micros() - startUs;
+    if (Serial) Serial.printf("[%lu] [SD] Resumed in %lu us\n", millis(), micros() - startUs);
+    return true;
+  }
+  if (Serial) Serial.printf("[%lu] [SD] Card changed or not responding — remounting\n", millis());
   initialized = false;
+  sleeping = false;
+  return false;
 }
 
 bool SDCardManager::ensureReady() {
-  if (initialized) return true;
+  if (initialized && !sleeping) return true;
+  if (initialized && resume()) return true;
   if (!hasCard) return false;  // No card was ever detected — don't retry
   return begin();
 }
 
 std::vector<String> SDCardManager::listFiles(const char* path, const int maxFiles) {
+  SdLock card;
   std::vector<String> ret;
   if (!ensureReady()) return ret;
 
@@ -72,85 +147,67 @@ std::vector<String> SDCardManager::listFiles(const char* path, const int maxFile
 }
 
 String SDCardManager::readFile(const char* path) {
-  if (!ensureReady()) return {""};
-
-  FsFile f;
-  if (!openFileForRead("SD", path, f)) {
+  SdLock card;
+  SdBlockReader reader;
+  if (!reader.open(path)) {
     return {""};
   }
 
   String content = "";
   constexpr size_t maxSize = 50000;  // Limit to 50KB
-  size_t readSize = 0;
-  while (f.available() && readSize < maxSize) {
-    const char c = static_cast<char>(f.read());
-    content += c;
-    readSize++;
+  content.reserve(min(reader.size(), maxSize));
+
+  const uint8_t* data;
+  int n;
+  while (content.length() < maxSize && (n = reader.next(data)) > 0) {
+    const size_t room = maxSize - content.length();
+    content.concat(reinterpret_cast<const char*>(data), min(static_cast<size_t>(n), room));
   }
-  f.close();
   return content;
 }
 
 bool SDCardManager::readFileToStream(const char* path, Print& out, const size_t chunkSize) {
-  if (!ensureReady()) return false;
-
-  FsFile f;
-  if (!openFileForRead("SD", path, f)) {
+  SdLock card;
+  SdBlockReader reader;
+  if (!reader.open(path)) {
     return false;
   }
 
-  constexpr size_t localBufSize = 256;
-  uint8_t buf[localBufSize];
-  const size_t toRead = (chunkSize == 0) ? localBufSize : (chunkSize < localBufSize ? chunkSize : localBufSize);
-
-  while (f.available()) {
-    const int r = f.read(buf, toRead);
-    if (r > 0) {
-      out.write(buf, static_cast<size_t>(r));
-    } else {
-      break;
+  // Hand the pool block to `out` directly, split into chunkSize pieces if asked
+  const uint8_t* data;
+  int n;
+  while ((n = reader.next(data)) > 0) {
+    size_t left = static_cast<size_t>(n);
+    while (left > 0) {
+      const size_t piece = (chunkSize == 0 || chunkSize > left) ? left : chunkSize;
+      out.write(data, piece);
+      data += piece;
+      left -= piece;
     }
   }
-
-  f.close();
-  return true;
+  return n == 0;
 }
 
 size_t SDCardManager::readFileToBuffer(const char* path, char* buffer, const size_t bufferSize, const size_t maxBytes) {
+  SdLock card;
   if (!buffer || bufferSize == 0)
     return 0;
-  if (!ensureReady()) {
-    buffer[0] = '\0';
-    return 0;
-  }
-
-  FsFile f;
-  if (!openFileForRead("SD", path, f)) {
+  SdBlockReader reader;
+  if (!reader.open(path)) {
     buffer[0] = '\0';
     return 0;
   }
 
   const size_t maxToRead = (maxBytes == 0) ? (bufferSize - 1) : min(maxBytes, bufferSize - 1);
-  size_t total = 0;
-
-  while (f.available() && total < maxToRead) {
-    constexpr size_t chunk = 64;
-    const size_t want = maxToRead - total;
-    const size_t readLen = (want < chunk) ? want : chunk;
-    const int r = f.read(buffer + total, readLen);
-    if (r > 0) {
-      total += static_cast<size_t>(r);
-    } else {
-      break;
-    }
-  }
+  const int r = reader.read(buffer, maxToRead);
+  const size_t total = (r > 0) ? static_cast<size_t>(r) : 0;
 
   buffer[total] = '\0';
-  f.close();
   return total;
 }
 
 bool SDCardManager::writeFile(const char* path, const String& content) {
+  SdLock card;
   if (!ensureReady()) return false;
 
   // Remove existing file so we perform an overwrite rather than append
@@ -158,19 +215,18 @@ bool SDCardManager::writeFile(const char* path, const String& content) {
     sd.remove(path);
   }
 
-  FsFile f;
-  if (!openFileForWrite("SD", path, f)) {
-    if (Serial) Serial.printf("[%lu] [SD] Path is not a directory\n", millis());
+  SdBlockWriter writer;
+  if (!writer.open(path)) {
     if (Serial) Serial.printf("Failed to open file for write: %s\n", path);
     return false;
   }
 
-  const size_t written = f.print(content);
-  f.close();
-  return written == content.length();
+  writer.write(content.c_str(), content.length());
+  return writer.close() && writer.written() == content.length();
 }
 
 bool SDCardManager::ensureDirectoryExists(const char* path) {
+  SdLock card;
   if (!ensureReady()) return false;
 
   // Check if directory already exists
@@ -198,6 +254,7 @@ bool SDCardManager::ensureDirectoryExists(const char* path) {
 }
 
 bool SDCardManager::openFileForRead(const char* moduleName, const char* path, FsFile& file) {
+  SdLock card;
   if (!ensureReady()) return false;
   if (!sd.exists(path)) {
     if (Serial) Serial.printf("[%lu] [%s] File does not exist: %s\n", millis(), moduleName, path);
@@ -221,6 +278,7 @@ bool SDCardManager::openFileForRead(const char* moduleName, const String& path,
 }
 
 bool SDCardManager::openFileForWrite(const char* moduleName, const char* path, FsFile& file) {
+  SdLock card;
   if (!ensureReady()) return false;
   file = sd.open(path, O_RDWR | O_CREAT | O_TRUNC);
   if (!file) {
@@ -239,6 +297,7 @@ bool SDCardManager::openFileForWrite(const char* moduleName, const String& path,
 }
 
 bool SDCardManager::removeDir(const char* path) {
+  SdLock card;
   if (!ensureReady()) return false;
   // 1. Open the directory
   auto dir = sd.open(path);
@@ -273,3 +332,206 @@ bool SDCardManager::removeDir(const char* path) {
 
   return sd.rmdir(path);
 }
+
+SdIoStats SDCardManager::ioStats() {
+  return ioCounters;
+}
+
+// ---------------------------------------------------------------------------
+// SdBlockReader
+// ---------------------------------------------------------------------------
+
+bool SdBlockReader::open(const char* path, const bool readAheadBlocks) {
+  SdLock card;
+  close();
+  file = SdMan.open(path, O_RDONLY);
+  if (!file) return false;
+  buf = acquireIoBlock();
+  if (!buf) {
+    file.close();
+    return false;
+  }
+  bufLen = 0;
+  bufPos = 0;
+  readAhead = readAheadBlocks;
+  return true;
+}
+
+// Refill the buffer. The file position is always sector-aligned here: every card
+// read is a whole number of sectors until the short read at EOF.
+int SdBlockReader::fill() {
+  CardBusy busy;
+  const int r = file.read(buf, readAhead ? SD_IO_BLOCK_SIZE : SD_SECTOR_SIZE);
+  bufPos = 0;
+  bufLen = (r > 0) ? static_cast<size_t>(r) : 0;
+  if (r > 0) {
+    ioCounters.readTransfers++;
+    ioCounters.readBytes += r;
+  }
+  return r;
+}
+
+int SdBlockReader::read(void* dst, const size_t len) {
+  SdLock card;
+  if (!buf) return -1;
+  auto* out = static_cast<uint8_t*>(dst);
+  size_t total = 0;
+
+  while (total < len) {
+    if (bufPos < bufLen) {
+      const size_t n = min(len - total, bufLen - bufPos);
+      memcpy(out + total, buf + bufPos, n);
+      bufPos += n;
+      total += n;
+      continue;
+    }
+
+    // Buffer drained: move whole sectors straight into the caller's memory
+    const size_t direct = (len - total) & ~(SD_SECTOR_SIZE - 1);
+    if (direct > 0) {
+      CardBusy busy;
+      const int r = file.read(out + total, direct);
+      if (r < 0) {
+        SdMan.markError();
+        return -1;
+      }
+      ioCounters.readTransfers++;
+      ioCounters.readBytes += r;
+      total += r;
+      if (static_cast<size_t>(r) < direct) break;  // EOF
+      continue;
+    }
+
+    const int r = fill();
+    if (r < 0) {
+      SdMan.markError();
+      return -1;
+    }
+    if (r == 0) break;
+  }
+  return static_cast<int>(total);
+}
+
+int SdBlockReader::next(const uint8_t*& data) {
+  SdLock card;
+  if (!buf) return -1;
+  if (bufPos >= bufLen) {
+    const int r = fill();
+    if (r < 0) SdMan.markError();
+    if (r <= 0) return r;
+  }
+  data = buf + bufPos;
+  const int n = static_cast<int>(bufLen - bufPos);
+  bufPos = bufLen;
+  return n;
+}
+
+bool SdBlockReader::seek(const uint32_t pos) {
+  SdLock card;
+  if (!buf) return false;
+  const uint32_t bufStart = static_cast<uint32_t>(file.curPosition()) - bufLen;
+  if (pos >= bufStart && pos <= bufStart + bufLen) {
+    bufPos = pos - bufStart;
+    return true;
+  }
+
+  const uint32_t aligned = pos & ~static_cast<uint32_t>(SD_SECTOR_SIZE - 1);
+  if (!file.seekSet(aligned)) return false;
+  bufLen = 0;
+  bufPos = 0;
+  const size_t skip = pos - aligned;
+  if (skip == 0) return true;
+  if (fill() < static_cast<int>(skip)) return false;
+  bufPos = skip;
+  return true;
+}
+
+bool SdBlockReader::modifyDateTime(uint16_t* date, uint16_t* time) {
+  SdLock card;
+  return file.getModifyDateTime(date, time);
+}
+
+void SdBlockReader::close() {
+  SdLock card;
+  if (file) file.close();
+  if (buf) releaseIoBlock(buf);
+  buf = nullptr;
+  bufLen = 0;
+  bufPos = 0;
+}
+
+// ---------------------------------------------------------------------------
+// SdBlockWriter
+// ---------------------------------------------------------------------------
+
+bool SdBlockWriter::open(const char* path) {
+  SdLock card;
+  close();
+  file = SdMan.open(path, O_WRONLY | O_CREAT | O_TRUNC);
+  if (!file) return false;
+  buf = acquireIoBlock();
+  if (!buf) {
+    file.close();
+    return false;
+  }
+  bufLen = 0;
+  total = 0;
+  ok = true;
+  return true;
+}
+
+bool SdBlockWriter::put(const uint8_t* data, const size_t len) {
+  CardBusy busy;
+  const size_t w = file.write(data, len);
+  ioCounters.writeTransfers++;
+  ioCounters.writeBytes += w;
+  total += w;
+  if (w != len) {
+    ok = false;
+    SdMan.markError();
+  }
+  return ok;
+}
+
+// The file position is sector-aligned whenever the buffer is empty: only full
+// blocks and whole-sector runs reach the card before close().
+bool SdBlockWriter::write(const void* src, size_t len) {
+  SdLock card;
+  if (!buf || !ok) return false;
+  auto* in = static_cast<const uint8_t*>(src);
+
+  while (len > 0) {
+    if (bufLen == 0 && len >= SD_SECTOR_SIZE) {
+      const size_t direct = len & ~(SD_SECTOR_SIZE - 1);
+      if (!put(in, direct)) return false;
+      in += direct;
+      len -= direct;
+      continue;
+    }
+
+    const size_t n = min(len, SD_IO_BLOCK_SIZE - bufLen);
+    memcpy(buf + bufLen, in, n);
+    bufLen += n;
+    in += n;
+    len -= n;
+    if (bufLen == SD_IO_BLOCK_SIZE) {
+      bufLen = 0;
+      if (!put(buf, SD_IO_BLOCK_SIZE)) return false;
+    }
+  }
+  return true;
+}
+
+bool SdBlockWriter::close() {
+  SdLock card;
+  if (!buf) return ok;
+  if (bufLen > 0 && ok) put(buf, bufLen);
+  bufLen = 0;
+  {
+    CardBusy busy;  // Close writes the directory entry
+    if (!file.close()) ok = false;
+  }
+  releaseIoBlock(buf);
+  buf = nullptr;
+  return ok;
+}
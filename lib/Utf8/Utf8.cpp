@@ -31,12 +31,16 @@ uint32_t utf8NextCodepoint(const unsigned char** string) {
 }
 
 size_t utf8RemoveLastChar(std::string& str) {
-  if (str.empty()) return 0;
-  size_t pos = str.size() - 1;
+  str.resize(utf8TrimLastChar(str.data(), str.size()));
+  return str.size();
+}
+
+size_t utf8TrimLastChar(const char* str, const size_t len) {
+  if (len == 0) return 0;
+  size_t pos = len - 1;
   while (pos > 0 && (static_cast<unsigned char>(str[pos]) & 0xC0) == 0x80) {
     --pos;
   }
-  str.resize(pos);
   return pos;
 }
 
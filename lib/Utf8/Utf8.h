@@ -7,5 +7,7 @@
 uint32_t utf8NextCodepoint(const unsigned char** string);
 // Remove the last UTF-8 codepoint from a std::string and return the new size.
 size_t utf8RemoveLastChar(std::string& str);
+// Length of the first `len` bytes of `str` with their last UTF-8 codepoint removed.
+size_t utf8TrimLastChar(const char* str, size_t len);
 // Truncate string by removing N UTF-8 codepoints from the end.
 void utf8TruncateChars(std::string& str, size_t numChars);
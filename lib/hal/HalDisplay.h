@@ -37,6 +37,10 @@ class HalDisplay {
   // Power management
   void deepSleep();
 
+  // Running totals since boot: SPI transfer time and BUSY (refresh) wait time
+  uint64_t getSpiMicros() const { return einkDisplay.getSpiMicros(); }
+  uint64_t getBusyMicros() const { return einkDisplay.getBusyMicros(); }
+
   // Access to frame buffer
   uint8_t* getFrameBuffer() const;
 
@@ -1,7 +1,25 @@
 #include <HalGPIO.h>
-#include <Preferences.h>
 #include <SPI.h>
 #include <esp_sleep.h>
+#include <esp_timer.h>
+
+// Battery voltage changes on a timescale of minutes: a slow timer takes an oversampled
+// reading and folds it into a moving average, and getBatteryPercentage() only looks the
+// cached average up. The first reading is taken in begin(), before the display and radio
+// load the battery, so the first frame already shows a real value.
+static constexpr uint32_t BATTERY_SAMPLE_MS = 30000;
+static constexpr uint8_t BATTERY_OVERSAMPLE = 16;
+static constexpr int BATTERY_EMA_SHIFT = 2;  // New reading weighs 1/4 — settles in a few minutes
+
+static const BatteryMonitor battery(BAT_GPIO0);
+static volatile uint32_t batteryMvQ4 = 0;  // Average battery millivolts, ×16
+static esp_timer_handle_t batteryTimer = nullptr;
+
+static void sampleBattery(void*) {
+  const int32_t sample = static_cast<int32_t>(battery.readMillivoltsAveraged(BATTERY_OVERSAMPLE)) << 4;
+  const int32_t avg = static_cast<int32_t>(batteryMvQ4);
+  batteryMvQ4 = static_cast<uint32_t>(avg + ((sample - avg) >> BATTERY_EMA_SHIFT));
+}
 
 void HalGPIO::begin() {
   inputMgr.begin();
@@ -9,6 +27,15 @@ void HalGPIO::begin() {
   // BAT_GPIO0 is configured for ADC via adc1_config_channel_atten in InputManager::begin()
   // — do NOT call pinMode() here as it reconfigures the pin as digital input in dual framework
   pinMode(UART0_RXD, INPUT);
+
+  batteryMvQ4 = static_cast<uint32_t>(battery.readMillivoltsAveraged(BATTERY_OVERSAMPLE)) << 4;
+  esp_timer_create_args_t args = {};
+  args.callback = sampleBattery;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "bat_sample";
+  args.skip_unhandled_events = true;
+  esp_timer_create(&args, &batteryTimer);
+  esp_timer_start_periodic(batteryTimer, BATTERY_SAMPLE_MS * 1000ULL);
 }
 
 void HalGPIO::update() { inputMgr.update(); }
@@ -25,6 +52,8 @@ bool HalGPIO::wasAnyReleased() const { return inputMgr.wasAnyReleased(); }
 
 unsigned long HalGPIO::getHeldTime() const { return inputMgr.getHeldTime(); }
 
+uint8_t HalGPIO::sampleButtons() { return inputMgr.getState(); }
+
 void HalGPIO::startDeepSleep() {
   // Ensure that the power button has been released to avoid immediately turning back on if you're holding it
   while (inputMgr.isPressed(BTN_POWER)) {
@@ -38,32 +67,8 @@ void HalGPIO::startDeepSleep() {
 }
 
 int HalGPIO::getBatteryPercentage() const {
-  static const BatteryMonitor battery = BatteryMonitor(BAT_GPIO0);
-  static int cachedPct = -1;
-  static unsigned long lastReadMs = 0;
-
-  // On first call, load the last persisted reading so we don't show a stale default
-  if (cachedPct < 0) {
-    Preferences prefs;
-    prefs.begin("battery", true);  // read-only
-    cachedPct = prefs.getInt("pct", -1);
-    prefs.end();
-  }
-
-  unsigned long now = millis();
-  // Battery voltage changes on a timescale of minutes — no need to read every frame
-  if (cachedPct < 0 || (now - lastReadMs) >= 30000) {
-    int newPct = battery.readPercentage();
-    if (newPct != cachedPct) {
-      Preferences prefs;
-      prefs.begin("battery", false);
-      prefs.putInt("pct", newPct);
-      prefs.end();
-    }
-    cachedPct = newPct;
-    lastReadMs = now;
-  }
-  return cachedPct;
+  // Cached EMA through the lookup table — no ADC work on the draw path
+  return BatteryMonitor::percentageFromMillivolts((batteryMvQ4 + 8) >> 4);
 }
 
 bool HalGPIO::isUsbConnected() const {
@@ -38,6 +38,10 @@ class HalGPIO {
   bool wasAnyReleased() const;
   unsigned long getHeldTime() const;
 
+  // Raw (undebounced) button bitmask, one bit per button index. Leaves update() state
+  // alone, so a timer can sample it between update() calls.
+  uint8_t sampleButtons();
+
   // Setup wake up GPIO and enter deep sleep
   void startDeepSleep();
 
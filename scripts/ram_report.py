@@ -0,0 +1,220 @@
+"""Static RAM budget report, read from the linker map.
+
+Lists every statically allocated table in DRAM (.data/.bss/.noinit) and RTC memory,
+grouped by subsystem (source module, bundled library or framework component), then the
+largest individual tables. Runs after every `pio run` link (extra_scripts in
+platformio.ini) and compares against the previous build; standalone:
+
+    python scripts/ram_report.py .pio/build/xteink_x4/firmware.map [baseline.map|.json]
+"""
+
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+MIN_TABLE_BYTES = 256  # Smaller symbols only count towards their subsystem total
+
+SECTION_PREFIXES = (".rtc_noinit.", ".rtc.bss.", ".rtc.data.", ".noinit.", ".sbss.", ".sdata.", ".bss.", ".data.",
+                    ".tbss.", ".tdata.")
+
+OUTPUT_SECTION = re.compile(r"^(\.\S+)(?:\s+0x[0-9a-fA-F]+\s+0x[0-9a-fA-F]+)?")
+INPUT_FULL = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+INPUT_NAME = re.compile(r"^ (\S+)$")
+INPUT_REST = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+
+
+def region_of(output_section):
+    """DRAM, RTC, or None for sections that don't take RAM (code, flash rodata, debug)."""
+    name = output_section.lower()
+    if "rtc" in name:
+        return "RTC" if ("data" in name or "bss" in name or "noinit" in name) else None
+    if "iram" in name or "flash" in name or "rodata" in name or "debug" in name:
+        return None
+    if name.endswith("bss") or name.endswith("data") or "noinit" in name or name.startswith((".bss", ".data")):
+        return "DRAM"
+    return None
+
+
+def subsystem_of(obj):
+    """'src/text_editor', 'lib/GfxRenderer' or 'idf/<component>' from a map object path."""
+    obj = obj.replace("\\", "/")
+    # PlatformIO builds bundled libraries into .pio/build/<env>/lib<hash>/lib<Name>.a
+    archive = re.match(r"(?:.*?/)?(?:(lib[0-9a-f]{3})/)?lib([^/()]+)\.a\(", obj)
+    if archive:
+        return ("lib/" if archive.group(1) else "idf/") + archive.group(2)
+    base = re.sub(r"\.(c|cc|cpp|S)\.o(bj)?$|\.o(bj)?$", "", obj.rsplit("/", 1)[-1])
+    return ("src/" if "/src/" in obj or "/" not in obj else "obj/") + base
+
+
+def symbol_of(section):
+    for prefix in SECTION_PREFIXES:
+        if section.startswith(prefix):
+            return section[len(prefix):]
+    return section  # COMMON, or a whole .bss from an object built without -fdata-sections
+
+
+def parse_map(path):
+    """{(region, subsystem, symbol): bytes} for every RAM input section in the map."""
+    tables = {}
+    region = None
+    pending = None
+    in_memory_map = False
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if not in_memory_map:
+                in_memory_map = line.startswith("Linker script and memory map")
+                continue
+            if line and not line[0].isspace():
+                m = OUTPUT_SECTION.match(line)
+                region = region_of(m.group(1)) if m else None
+                pending = None
+                continue
+            if region is None:
+                continue
+            if pending is not None:
+                m = INPUT_REST.match(line)
+                if m:
+                    add(tables, region, pending, int(m.group(2), 16), m.group(3))
+                pending = None
+                continue
+            m = INPUT_FULL.match(line)
+            if m and (m.group(1).startswith(".") or m.group(1) == "COMMON"):
+                add(tables, region, m.group(1), int(m.group(3), 16), m.group(4))
+                continue
+            m = INPUT_NAME.match(line)
+            if m and m.group(1).startswith("."):
+                pending = m.group(1)
+    return tables
+
+
+def add(tables, region, section, size, obj):
+    if size == 0 or obj.startswith("*"):
+        return
+    key = (region, subsystem_of(obj.strip()), symbol_of(section))
+    tables[key] = tables.get(key, 0) + size
+
+
+def demangle(names, cxxfilt):
+    names = list(names)
+    if not cxxfilt or not names:
+        return {n: n for n in names}
+    try:
+        out = subprocess.run([cxxfilt], input="\n".join(names), capture_output=True, text=True, check=True).stdout
+        return dict(zip(names, out.splitlines()))
+    except (OSError, subprocess.CalledProcessError):
+        return {n: n for n in names}
+
+
+def to_json(tables):
+    return {"|".join(k): v for k, v in tables.items()}
+
+
+def from_json(data):
+    return {tuple(k.split("|", 2)): v for k, v in data.items()}
+
+
+def load(path):
+    if path.endswith(".json"):
+        with open(path) as f:
+            return from_json(json.load(f))
+    return parse_map(path)
+
+
+def fmt_delta(now, before):
+    if before is None:
+        return ""
+    d = now - before
+    return f"  {d:+7d}" if d else "        ="
+
+
+def report(tables, baseline=None, cxxfilt=None, title="RAM budget"):
+    totals = {}
+    subsystems = {}
+    for (region, sub, _), size in tables.items():
+        totals[region] = totals.get(region, 0) + size
+        subsystems.setdefault(sub, {"DRAM": 0, "RTC": 0})[region] += size
+    base_subs = {}
+    if baseline is not None:
+        for (region, sub, _), size in baseline.items():
+            base_subs.setdefault(sub, {"DRAM": 0, "RTC": 0})[region] += size
+
+    delta_hdr = "    delta" if baseline is not None else ""
+    print(f"\n{title}: {totals.get('DRAM', 0)} B static DRAM, {totals.get('RTC', 0)} B RTC")
+    if baseline is not None:
+        before = sum(v for (r, _, _), v in baseline.items() if r == "DRAM")
+        print(f"  DRAM was {before} B ({totals.get('DRAM', 0) - before:+d})")
+
+    print(f"\n  {'Subsystem':<32}{'DRAM':>8}{'RTC':>8}{delta_hdr}")
+    for sub, sizes in sorted(subsystems.items(), key=lambda kv: -(kv[1]["DRAM"] + kv[1]["RTC"])):
+        old = base_subs.get(sub)
+        delta = fmt_delta(sizes["DRAM"] + sizes["RTC"], old["DRAM"] + old["RTC"] if old else 0) \
+            if baseline is not None else ""
+        print(f"  {sub:<32}{sizes['DRAM']:>8}{sizes['RTC']:>8}{delta}")
+    gone = [s for s in base_subs if s not in subsystems]
+    for sub in gone:
+        old = base_subs[sub]["DRAM"] + base_subs[sub]["RTC"]
+        print(f"  {sub:<32}{0:>8}{0:>8}{fmt_delta(0, old)}")
+
+    big = {k: v for k, v in tables.items() if v >= MIN_TABLE_BYTES}
+    names = demangle({k[2] for k in big}, cxxfilt)
+    print(f"\n  Tables >= {MIN_TABLE_BYTES} B{'':<18}{'bytes':>8}{'':>8}{delta_hdr}")
+    for (region, sub, sym), size in sorted(big.items(), key=lambda kv: -kv[1]):
+        label = f"{sub}: {names.get(sym, sym)}" + (" [RTC]" if region == "RTC" else "")
+        delta = fmt_delta(size, baseline.get((region, sub, sym), 0)) if baseline is not None else ""
+        print(f"  {label[:46]:<46}{size:>8}{delta}")
+    print()
+
+
+def find_cxxfilt(cc=None):
+    if cc:
+        candidate = re.sub(r"(g?cc|g\+\+|clang(\+\+)?)(\.exe)?$", r"c++filt\3", cc)
+        if candidate != cc and shutil.which(candidate):
+            return candidate
+    return shutil.which("c++filt")
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(__doc__.strip())
+        return 1
+    baseline = load(argv[2]) if len(argv) > 2 else None
+    report(parse_map(argv[1]), baseline, find_cxxfilt(os.environ.get("CC")), f"RAM budget ({argv[1]})")
+    return 0
+
+
+try:
+    Import("env")  # noqa: F821 — only defined when PlatformIO runs this as an extra script
+except NameError:
+    env = None
+
+if env is not None:
+    # Reuse the framework's map file if it already asks for one, otherwise request ours
+    map_path = None
+    for flag in env.get("LINKFLAGS", []):
+        m = re.search(r"-Map[=,](\S+)", str(flag))
+        if m:
+            map_path = m.group(1)
+    if map_path is None:
+        map_path = "$BUILD_DIR/${PROGNAME}.map"
+        env.Append(LINKFLAGS=["-Wl,-Map," + map_path])
+
+    def _after_link(source, target, env):
+        path = env.subst(map_path)
+        if not os.path.isfile(path):
+            print(f"ram_report: no linker map at {path}")
+            return
+        saved = os.path.join(env.subst("$BUILD_DIR"), "ram_report.json")
+        baseline = load(saved) if os.path.isfile(saved) else None
+        tables = parse_map(path)
+        report(tables, baseline, find_cxxfilt(env.subst("$CC")), "RAM budget (vs previous build)" if baseline else
+               "RAM budget")
+        with open(saved, "w") as f:
+            json.dump(to_json(tables), f)
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", _after_link)
+elif __name__ == "__main__":
+    sys.exit(main(sys.argv))
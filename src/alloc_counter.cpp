@@ -0,0 +1,75 @@
+#include "alloc_counter.h"
+#include "config.h"
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <cstdlib>
+
+static uint32_t frameStart = 0;
+static uint32_t frames = 0;
+static uint32_t allocatingFrames = 0;
+
+// malloc, calloc and realloc are linked with --wrap (platformio.ini), so every heap
+// allocation in the image comes through here: C code, newlib, and operator new, which
+// calls malloc. Release builds only forward.
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* p, size_t size);
+}
+
+#ifndef RELEASE_BUILD
+static TaskHandle_t countedTask = nullptr;
+static volatile uint32_t count = 0;
+
+static inline void countAlloc() {
+  if (countedTask && xTaskGetCurrentTaskHandle() == countedTask) count = count + 1;
+}
+#else
+static inline void countAlloc() {}
+#endif
+
+extern "C" void* __wrap_malloc(size_t size) {
+  countAlloc();
+  return __real_malloc(size);
+}
+
+extern "C" void* __wrap_calloc(size_t n, size_t size) {
+  countAlloc();
+  return __real_calloc(n, size);
+}
+
+extern "C" void* __wrap_realloc(void* p, size_t size) {
+  countAlloc();
+  return __real_realloc(p, size);
+}
+
+#ifndef RELEASE_BUILD
+void allocCounterBegin() {
+  countedTask = xTaskGetCurrentTaskHandle();
+}
+
+uint32_t allocCount() {
+  return count;
+}
+#else
+void allocCounterBegin() {}
+
+uint32_t allocCount() {
+  return 0;
+}
+#endif
+
+void allocFrameBegin() {
+  frameStart = allocCount();
+}
+
+void allocFrameEnd() {
+  uint32_t allocs = allocCount() - frameStart;
+  frames++;
+  if (allocs == 0) return;
+  allocatingFrames++;
+  DBG_PRINTF("[ALLOC] Frame made %lu heap allocations (%lu of %lu frames allocated)\n", (unsigned long)allocs,
+             (unsigned long)allocatingFrames, (unsigned long)frames);
+}
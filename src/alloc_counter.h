@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+// --- Heap allocation counter (debug builds) ---
+// The typing path — key queue, editor insert, render, present — is meant to make no heap
+// allocations: the heap is shared with the BLE stack and fragments over a long session.
+// Debug builds count every malloc/calloc/realloc made by the main task (std::string,
+// containers, new, C code) through the linker's --wrap; loop() brackets each input +
+// render pass as a frame and logs any frame that allocated. Release builds only forward
+// and every count reads 0. test/host/test_typing_alloc.cpp checks the same path on a PC.
+
+// Count allocations made by the calling task from now on
+void allocCounterBegin();
+uint32_t allocCount();
+
+void allocFrameBegin();
+// Logs the frame (debug builds) if it allocated
+void allocFrameEnd();
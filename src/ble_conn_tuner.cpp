@@ -0,0 +1,424 @@
+#include "ble_conn_tuner.h"
+
+// ---------------------------------------------------------------------------
+// Everything is chosen for the fewest radio events within two latency bounds, from key
+// press to report arrival: KEY_LATENCY_TARGET_MS for 95% of keystrokes while typing, and
+// KEY_LATENCY_LIMIT_MS for every keystroke, the first ones after idling included.
+//
+// Measured on the link:
+//   - Notify delay. Reports only arrive in connection events, so arrival times sit on the
+//     event grid plus the controller/host delivery delay. The grid is anchored on the
+//     earliest arrivals (placed over SETTLE_REPORTS after an interval change or a long
+//     silence, re-aligned every DELAY_WINDOW reports for clock drift) and each report's
+//     offset from it goes into a histogram. The floor is the fastest delivery seen, so
+//     the delay is the part above it: what varies, and what a key may wait for.
+//   - Switch-back time: idle → active update request to the fast interval in effect.
+//   - Typing rhythm: gaps between key presses (log2 histogram), in-burst gap, keys per burst.
+//
+// Chosen from those:
+//   - ACTIVE interval: a key waits for the next event, uniformly up to one interval, then
+//     the notify delay. The longest interval that keeps 97% of keys within the target
+//     (with the measured p95 delay) wins; fewer events than a fixed fast interval.
+//   - Slave latency: it never delays keyboard → host reports (the keyboard transmits as
+//     soon as it has data), but what we send (parameter updates, LED state) waits for the
+//     keyboard to listen. The keyboard may skip events as long as it still listens within
+//     the target.
+//   - IDLE interval and threshold: idle intervals that keep every key within the limit are
+//     candidates. For each candidate pair, a gap G costs
+//       G <= t:  G / I_active
+//       G >  t:  t / I_active + (G - t) / I_idle + update delay + slow keys
+//     connection events. The keys typed during the switch back (the measured time, scaled
+//     to the candidate interval, over the in-burst gap) wait on the idle interval; those
+//     expected over the target cost SLOW_KEY_EVENTS each. A lone key after a pause doesn't
+//     switch back (the second key of a burst does), so a pause that follows a lone key is
+//     idle throughout: pauses are mixed between the two by how often one follows another.
+//     The cheapest pair wins, "never" included, so a rhythm of short pauses holds the
+//     active set.
+//
+// The active interval is re-chosen only when the link switches back from idle (or on
+// connect), so a change never costs an update of its own. Everything runs in integer
+// fixed point — this is called per keystroke on a core with no FPU.
+// ---------------------------------------------------------------------------
+
+static constexpr uint32_t KEY_LATENCY_TARGET_MS = 50;   // E-ink refresh takes ~10x this
+static constexpr uint32_t KEY_LATENCY_LIMIT_MS = 250;   // About one e-ink refresh
+static constexpr uint32_t ACTIVE_MISS_PCT = 3;    // Margin under the 5% the target allows
+
+static constexpr uint16_t MIN_INTERVAL = 6;  // 7.5 ms, the spec minimum (1.25 ms units)
+static constexpr int IDLE_CANDIDATES = 4;
+static constexpr uint16_t IDLE_INTERVALS[IDLE_CANDIDATES] = {80, 120, 160, 320};  // 100, 150, 200, 400 ms
+static constexpr int DEFAULT_IDLE = 2;
+
+static constexpr uint32_t COST_SCALE = 16;      // Costs in 1/16 connection events
+static constexpr uint32_t UPDATE_EVENTS = 6;    // An update takes effect this many events on
+static constexpr uint32_t SLOW_KEY_EVENTS = 20; // What a keystroke over the target is worth
+static constexpr uint32_t SWITCH_EVENTS_Q4 = 7 * 16;  // Idle events per switch back until measured
+
+static constexpr uint32_t DEFAULT_IDLE_MS = 3000;  // Until enough gaps are learned
+static constexpr uint32_t MIN_LEARNED_GAPS = 64;
+static constexpr uint32_t MIN_UPDATE_SPACING_MS = 1000;
+static constexpr uint32_t RETRY_MS = 3000;         // Longer than any switch takes (6 events at 400 ms)
+static constexpr uint32_t BURST_GAP_MS = 1000;     // Shorter gaps are within a burst of typing
+static constexpr uint32_t SWITCH_WATCH_MS = 50;    // Interval check while a switch back is pending,
+static constexpr uint32_t SWITCH_WATCH_LIMIT_MS = 5000;  // for at most this long
+
+// Gap histogram: bucket b holds [32 << b, 32 << (b + 1)) ms, the last one everything longer
+static constexpr int GAP_BUCKETS = 12;
+static constexpr uint32_t GAP_BASE_MS = 32;
+static constexpr uint32_t DECAY_TOTAL = 1024;  // Halve all counts past this — recent behaviour wins
+
+// Notify delay: bucket b holds delays up to 1 << b ms, the last one everything longer
+static constexpr int DELAY_WINDOW = 32;                  // Reports between grid re-alignments
+static constexpr int SETTLE_REPORTS = 8;                 // Reports that only place a new grid
+static constexpr uint32_t ANCHOR_STALE_US = 30000000;    // Re-anchor after this long without a report
+static constexpr uint32_t DEFAULT_DELAY_P95_US = 2000;   // Until measured
+
+// EMAs are Q4 fixed point (value * 16)
+static constexpr int EMA_FRAC = 16;
+static uint16_t gapCounts[GAP_BUCKETS];
+static uint32_t gapTotal = 0;
+static int32_t burstGapQ4 = 200 * EMA_FRAC;     // EMA of in-burst gaps, ms
+static int32_t burstKeysQ4 = 20 * EMA_FRAC;     // EMA of keystrokes per burst
+static uint32_t keysInBurst = 0;
+static int32_t switchEventsQ4 = SWITCH_EVENTS_Q4;  // EMA of switch-back time in idle intervals
+static int32_t lonePauseQ8 = 0;    // EMA of the share of pauses that follow a lone key, Q8
+static bool lastGapPause = false;
+
+static uint16_t delayCounts[TUNER_DELAY_BUCKETS];
+static uint32_t delayTotal = 0;
+static int32_t delayMeanUs = 0;
+static uint32_t anchorUs = 0;      // A connection event on the current grid
+static uint32_t lastNotifyUs = 0;
+static uint32_t windowMinUs = UINT32_MAX;
+static int windowCount = 0;
+static int settleLeft = 0;
+static bool anchored = false;
+
+static ConnTunerStats stats;
+static ConnParams active;
+static ConnParams idle;
+static uint32_t lastKeyMs = 0;
+static uint32_t lastUpdateMs = 0;
+static uint32_t switchRequestMs = 0;
+static uint16_t switchFromInterval = 0;
+static bool switchPending = false;
+static bool keyThisConnection = false;
+static bool retried = false;
+
+// x += (sample - x) / div, all Q4
+static void ema(int32_t& x, int32_t sampleQ4, int32_t div) {
+  x += (sampleQ4 - x) / div;
+}
+
+static uint32_t intervalMs(uint16_t units) {
+  return units * 5 / 4;
+}
+
+// Halve every count once the total passes DECAY_TOTAL
+template <int N>
+static void decay(uint16_t (&counts)[N], uint32_t& total) {
+  if (++total <= DECAY_TOTAL) return;
+  total = 0;
+  for (uint16_t& c : counts) {
+    c /= 2;
+    total += c;
+  }
+}
+
+// Keyboard may skip events while it still listens within the target
+static ConnParams withLatency(uint16_t intervalMin, uint16_t intervalMax) {
+  uint32_t listens = KEY_LATENCY_TARGET_MS / intervalMs(intervalMax);
+  return {intervalMin, intervalMax, static_cast<uint16_t>(listens > 1 ? listens - 1 : 0)};
+}
+
+// --- Notify delay ---
+
+static uint32_t delayPercentileUs(uint32_t percent) {
+  if (delayTotal == 0) return 0;
+  uint32_t want = (delayTotal * percent + 99) / 100;
+  uint32_t seen = 0;
+  for (int b = 0; b < TUNER_DELAY_BUCKETS; b++) {
+    seen += delayCounts[b];
+    if (seen >= want) return b == TUNER_DELAY_BUCKETS - 1 ? 2000u << b : 1000u << b;
+  }
+  return 2000u << (TUNER_DELAY_BUCKETS - 1);
+}
+
+static void recordDelay(uint32_t delayUs) {
+  int b = 0;
+  while (b < TUNER_DELAY_BUCKETS - 1 && delayUs > (1000u << b)) b++;
+  delayCounts[b]++;
+  stats.delayCounts[b]++;
+  decay(delayCounts, delayTotal);
+  stats.notifies++;
+
+  int32_t d = static_cast<int32_t>(delayUs);
+  delayMeanUs += (d - delayMeanUs) / 16;
+  int32_t dev = d > delayMeanUs ? d - delayMeanUs : delayMeanUs - d;
+  stats.jitterUs += (dev - static_cast<int32_t>(stats.jitterUs)) / 16;
+  stats.delayP50Us = delayPercentileUs(50);
+  stats.delayP95Us = delayPercentileUs(95);
+}
+
+// --- Choosing parameters ---
+
+static uint32_t delayP95Us() {
+  return delayTotal >= DELAY_WINDOW ? delayPercentileUs(95) : DEFAULT_DELAY_P95_US;
+}
+
+static void chooseActive() {
+  // 100 - ACTIVE_MISS_PCT of keys within the target: interval * (100 - miss)% + p95 delay
+  uint32_t delayUs = delayP95Us();
+  uint32_t budgetUs = KEY_LATENCY_TARGET_MS * 1000 > delayUs ? KEY_LATENCY_TARGET_MS * 1000 - delayUs : 0;
+  uint32_t units = budgetUs * 100 / (100 - ACTIVE_MISS_PCT) / 1250;
+  if (units < MIN_INTERVAL) units = MIN_INTERVAL;
+  if (units > IDLE_INTERVALS[0] / 2) units = IDLE_INTERVALS[0] / 2;
+  // A narrow window: the controller may pick any interval in it
+  active = withLatency(static_cast<uint16_t>(units - units / 8), static_cast<uint16_t>(units));
+}
+
+static uint32_t bucketMidMs(int b) {
+  return b == GAP_BUCKETS - 1 ? 120000 : (GAP_BASE_MS << b) * 3 / 2;
+}
+
+// In COST_SCALE units; at most 120 s / 7.5 ms * 16 = 256000 per gap, so a 1024-gap histogram
+// needs 64 bits. switchCost: update delay and slow keys of one round trip to idle.
+static uint32_t gapCost(uint32_t gap, uint32_t threshold, uint32_t activeMs, uint32_t idleMs, uint32_t switchCost) {
+  if (gap <= threshold) return gap * COST_SCALE / activeMs;
+  uint32_t roundTrip = threshold * COST_SCALE / activeMs + (gap - threshold) * COST_SCALE / idleMs + switchCost;
+  if (gap < BURST_GAP_MS) return roundTrip;
+  uint32_t stayIdle = gap * COST_SCALE / idleMs;
+  return (stayIdle * lonePauseQ8 + roundTrip * (256 - lonePauseQ8)) / 256;
+}
+
+static void choosePolicy() {
+  stats.activeParams = active;
+  if (gapTotal < MIN_LEARNED_GAPS) {
+    stats.idleThresholdMs = DEFAULT_IDLE_MS;
+    idle = withLatency(IDLE_INTERVALS[DEFAULT_IDLE] - IDLE_INTERVALS[DEFAULT_IDLE] / 4, IDLE_INTERVALS[DEFAULT_IDLE]);
+    stats.idleParams = idle;
+    return;
+  }
+  uint32_t activeMs = intervalMs(active.intervalMax);
+  uint32_t delayMs = (delayP95Us() + 999) / 1000;
+  uint32_t budgetMs = KEY_LATENCY_TARGET_MS > delayMs ? KEY_LATENCY_TARGET_MS - delayMs : 0;
+  uint32_t burstGapMs = burstGapQ4 > EMA_FRAC ? burstGapQ4 / EMA_FRAC : 1;
+
+  uint64_t bestCost = 0;
+  for (int b = 0; b < GAP_BUCKETS; b++) {
+    bestCost += uint64_t(gapCounts[b]) * gapCost(bucketMidMs(b), UINT32_MAX, activeMs, 1, 0);
+  }
+  uint32_t bestThreshold = 0;
+  int bestIdle = DEFAULT_IDLE;
+
+  for (int c = 0; c < IDLE_CANDIDATES; c++) {
+    uint32_t idleMs = intervalMs(IDLE_INTERVALS[c]);
+    if (idleMs + delayMs > KEY_LATENCY_LIMIT_MS) continue;
+    // Keys typed until the link is fast again (the one that asks for it is the second
+    // of the burst) wait up to one idle interval each; the share of that wait beyond the
+    // target budget misses it
+    uint32_t slowKeysQ4 = 2 * EMA_FRAC + switchEventsQ4 * idleMs / burstGapMs;
+    if (slowKeysQ4 > static_cast<uint32_t>(burstKeysQ4)) slowKeysQ4 = burstKeysQ4;
+    uint32_t missPct = idleMs > budgetMs ? (idleMs - budgetMs) * 100 / idleMs : 0;
+    // The link stays active until the idle update's instant; the update itself rides in
+    // an event that happens anyway. (Q4 is COST_SCALE.)
+    uint32_t switchCost = UPDATE_EVENTS * COST_SCALE + slowKeysQ4 * missPct * SLOW_KEY_EVENTS / 100;
+
+    // Candidates: bucket boundaries from 256 ms up
+    for (int k = 3; k < GAP_BUCKETS; k++) {
+      uint32_t t = GAP_BASE_MS << k;
+      uint64_t cost = 0;
+      for (int b = 0; b < GAP_BUCKETS; b++) {
+        cost += uint64_t(gapCounts[b]) * gapCost(bucketMidMs(b), t, activeMs, idleMs, switchCost);
+      }
+      // A tie with "never" means no learned gap is that long yet: keep the threshold for them
+      if (cost < bestCost || (bestThreshold == 0 && cost <= bestCost)) {
+        bestCost = cost;
+        bestThreshold = t;
+        bestIdle = c;
+      }
+    }
+  }
+  stats.idleThresholdMs = bestThreshold;
+  idle = withLatency(IDLE_INTERVALS[bestIdle] - IDLE_INTERVALS[bestIdle] / 4, IDLE_INTERVALS[bestIdle]);
+  stats.idleParams = idle;
+}
+
+// --- Typing rhythm ---
+
+static uint32_t gapPercentile(uint32_t percent) {
+  if (gapTotal == 0) return 0;
+  uint32_t want = (gapTotal * percent + 99) / 100;
+  uint32_t seen = 0;
+  for (int b = 0; b < GAP_BUCKETS; b++) {
+    seen += gapCounts[b];
+    if (seen >= want) return bucketMidMs(b);
+  }
+  return bucketMidMs(GAP_BUCKETS - 1);
+}
+
+static void learnGap(uint32_t gap) {
+  int b = 0;
+  while (b < GAP_BUCKETS - 1 && gap >= (GAP_BASE_MS << (b + 1))) b++;
+  gapCounts[b]++;
+  decay(gapCounts, gapTotal);
+  if (gap < BURST_GAP_MS) {
+    ema(burstGapQ4, static_cast<int32_t>(gap) * EMA_FRAC, 16);
+    keysInBurst++;
+    lastGapPause = false;
+  } else {
+    ema(lonePauseQ8, lastGapPause ? 256 : 0, 16);
+    lastGapPause = true;
+    ema(burstKeysQ4, static_cast<int32_t>(keysInBurst < 4096 ? keysInBurst + 1 : 4096) * EMA_FRAC, 8);
+    keysInBurst = 0;
+  }
+
+  // Re-plan when a pause ends — that's when the rhythm picture changes
+  if (gap >= BURST_GAP_MS || gapTotal == MIN_LEARNED_GAPS) {
+    choosePolicy();
+    stats.gapP50Ms = gapPercentile(50);
+    stats.gapP90Ms = gapPercentile(90);
+  }
+}
+
+static ConnParams request(bool toIdle, uint32_t nowMs) {
+  retried = false;
+  stats.idle = toIdle;
+  stats.requested = toIdle ? idle : active;
+  stats.updates++;
+  lastUpdateMs = nowMs;
+  return stats.requested;
+}
+
+// --- API ---
+
+ConnParams connTunerReset(uint32_t nowMs) {
+  stats = ConnTunerStats{};
+  chooseActive();
+  choosePolicy();
+  stats.gapP50Ms = gapPercentile(50);
+  stats.gapP90Ms = gapPercentile(90);
+  stats.switchBackMs = switchEventsQ4 * intervalMs(idle.intervalMax) / EMA_FRAC;
+  lastKeyMs = nowMs;  // Connecting counts as activity
+  switchPending = false;
+  keyThisConnection = false;
+  anchored = false;
+  return request(false, nowMs);
+}
+
+bool connTunerKeystroke(uint32_t nowMs, ConnParams& out) {
+  uint32_t gap = nowMs - lastKeyMs;
+  bool continues = keyThisConnection && gap < BURST_GAP_MS;
+  if (keyThisConnection) learnGap(gap);
+  keyThisConnection = true;
+  lastKeyMs = nowMs;
+  stats.keystrokes++;
+
+  // A lone key (a cursor move, a fix) is served fine by the idle interval; switching for it
+  // would buy a second of the active one. A second key within a burst gap means typing.
+  if (!stats.idle || !continues) return false;
+  // Typing resumed: back to the fast interval at once, re-chosen from the delays so far
+  switchRequestMs = nowMs;
+  switchFromInterval = stats.actualInterval;
+  switchPending = true;
+  chooseActive();
+  stats.activeParams = active;
+  out = request(false, nowMs);
+  return true;
+}
+
+void connTunerNotify(uint32_t nowUs) {
+  if (stats.actualInterval == 0) return;
+  uint32_t periodUs = stats.actualInterval * 1250u;
+  if (!anchored || nowUs - lastNotifyUs > ANCHOR_STALE_US) {
+    // The first report defines the grid; it has no delay to measure against
+    anchorUs = nowUs;
+    lastNotifyUs = nowUs;
+    windowMinUs = UINT32_MAX;
+    windowCount = 0;
+    settleLeft = SETTLE_REPORTS;
+    anchored = true;
+    return;
+  }
+  lastNotifyUs = nowUs;
+  uint32_t phase = (nowUs - anchorUs) % periodUs;
+  if (phase > periodUs - periodUs / 4) {
+    phase = 0;  // Earlier than the grid: the anchoring report was late, this one is the floor
+    anchorUs = nowUs;
+  } else {
+    anchorUs = nowUs - phase;  // Keep the anchor recent so the difference never wraps
+  }
+  if (phase < windowMinUs) windowMinUs = phase;
+  if (settleLeft > 0) {
+    // Measured against one report's delay the grid sits late: wait for a faster one
+    if (--settleLeft == 0) {
+      anchorUs += windowMinUs;
+      windowMinUs = UINT32_MAX;
+      windowCount = 0;
+    }
+    return;
+  }
+  if (++windowCount == DELAY_WINDOW) {
+    anchorUs += windowMinUs;  // Clock drift: the fastest report of the window sits on the grid
+    windowMinUs = UINT32_MAX;
+    windowCount = 0;
+  }
+  recordDelay(phase);
+}
+
+void connTunerObserved(uint16_t interval, uint32_t nowMs) {
+  if (interval != stats.actualInterval) anchored = false;  // New grid
+  stats.actualInterval = interval;
+  if (switchPending && nowMs - switchRequestMs > SWITCH_WATCH_LIMIT_MS) {
+    switchPending = false;  // Turned down; the retry isn't a switch-back time
+  } else if (switchPending && interval <= active.intervalMax) {
+    switchPending = false;
+    uint32_t took = nowMs - switchRequestMs;
+    stats.switchBackMs = took;
+    uint32_t fromMs = intervalMs(switchFromInterval ? switchFromInterval : idle.intervalMax);
+    ema(switchEventsQ4, static_cast<int32_t>(took * EMA_FRAC / fromMs), 4);
+  }
+}
+
+// The controller turns an update down while another is in progress, and a keyboard may
+// counter with its own; the link then runs on the other mode's interval
+static bool linkMismatched() {
+  return stats.actualInterval != 0 &&
+         (stats.actualInterval < stats.requested.intervalMin || stats.actualInterval > stats.requested.intervalMax);
+}
+
+bool connTunerPoll(uint32_t nowMs, ConnParams& out) {
+  if (!retried && linkMismatched() && nowMs - lastUpdateMs >= RETRY_MS) {
+    out = request(stats.idle, nowMs);
+    retried = true;  // Once per mode change: don't fight a keyboard that insists
+    return true;
+  }
+  // An update in flight turns the next one down: idle only once the switch back is done
+  if (stats.idle || stats.idleThresholdMs == 0 || switchPending) return false;
+  if (nowMs - lastKeyMs < stats.idleThresholdMs || nowMs - lastUpdateMs < MIN_UPDATE_SPACING_MS) return false;
+  out = request(true, nowMs);
+  return true;
+}
+
+uint32_t connTunerNextPoll(uint32_t nowMs) {
+  // Timing the switch back needs the new interval promptly
+  if (switchPending && nowMs - switchRequestMs < SWITCH_WATCH_LIMIT_MS) return SWITCH_WATCH_MS;
+  uint32_t sinceUpdate = nowMs - lastUpdateMs;
+  uint32_t retry = UINT32_MAX;
+  if (!retried && linkMismatched()) retry = sinceUpdate < RETRY_MS ? RETRY_MS - sinceUpdate : 0;
+  if (stats.idle || stats.idleThresholdMs == 0) return retry;
+  uint32_t sinceKey = nowMs - lastKeyMs;
+  uint32_t wait = sinceKey < stats.idleThresholdMs ? stats.idleThresholdMs - sinceKey : 0;
+  if (sinceUpdate < MIN_UPDATE_SPACING_MS && MIN_UPDATE_SPACING_MS - sinceUpdate > wait) {
+    wait = MIN_UPDATE_SPACING_MS - sinceUpdate;
+  }
+  return wait < retry ? wait : retry;
+}
+
+ConnParams connTunerCurrent() {
+  return stats.idle ? idle : active;
+}
+
+const ConnTunerStats& connTunerStats() {
+  return stats;
+}
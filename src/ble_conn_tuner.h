@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+
+// --- Adaptive BLE connection parameters ---
+// Measures how late input reports arrive after their connection event, the typing rhythm
+// (gaps between keystrokes) and how long a switch back to the fast interval takes, and
+// picks the active interval, slave latency, idle interval and idle threshold that keep
+// keystrokes within a latency target at the fewest radio events. No hardware
+// dependencies: ble_keyboard feeds it events and applies what it returns (see
+// ble_conn_tuner.cpp for the model).
+
+struct ConnParams {
+  uint16_t intervalMin;  // 1.25 ms units
+  uint16_t intervalMax;
+  uint16_t latency;      // Connection events the keyboard may skip when it has nothing to send
+};
+
+// Measured notify delay buckets: up to 1, 2, 4, 8, 16 ms, more
+static constexpr int TUNER_DELAY_BUCKETS = 6;
+
+struct ConnTunerStats {
+  bool idle;                        // Idle parameters requested
+  ConnParams requested;
+  ConnParams activeParams;          // Chosen sets for each mode
+  ConnParams idleParams;
+  uint16_t actualInterval;          // Last interval reported by the link (1.25 ms units), 0 = unknown
+  uint32_t idleThresholdMs;         // Current idle switch threshold, 0 = never go idle
+  uint32_t gapP50Ms;                // Typing gap percentiles from the learned histogram
+  uint32_t gapP90Ms;
+  uint32_t switchBackMs;            // Measured idle → active switch time
+  uint32_t keystrokes;
+  uint32_t notifies;                // Input reports measured against the event grid
+  uint32_t updates;                 // Parameter updates requested this connection
+  uint32_t delayP50Us;              // Measured report delay after its connection event
+  uint32_t delayP95Us;
+  uint32_t jitterUs;                // Mean deviation of that delay
+  uint32_t delayCounts[TUNER_DELAY_BUCKETS];  // Reports by measured delay, this connection
+};
+
+// New connection: active parameters, per-connection counters cleared (the learned
+// rhythm is kept). Returns the parameters to request.
+ConnParams connTunerReset(uint32_t nowMs);
+// A key press arrived. Returns true with `out` set if the link should switch now.
+bool connTunerKeystroke(uint32_t nowMs, ConnParams& out);
+// An input report (press or release) arrived at `nowUs` (esp_timer clock, taken on arrival)
+void connTunerNotify(uint32_t nowUs);
+// Interval currently in effect on the link (1.25 ms units)
+void connTunerObserved(uint16_t interval, uint32_t nowMs);
+// Periodic check. Returns true with `out` set if an update is worth requesting.
+bool connTunerPoll(uint32_t nowMs, ConnParams& out);
+// Milliseconds until connTunerPoll() could next act (UINT32_MAX = nothing scheduled), so
+// the caller can sleep until then instead of polling
+uint32_t connTunerNextPoll(uint32_t nowMs);
+// Parameters for the current mode (floor for keyboard-initiated update requests)
+ConnParams connTunerCurrent();
+const ConnTunerStats& connTunerStats();
@@ -1,8 +1,13 @@
 #include "ble_keyboard.h"
+#include "ble_conn_tuner.h"
+#include "energy_meter.h"
 #include "input_handler.h"
+#include "loop_events.h"
 
 #include <NimBLEDevice.h>
 #include <Preferences.h>
+#include <esp_timer.h>
+#include <freertos/semphr.h>
 
 // HID service and characteristic UUIDs
 static NimBLEUUID hidServiceUUID("1812");
@@ -33,21 +38,16 @@ static unsigned long reconnectDelay = 10000;  // Start at 10s (was 5s) — less
 static unsigned long lastReconnectAttempt = 0;
 static constexpr unsigned long MAX_RECONNECT_DELAY = 120000;  // Cap at 2min (was 60s)
 
-// BLE connection parameters (in 1.25ms units)
-// Active typing: 15-20ms interval — maximise keystroke responsiveness
-static constexpr uint16_t CONN_INTERVAL_ACTIVE_MIN = 12;   // 15ms
-static constexpr uint16_t CONN_INTERVAL_ACTIVE_MAX = 16;   // 20ms
-// Idle: 100-200ms interval — radio mostly sleeps between events
-static constexpr uint16_t CONN_INTERVAL_IDLE_MIN   = 80;   // 100ms
-static constexpr uint16_t CONN_INTERVAL_IDLE_MAX   = 160;  // 200ms
-static constexpr uint16_t CONN_SLAVE_LATENCY_ACTIVE = 0;   // No skipped events while typing
-static constexpr uint16_t CONN_SLAVE_LATENCY_IDLE   = 4;   // Keyboard can skip 4 events when idle
+// BLE connection parameters: interval / slave latency come from ble_conn_tuner
 static constexpr uint16_t CONN_SUPERVISION_TIMEOUT  = 400;  // 4s (10ms units)
-static constexpr unsigned long BLE_IDLE_SWITCH_MS   = 3000; // Switch to idle params after 3s no keystrokes
 
-// Activity tracking for adaptive connection parameters
-static unsigned long lastBleKeystrokeMs = 0;
-static bool bleConnIdleMode = false;
+// Input report arrival times from the notify callback (NimBLE host task), fed to the tuner
+// by bleLoop(): every report measures notify delay, those with a new key press the rhythm
+static constexpr uint8_t KEY_TIME_RING = 16;
+static volatile int64_t reportArrivedUs[KEY_TIME_RING];  // esp_timer, taken on arrival
+static volatile bool reportPressed[KEY_TIME_RING];
+static volatile uint8_t keyTimeHead = 0;
+static uint8_t keyTimeTail = 0;
 
 // Device discovery variables
 static std::vector<BleDeviceInfo> discoveredDevices;
@@ -63,9 +63,88 @@ static volatile bool authSuccess = false;
 // Connection timeout in seconds
 static constexpr uint32_t CONNECT_TIMEOUT_MS = 10000;
 
+// bleLoop() cadence while waiting on something without a callback (scan end, link drop
+// before a keyboard switch)
+static constexpr uint32_t BLE_POLL_MS = 100;
+
 // Global variable to store the passkey for display
 static uint32_t currentPasskey = 0;
 
+// Time-to-first-keystroke instrumentation (ms since power-on / per connect phase)
+static unsigned long connectPhaseMs = 0;
+static unsigned long securityPhaseMs = 0;
+static unsigned long hidPhaseMs = 0;
+static bool firstKeystrokeLogged = false;
+
+// --- Cached GATT handles ---
+// HID handles of each saved keyboard ("gatt<slot>" next to its profile), so a reconnect
+// can set the protocol mode and enable notifications straight away instead of walking
+// the keyboard's whole GATT database. The NimBLE client only routes notifications to
+// characteristics it has discovered, so for cached handles a GAP event listener picks
+// them up instead. A failed write falls back to full discovery, which re-caches.
+// A keyboard whose firmware update moved handles without breaking those writes is caught
+// by its GATT Database Hash (checked before using the cache, if it has one) or by a
+// Service Changed indication (re-enabled by handle, acted on by bleLoop()).
+static constexpr int MAX_CACHED_REPORTS = 4;
+static constexpr uint8_t HID_CACHE_VERSION = 2;
+static constexpr size_t DB_HASH_LEN = 16;
+struct HidHandleCache {
+  uint8_t version;
+  uint8_t reportCount;
+  char address[18];                          // Keyboard these handles belong to
+  uint16_t protoHandle;                      // 0 = no Protocol Mode characteristic
+  uint16_t valueHandle[MAX_CACHED_REPORTS];  // Subscribed input reports
+  uint16_t cccdHandle[MAX_CACHED_REPORTS];   // Their Client Characteristic Configuration
+  uint16_t svcChangedHandle;                 // 0 = no Service Changed characteristic
+  uint16_t svcChangedCccd;
+  bool hasDbHash;
+  uint8_t dbHash[DB_HASH_LEN];               // GATT Database Hash when cached (Bluetooth 5.1+)
+};
+static HidHandleCache hidCache;
+static bool hidCacheFresh = false;           // Built by full discovery, not yet saved
+static volatile bool cachedRouting = false;  // Listener delivers reports (cached-handle connection)
+static volatile bool gattChanged = false;    // Cached handles hit by Service Changed, handled by bleLoop()
+static ble_gap_event_listener gapListener;
+
+// --- Keyboard profiles ---
+// Bonded keyboards, one NVS blob each ("kb<slot>"). Reconnects try them most recently used
+// first with directed connects to the saved address, so switching keyboards is a matter of
+// waking the other one rather than a scan and re-pair. The cap matches NimBLE's default
+// bond store (CONFIG_BT_NIMBLE_MAX_BONDS); a new keyboard past it replaces the least
+// recently used profile and its bond.
+static constexpr int MAX_KB_PROFILES = 3;
+static constexpr uint8_t KB_PROFILE_VERSION = 1;
+struct KeyboardProfile {
+  uint8_t version;
+  uint8_t addrType;
+  char address[18];   // "" = free slot
+  char name[32];
+  uint32_t lastUsed;  // MRU stamp, higher = more recent
+};
+static KeyboardProfile profiles[MAX_KB_PROFILES];
+static uint32_t profileClock = 0;  // Highest lastUsed handed out
+
+// The connect task saves the keyboard it just connected to while the UI and bleLoop()
+// read the list, so every profiles[] / profileClock access after bleInit() holds this
+static StaticSemaphore_t profileMutexBuf;
+static SemaphoreHandle_t profileMutex = xSemaphoreCreateMutexStatic(&profileMutexBuf);
+struct ProfileLock {
+  ProfileLock() { xSemaphoreTake(profileMutex, portMAX_DELAY); }
+  ~ProfileLock() { xSemaphoreGive(profileMutex); }
+};
+
+// Reconnect round: one directed attempt per profile in MRU order, back to back, then backoff
+static constexpr uint32_t ROUND_CONNECT_TIMEOUT_MS = 3000;  // Per attempt when several are saved
+static int reconnectRound[MAX_KB_PROFILES];
+static int reconnectRoundCount = 0;
+static int reconnectRoundNext = 0;
+static bool reconnectNow = false;         // Start a round without waiting out the backoff
+static volatile int switchSlot = -1;      // Profile the user switched to, applied by bleLoop()
+static uint32_t connectTimeoutMs = CONNECT_TIMEOUT_MS;
+static unsigned long connectRequestMs = 0;  // Reconnect / switch request, for ready-time logging
+static unsigned long connectFlowStartMs = 0;  // Scan start for a picked device, else the request
+static const char* connectFlow = "reconnect";  // Which flow connectRequestMs belongs to
+
 // Forward declarations
 static bool setupHidConnection();
 
@@ -90,9 +169,9 @@ static void pruneStaleDevices() {
   }
 }
 
-// Keyboard notification callback
-static void onKeyboardNotify(NimBLERemoteCharacteristic* pRemChar,
-                              uint8_t* pData, size_t length, bool isNotify) {
+// Keyboard input report, from a subscribed characteristic or a cached handle
+static void handleKeyboardReport(const uint8_t* pData, size_t length) {
+  int64_t arrivedUs = esp_timer_get_time();
   // Keyboard reports can be 7 or 8 bytes
   // 8-byte: [Modifiers] [Reserved] [Key1-Key6]  (standard)
   // 7-byte: [Modifiers] [Key1-Key6]              (compact, used by Keys-To-Go 2)
@@ -123,6 +202,7 @@ static void onKeyboardNotify(NimBLERemoteCharacteristic* pRemChar,
 #endif
 
   // Detect newly pressed keys (bytes 2-7 in normalized format)
+  bool anyPress = false;
   for (int i = 2; i < 8; i++) {
     if (newReport[i] == 0) continue;
     bool wasPressed = false;
@@ -132,6 +212,13 @@ static void onKeyboardNotify(NimBLERemoteCharacteristic* pRemChar,
     if (!wasPressed) {
       DBG_PRINTF("  KEY PRESS: 0x%02X mod=0x%02X\n", newReport[i], modifiers);
       enqueueKeyEvent(newReport[i], modifiers, true);
+      anyPress = true;
+      energyKeystroke();
+      if (!firstKeystrokeLogged) {
+        firstKeystrokeLogged = true;
+        DBG_PRINTF("[BLE] First keystroke %lums after power-on (connect %lums, security %lums, HID %lums%s)\n",
+                   millis(), connectPhaseMs, securityPhaseMs, hidPhaseMs, cachedRouting ? ", cached" : "");
+      }
     }
   }
 
@@ -149,9 +236,55 @@ static void onKeyboardNotify(NimBLERemoteCharacteristic* pRemChar,
   }
 
   memcpy(lastReport, newReport, 8);
+  reportArrivedUs[keyTimeHead % KEY_TIME_RING] = arrivedUs;
+  reportPressed[keyTimeHead % KEY_TIME_RING] = anyPress;
+  keyTimeHead = keyTimeHead + 1;
+  loopPost(LoopEvent::KEY);
+}
+
+static void onKeyboardNotify(NimBLERemoteCharacteristic* pRemChar,
+                              uint8_t* pData, size_t length, bool isNotify) {
+  handleKeyboardReport(pData, length);
+}
 
-  // Track activity for adaptive connection parameters
-  lastBleKeystrokeMs = millis();
+// Notifications on cached handles (nothing discovered for the client to route them to)
+static int onGapEvent(ble_gap_event* event, void* arg) {
+  if (event->type != BLE_GAP_EVENT_NOTIFY_RX || !cachedRouting || !pClient ||
+      event->notify_rx.conn_handle != pClient->getConnHandle()) {
+    return 0;
+  }
+  if (hidCache.svcChangedHandle != 0 && event->notify_rx.attr_handle == hidCache.svcChangedHandle) {
+    // Affected handle range; only a change covering a cached handle invalidates the cache
+    uint8_t range[4];
+    uint16_t len = 0;
+    uint16_t first = 0x0001, last = 0xFFFF;
+    if (ble_hs_mbuf_to_flat(event->notify_rx.om, range, sizeof(range), &len) == 0 && len == sizeof(range)) {
+      first = range[0] | (range[1] << 8);
+      last = range[2] | (range[3] << 8);
+    }
+    bool hit = hidCache.protoHandle >= first && hidCache.protoHandle <= last;
+    for (int i = 0; i < hidCache.reportCount; i++) {
+      hit |= hidCache.cccdHandle[i] >= first && hidCache.valueHandle[i] <= last;
+    }
+    if (hit) {
+      gattChanged = true;
+      loopPost(LoopEvent::BLE);
+    }
+    return 0;
+  }
+  for (int i = 0; i < hidCache.reportCount; i++) {
+    if (event->notify_rx.attr_handle != hidCache.valueHandle[i]) continue;
+    uint8_t data[8];
+    uint16_t len = 0;
+    uint16_t total = OS_MBUF_PKTLEN(event->notify_rx.om);
+    if (total <= sizeof(data) && ble_hs_mbuf_to_flat(event->notify_rx.om, data, sizeof(data), &len) == 0) {
+      handleKeyboardReport(data, len);
+    } else {
+      DBG_PRINTF("[KB-Notify] Unexpected length %d, skipping\n", total);
+    }
+    break;
+  }
+  return 0;
 }
 
 // --- Callbacks (static instances, no heap allocation) ---
@@ -176,20 +309,24 @@ static class ClientCallbacks : public NimBLEClientCallbacks {
 
   void onDisconnect(NimBLEClient* pclient, int reason) override {
     bleState = BLEState::DISCONNECTED;
+    cachedRouting = false;
     pInputReportChar = nullptr;
     pRemoteService = nullptr;
     authSuccess = false;
     memset(lastReport, 0, 8);
     lastReconnectAttempt = millis();
     DBG_PRINTLN("[BLE] Disconnected");
+    energyBleInterval(0);
+    loopPost(LoopEvent::BLE);
   }
 
   bool onConnParamsUpdateRequest(NimBLEClient* pClient,
                                   const ble_gap_upd_params* params) override {
     // Don't blindly accept the keyboard's requested interval — enforce our floor.
-    uint16_t floorMin = bleConnIdleMode ? CONN_INTERVAL_IDLE_MIN : CONN_INTERVAL_ACTIVE_MIN;
-    uint16_t floorMax = bleConnIdleMode ? CONN_INTERVAL_IDLE_MAX : CONN_INTERVAL_ACTIVE_MAX;
-    uint16_t latency  = bleConnIdleMode ? CONN_SLAVE_LATENCY_IDLE : CONN_SLAVE_LATENCY_ACTIVE;
+    ConnParams current = connTunerCurrent();
+    uint16_t floorMin = current.intervalMin;
+    uint16_t floorMax = current.intervalMax;
+    uint16_t latency  = current.latency;
     uint16_t itvlMin = (params->itvl_min > floorMin) ? params->itvl_min : floorMin;
     uint16_t itvlMax = (params->itvl_max > floorMax) ? params->itvl_max : floorMax;
     if (itvlMin > itvlMax) itvlMax = itvlMin;
@@ -210,6 +347,7 @@ static class ClientCallbacks : public NimBLEClientCallbacks {
     currentPasskey = pin;
     extern bool screenDirty;
     screenDirty = true;
+    loopPost(LoopEvent::SCREEN);
     NimBLEDevice::injectConfirmPasskey(connInfo, true);
   }
 
@@ -227,14 +365,273 @@ static class ClientCallbacks : public NimBLEClientCallbacks {
     currentPasskey = 0;
     extern bool screenDirty;
     screenDirty = true;
+    loopPost(LoopEvent::SCREEN);
   }
 } clientCallbacks;
 
+// --- Cached-handle subscription ---
+
+static void profileKey(char* key, size_t size, const char* prefix, int slot) {
+  snprintf(key, size, "%s%d", prefix, slot);
+}
+
+static int findProfile(const std::string& address) {
+  for (int i = 0; i < MAX_KB_PROFILES; i++) {
+    if (profiles[i].address[0] != '\0' && address == profiles[i].address) return i;
+  }
+  return -1;
+}
+
+static bool loadHidCache(int slot) {
+  if (slot < 0) return false;
+  char key[8];
+  profileKey(key, sizeof(key), "gatt", slot);
+  return prefs.getBytes(key, &hidCache, sizeof(hidCache)) == sizeof(hidCache) &&
+         hidCache.version == HID_CACHE_VERSION && hidCache.reportCount > 0 &&
+         hidCache.reportCount <= MAX_CACHED_REPORTS && strcmp(hidCache.address, keyboardAddress.c_str()) == 0;
+}
+
+// Remember the handles full discovery ended up using; saveHidCache() stores them with the
+// keyboard's profile once the connection is up.
+static void rememberHidHandles(NimBLERemoteCharacteristic* proto, NimBLERemoteCharacteristic* const* reports,
+                               int count, NimBLERemoteCharacteristic* svcChanged, const uint8_t* dbHash) {
+  HidHandleCache cache = {};
+  cache.version = HID_CACHE_VERSION;
+  strncpy(cache.address, keyboardAddress.c_str(), sizeof(cache.address) - 1);
+  cache.protoHandle = proto ? proto->getHandle() : 0;
+  NimBLERemoteDescriptor* changedCccd = svcChanged ? svcChanged->getDescriptor(NimBLEUUID((uint16_t)0x2902)) : nullptr;
+  if (changedCccd) {
+    cache.svcChangedHandle = svcChanged->getHandle();
+    cache.svcChangedCccd = changedCccd->getHandle();
+  }
+  if (dbHash) {
+    cache.hasDbHash = true;
+    memcpy(cache.dbHash, dbHash, DB_HASH_LEN);
+  }
+  for (int i = 0; i < count && i < MAX_CACHED_REPORTS; i++) {
+    NimBLERemoteDescriptor* cccd = reports[i]->getDescriptor(NimBLEUUID((uint16_t)0x2902));
+    if (!cccd) return;  // Can't re-enable it by handle — don't cache a partial set
+    cache.valueHandle[i] = reports[i]->getHandle();
+    cache.cccdHandle[i] = cccd->getHandle();
+    cache.reportCount++;
+  }
+  if (cache.reportCount == 0) return;
+  hidCache = cache;
+  hidCacheFresh = true;
+}
+
+// NVS is only written on change
+static void saveHidCache(int slot) {
+  if (!hidCacheFresh || slot < 0) return;
+  hidCacheFresh = false;
+  char key[8];
+  profileKey(key, sizeof(key), "gatt", slot);
+  HidHandleCache old;
+  if (prefs.getBytes(key, &old, sizeof(old)) == sizeof(old) && memcmp(&old, &hidCache, sizeof(hidCache)) == 0) {
+    return;
+  }
+  prefs.putBytes(key, &hidCache, sizeof(hidCache));
+  DBG_PRINTF("[BLE] Cached %d HID report handle(s) for %s\n", hidCache.reportCount, hidCache.address);
+}
+
+// --- Keyboard profile storage ---
+
+static void saveProfile(int slot) {
+  char key[8];
+  profileKey(key, sizeof(key), "kb", slot);
+  prefs.putBytes(key, &profiles[slot], sizeof(KeyboardProfile));
+}
+
+// Slots of saved profiles, most recently used first. Returns how many.
+static int profilesByRecency(int* order) {
+  int n = 0;
+  for (int i = 0; i < MAX_KB_PROFILES; i++) {
+    if (profiles[i].address[0] == '\0') continue;
+    int j = n++;
+    while (j > 0 && profiles[order[j - 1]].lastUsed < profiles[i].lastUsed) {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = i;
+  }
+  return n;
+}
+
+// Save a keyboard as the most recently used profile. Returns its slot.
+static int saveKeyboardProfile(const std::string& address, const std::string& name, uint8_t addrType) {
+  ProfileLock lock;
+  int slot = findProfile(address);
+  if (slot >= 0 && profiles[slot].lastUsed == profileClock && name == profiles[slot].name &&
+      profiles[slot].addrType == addrType) {
+    return slot;  // Already the most recent, unchanged — skip the NVS write
+  }
+  if (slot < 0) {
+    // Free slot, else replace the least recently used keyboard
+    slot = 0;
+    for (int i = 0; i < MAX_KB_PROFILES; i++) {
+      if (profiles[i].address[0] == '\0') {
+        slot = i;
+        break;
+      }
+      if (profiles[i].lastUsed < profiles[slot].lastUsed) slot = i;
+    }
+    if (profiles[slot].address[0] != '\0') {
+      DBG_PRINTF("[BLE] Profile limit reached — replacing %s (%s)\n", profiles[slot].name, profiles[slot].address);
+      NimBLEDevice::deleteBond(NimBLEAddress(std::string(profiles[slot].address), profiles[slot].addrType));
+    }
+    char key[8];
+    profileKey(key, sizeof(key), "gatt", slot);
+    prefs.remove(key);
+  }
+
+  KeyboardProfile& p = profiles[slot];
+  memset(&p, 0, sizeof(p));
+  p.version = KB_PROFILE_VERSION;
+  p.addrType = addrType;
+  strncpy(p.address, address.c_str(), sizeof(p.address) - 1);
+  strncpy(p.name, name.c_str(), sizeof(p.name) - 1);
+  p.lastUsed = ++profileClock;
+  saveProfile(slot);
+  DBG_PRINTF("[BLE] Stored profile %d: %s (%s) type=%d\n", slot, p.address, p.name, p.addrType);
+  return slot;
+}
+
+// Runs from bleInit(), before the connect task exists — no lock
+static void loadProfiles() {
+  profileClock = 0;
+  for (int i = 0; i < MAX_KB_PROFILES; i++) {
+    char key[8];
+    profileKey(key, sizeof(key), "kb", i);
+    KeyboardProfile& p = profiles[i];
+    if (prefs.getBytes(key, &p, sizeof(p)) != sizeof(p) || p.version != KB_PROFILE_VERSION) {
+      memset(&p, 0, sizeof(p));
+      continue;
+    }
+    p.address[sizeof(p.address) - 1] = '\0';
+    p.name[sizeof(p.name) - 1] = '\0';
+    if (p.lastUsed > profileClock) profileClock = p.lastUsed;
+  }
+
+  // Single stored keyboard from earlier firmware (addr / name / addrType keys)
+  String addr = prefs.getString("addr", "");
+  if (addr.length() > 0) {
+    String name = prefs.getString("name", "");
+    saveKeyboardProfile(addr.c_str(), name.length() > 0 ? name.c_str() : addr.c_str(), prefs.getUChar("addrType", 0));
+    prefs.remove("addr");
+    prefs.remove("name");
+    prefs.remove("addrType");
+    DBG_PRINTLN("[BLE] Migrated stored keyboard to profile storage");
+  }
+}
+
+static volatile bool gattOpDone = false;
+static volatile int gattOpStatus = 0;
+static uint8_t gattReadBuf[DB_HASH_LEN];
+static volatile uint16_t gattReadLen = 0;
+
+static int onGattWrite(uint16_t connHandle, const ble_gatt_error* error, ble_gatt_attr* attr, void* arg) {
+  gattOpStatus = error->status;
+  gattOpDone = true;
+  return 0;
+}
+
+// Called once per matching attribute, then with BLE_HS_EDONE (or an ATT error)
+static int onGattRead(uint16_t connHandle, const ble_gatt_error* error, ble_gatt_attr* attr, void* arg) {
+  if (error->status == 0 && attr) {
+    uint16_t len = 0;
+    if (ble_hs_mbuf_to_flat(attr->om, gattReadBuf, sizeof(gattReadBuf), &len) == 0) gattReadLen = len;
+    return 0;
+  }
+  gattOpStatus = error->status == BLE_HS_EDONE ? 0 : error->status;
+  gattOpDone = true;
+  return 0;
+}
+
+static bool waitGattOp() {
+  unsigned long start = millis();
+  while (!gattOpDone && millis() - start < 2000) {
+    vTaskDelay(pdMS_TO_TICKS(5));
+  }
+  return gattOpDone && gattOpStatus == 0;
+}
+
+// Write with response to a raw handle, waiting for the keyboard's reply
+static bool writeHandle(uint16_t handle, const uint8_t* data, size_t len) {
+  gattOpDone = false;
+  if (ble_gattc_write_flat(pClient->getConnHandle(), handle, data, len, onGattWrite, nullptr) != 0) return false;
+  return waitGattOp();
+}
+
+// The keyboard's GATT Database Hash: one read by UUID, no discovery. False if it has none.
+static bool readDatabaseHash(uint8_t* hash) {
+  static const ble_uuid16_t dbHashUuid = BLE_UUID16_INIT(0x2B2A);
+  gattOpDone = false;
+  gattReadLen = 0;
+  if (ble_gattc_read_by_uuid(pClient->getConnHandle(), 1, 0xFFFF, &dbHashUuid.u, onGattRead, nullptr) != 0) {
+    return false;
+  }
+  if (!waitGattOp() || gattReadLen != DB_HASH_LEN) return false;
+  memcpy(hash, gattReadBuf, DB_HASH_LEN);
+  return true;
+}
+
+// Turn on Service Changed indications after full discovery, so the keyboard keeps them on
+// for later cached-handle connections (this connection's handles are fresh, so nothing to
+// act on here). Returns the characteristic, or nullptr if the keyboard has none.
+static NimBLERemoteCharacteristic* subscribeServiceChanged() {
+  NimBLERemoteService* gatt = pClient->getService(NimBLEUUID((uint16_t)0x1801));
+  NimBLERemoteCharacteristic* changed = gatt ? gatt->getCharacteristic(NimBLEUUID((uint16_t)0x2A05)) : nullptr;
+  if (!changed || !changed->canIndicate() || !changed->subscribe(false, nullptr)) return nullptr;
+  return changed;
+}
+
+static bool subscribeCachedHandles() {
+  if (hidCache.hasDbHash) {
+    uint8_t hash[DB_HASH_LEN];
+    if (!readDatabaseHash(hash) || memcmp(hash, hidCache.dbHash, DB_HASH_LEN) != 0) {
+      DBG_PRINTLN("[BLE] GATT database hash changed");
+      return false;
+    }
+  }
+  pClient->deleteServices();  // No stale characteristics delivering the same reports twice
+
+  if (hidCache.protoHandle != 0) {
+    uint8_t mode = 1;  // 1 = Report Protocol
+    if (!writeHandle(hidCache.protoHandle, &mode, 1)) return false;
+  }
+  static const uint8_t notifyOn[2] = {0x01, 0x00};
+  cachedRouting = true;  // Reports may arrive as soon as the first CCCD write lands
+  for (int i = 0; i < hidCache.reportCount; i++) {
+    if (!writeHandle(hidCache.cccdHandle[i], notifyOn, sizeof(notifyOn))) {
+      cachedRouting = false;
+      return false;
+    }
+  }
+  if (hidCache.svcChangedCccd != 0) {
+    static const uint8_t indicateOn[2] = {0x02, 0x00};
+    writeHandle(hidCache.svcChangedCccd, indicateOn, sizeof(indicateOn));  // Best effort — usually still on from the bond
+  }
+  return true;
+}
+
 // --- HID service discovery and subscription ---
 
 static bool setupHidConnection() {
   if (!pClient || !pClient->isConnected()) return false;
 
+  int slot;
+  {
+    ProfileLock lock;
+    slot = findProfile(keyboardAddress);
+  }
+  if (loadHidCache(slot)) {
+    if (subscribeCachedHandles()) {
+      DBG_PRINTF("[BLE] HID setup from %d cached handle(s)\n", hidCache.reportCount);
+      return true;
+    }
+    DBG_PRINTLN("[BLE] Cached handles failed — full discovery");
+  }
+
   DBG_PRINTLN("[BLE] Discovering services...");
   if (pClient->getServices(true).empty()) {
     DBG_PRINTLN("[BLE] Service discovery failed");
@@ -287,6 +684,9 @@ static bool setupHidConnection() {
     if (pInputReportChar) break;
   }
 
+  NimBLERemoteCharacteristic* subscribed[MAX_CACHED_REPORTS];
+  int subscribedCount = 0;
+
   // Fallback: subscribe to ALL notifiable report chars to find keyboard input
   if (!pInputReportChar) {
     DBG_PRINTLN("[BLE] No report ref found, subscribing to ALL notifiable report chars");
@@ -301,6 +701,7 @@ static bool setupHidConnection() {
           if (reportCount == 1) {
             pInputReportChar = chr;  // Keep first one as primary reference
           }
+          if (subscribedCount < MAX_CACHED_REPORTS) subscribed[subscribedCount++] = chr;
         } else {
           DBG_PRINTF("[BLE] FAILED to subscribe to report char handle=%d\n", chr->getHandle());
         }
@@ -329,17 +730,23 @@ static bool setupHidConnection() {
 
   // If we have a specific input report char (from report ref or boot keyboard),
   // and we haven't already subscribed to it, subscribe now
-  if (pInputReportChar->getUUID() != reportUUID || !pInputReportChar->canNotify()) {
+  if (subscribedCount == 0) {
     DBG_PRINTF("[BLE] Subscribing to char %s\n", pInputReportChar->getUUID().toString().c_str());
     if (!pInputReportChar->subscribe(true, onKeyboardNotify)) {
       DBG_PRINTLN("[BLE] Subscribe failed");
       return false;
     }
     DBG_PRINTLN("[BLE] Subscribe succeeded");
+    subscribed[subscribedCount++] = pInputReportChar;
   } else {
     DBG_PRINTLN("[BLE] Already subscribed to report char(s)");
   }
 
+  // Change detection for the cached handles (see subscribeCachedHandles)
+  NimBLERemoteCharacteristic* svcChanged = subscribeServiceChanged();
+  uint8_t dbHash[DB_HASH_LEN];
+  bool hasDbHash = readDatabaseHash(dbHash);
+  rememberHidHandles(pProto, subscribed, subscribedCount, svcChanged, hasDbHash ? dbHash : nullptr);
   DBG_PRINTLN("[BLE] HID setup complete");
   return true;
 }
@@ -349,6 +756,7 @@ static bool setupHidConnection() {
 static void bleConnectTask(void* param) {
   bleState = BLEState::CONNECTING;
   authSuccess = false;
+  unsigned long phaseStart = millis();
 
   DBG_PRINTF("[BLE-Task] Connecting to %s type=%d\n",
              keyboardAddress.c_str(), keyboardAddressType);
@@ -358,7 +766,7 @@ static void bleConnectTask(void* param) {
     pClient = NimBLEDevice::createClient();
     pClient->setClientCallbacks(&clientCallbacks, false);
   }
-  pClient->setConnectTimeout(CONNECT_TIMEOUT_MS);
+  pClient->setConnectTimeout(connectTimeoutMs);
 
   // Step 1: Connect (blocks this task, main loop continues)
   NimBLEAddress addr(keyboardAddress, keyboardAddressType);
@@ -366,10 +774,13 @@ static void bleConnectTask(void* param) {
     DBG_PRINTLN("[BLE-Task] Connection failed");
     bleState = BLEState::DISCONNECTED;
     connectTaskHandle = nullptr;
+    loopPost(LoopEvent::BLE);
     vTaskDelete(NULL);
     return;
   }
 
+  connectPhaseMs = millis() - phaseStart;
+  phaseStart = millis();
   DBG_PRINTLN("[BLE-Task] Connected, attempting security...");
 
   // Step 2: Try security pairing (optional for some keyboards)
@@ -380,7 +791,7 @@ static void bleConnectTask(void* param) {
     // Wait for auth callbacks
     unsigned long secStart = millis();
     while (!authSuccess && (millis() - secStart < 5000)) {
-      vTaskDelay(pdMS_TO_TICKS(100));
+      vTaskDelay(pdMS_TO_TICKS(10));
     }
 
     if (authSuccess) {
@@ -392,6 +803,8 @@ static void bleConnectTask(void* param) {
     DBG_PRINTLN("[BLE-Task] secureConnection() returned false - trying HID anyway");
   }
 
+  securityPhaseMs = millis() - phaseStart;
+  phaseStart = millis();
   DBG_PRINTLN("[BLE-Task] Setting up HID...");
 
   // Step 4: Service discovery + HID subscription (blocks this task)
@@ -400,34 +813,50 @@ static void bleConnectTask(void* param) {
     if (pClient->isConnected()) pClient->disconnect();
     bleState = BLEState::DISCONNECTED;
     connectTaskHandle = nullptr;
+    loopPost(LoopEvent::BLE);
     vTaskDelete(NULL);
     return;
   }
 
-  // Step 5: Store device and mark connected
-  std::string storedAddr, storedName;
-  if (!getStoredDevice(storedAddr, storedName) || storedAddr != keyboardAddress) {
-    std::string devName = keyboardAddress;
+  hidPhaseMs = millis() - phaseStart;
+  DBG_PRINTF("[BLE-Task] connect %lums, security %lums, HID %lums\n", connectPhaseMs, securityPhaseMs,
+             hidPhaseMs);
+
+  // Step 5: Save the keyboard as the most recently used profile and mark connected
+  int slot;
+  std::string devName = keyboardAddress;
+  {
+    ProfileLock lock;
+    slot = findProfile(keyboardAddress);
+    if (slot >= 0) devName = profiles[slot].name;
+  }
+  if (slot < 0) {
     for (auto& d : discoveredDevices) {
       if (d.address == keyboardAddress) {
         devName = d.name;
         break;
       }
     }
-    storePairedDevice(keyboardAddress, devName);
   }
+  slot = saveKeyboardProfile(keyboardAddress, devName, keyboardAddressType);
+  saveHidCache(slot);
 
   // Request our preferred connection parameters (active typing mode)
-  pClient->updateConnParams(CONN_INTERVAL_ACTIVE_MIN, CONN_INTERVAL_ACTIVE_MAX,
-                             CONN_SLAVE_LATENCY_ACTIVE, CONN_SUPERVISION_TIMEOUT);
-  bleConnIdleMode = false;
-  lastBleKeystrokeMs = millis();
-
-  DBG_PRINTLN("[BLE-Task] Keyboard ready!");
+  keyTimeTail = keyTimeHead;
+  ConnParams params = connTunerReset(millis());
+  pClient->updateConnParams(params.intervalMin, params.intervalMax, params.latency, CONN_SUPERVISION_TIMEOUT);
+
+  // Switch time per flow: "scan" counts from the scan start (scan, pick, connect, pair) and
+  // "switch" from the profile step, so both ways of changing keyboard log comparable numbers
+  DBG_PRINTF("[BLE-Task] Keyboard ready! %s, %s %lums (%lums after request; connect %lums, security %lums, HID %lums)\n",
+             devName.c_str(), connectFlow, millis() - connectFlowStartMs, millis() - connectRequestMs,
+             connectPhaseMs, securityPhaseMs, hidPhaseMs);
   bleState = BLEState::CONNECTED;
   reconnectDelay = 10000;  // Reset backoff after successful connection
+  reconnectRoundNext = 0;
 
   connectTaskHandle = nullptr;
+  loopPost(LoopEvent::BLE);
   vTaskDelete(NULL);
 }
 
@@ -455,6 +884,7 @@ void bleSetup() {
   NimBLEDevice::setSecurityInitKey(BLE_SM_PAIR_KEY_DIST_ENC | BLE_SM_PAIR_KEY_DIST_ID);
   NimBLEDevice::setSecurityRespKey(BLE_SM_PAIR_KEY_DIST_ENC | BLE_SM_PAIR_KEY_DIST_ID);
   NimBLEDevice::setPower(-9);  // -9dBm — lowest verified working power level
+  ble_gap_event_listener_register(&gapListener, onGapEvent, nullptr);
 
   prefs.begin("ble_kb", false);
 
@@ -464,13 +894,12 @@ void bleSetup() {
   scan->setWindow(449);
   scan->setActiveScan(true);
 
-  // Check for stored device to auto-reconnect
-  std::string storedAddr, storedName;
-  if (getStoredDevice(storedAddr, storedName) && !storedAddr.empty()) {
-    keyboardAddress = storedAddr;
-    keyboardAddressType = prefs.getUChar("addrType", 0);
-    connectToKeyboard = true;
-    DBG_PRINTF("[BLE] Will reconnect to: %s type=%d\n", storedAddr.c_str(), keyboardAddressType);
+  // Saved keyboards: start a reconnect round right away
+  loadProfiles();
+  int profileCount = getKeyboardProfileCount();
+  if (profileCount > 0) {
+    reconnectNow = true;
+    DBG_PRINTF("[BLE] Will reconnect to %d saved keyboard(s)\n", profileCount);
   } else {
     bleState = BLEState::DISCONNECTED;
     DBG_PRINTLN("[BLE] No stored device");
@@ -488,6 +917,52 @@ void bleLoop() {
     screenDirty = true;
   }
 
+  // The keyboard's GATT layout changed under us: forget its cached handles and reconnect,
+  // which runs full discovery
+  if (gattChanged && connectTaskHandle == nullptr) {
+    gattChanged = false;
+    int slot;
+    {
+      ProfileLock lock;
+      slot = findProfile(keyboardAddress);
+    }
+    if (slot >= 0) {
+      char key[8];
+      profileKey(key, sizeof(key), "gatt", slot);
+      prefs.remove(key);
+    }
+    DBG_PRINTF("[BLE] Service Changed from %s — rediscovering\n", keyboardAddress.c_str());
+    if (pClient && pClient->isConnected()) {
+      reconnectNow = true;
+      pClient->disconnect();
+      return;
+    }
+  }
+
+  // Keyboard switch: once no connect attempt is running, drop the current link and
+  // connect straight to the chosen profile
+  if (switchSlot >= 0 && connectTaskHandle == nullptr) {
+    KeyboardProfile p;
+    {
+      ProfileLock lock;
+      p = profiles[switchSlot];
+    }
+    if (p.address[0] == '\0' || (bleState == BLEState::CONNECTED && keyboardAddress == p.address)) {
+      switchSlot = -1;  // Cleared meanwhile, or already on it
+    } else if (pClient && pClient->isConnected()) {
+      pClient->disconnect();  // Connect once onDisconnect has run
+      return;
+    } else {
+      keyboardAddress = p.address;
+      keyboardAddressType = p.addrType;
+      connectTimeoutMs = CONNECT_TIMEOUT_MS;
+      reconnectRoundNext = 0;
+      switchSlot = -1;
+      connectToKeyboard = true;
+      DBG_PRINTF("[BLE] Switching to %s (%s)\n", p.name, p.address);
+    }
+  }
+
   // Launch connect task if requested (non-blocking)
   if (connectToKeyboard && bleState != BLEState::CONNECTED && connectTaskHandle == nullptr) {
     connectToKeyboard = false;
@@ -495,40 +970,87 @@ void bleLoop() {
     return;
   }
 
-  // Adaptive BLE connection parameters: fast interval while typing, slow when idle.
-  // Saves significant radio power during pauses between typing bursts.
+  // Adaptive BLE connection parameters: intervals, slave latency and idle threshold chosen
+  // from the measured notify delay and typing rhythm (see ble_conn_tuner.cpp).
   if (bleState == BLEState::CONNECTED && pClient && pClient->isConnected()) {
+    ConnParams params;
+    bool update = false;
+    unsigned long now = millis();
+    uint16_t interval = pClient->getConnInfo().getConnInterval();
+    connTunerObserved(interval, now);
+    while (keyTimeTail != keyTimeHead) {
+      uint8_t slot = keyTimeTail % KEY_TIME_RING;
+      int64_t arrivedUs = reportArrivedUs[slot];
+      connTunerNotify(static_cast<uint32_t>(arrivedUs));
+      // millis() is esp_timer in ms
+      if (reportPressed[slot]) update |= connTunerKeystroke(static_cast<uint32_t>(arrivedUs / 1000), params);
+      keyTimeTail++;
+    }
+    energyBleInterval(interval);
+    if (!update) update = connTunerPoll(now, params);
+    if (update) {
+      pClient->updateConnParams(params.intervalMin, params.intervalMax, params.latency, CONN_SUPERVISION_TIMEOUT);
+      DBG_PRINTF("[BLE] Conn params -> %u-%u latency %u\n", params.intervalMin, params.intervalMax,
+                 params.latency);
+    }
+  }
+
+  // Auto-reconnect to saved keyboards: a round of directed connects, most recently used
+  // first and back to back, then exponential backoff before the next round
+  if (bleState == BLEState::DISCONNECTED && autoReconnectEnabled && connectTaskHandle == nullptr &&
+      !connectToKeyboard && switchSlot < 0) {
     unsigned long now = millis();
-    if (!bleConnIdleMode && (now - lastBleKeystrokeMs > BLE_IDLE_SWITCH_MS)) {
-      // No keystrokes for 3s — switch to slow polling to save radio power
-      pClient->updateConnParams(CONN_INTERVAL_IDLE_MIN, CONN_INTERVAL_IDLE_MAX,
-                                 CONN_SLAVE_LATENCY_IDLE, CONN_SUPERVISION_TIMEOUT);
-      bleConnIdleMode = true;
-    } else if (bleConnIdleMode && (now - lastBleKeystrokeMs <= BLE_IDLE_SWITCH_MS)) {
-      // Keystroke arrived — switch back to fast polling, no skipped events
-      pClient->updateConnParams(CONN_INTERVAL_ACTIVE_MIN, CONN_INTERVAL_ACTIVE_MAX,
-                                 CONN_SLAVE_LATENCY_ACTIVE, CONN_SUPERVISION_TIMEOUT);
-      bleConnIdleMode = false;
-    }
-  }
-
-  // Auto-reconnect to stored device (exponential backoff)
-  if (bleState == BLEState::DISCONNECTED && autoReconnectEnabled && connectTaskHandle == nullptr) {
-    std::string storedAddr, storedName;
-    if (getStoredDevice(storedAddr, storedName) && !storedAddr.empty()) {
-      unsigned long now = millis();
-      if (now - lastReconnectAttempt >= reconnectDelay) {
-        lastReconnectAttempt = now;
-        keyboardAddress = storedAddr;
-        keyboardAddressType = prefs.getUChar("addrType", 0);
-        connectToKeyboard = true;
-        DBG_PRINTF("[BLE] Auto-reconnect: %s (retry in %lums)\n",
-                   storedAddr.c_str(), reconnectDelay);
-        reconnectDelay = (reconnectDelay * 2 > MAX_RECONNECT_DELAY)
-                           ? MAX_RECONNECT_DELAY : reconnectDelay * 2;
+    if (reconnectRoundNext == 0) {
+      if (!reconnectNow && now - lastReconnectAttempt < reconnectDelay) return;
+      reconnectNow = false;
+      {
+        ProfileLock lock;
+        reconnectRoundCount = profilesByRecency(reconnectRound);
       }
+      if (reconnectRoundCount == 0) return;
+      connectRequestMs = now;
+      connectFlowStartMs = now;
+      connectFlow = "reconnect";
     }
+    KeyboardProfile p;
+    {
+      ProfileLock lock;
+      p = profiles[reconnectRound[reconnectRoundNext++]];
+    }
+    if (p.address[0] != '\0') {
+      keyboardAddress = p.address;
+      keyboardAddressType = p.addrType;
+      connectTimeoutMs = reconnectRoundCount > 1 ? ROUND_CONNECT_TIMEOUT_MS : CONNECT_TIMEOUT_MS;
+      connectToKeyboard = true;
+      DBG_PRINTF("[BLE] Auto-reconnect %d/%d: %s (%s)\n", reconnectRoundNext, reconnectRoundCount, p.name,
+                 p.address);
+    }
+    if (reconnectRoundNext >= reconnectRoundCount) {
+      reconnectRoundNext = 0;
+      lastReconnectAttempt = now;
+      DBG_PRINTF("[BLE] Next reconnect round in %lums\n", reconnectDelay);
+      reconnectDelay = (reconnectDelay * 2 > MAX_RECONNECT_DELAY)
+                         ? MAX_RECONNECT_DELAY : reconnectDelay * 2;
+    }
+  }
+}
+
+uint32_t bleNextDeadline(unsigned long now) {
+  if (isScanning) return BLE_POLL_MS;  // Scan end is detected by polling
+  if (switchSlot >= 0) return connectTaskHandle ? LOOP_NO_DEADLINE : BLE_POLL_MS;
+  // A running connect task posts LoopEvent::BLE when it finishes
+  if (connectTaskHandle != nullptr) return LOOP_NO_DEADLINE;
+  if (connectToKeyboard && bleState != BLEState::CONNECTED) return 0;
+
+  if (bleState == BLEState::CONNECTED && pClient && pClient->isConnected()) {
+    return connTunerNextPoll(now);
+  }
+  if (bleState == BLEState::DISCONNECTED && autoReconnectEnabled && getKeyboardProfileCount() > 0) {
+    if (reconnectNow || reconnectRoundNext > 0) return 0;
+    unsigned long since = now - lastReconnectAttempt;
+    return since >= reconnectDelay ? 0 : reconnectDelay - since;
   }
+  return LOOP_NO_DEADLINE;
 }
 
 bool isKeyboardConnected() {
@@ -597,6 +1119,10 @@ void connectToDevice(int deviceIndex) {
 
   keyboardAddress = discoveredDevices[deviceIndex].address;
   keyboardAddressType = discoveredDevices[deviceIndex].addressType;
+  connectTimeoutMs = CONNECT_TIMEOUT_MS;
+  connectRequestMs = millis();
+  connectFlowStartMs = scanStartMs;  // Switching by scan-and-pick starts at the scan
+  connectFlow = "scan";
   connectToKeyboard = true;
 
   DBG_PRINTF("[BLE] Will connect to: %s type=%d (%s)\n",
@@ -621,22 +1147,52 @@ std::string getCurrentDeviceAddress() {
 }
 
 void storePairedDevice(const std::string& address, const std::string& name) {
-  prefs.putString("addr", address.c_str());
-  prefs.putString("name", name.c_str());
-  prefs.putUChar("addrType", keyboardAddressType);
-  DBG_PRINTF("[BLE] Stored to NVS: %s (%s) type=%d\n",
-             address.c_str(), name.c_str(), keyboardAddressType);
+  saveKeyboardProfile(address, name, keyboardAddressType);
 }
 
 bool getStoredDevice(std::string& address, std::string& name) {
-  String addr = prefs.getString("addr", "");
-  if (addr.length() > 0) {
-    address = addr.c_str();
-    String n = prefs.getString("name", "");
-    name = (n.length() > 0) ? n.c_str() : address;
-    return true;
+  return getKeyboardProfile(0, address, name);
+}
+
+int getKeyboardProfileCount() {
+  ProfileLock lock;
+  int order[MAX_KB_PROFILES];
+  return profilesByRecency(order);
+}
+
+bool getKeyboardProfile(int index, std::string& address, std::string& name) {
+  ProfileLock lock;
+  int order[MAX_KB_PROFILES];
+  int count = profilesByRecency(order);
+  if (index < 0 || index >= count) return false;
+  address = profiles[order[index]].address;
+  name = profiles[order[index]].name[0] != '\0' ? profiles[order[index]].name : address;
+  return true;
+}
+
+void stepKeyboardProfile(int step) {
+  // From the keyboard being switched to if a switch is pending, else the one in use; with
+  // neither, start just outside the slot range so the first step lands on an end slot
+  int from, slot = -1;
+  {
+    ProfileLock lock;
+    from = switchSlot >= 0 ? switchSlot : findProfile(keyboardAddress);
+    if (from < 0) from = step > 0 ? -1 : MAX_KB_PROFILES;
+    for (int k = 1; k <= MAX_KB_PROFILES; k++) {
+      int i = ((from + k * step) % MAX_KB_PROFILES + MAX_KB_PROFILES) % MAX_KB_PROFILES;
+      if (profiles[i].address[0] != '\0') {
+        slot = i;
+        break;
+      }
+    }
   }
-  return false;
+  if (slot < 0 || slot == from) return;
+  stopDeviceScan();
+  connectToKeyboard = false;
+  connectRequestMs = millis();
+  connectFlowStartMs = connectRequestMs;
+  connectFlow = "switch";
+  switchSlot = slot;
 }
 
 bool isDeviceScanning() {
@@ -661,10 +1217,21 @@ void clearAllBluetoothBonds() {
 }
 
 void clearStoredDevice() {
-  prefs.remove("addr");
-  prefs.remove("name");
-  prefs.remove("addrType");
-  DBG_PRINTLN("[BLE] Cleared stored device from NVS");
+  for (int i = 0; i < MAX_KB_PROFILES; i++) {
+    char key[8];
+    profileKey(key, sizeof(key), "kb", i);
+    prefs.remove(key);
+    profileKey(key, sizeof(key), "gatt", i);
+    prefs.remove(key);
+  }
+  {
+    ProfileLock lock;
+    memset(profiles, 0, sizeof(profiles));
+    profileClock = 0;
+  }
+  reconnectRoundNext = 0;
+  switchSlot = -1;
+  DBG_PRINTLN("[BLE] Cleared stored keyboards from NVS");
   NimBLEDevice::deleteAllBonds();
   DBG_PRINTLN("[BLE] Cleared all stored bonds");
 }
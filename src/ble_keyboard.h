@@ -14,6 +14,9 @@ struct BleDeviceInfo {
 
 void bleSetup();
 void bleLoop();
+// Milliseconds until bleLoop() next has timed work (reconnect backoff, scan end, connection
+// parameter switch): 0 = now, LOOP_NO_DEADLINE = only when an event arrives
+uint32_t bleNextDeadline(unsigned long now);
 bool isKeyboardConnected();
 BLEState getConnectionState();
 
@@ -29,11 +32,21 @@ std::string getCurrentDeviceAddress();
 // Global flag to control auto-reconnect behavior
 extern bool autoReconnectEnabled;
 
-// Functions for managing stored device
+// Functions for managing stored devices (keyboard profiles)
 void storePairedDevice(const std::string& address, const std::string& name);
+// Most recently used keyboard profile
 bool getStoredDevice(std::string& address, std::string& name);
+// Removes every saved keyboard and bond
 void clearStoredDevice();
 
+// Saved keyboard profiles, most recently used first (index 0 is tried first on reconnect)
+int getKeyboardProfileCount();
+bool getKeyboardProfile(int index, std::string& address, std::string& name);
+// Drop the current keyboard and connect straight to the next (step > 0) or previous saved
+// one (no scan). Steps go through profile slots, not MRU order, so repeated steps visit
+// every saved keyboard.
+void stepKeyboardProfile(int step);
+
 // Function for getting current passkey for UI display
 uint32_t getCurrentPasskey();
 
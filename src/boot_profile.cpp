@@ -0,0 +1,31 @@
+#include "boot_profile.h"
+#include "config.h"
+
+#include <Arduino.h>
+
+static BootPhaseTiming timings[static_cast<int>(BootPhase::COUNT)];
+
+static const char* const PHASE_NAMES[] = {
+  "Hardware", "Display", "Settings", "Resume", "SD mount", "BLE init", "First frame", "File list"
+};
+static_assert(sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]) == static_cast<int>(BootPhase::COUNT),
+              "one name per boot phase");
+
+void bootPhaseStart(BootPhase phase) {
+  timings[static_cast<int>(phase)] = {static_cast<uint32_t>(millis()), 0};
+}
+
+void bootPhaseEnd(BootPhase phase) {
+  BootPhaseTiming& t = timings[static_cast<int>(phase)];
+  t.endMs = millis();
+  DBG_PRINTF("[BOOT] %-11s %5lu - %5lu ms\n", bootPhaseName(phase), static_cast<unsigned long>(t.startMs),
+             static_cast<unsigned long>(t.endMs));
+}
+
+const BootPhaseTiming& bootPhaseTiming(BootPhase phase) {
+  return timings[static_cast<int>(phase)];
+}
+
+const char* bootPhaseName(BootPhase phase) {
+  return PHASE_NAMES[static_cast<int>(phase)];
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+// --- Boot profile ---
+// Start / end time (ms since app start) of each boot phase, for the Boot Profile screen.
+// Each phase is recorded by the one task that runs it, so no locking is needed.
+
+enum class BootPhase : uint8_t {
+  HARDWARE,     // CPU clock, GPIO / SPI
+  DISPLAY,      // Panel reset + controller init, renderer fonts
+  SETTINGS,     // UI preferences from NVS
+  RESUME,       // Instant-resume check (reads the note when resuming)
+  SD_MOUNT,     // Boot task, concurrent with the first frame
+  BLE_INIT,     // Boot task, concurrent with the first frame
+  FIRST_FRAME,  // Main menu (or resumed editor) drawn with the power-on full refresh
+  FILE_LIST,    // Lazy: first time the note list is needed
+  COUNT
+};
+
+struct BootPhaseTiming {
+  uint32_t startMs;
+  uint32_t endMs;  // 0 = not finished (or not run)
+};
+
+void bootPhaseStart(BootPhase phase);
+void bootPhaseEnd(BootPhase phase);
+const BootPhaseTiming& bootPhaseTiming(BootPhase phase);
+const char* bootPhaseName(BootPhase phase);
@@ -12,7 +12,13 @@ enum class UIState {
   NEW_FILE,
   SETTINGS,
   BLUETOOTH_SETTINGS,
-  WIFI_SYNC
+  BLE_DIAGNOSTICS,
+  BOOT_PROFILE,
+  ENERGY_REPORT,
+  WIFI_SYNC,
+  NOTE_SEARCH,
+  EDITOR_FIND,
+  NOTE_HISTORY
 };
 
 // --- Display Orientation ---
@@ -40,41 +46,63 @@ enum class BLEState : uint8_t {
 };
 
 // --- Key Event (for input queue) ---
+// Packed into 16 bits: the right-hand modifier bits are folded onto the left-hand ones
+// on enqueue (nothing distinguishes the two sides), so they fit in 4 bits.
 struct KeyEvent {
   uint8_t keyCode;
-  uint8_t modifiers;
-  bool pressed;
+  uint8_t modifiers : 4;
+  bool pressed : 1;
 };
+static_assert(sizeof(KeyEvent) == 2, "KeyEvent should pack into 16 bits");
 
 // --- File Info ---
 static constexpr int MAX_FILENAME_LEN = 64;
 static constexpr int MAX_TITLE_LEN = 40;
 
+// Display titles aren't stored: filenameToTitle() derives one in a few hundred ns when
+// it's drawn, which saves MAX_TITLE_LEN + 4 bytes per entry.
 struct FileInfo {
   char filename[MAX_FILENAME_LEN];
-  char title[MAX_TITLE_LEN];
-  unsigned long modTime;
 };
 
 // --- Auto-save timing ---
 static constexpr unsigned long AUTO_SAVE_IDLE_MS = 10000;    // Save after 10s of no keystrokes
 static constexpr unsigned long AUTO_SAVE_MAX_MS  = 120000;   // Hard cap: save every 2min during continuous typing
 
-// --- Buffer/Queue Sizes ---
-static constexpr size_t TEXT_BUFFER_SIZE = 16384;
+// --- Energy model (see energy_meter.h) ---
+// Current each state adds on top of the light-sleep floor, in µA. Rough datasheet-level
+// estimates for this board — adjust them to bench measurements when available.
+static constexpr uint32_t ENERGY_FLOOR_UA        = 350;    // Light sleep, BLE modem sleep, always drawn
+static constexpr uint32_t ENERGY_CPU_UA          = 20000;  // CPU awake at 80 MHz
+static constexpr uint32_t ENERGY_DISPLAY_BUSY_UA = 4000;   // Panel waveform running (BUSY high)
+static constexpr uint32_t ENERGY_DISPLAY_SPI_UA  = 3000;   // Frame transfer to the controller
+static constexpr uint32_t ENERGY_SD_UA           = 25000;  // Card reading / writing
+static constexpr uint32_t ENERGY_WIFI_UA         = 80000;  // WiFi sync radio on
+static constexpr uint32_t ENERGY_BLE_EVENT_UC    = 40;     // Charge per BLE connection event, µC
+
+// --- Screen cache (see screen_cache.h) ---
+static constexpr size_t SCREEN_CACHE_BUDGET = 24 * 1024;  // Heap for RLE-encoded static screens
+
+// --- Core tables (scripts/ram_report.py lists what they cost after every build) ---
+static constexpr size_t TEXT_BUFFER_SIZE = 20480;
 static constexpr int MAX_FILES = 50;
 static constexpr int INPUT_QUEUE_SIZE = 50;
 static constexpr int MAX_LINES = 1024;
 
-// --- Font IDs (from crosspoint-reader fontIds.h) ---
-#define FONT_BODY    (-1014561631)   // NOTOSANS_14_FONT_ID
-#define FONT_UI      (-1559651934)   // NOTOSANS_12_FONT_ID
-#define FONT_SMALL   (-1246724383)   // UI_10_FONT_ID (ubuntu 10)
+// --- Font IDs ---
+// Dense indices into the renderer's flat font table (registered in rendererSetup)
+static constexpr int FONT_BODY  = 0;   // Noto Sans 14
+static constexpr int FONT_UI    = 1;   // Noto Sans 12
+static constexpr int FONT_SMALL = 2;   // Ubuntu 10
+static constexpr int FONT_COUNT = 3;
 
 // --- HID Keycodes ---
 static constexpr uint8_t HID_KEY_A          = 0x04;
 static constexpr uint8_t HID_KEY_B          = 0x05;
 static constexpr uint8_t HID_KEY_D          = 0x07;
+static constexpr uint8_t HID_KEY_F          = 0x09;
+static constexpr uint8_t HID_KEY_G          = 0x0A;
+static constexpr uint8_t HID_KEY_H          = 0x0B;
 static constexpr uint8_t HID_KEY_N          = 0x11;
 static constexpr uint8_t HID_KEY_P          = 0x13;
 static constexpr uint8_t HID_KEY_Q          = 0x14;
@@ -0,0 +1,137 @@
+#include "energy_meter.h"
+#include "config.h"
+
+#include <Arduino.h>
+#include <HalDisplay.h>
+#include <SDCardManager.h>
+#include <esp_timer.h>
+
+extern HalDisplay display;
+
+// Spans are [since, now) in esp_timer µs; since < 0 = not in that state
+static uint64_t idleUs = 0;
+static int64_t idleSinceUs = -1;
+static uint64_t wifiUs = 0;
+static int64_t wifiSinceUs = -1;
+
+// BLE: connection events counted per span of constant interval. The central wakes for
+// every event whatever the slave latency, so events = span / interval.
+static uint64_t bleLinkUs = 0;
+static uint32_t bleEvents = 0;
+static uint16_t bleInterval = 0;
+static int64_t bleSinceUs = 0;
+
+static volatile uint32_t keystrokes = 0;
+
+static const char* RAIL_NAMES[] = {"Sleep floor", "CPU", "Display refresh", "Display SPI", "SD card", "BLE link",
+                                   "WiFi"};
+
+void energyLoopIdle(bool idle) {
+  int64_t now = esp_timer_get_time();
+  if (idle) {
+    idleSinceUs = now;
+  } else if (idleSinceUs >= 0) {
+    idleUs += now - idleSinceUs;
+    idleSinceUs = -1;
+  }
+}
+
+void energyWifi(bool on) {
+  int64_t now = esp_timer_get_time();
+  if (on && wifiSinceUs < 0) {
+    wifiSinceUs = now;
+  } else if (!on && wifiSinceUs >= 0) {
+    wifiUs += now - wifiSinceUs;
+    wifiSinceUs = -1;
+  }
+}
+
+// Caller holds interrupts off
+static void closeBleSpan(int64_t now) {
+  if (bleInterval == 0) return;
+  uint64_t span = now - bleSinceUs;
+  bleLinkUs += span;
+  bleEvents += static_cast<uint32_t>(span / (bleInterval * 1250ULL));
+}
+
+// From bleLoop() and the disconnect callback (NimBLE host task)
+void energyBleInterval(uint16_t interval) {
+  noInterrupts();
+  if (interval != bleInterval) {
+    int64_t now = esp_timer_get_time();
+    closeBleSpan(now);
+    bleInterval = interval;
+    bleSinceUs = now;
+  }
+  interrupts();
+}
+
+void energyKeystroke() {
+  keystrokes = keystrokes + 1;
+}
+
+static float toMah(uint64_t us, uint32_t microAmps) {
+  return static_cast<float>(static_cast<double>(us) * microAmps / 3.6e12);
+}
+
+void energyReport(EnergyReport& out) {
+  int64_t now = esp_timer_get_time();
+  uint64_t rail[static_cast<int>(EnergyRail::COUNT)] = {};
+
+  uint64_t idle = idleUs + (idleSinceUs >= 0 ? now - idleSinceUs : 0);
+  uint64_t busy = display.getBusyMicros();
+  // The refresh BUSY wait is delay(1) polling: the CPU sleeps through most of it
+  uint64_t awake = static_cast<uint64_t>(now) > idle + busy ? now - idle - busy : 0;
+
+  noInterrupts();
+  uint64_t linkUs = bleLinkUs;
+  uint32_t events = bleEvents;
+  if (bleInterval != 0) {
+    uint64_t span = now - bleSinceUs;
+    linkUs += span;
+    events += static_cast<uint32_t>(span / (bleInterval * 1250ULL));
+  }
+  interrupts();
+
+  rail[static_cast<int>(EnergyRail::FLOOR)] = now;
+  rail[static_cast<int>(EnergyRail::CPU)] = awake;
+  rail[static_cast<int>(EnergyRail::DISPLAY_BUSY)] = busy;
+  rail[static_cast<int>(EnergyRail::DISPLAY_SPI)] = display.getSpiMicros();
+  rail[static_cast<int>(EnergyRail::SD)] = SDCardManager::ioStats().busyMicros;
+  rail[static_cast<int>(EnergyRail::BLE)] = linkUs;
+  rail[static_cast<int>(EnergyRail::WIFI)] = wifiUs + (wifiSinceUs >= 0 ? now - wifiSinceUs : 0);
+
+  static constexpr uint32_t RAIL_UA[] = {ENERGY_FLOOR_UA, ENERGY_CPU_UA, ENERGY_DISPLAY_BUSY_UA,
+                                         ENERGY_DISPLAY_SPI_UA, ENERGY_SD_UA, 0, ENERGY_WIFI_UA};
+
+  out.elapsedMs = static_cast<uint32_t>(now / 1000);
+  out.keystrokes = keystrokes;
+  out.bleEvents = events;
+  out.totalMah = 0;
+  for (int i = 0; i < static_cast<int>(EnergyRail::COUNT); i++) {
+    out.railMs[i] = static_cast<uint32_t>(rail[i] / 1000);
+    out.railMah[i] = toMah(rail[i], RAIL_UA[i]);
+  }
+  out.railMah[static_cast<int>(EnergyRail::BLE)] = events * static_cast<float>(ENERGY_BLE_EVENT_UC) / 3.6e6f;
+  for (float mah : out.railMah) out.totalMah += mah;
+
+  out.mahPerHour = now > 0 ? out.totalMah * 3.6e9f / static_cast<float>(now) : 0;
+  out.mahPerKiloKeys = out.keystrokes ? out.totalMah * 1000.0f / out.keystrokes : 0;
+}
+
+const char* energyRailName(EnergyRail rail) {
+  return RAIL_NAMES[static_cast<int>(rail)];
+}
+
+void energyLog() {
+#ifndef RELEASE_BUILD
+  EnergyReport r;
+  energyReport(r);
+  DBG_PRINTF("[ENERGY] %lu s: %.3f mAh, %.2f mAh/h, %.3f mAh per 1000 keys (%lu keys)\n",
+             (unsigned long)(r.elapsedMs / 1000), r.totalMah, r.mahPerHour, r.mahPerKiloKeys,
+             (unsigned long)r.keystrokes);
+  for (int i = 0; i < static_cast<int>(EnergyRail::COUNT); i++) {
+    DBG_PRINTF("[ENERGY]   %-15s %8lu ms  %.4f mAh\n", RAIL_NAMES[i], (unsigned long)r.railMs[i], r.railMah[i]);
+  }
+#endif
+}
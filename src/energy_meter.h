@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+// --- Energy accounting ---
+// Where the battery goes while writing: time in each power-relevant state multiplied by
+// the per-state current estimates in config.h. Display and SD time are running totals
+// kept by their drivers, BLE is connection events at the interval in effect, CPU is the
+// time loop() is not blocked waiting. Recording is a timestamp and an add, so it stays
+// on in release builds; the report is only computed when asked for.
+
+enum class EnergyRail : uint8_t {
+  FLOOR,         // Light-sleep floor, drawn the whole time
+  CPU,
+  DISPLAY_BUSY,  // Panel refresh (BUSY wait)
+  DISPLAY_SPI,   // Frame transfer
+  SD,
+  BLE,
+  WIFI,
+  COUNT
+};
+
+// loop() is about to block / has woken (from loopWait)
+void energyLoopIdle(bool idle);
+void energyWifi(bool on);
+// Connection interval in effect (1.25 ms units), 0 when the link is down
+void energyBleInterval(uint16_t interval);
+void energyKeystroke();
+
+struct EnergyReport {
+  uint32_t elapsedMs;
+  uint32_t keystrokes;
+  uint32_t bleEvents;
+  uint32_t railMs[static_cast<int>(EnergyRail::COUNT)];  // Time in each state (BLE: connected)
+  float railMah[static_cast<int>(EnergyRail::COUNT)];
+  float totalMah;
+  float mahPerHour;
+  float mahPerKiloKeys;  // 0 until there are keystrokes
+};
+
+// Totals since boot
+void energyReport(EnergyReport& out);
+const char* energyRailName(EnergyRail rail);
+// Print the report to serial (debug builds)
+void energyLog();
@@ -1,5 +1,9 @@
 #include "file_manager.h"
 #include "text_editor.h"
+#include "note_index.h"
+#include "note_history.h"
+#include "note_manifest.h"
+#include "boot_profile.h"
 #include <Arduino.h>
 #include <SDCardManager.h>
 #include <cstring>
@@ -7,13 +11,14 @@
 // --- File list ---
 static FileInfo fileList[MAX_FILES];
 static int fileCount = 0;
+static bool fileListLoaded = false;
 
 // Shared state
 extern UIState currentState;
 
 // Convert filename to a readable display title.
 // "my_note_2.txt" -> "My Note 2"
-static void filenameToTitle(const char* filename, char* out, int maxLen) {
+void filenameToTitle(const char* filename, char* out, int maxLen) {
   int j = 0;
   bool capitalizeNext = true;
   for (int i = 0; filename[i] != '\0' && filename[i] != '.' && j < maxLen - 1; i++) {
@@ -52,6 +57,7 @@ static void titleToFilename(const char* title, char* out, int maxLen) {
 
 // Derive a unique /notes/ filename from a title, handling collisions with _2, _3 suffix.
 void deriveUniqueFilename(const char* title, char* out, int maxLen) {
+  SdLock card;
   titleToFilename(title, out, maxLen);
 
   char path[320];
@@ -70,10 +76,13 @@ void deriveUniqueFilename(const char* title, char* out, int maxLen) {
   }
 }
 
-void fileManagerSetup() {
+bool fileManagerMount() {
+  SdLock card;
+  static bool mounted = false;
+  if (mounted) return true;
   if (!SdMan.begin()) {
     DBG_PRINTLN("SD Card mount failed!");
-    return;
+    return false;
   }
 
   if (!SdMan.exists("/notes")) {
@@ -81,15 +90,21 @@ void fileManagerSetup() {
   }
 
   DBG_PRINTLN("SD Card initialized");
-  refreshFileList();
+  mounted = true;
+  return true;
 }
 
 void refreshFileList() {
+  SdLock card;
   fileCount = 0;
+  bool firstLoad = !fileListLoaded;
+  fileListLoaded = true;
+  if (firstLoad) bootPhaseStart(BootPhase::FILE_LIST);
 
   auto root = SdMan.open("/notes");
   if (!root || !root.isDirectory()) {
     if (root) root.close();
+    if (firstLoad) bootPhaseEnd(BootPhase::FILE_LIST);
     return;
   }
 
@@ -108,40 +123,49 @@ void refreshFileList() {
     if (nameLen > 4 && strcmp(name + nameLen - 4, ".txt") == 0) {
       strncpy(fileList[fileCount].filename, name, MAX_FILENAME_LEN - 1);
       fileList[fileCount].filename[MAX_FILENAME_LEN - 1] = '\0';
-
-      filenameToTitle(name, fileList[fileCount].title, MAX_TITLE_LEN);
-      fileList[fileCount].modTime = 0;
       fileCount++;
     }
     file.close();
   }
   root.close();
   SdMan.sleep();
+  if (firstLoad) bootPhaseEnd(BootPhase::FILE_LIST);
 
   DBG_PRINTF("File listing: %d files found\n", fileCount);
 }
 
-int getFileCount() { return fileCount; }
-FileInfo* getFileList() { return fileList; }
+int getFileCount() {
+  if (!fileListLoaded) refreshFileList();
+  return fileCount;
+}
 
-void loadFile(const char* filename) {
+FileInfo* getFileList() {
+  if (!fileListLoaded) refreshFileList();
+  return fileList;
+}
+
+int openNoteBuffer(const char* filename) {
+  SdLock card;
   char path[320];
   snprintf(path, sizeof(path), "/notes/%s", filename);
 
-  auto file = SdMan.open(path, O_RDONLY);
-  if (!file) {
+  [[maybe_unused]] unsigned long startMs = millis();
+  [[maybe_unused]] SdIoStats io0 = SDCardManager::ioStats();
+
+  SdBlockReader reader;
+  if (!reader.open(path)) {
     DBG_PRINTF("Could not open: %s\n", path);
-    return;
+    return -1;
   }
 
+  // Whole sectors land directly in the editor buffer; only the tail goes through the pool
   char* buf = editorGetBuffer();
-  int readResult = file.read(buf, TEXT_BUFFER_SIZE - 1);
+  int readResult = reader.read(buf, TEXT_BUFFER_SIZE - 1);
   size_t bytesRead = (readResult > 0) ? (size_t)readResult : 0;
   buf[bytesRead] = '\0';
-  file.close();
+  reader.close();
 
   editorSetCurrentFile(filename);
-  editorLoadBuffer(bytesRead);
 
   // Title comes from the filename, not the file content
   char title[MAX_TITLE_LEN];
@@ -149,40 +173,53 @@ void loadFile(const char* filename) {
   editorSetCurrentTitle(title);
   editorSetUnsavedChanges(false);
 
-  currentState = UIState::TEXT_EDITOR;
   SdMan.sleep();
-  DBG_PRINTF("Loaded: %s (%d bytes)\n", filename, (int)bytesRead);
+  DBG_PRINTF("Loaded: %s (%d bytes, %lu reads, %lums)\n", filename, (int)bytesRead,
+             (unsigned long)(SDCardManager::ioStats().readTransfers - io0.readTransfers), millis() - startMs);
+  return (int)bytesRead;
 }
 
-void saveCurrentFile(bool refreshList) {
-  const char* filename = editorGetCurrentFile();
-  if (filename[0] == '\0') return;
+void loadFile(const char* filename) {
+  int length = openNoteBuffer(filename);
+  if (length < 0) return;
+  editorLoadBuffer(length);
+  currentState = UIState::TEXT_EDITOR;
+}
 
+bool writeNote(const char* filename, const char* text, size_t length, bool checkpoint) {
+  SdLock card;
   char path[320], tmpPath[336], bakPath[336];
   snprintf(path, sizeof(path), "/notes/%s", filename);
   snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
   snprintf(bakPath, sizeof(bakPath), "%s.bak", path);
 
+  [[maybe_unused]] unsigned long startMs = millis();
+  [[maybe_unused]] unsigned long startUs = micros();
+  [[maybe_unused]] SdIoStats io0 = SDCardManager::ioStats();
+
   // Step 1: Write new content to .tmp
-  auto file = SdMan.open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC);
-  if (!file) {
-    DBG_PRINTF("saveCurrentFile: could not create tmp: %s\n", tmpPath);
-    return;
+  SdBlockWriter writer;
+  if (!writer.open(tmpPath)) {
+    DBG_PRINTF("writeNote: could not create tmp: %s\n", tmpPath);
+    return false;
   }
+  // Save request → card ready and .tmp open: dominated by SD wake (resume vs. full remount)
+  [[maybe_unused]] unsigned long readyUs = micros() - startUs;
+  [[maybe_unused]] SdIoStats ioReady = SDCardManager::ioStats();
 
-  size_t toWrite = editorGetLength();
-  size_t written = file.write((const uint8_t*)editorGetBuffer(), toWrite);
-  file.close();
+  writer.write(text, length);
+  size_t written = writer.close() ? writer.written() : 0;
 
   // Step 2: Verify bytes written match expected length
-  if (written != toWrite) {
-    DBG_PRINTF("saveCurrentFile: write mismatch (%d/%d) — aborting\n", (int)written, (int)toWrite);
+  if (written != length) {
+    DBG_PRINTF("writeNote: write mismatch (%d/%d) — aborting\n", (int)written, (int)length);
     SdMan.remove(tmpPath);
-    return;
+    return false;
   }
 
   // Step 3: Rotate original → .bak (original is now safe in .tmp, preserve previous .bak)
-  if (SdMan.exists(path)) {
+  bool hadOriginal = SdMan.exists(path);
+  if (hadOriginal) {
     SdMan.remove(bakPath);          // Remove old .bak (if any)
     SdMan.rename(path, bakPath);    // Original becomes new .bak
   }
@@ -190,10 +227,43 @@ void saveCurrentFile(bool refreshList) {
   // Step 4: Promote .tmp → original
   SdMan.rename(tmpPath, path);
 
+  // Step 5: Refresh this note's search postings (no-op if its terms are unchanged)
+  noteIndexUpdate(filename, text, length);
+
+  // Step 6: Record a version (delta against the .bak when it is the newest version)
+  noteHistoryRecord(filename, hadOriginal ? bakPath : nullptr, text, length, checkpoint);
+
+  // Step 7: Content hash for WiFi sync (lets the PC skip unchanged notes)
+  noteManifestUpdate(filename, text, length);
+
+  DBG_PRINTF("Saved: %s (%d bytes, %lu writes, first write after %lu us, %lums)\n", filename, (int)length,
+             (unsigned long)(SDCardManager::ioStats().writeTransfers - io0.writeTransfers), readyUs,
+             millis() - startMs);
+
+#ifndef RELEASE_BUILD
+  // Before/after: every save used to wake the card with a full begin(). Time one now, in
+  // place of this save's wake, for the figure the old path would have logged.
+  unsigned long wakeUs = static_cast<unsigned long>((ioReady.mountMicros - io0.mountMicros) +
+                                                    (ioReady.resumeMicros - io0.resumeMicros));
+  SdIoStats ioRemount = SDCardManager::ioStats();
+  if (SdMan.begin()) {
+    unsigned long remountUs = static_cast<unsigned long>(SDCardManager::ioStats().mountMicros - ioRemount.mountMicros);
+    DBG_PRINTF("Save to first write: %lu us via %s, %lu us with a full remount\n", readyUs,
+               ioReady.resumes != io0.resumes ? "resume" : "remount", readyUs - wakeUs + remountUs);
+  }
+#endif
+  return true;
+}
+
+void saveCurrentFile(bool refreshList, bool checkpoint) {
+  const char* filename = editorGetCurrentFile();
+  if (filename[0] == '\0') return;
+
+  if (!writeNote(filename, editorGetBuffer(), editorGetLength(), checkpoint)) return;
+
   editorSetUnsavedChanges(false);
   if (refreshList) refreshFileList();
   SdMan.sleep();
-  DBG_PRINTF("Saved: %s\n", filename);
 }
 
 void createNewFile() {
@@ -205,6 +275,7 @@ void createNewFile() {
 
 // Rename a file on disk to match a new title, updating editor state if needed.
 void updateFileTitle(const char* filename, const char* newTitle) {
+  SdLock card;
   char newFilename[MAX_FILENAME_LEN];
   deriveUniqueFilename(newTitle, newFilename, MAX_FILENAME_LEN);
 
@@ -213,6 +284,9 @@ void updateFileTitle(const char* filename, const char* newTitle) {
     snprintf(oldPath, sizeof(oldPath), "/notes/%s", filename);
     snprintf(newPath, sizeof(newPath), "/notes/%s", newFilename);
     SdMan.rename(oldPath, newPath);
+    noteIndexRename(filename, newFilename);
+    noteHistoryRename(filename, newFilename);
+    noteManifestRename(filename, newFilename);
 
     if (strcmp(editorGetCurrentFile(), filename) == 0) {
       editorSetCurrentFile(newFilename);
@@ -224,11 +298,15 @@ void updateFileTitle(const char* filename, const char* newTitle) {
 }
 
 void deleteFile(const char* filename) {
+  SdLock card;
   char path[320], bakPath[336];
   snprintf(path, sizeof(path), "/notes/%s", filename);
   snprintf(bakPath, sizeof(bakPath), "%s.bak", path);
   SdMan.remove(path);
   SdMan.remove(bakPath);
+  noteIndexRemove(filename);
+  noteHistoryRemove(filename);
+  noteManifestRemove(filename);
   refreshFileList();
   SdMan.sleep();
   DBG_PRINTF("Deleted: %s\n", filename);
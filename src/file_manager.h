@@ -2,14 +2,25 @@
 
 #include "config.h"
 
-void fileManagerSetup();
+// Mount the card and make sure /notes exists. Safe to call again. The file list is read
+// lazily on first use (getFileCount / getFileList), not at boot.
+bool fileManagerMount();
 void refreshFileList();
 int getFileCount();
 FileInfo* getFileList();
 
 void loadFile(const char* filename);
-void saveCurrentFile(bool refreshList = true);
+// Read a note into the editor buffer and make it the current file (title, no unsaved
+// changes), leaving line layout and cursor to the caller. Bytes read, -1 if it can't be opened.
+int openNoteBuffer(const char* filename);
+// checkpoint = explicit save (always recorded in history); auto-saves pass false
+void saveCurrentFile(bool refreshList = true, bool checkpoint = true);
+// Crash-safe write of a whole note (.tmp → verify → original to .bak → promote), then
+// refresh its search postings, history and sync manifest. False if nothing was replaced.
+bool writeNote(const char* filename, const char* text, size_t length, bool checkpoint);
 void createNewFile();
+// "my_note_2.txt" -> "My Note 2"; the browser derives titles this way on demand
+void filenameToTitle(const char* filename, char* out, int maxLen);
 void deriveUniqueFilename(const char* title, char* out, int maxLen);
 void updateFileTitle(const char* filename, const char* newTitle);
 void deleteFile(const char* filename);
@@ -0,0 +1,243 @@
+#include "gzip_stream.h"
+
+#include <cstdlib>
+#include <cstring>
+
+// ---------------------------------------------------------------------------
+// One fixed-Huffman deflate block (BTYPE 01) for the whole stream, so there are no
+// code tables to build or send. Matches are found greedily through hash chains over
+// the last WINDOW bytes. Input sits in a 2 × WINDOW buffer that slides down by
+// WINDOW when full; chain links are kept in a WINDOW-sized ring indexed by
+// position & (WINDOW - 1), which the slide leaves in place.
+// ---------------------------------------------------------------------------
+
+static constexpr int WINDOW = 4096;  // Max match distance, power of two
+static constexpr int BUF_SIZE = 2 * WINDOW;
+static constexpr int HASH_BITS = 12;
+static constexpr int HASH_SIZE = 1 << HASH_BITS;
+static constexpr int MIN_MATCH = 3;
+static constexpr int MAX_MATCH = 258;
+static constexpr int MAX_CHAIN = 16;  // Candidates tried per position
+static constexpr uint16_t NIL = 0xFFFF;
+
+struct GzipStream::Work {
+  uint8_t buf[BUF_SIZE];
+  uint16_t head[HASH_SIZE];  // Newest position per hash
+  uint16_t prev[WINDOW];     // Previous position with the same hash
+  uint8_t out[GZIP_OUT_CHUNK];
+  int fill;
+  int pos;                   // Next byte to encode
+  size_t outLen;
+};
+
+static const uint16_t LEN_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                      35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LEN_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                      3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DIST_BASE[24] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                       257, 385, 513, 769, 1025, 1537, 2049, 3073};
+static const uint8_t DIST_EXTRA[24] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                       7, 7, 8, 8, 9, 9, 10, 10};
+static_assert(WINDOW <= 4096, "distance tables stop at code 23");
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t* p, size_t n) {
+  static const uint32_t T[16] = {0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+                                 0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+                                 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+  crc = ~crc;
+  while (n--) {
+    crc ^= *p++;
+    crc = (crc >> 4) ^ T[crc & 15];
+    crc = (crc >> 4) ^ T[crc & 15];
+  }
+  return ~crc;
+}
+
+static inline uint32_t hash3(const uint8_t* p) {
+  uint32_t v = (uint32_t(p[0]) << 16) | (uint32_t(p[1]) << 8) | p[2];
+  return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+bool GzipStream::begin(Sink sinkFn, void* sinkCtx) {
+  end();
+  work = static_cast<Work*>(malloc(sizeof(Work)));
+  if (!work) return false;
+  work->fill = 0;
+  work->pos = 0;
+  work->outLen = 0;
+  memset(work->head, 0xFF, sizeof(work->head));
+  memset(work->prev, 0xFF, sizeof(work->prev));
+
+  sink = sinkFn;
+  ctx = sinkCtx;
+  bitBuf = 0;
+  bitCount = 0;
+  crc = 0;
+  inBytes = 0;
+  outBytes = 0;
+  ok = true;
+
+  // gzip header: deflate, no flags, no mtime, unknown OS
+  static const uint8_t header[10] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF};
+  for (uint8_t b : header) putByte(b);
+  putBits(1, 1);  // BFINAL
+  putBits(1, 2);  // BTYPE = fixed Huffman
+  return ok;
+}
+
+bool GzipStream::write(const void* data, size_t len) {
+  if (!work || !ok) return false;
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  crc = crc32Update(crc, p, len);
+  inBytes += len;
+
+  while (len > 0 && ok) {
+    if (work->fill == BUF_SIZE) slide();
+    size_t n = BUF_SIZE - work->fill;
+    if (n > len) n = len;
+    memcpy(work->buf + work->fill, p, n);
+    work->fill += n;
+    p += n;
+    len -= n;
+    compress(false);
+  }
+  return ok;
+}
+
+bool GzipStream::finish() {
+  if (!work || !ok) {
+    end();
+    return false;
+  }
+  compress(true);
+  putLiteral(256);  // End of block
+  if (bitCount > 0) putBits(0, 8 - bitCount);
+
+  uint32_t trailer[2] = {crc, inBytes};
+  for (uint32_t v : trailer) {
+    for (int i = 0; i < 4; i++) putByte(static_cast<uint8_t>(v >> (8 * i)));
+  }
+  bool done = flushOut();
+  end();
+  return done;
+}
+
+void GzipStream::end() {
+  free(work);
+  work = nullptr;
+}
+
+// Encode everything up to MAX_MATCH bytes short of the buffered input (so every match
+// can reach full length), or all of it when flushing.
+void GzipStream::compress(bool flush) {
+  Work& w = *work;
+  int stop = flush ? w.fill : w.fill - MAX_MATCH;
+  while (w.pos < stop && ok) {
+    int distance = 0;
+    int length = 0;
+    if (w.fill - w.pos >= MIN_MATCH) {
+      length = longestMatch(w.pos, distance);
+      uint32_t h = hash3(w.buf + w.pos);
+      w.prev[w.pos & (WINDOW - 1)] = w.head[h];
+      w.head[h] = w.pos;
+    }
+
+    if (length >= MIN_MATCH) {
+      putMatch(length, distance);
+      for (int i = 1; i < length; i++) {
+        int p = w.pos + i;
+        if (w.fill - p < MIN_MATCH) break;
+        uint32_t h = hash3(w.buf + p);
+        w.prev[p & (WINDOW - 1)] = w.head[h];
+        w.head[h] = p;
+      }
+      w.pos += length;
+    } else {
+      putLiteral(w.buf[w.pos]);
+      w.pos++;
+    }
+  }
+}
+
+void GzipStream::slide() {
+  Work& w = *work;
+  memmove(w.buf, w.buf + WINDOW, w.fill - WINDOW);
+  w.fill -= WINDOW;
+  w.pos -= WINDOW;
+  for (uint16_t& v : w.head) v = (v == NIL || v < WINDOW) ? NIL : v - WINDOW;
+  for (uint16_t& v : w.prev) v = (v == NIL || v < WINDOW) ? NIL : v - WINDOW;
+}
+
+int GzipStream::longestMatch(int pos, int& distance) {
+  Work& w = *work;
+  const uint8_t* cur = w.buf + pos;
+  int maxLen = w.fill - pos < MAX_MATCH ? w.fill - pos : MAX_MATCH;
+  int limit = pos - WINDOW;  // Older chain slots have been reused
+  int best = MIN_MATCH - 1;
+
+  uint16_t cand = w.head[hash3(cur)];
+  for (int tries = MAX_CHAIN; cand != NIL && cand > limit && tries > 0; tries--) {
+    const uint8_t* prior = w.buf + cand;
+    if (prior[best] == cur[best] && prior[0] == cur[0]) {
+      int n = 0;
+      while (n < maxLen && prior[n] == cur[n]) n++;
+      if (n > best) {
+        best = n;
+        distance = pos - cand;
+        if (n >= maxLen) break;
+      }
+    }
+    uint16_t next = w.prev[cand & (WINDOW - 1)];
+    if (next == NIL || next >= cand) break;
+    cand = next;
+  }
+  return best >= MIN_MATCH ? best : 0;
+}
+
+void GzipStream::putBits(uint32_t value, int count) {
+  bitBuf |= value << bitCount;
+  bitCount += count;
+  while (bitCount >= 8) {
+    putByte(static_cast<uint8_t>(bitBuf));
+    bitBuf >>= 8;
+    bitCount -= 8;
+  }
+}
+
+// Huffman codes go out most-significant bit first
+void GzipStream::putCode(uint32_t code, int length) {
+  uint32_t reversed = 0;
+  for (int i = 0; i < length; i++) reversed = (reversed << 1) | ((code >> i) & 1);
+  putBits(reversed, length);
+}
+
+void GzipStream::putLiteral(int value) {
+  if (value < 144) putCode(0x30 + value, 8);
+  else if (value < 256) putCode(0x190 + value - 144, 9);
+  else if (value < 280) putCode(value - 256, 7);
+  else putCode(0xC0 + value - 280, 8);
+}
+
+void GzipStream::putMatch(int length, int distance) {
+  int lc = 28;
+  while (LEN_BASE[lc] > length) lc--;
+  putLiteral(257 + lc);
+  if (LEN_EXTRA[lc]) putBits(length - LEN_BASE[lc], LEN_EXTRA[lc]);
+
+  int dc = 23;
+  while (DIST_BASE[dc] > distance) dc--;
+  putCode(dc, 5);
+  if (DIST_EXTRA[dc]) putBits(distance - DIST_BASE[dc], DIST_EXTRA[dc]);
+}
+
+void GzipStream::putByte(uint8_t b) {
+  work->out[work->outLen++] = b;
+  outBytes++;
+  if (work->outLen == GZIP_OUT_CHUNK) flushOut();
+}
+
+bool GzipStream::flushOut() {
+  if (work->outLen > 0 && ok) ok = sink(work->out, work->outLen, ctx);
+  work->outLen = 0;
+  return ok;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// --- Streaming gzip encoder ---
+// RFC 1951/1952 output from LZ77 over a small window with the fixed Huffman code: roughly
+// 2× on prose with ~26 KB of working memory, allocated only between begin() and end().
+// Compressed bytes are handed to `sink` in chunks of up to GZIP_OUT_CHUNK.
+
+static constexpr size_t GZIP_OUT_CHUNK = 1460;  // One TCP segment
+
+class GzipStream {
+ public:
+  // Return false to abort the stream (e.g. client went away)
+  using Sink = bool (*)(const uint8_t* data, size_t len, void* ctx);
+
+  GzipStream() = default;
+  ~GzipStream() { end(); }
+  GzipStream(const GzipStream&) = delete;
+  GzipStream& operator=(const GzipStream&) = delete;
+
+  // Allocate working memory and emit the gzip header. False if out of memory.
+  bool begin(Sink sink, void* ctx);
+  bool write(const void* data, size_t len);
+  // Compress what's left, emit the trailer and flush. The stream is done after this.
+  bool finish();
+  // Release working memory (safe to call at any point)
+  void end();
+
+  uint32_t bytesIn() const { return inBytes; }
+  uint32_t bytesOut() const { return outBytes; }
+
+ private:
+  struct Work;
+  void compress(bool flush);
+  void slide();
+  int longestMatch(int pos, int& distance);
+  void putBits(uint32_t value, int count);
+  void putCode(uint32_t code, int length);
+  void putLiteral(int value);
+  void putMatch(int length, int distance);
+  void putByte(uint8_t b);
+  bool flushOut();
+
+  Work* work = nullptr;
+  Sink sink = nullptr;
+  void* ctx = nullptr;
+  uint32_t bitBuf = 0;
+  int bitCount = 0;
+  uint32_t crc = 0;
+  uint32_t inBytes = 0;
+  uint32_t outBytes = 0;
+  bool ok = false;
+};
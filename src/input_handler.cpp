@@ -1,6 +1,8 @@
 #include "input_handler.h"
 #include "text_editor.h"
 #include "file_manager.h"
+#include "note_index.h"
+#include "note_history.h"
 #include "ble_keyboard.h"
 #include "wifi_sync.h"
 
@@ -35,8 +37,10 @@ static bool capsLockOn = false;
 // Where to return after title edit is confirmed or cancelled
 static UIState renameReturnState = UIState::FILE_BROWSER;
 
-// Forward declaration
+// Forward declarations
 static void openTitleEdit(const char* currentTitle, UIState returnTo);
+static void openFindBar(bool replace);
+static void findNextFrom(int from);
 
 // --- Shared UI state (defined in main.cpp) ---
 extern UIState currentState;
@@ -49,6 +53,24 @@ extern int charsPerLine;
 extern bool screenDirty;
 extern char renameBuffer[];
 extern int renameBufferLen;
+extern char searchQuery[];
+extern int searchQueryLen;
+extern SearchHit searchHits[];
+extern int searchHitCount;
+extern int searchSelection;
+extern char findBuffer[];
+extern int findBufferLen;
+extern char replaceBuffer[];
+extern int replaceBufferLen;
+extern bool findEditingReplace;
+extern char findStatus[];
+extern char historyFile[];
+extern HistoryVersion historyVersions[];
+extern int historyCount;
+extern int historySelection;
+
+// True when the query was edited after the last search (Enter re-runs instead of opening)
+static bool searchQueryDirty = true;
 
 void inputSetup() {
   queueHead = 0;
@@ -65,7 +87,7 @@ void enqueueKeyEvent(uint8_t keyCode, uint8_t modifiers, bool pressed) {
   noInterrupts();
   if (!queueFull) {
     inputQueue[queueHead].keyCode = keyCode;
-    inputQueue[queueHead].modifiers = modifiers;
+    inputQueue[queueHead].modifiers = (modifiers | modifiers >> 4) & 0x0F;
     inputQueue[queueHead].pressed = pressed;
     queueHead = (queueHead + 1) % INPUT_QUEUE_SIZE;
     if (queueHead == queueTail) queueFull = true;
@@ -153,6 +175,20 @@ static void handleEditorKey(uint8_t keyCode, uint8_t modifiers) {
       screenDirty = true;
       return;
     }
+    if (keyCode == HID_KEY_F) {
+      openFindBar(false);
+      return;
+    }
+    if (keyCode == HID_KEY_H) {
+      openFindBar(true);
+      return;
+    }
+    if (keyCode == HID_KEY_G) {
+      // Find again without reopening the bar
+      findNextFrom(editorGetCursorPosition() + 1);
+      screenDirty = true;
+      return;
+    }
     // Ctrl+Left/Right: jump pages in pagination mode
     if (writingMode == WritingMode::PAGINATION) {
       int pageSize = editorGetStoredVisibleLines();
@@ -274,6 +310,201 @@ static void handleRenameKey(uint8_t keyCode, uint8_t modifiers) {
   }
 }
 
+// Open the in-note find bar; `replace` puts focus on the replacement field.
+// The previous find/replace text is kept so Ctrl+F, Enter repeats the last search.
+static void openFindBar(bool replace) {
+  findEditingReplace = replace;
+  findStatus[0] = '\0';
+  currentState = UIState::EDITOR_FIND;
+  screenDirty = true;
+}
+
+// Move the cursor to the next match at/after `from` (wraps to the top)
+static void findNextFrom(int from) {
+  if (findBufferLen == 0) return;
+  int pos = editorFind(findBuffer, from, false);
+  if (pos >= 0) {
+    editorSetCursorPosition(pos);
+    findStatus[0] = '\0';
+  } else {
+    strncpy(findStatus, "Not found", 23);
+  }
+}
+
+// Handle find bar input: Tab switches field, Enter finds (or replaces) the next
+// match, Ctrl+R replaces all, Esc returns to the editor with the cursor on the match
+static void handleFindKey(uint8_t keyCode, uint8_t modifiers) {
+  if (keyCode == HID_KEY_ESCAPE) {
+    currentState = UIState::TEXT_EDITOR;
+    screenDirty = true;
+    return;
+  }
+
+  if (isCtrl(modifiers)) {
+    if (keyCode == HID_KEY_R && findBufferLen > 0) {
+      int n = editorReplaceAll(findBuffer, replaceBuffer, false);
+      if (n < 0) strncpy(findStatus, "Too long", 23);
+      else snprintf(findStatus, 24, "%d replaced", n);
+      screenDirty = true;
+    } else if (keyCode == HID_KEY_G) {
+      findNextFrom(editorGetCursorPosition() + 1);
+      screenDirty = true;
+    }
+    return;
+  }
+
+  if (keyCode == HID_KEY_TAB) {
+    findEditingReplace = !findEditingReplace;
+    screenDirty = true;
+    return;
+  }
+
+  if (keyCode == HID_KEY_ENTER) {
+    int cursor = editorGetCursorPosition();
+    if (findEditingReplace && editorReplaceAt(cursor, findBuffer, replaceBuffer, false)) {
+      // Cursor now sits after the replacement — the next match may start right there
+      findNextFrom(editorGetCursorPosition());
+    } else {
+      findNextFrom(cursor + 1);
+    }
+    screenDirty = true;
+    return;
+  }
+
+  char* field = findEditingReplace ? replaceBuffer : findBuffer;
+  int& fieldLen = findEditingReplace ? replaceBufferLen : findBufferLen;
+
+  if (keyCode == HID_KEY_BACKSPACE) {
+    if (fieldLen > 0) {
+      fieldLen--;
+      field[fieldLen] = '\0';
+      findStatus[0] = '\0';
+      screenDirty = true;
+    }
+    return;
+  }
+
+  char c = hidToAscii(keyCode, modifiers);
+  if (c != 0 && c >= ' ' && fieldLen < MAX_FIND_LEN - 1) {
+    field[fieldLen++] = c;
+    field[fieldLen] = '\0';
+    findStatus[0] = '\0';
+    screenDirty = true;
+  }
+}
+
+// Open the note search screen with an empty query
+static void openSearch() {
+  searchQuery[0] = '\0';
+  searchQueryLen = 0;
+  searchHitCount = -1;
+  searchSelection = 0;
+  searchQueryDirty = true;
+  currentState = UIState::NOTE_SEARCH;
+  screenDirty = true;
+}
+
+// Handle note search input: type a query, Enter searches, Enter again opens the hit
+static void handleSearchKey(uint8_t keyCode, uint8_t modifiers) {
+  if (keyCode == HID_KEY_ESCAPE) {
+    currentState = UIState::FILE_BROWSER;
+    screenDirty = true;
+    return;
+  }
+
+  if (keyCode == HID_KEY_DOWN && searchHitCount > 0) {
+    searchSelection = (searchSelection + 1) % searchHitCount;
+    screenDirty = true;
+    return;
+  }
+  if (keyCode == HID_KEY_UP && searchHitCount > 0) {
+    searchSelection = (searchSelection - 1 + searchHitCount) % searchHitCount;
+    screenDirty = true;
+    return;
+  }
+
+  if (keyCode == HID_KEY_ENTER) {
+    if (!searchQueryDirty && searchHitCount > 0) {
+      const SearchHit& hit = searchHits[searchSelection];
+      loadFile(hit.filename);
+      if (currentState == UIState::TEXT_EDITOR) editorSetCursorPosition((int)hit.offset);
+    } else if (searchQueryLen > 0) {
+      // Notes saved before the index existed are only picked up by a full rebuild
+      if (!noteIndexIsComplete()) noteIndexRebuild();
+      searchHitCount = noteIndexSearch(searchQuery, searchHits, MAX_SEARCH_HITS);
+      searchSelection = 0;
+      searchQueryDirty = false;
+    }
+    screenDirty = true;
+    return;
+  }
+
+  if (keyCode == HID_KEY_BACKSPACE) {
+    if (searchQueryLen > 0) {
+      searchQueryLen--;
+      searchQuery[searchQueryLen] = '\0';
+      searchQueryDirty = true;
+      screenDirty = true;
+    }
+    return;
+  }
+
+  char c = hidToAscii(keyCode, modifiers);
+  if (c != 0 && c >= ' ' && searchQueryLen < MAX_QUERY_LEN - 1) {
+    searchQuery[searchQueryLen++] = c;
+    searchQuery[searchQueryLen] = '\0';
+    searchQueryDirty = true;
+    screenDirty = true;
+  }
+}
+
+// Open the version list of a note
+static void openHistory(const char* filename) {
+  strncpy(historyFile, filename, MAX_FILENAME_LEN - 1);
+  historyFile[MAX_FILENAME_LEN - 1] = '\0';
+  historyCount = noteHistoryList(filename, historyVersions, MAX_HISTORY_VERSIONS);
+  historySelection = 0;
+  currentState = UIState::NOTE_HISTORY;
+  screenDirty = true;
+}
+
+// Handle version list input: Enter opens the note with the selected version's text as
+// unsaved changes — nothing is overwritten until the next save (which records it as a new version)
+static void handleHistoryKey(uint8_t keyCode) {
+  if (keyCode == HID_KEY_ESCAPE) {
+    currentState = UIState::FILE_BROWSER;
+    screenDirty = true;
+    return;
+  }
+
+  if (keyCode == HID_KEY_DOWN && historyCount > 0) {
+    historySelection = (historySelection + 1) % historyCount;
+    screenDirty = true;
+  } else if (keyCode == HID_KEY_UP && historyCount > 0) {
+    historySelection = (historySelection - 1 + historyCount) % historyCount;
+    screenDirty = true;
+  } else if (keyCode == HID_KEY_ENTER && historyCount > 0) {
+    loadFile(historyFile);
+    if (currentState == UIState::TEXT_EDITOR) {
+      int len = noteHistoryRestore(historyFile, historyVersions[historySelection],
+                                   editorGetBuffer(), TEXT_BUFFER_SIZE);
+      if (len >= 0) {
+        editorLoadBuffer(len);
+        editorSetUnsavedChanges(true);
+      } else {
+        loadFile(historyFile);  // Failed rebuild left the buffer half-written
+      }
+    }
+    screenDirty = true;
+  }
+}
+
+// Settings → Keyboard: switch to the next / previous saved keyboard without going through a scan
+static void switchKeyboard(int step) {
+  if (getKeyboardProfileCount() < 2) return;
+  stepKeyboardProfile(step);
+}
+
 static void dispatchEvent(const KeyEvent& event) {
   if (!event.pressed) return;
 
@@ -334,13 +565,22 @@ static void dispatchEvent(const KeyEvent& event) {
       } else if (isCtrl(event.modifiers) && event.keyCode == HID_KEY_N) {
         if (fc > 0) {
           FileInfo* files = getFileList();
-          openTitleEdit(files[selectedFileIndex].title, UIState::FILE_BROWSER);
+          char title[MAX_TITLE_LEN];
+          filenameToTitle(files[selectedFileIndex].filename, title, MAX_TITLE_LEN);
+          openTitleEdit(title, UIState::FILE_BROWSER);
         }
       } else if (isCtrl(event.modifiers) && event.keyCode == HID_KEY_D) {
         if (fc > 0) {
           deleteConfirmPending = true;
           screenDirty = true;
         }
+      } else if (isCtrl(event.modifiers) && event.keyCode == HID_KEY_F) {
+        openSearch();
+      } else if (isCtrl(event.modifiers) && event.keyCode == HID_KEY_H) {
+        if (fc > 0) {
+          FileInfo* files = getFileList();
+          openHistory(files[selectedFileIndex].filename);
+        }
       } else if (event.keyCode == HID_KEY_ESCAPE) {
         currentState = UIState::MAIN_MENU;
         screenDirty = true;
@@ -356,8 +596,20 @@ static void dispatchEvent(const KeyEvent& event) {
       handleRenameKey(event.keyCode, event.modifiers);
       break;
 
+    case UIState::EDITOR_FIND:
+      handleFindKey(event.keyCode, event.modifiers);
+      break;
+
+    case UIState::NOTE_SEARCH:
+      handleSearchKey(event.keyCode, event.modifiers);
+      break;
+
+    case UIState::NOTE_HISTORY:
+      handleHistoryKey(event.keyCode);
+      break;
+
     case UIState::SETTINGS: {
-      const int SETTINGS_COUNT = 5;  // Orientation, Dark Mode, Writing Mode, Bluetooth, Clear Paired
+      const int SETTINGS_COUNT = 10;  // Orientation, Dark Mode, Writing Mode, Bluetooth, Keyboard, Clear Paired, Rebuild Index, BLE Diagnostics, Boot Profile, Energy
 
       // Up/Down: navigate settings list (physical buttons also map here)
       if (event.keyCode == HID_KEY_DOWN) {
@@ -380,7 +632,17 @@ static void dispatchEvent(const KeyEvent& event) {
         } else if (settingsSelection == 3) {
           currentState = UIState::BLUETOOTH_SETTINGS;
         } else if (settingsSelection == 4) {
+          switchKeyboard(1);
+        } else if (settingsSelection == 5) {
           clearAllBluetoothBonds();
+        } else if (settingsSelection == 6) {
+          noteIndexRebuild();
+        } else if (settingsSelection == 7) {
+          currentState = UIState::BLE_DIAGNOSTICS;
+        } else if (settingsSelection == 8) {
+          currentState = UIState::BOOT_PROFILE;
+        } else if (settingsSelection == 9) {
+          currentState = UIState::ENERGY_REPORT;
         }
         screenDirty = true;
 
@@ -394,6 +656,8 @@ static void dispatchEvent(const KeyEvent& event) {
         } else if (settingsSelection == 2) {
           int v = static_cast<int>(writingMode);
           writingMode = static_cast<WritingMode>((v - 1 + 3) % 3);
+        } else if (settingsSelection == 4) {
+          switchKeyboard(-1);
         }
         screenDirty = true;
 
@@ -404,6 +668,15 @@ static void dispatchEvent(const KeyEvent& event) {
       break;
     }
 
+    case UIState::BLE_DIAGNOSTICS:
+    case UIState::BOOT_PROFILE:
+    case UIState::ENERGY_REPORT:
+      if (event.keyCode == HID_KEY_ESCAPE) {
+        currentState = UIState::SETTINGS;
+        screenDirty = true;
+      }
+      break;
+
     case UIState::BLUETOOTH_SETTINGS: {
       int deviceCount = getDiscoveredDeviceCount();
 
@@ -0,0 +1,85 @@
+#include "loop_events.h"
+#include "config.h"
+#include "energy_meter.h"
+
+#include <Arduino.h>
+#include <HalGPIO.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+extern HalGPIO gpio;
+
+// The buttons sit on ADC ladders, so they can't raise an interrupt: a periodic timer reads
+// the raw state and wakes loop() only when it changes. 50 ms still catches a quick tap
+// (~80-150 ms) at least once; once woken, loop() polls every few ms itself while a button
+// is down, for debounce, long-press and key repeat. The timer callback is two ADC reads
+// and a GPIO read — far cheaper than a full loop() pass, which is what it replaces.
+static constexpr uint32_t BUTTON_SAMPLE_MS = 50;
+static constexpr int QUEUE_LENGTH = 16;
+
+static QueueHandle_t loopQueue = nullptr;
+static esp_timer_handle_t sampleTimer = nullptr;
+
+// Wakeups by cause, logged once a minute
+static uint32_t wakeCounts[static_cast<int>(LoopEvent::COUNT)];
+static uint32_t deadlineWakes = 0;
+static volatile uint32_t sampleCount = 0;
+static unsigned long statsStartMs = 0;
+
+static void sampleButtons(void*) {
+  static uint8_t lastRaw = 0;
+  sampleCount++;
+  uint8_t raw = gpio.sampleButtons();
+  if (raw != lastRaw) {
+    lastRaw = raw;
+    loopPost(LoopEvent::BUTTON);
+  }
+}
+
+void loopEventsBegin() {
+  loopQueue = xQueueCreate(QUEUE_LENGTH, sizeof(LoopEvent));
+
+  esp_timer_create_args_t args = {};
+  args.callback = sampleButtons;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "btn_sample";
+  args.skip_unhandled_events = true;  // A late sample replaces missed ones, no catch-up burst
+  esp_timer_create(&args, &sampleTimer);
+  esp_timer_start_periodic(sampleTimer, BUTTON_SAMPLE_MS * 1000ULL);
+  statsStartMs = millis();
+}
+
+void loopPost(LoopEvent event) {
+  if (loopQueue) xQueueSend(loopQueue, &event, 0);
+}
+
+uint8_t loopWait(uint32_t timeoutMs) {
+  TickType_t ticks = timeoutMs == LOOP_NO_DEADLINE ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+  uint8_t events = 0;
+  LoopEvent event;
+  energyLoopIdle(true);
+  BaseType_t received = xQueueReceive(loopQueue, &event, ticks);
+  energyLoopIdle(false);
+  if (received == pdTRUE) {
+    wakeCounts[static_cast<int>(event)]++;
+    do {
+      events |= loopEventBit(event);
+    } while (xQueueReceive(loopQueue, &event, 0) == pdTRUE);
+  } else {
+    deadlineWakes++;
+  }
+
+  unsigned long now = millis();
+  if (now - statsStartMs >= 60000) {
+    DBG_PRINTF("[LOOP] Wakeups/min: key %lu, button %lu, ble %lu, screen %lu, deadline %lu (sampler %lu)\n",
+               (unsigned long)wakeCounts[0], (unsigned long)wakeCounts[1], (unsigned long)wakeCounts[2],
+               (unsigned long)wakeCounts[3], (unsigned long)deadlineWakes, (unsigned long)sampleCount);
+    memset(wakeCounts, 0, sizeof(wakeCounts));
+    deadlineWakes = 0;
+    sampleCount = 0;
+    statsStartMs = now;
+    energyLog();
+  }
+  return events;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+// --- Main loop wake events ---
+// loop() blocks on one FreeRTOS queue between iterations instead of polling on a fixed
+// delay. Anything that gives it work posts here: BLE input and connection changes, the
+// button sampler, background tasks that dirty the screen. Timed work (auto-save, idle
+// timeout, periodic redraws, BLE reconnect backoff) is the deadline passed to loopWait().
+
+enum class LoopEvent : uint8_t {
+  KEY,     // Key event queued for processAllInput()
+  BUTTON,  // Button sampler saw the raw button state change
+  BLE,     // Connection state changed (connect task finished, link dropped)
+  SCREEN,  // Another task set screenDirty
+  COUNT
+};
+
+static constexpr uint32_t LOOP_NO_DEADLINE = UINT32_MAX;
+
+// Create the queue and start the button sampler (after gpio.begin())
+void loopEventsBegin();
+// Wake the main task. Safe from any task and never blocks: if the queue is full a wake
+// is already pending.
+void loopPost(LoopEvent event);
+// Block until an event arrives or `timeoutMs` passes, then drain the queue.
+// Returns the events received as a loopEventBit() mask, 0 if the deadline passed.
+uint8_t loopWait(uint32_t timeoutMs);
+
+constexpr uint8_t loopEventBit(LoopEvent event) { return 1 << static_cast<int>(event); }
@@ -4,14 +4,21 @@
 #include <GfxRenderer.h>
 #include <esp_pm.h>
 #include <Preferences.h>
+#include <freertos/event_groups.h>
 
 #include "config.h"
 #include "ble_keyboard.h"
 #include "input_handler.h"
 #include "text_editor.h"
 #include "file_manager.h"
+#include "note_index.h"
+#include "note_history.h"
 #include "ui_renderer.h"
 #include "wifi_sync.h"
+#include "session_resume.h"
+#include "boot_profile.h"
+#include "loop_events.h"
+#include "alloc_counter.h"
 
 // Enum for sleep reasons
 enum class SleepReason {
@@ -50,6 +57,27 @@ bool screenDirty = true;
 char renameBuffer[MAX_FILENAME_LEN] = "";
 int renameBufferLen = 0;
 
+// Note search state (query + last result set)
+char searchQuery[MAX_QUERY_LEN] = "";
+int searchQueryLen = 0;
+SearchHit searchHits[MAX_SEARCH_HITS];
+int searchHitCount = -1;  // -1 = no search run yet
+int searchSelection = 0;
+
+// In-note find/replace bar state
+char findBuffer[MAX_FIND_LEN] = "";
+int findBufferLen = 0;
+char replaceBuffer[MAX_FIND_LEN] = "";
+int replaceBufferLen = 0;
+bool findEditingReplace = false;  // Which field of the find bar has focus
+char findStatus[24] = "";         // Result of the last action ("Not found", "3 replaced")
+
+// Version history browser state
+char historyFile[MAX_FILENAME_LEN] = "";
+HistoryVersion historyVersions[MAX_HISTORY_VERSIONS];
+int historyCount = 0;
+int historySelection = 0;
+
 // UI mode flags
 bool darkMode = false;
 bool cleanMode = false;
@@ -87,28 +115,120 @@ static void updateScreen() {
   switch (currentState) {
     case UIState::MAIN_MENU:         drawMainMenu(renderer, gpio); break;
     case UIState::FILE_BROWSER:      drawFileBrowser(renderer, gpio); break;
-    case UIState::TEXT_EDITOR:       drawTextEditor(renderer, gpio); break;
+    case UIState::TEXT_EDITOR:
+    case UIState::EDITOR_FIND:       drawTextEditor(renderer, gpio); break;
     case UIState::RENAME_FILE:       drawRenameScreen(renderer, gpio); break;
     case UIState::SETTINGS:          drawSettingsMenu(renderer, gpio); break;
     case UIState::BLUETOOTH_SETTINGS: drawBluetoothSettings(renderer, gpio); break;
+    case UIState::BLE_DIAGNOSTICS:    drawBleDiagnostics(renderer, gpio); break;
+    case UIState::BOOT_PROFILE:       drawBootProfile(renderer, gpio); break;
+    case UIState::ENERGY_REPORT:      drawEnergyReport(renderer, gpio); break;
     case UIState::WIFI_SYNC:          drawSyncScreen(renderer, gpio); break;
+    case UIState::NOTE_SEARCH:        drawSearchScreen(renderer, gpio); break;
+    case UIState::NOTE_HISTORY:       drawHistoryScreen(renderer, gpio); break;
     default: break;
   }
 }
 
+// --- Boot ---
+// Phases run as a small dependency graph rather than strictly in order:
+//   hardware -> display -> settings -> resume check -> first frame (full refresh)
+//   hardware -> BLE init task            (no SPI; NimBLE host start is mostly CPU)
+//   display  -> SD mount task            (shares the SPI bus; the display driver and SdFat
+//                                          both take the bus per transaction, and the long
+//                                          part of the refresh is the BUSY wait)
+// setup() waits for both tasks after the first frame, which outlasts them. The note list
+// is no longer read at boot — file_manager loads it the first time it's needed.
+#ifndef BOOT_SEQUENTIAL
+static EventGroupHandle_t bootEvents = nullptr;
+static constexpr EventBits_t BOOT_SD_READY = 1 << 0;
+static constexpr EventBits_t BOOT_BLE_READY = 1 << 1;
+
+static void bootSdTask(void* param) {
+  bootPhaseStart(BootPhase::SD_MOUNT);
+  fileManagerMount();
+  bootPhaseEnd(BootPhase::SD_MOUNT);
+  xEventGroupSetBits(bootEvents, BOOT_SD_READY);
+  vTaskDelete(NULL);
+}
+
+static void bootBleTask(void* param) {
+  bootPhaseStart(BootPhase::BLE_INIT);
+  bleSetup();
+  bootPhaseEnd(BootPhase::BLE_INIT);
+  xEventGroupSetBits(bootEvents, BOOT_BLE_READY);
+  vTaskDelete(NULL);
+}
+#else
+// Reference build (env xteink_x4_boot_sequential): the boot order before the task graph —
+// resume check, SD mount and note list scan, BLE init, a blank power-on refresh, then the
+// menu — recorded under the same phases. First frame ends with the main menu on screen in
+// both builds, so their Boot Profile screens give before / after numbers on the same card.
+static void bootSequential() {
+  bool resumed = false;
+  if (sessionResumePending()) {
+    bootPhaseStart(BootPhase::RESUME);
+    resumed = sessionResume();
+    bootPhaseEnd(BootPhase::RESUME);
+  }
+  if (resumed) {
+    bootPhaseStart(BootPhase::FIRST_FRAME);
+    requestFullRefresh();
+    screenDirty = true;
+    updateScreen();
+    bootPhaseEnd(BootPhase::FIRST_FRAME);
+  }
+
+  bootPhaseStart(BootPhase::SD_MOUNT);
+  fileManagerMount();
+  bootPhaseEnd(BootPhase::SD_MOUNT);
+  refreshFileList();  // Records the file list phase
+
+  bootPhaseStart(BootPhase::BLE_INIT);
+  bleSetup();
+  bootPhaseEnd(BootPhase::BLE_INIT);
+  if (resumed) return;
+
+  bootPhaseStart(BootPhase::FIRST_FRAME);
+  renderer.clearScreen();
+  renderer.displayBuffer(HalDisplay::FULL_REFRESH);
+  screenDirty = true;
+  updateScreen();
+  bootPhaseEnd(BootPhase::FIRST_FRAME);
+}
+#endif
+
 void setup() {
   DBG_INIT();
   DBG_PRINTLN("MicroSlate starting...");
 
+  bootPhaseStart(BootPhase::HARDWARE);
   setCpuFrequencyMhz(80);
-
   gpio.begin();
-  display.begin();
+  loopEventsBegin();
+  allocCounterBegin();
+  bootPhaseEnd(BootPhase::HARDWARE);
 
+#ifndef BOOT_SEQUENTIAL
+  bootEvents = xEventGroupCreate();
+  xTaskCreate(bootBleTask, "boot_ble", 8192, NULL, 1, NULL);
+#endif
+
+  bootPhaseStart(BootPhase::DISPLAY);
+  display.begin();
   renderer.setFadingFix(true);  // Power down display analog circuits after each refresh — reduces idle drain
   rendererSetup(renderer);
+  bootPhaseEnd(BootPhase::DISPLAY);
+
+#ifndef BOOT_SEQUENTIAL
+  // Instant resume reads the note itself (mounting the card first); otherwise mount now
+  // alongside the first frame
+  bool resumeCandidate = sessionResumePending();
+  if (!resumeCandidate) xTaskCreate(bootSdTask, "boot_sd", 4096, NULL, 1, NULL);
+#endif
 
   // Load persisted UI settings from NVS early so startup screen uses saved orientation
+  bootPhaseStart(BootPhase::SETTINGS);
   uiPrefs.begin("ui_prefs", false);
   currentOrientation = static_cast<Orientation>(uiPrefs.getUChar("orient", 0));
   darkMode = uiPrefs.getBool("darkMode", false);
@@ -128,8 +248,32 @@ void setup() {
 
   editorInit();
   inputSetup();
-  fileManagerSetup();
-  bleSetup();
+  bootPhaseEnd(BootPhase::SETTINGS);
+
+#ifdef BOOT_SEQUENTIAL
+  bootSequential();
+#else
+  // Instant resume: after deep sleep with a note open, the first frame is the editor
+  if (resumeCandidate) {
+    bootPhaseStart(BootPhase::RESUME);
+    [[maybe_unused]] bool resumed = sessionResume();
+    bootPhaseEnd(BootPhase::RESUME);
+    xEventGroupSetBits(bootEvents, BOOT_SD_READY);  // Mounted by the resume check
+    DBG_PRINTF("[BOOT] %s\n", resumed ? "Resuming editor session" : "Resume record stale — main menu");
+  }
+
+  // The display needs one FULL_REFRESH after power-on to initialize its analog
+  // circuits before FAST_REFRESH will work — make it the first real frame.
+  bootPhaseStart(BootPhase::FIRST_FRAME);
+  requestFullRefresh();
+  screenDirty = true;
+  updateScreen();
+  bootPhaseEnd(BootPhase::FIRST_FRAME);
+
+  xEventGroupWaitBits(bootEvents, BOOT_SD_READY | BOOT_BLE_READY, pdFALSE, pdTRUE, portMAX_DELAY);
+  vEventGroupDelete(bootEvents);
+  bootEvents = nullptr;
+#endif
 
   // Enable automatic light sleep between loop iterations.
   // CONFIG_PM_ENABLE and CONFIG_FREERTOS_USE_TICKLESS_IDLE are compiled into
@@ -146,27 +290,24 @@ void setup() {
   // Initialize auto-reconnect to enabled by default
   autoReconnectEnabled = true;
 
-  DBG_PRINTLN("MicroSlate ready.");
-
-  // The display needs one FULL_REFRESH after power-on to initialize its analog
-  // circuits before FAST_REFRESH will work.
-  renderer.clearScreen();
-  renderer.displayBuffer(HalDisplay::FULL_REFRESH);
-
-  screenDirty = true;
+  DBG_PRINTF("MicroSlate ready. (%lums)\n", millis());
 }
 
 // Enter deep sleep - matches crosspoint pattern
 void enterDeepSleep(SleepReason reason) {
   DBG_PRINTLN("Entering deep sleep...");
-  
+
+  // Stop the sync server task and the radio before anything else touches the card
+  if (isWifiSyncActive()) wifiSyncStop();
+
   // Render the sleep screen before entering deep sleep
   renderSleepScreen();
 
-  // Save any unsaved work
-  if (currentState == UIState::TEXT_EDITOR && editorHasUnsavedChanges()) {
+  // Save any unsaved work, then remember where we were for instant resume
+  if ((currentState == UIState::TEXT_EDITOR || currentState == UIState::EDITOR_FIND) && editorHasUnsavedChanges()) {
     saveCurrentFile();
   }
+  sessionSaveForSleep();
 
   display.deepSleep();     // Power down display first
   gpio.startDeepSleep();   // Waits for power button release, then sleeps
@@ -222,7 +363,7 @@ static void processPhysicalButtons() {
     if (!sleepTriggered && duration > 50 && duration < 1000) {
       // Short press - go to main menu (except when already there)
       if (currentState != UIState::MAIN_MENU) {
-        if (currentState == UIState::TEXT_EDITOR && editorHasUnsavedChanges()) {
+        if ((currentState == UIState::TEXT_EDITOR || currentState == UIState::EDITOR_FIND) && editorHasUnsavedChanges()) {
           saveCurrentFile();
         }
         currentState = UIState::MAIN_MENU;
@@ -246,7 +387,7 @@ static void processPhysicalButtons() {
     if (millis() - backPressStart > 5000) {
       restartTriggered = true;
       DBG_PRINTLN("BACK held for 5s — restarting device...");
-      if (currentState == UIState::TEXT_EDITOR && editorHasUnsavedChanges()) {
+      if ((currentState == UIState::TEXT_EDITOR || currentState == UIState::EDITOR_FIND) && editorHasUnsavedChanges()) {
         saveCurrentFile();
       }
       delay(100);
@@ -342,6 +483,7 @@ static void processPhysicalButtons() {
 
     case UIState::RENAME_FILE:
     case UIState::NEW_FILE:
+    case UIState::EDITOR_FIND:
       if (btnConfirm && !btnConfirmLast) {
         enqueueKeyEvent(HID_KEY_ENTER, 0, true);
         enqueueKeyEvent(HID_KEY_ENTER, 0, false);
@@ -352,7 +494,12 @@ static void processPhysicalButtons() {
       }
       break;
 
+    case UIState::NOTE_SEARCH:
+    case UIState::NOTE_HISTORY:
     case UIState::BLUETOOTH_SETTINGS:
+    case UIState::BLE_DIAGNOSTICS:
+    case UIState::BOOT_PROFILE:
+    case UIState::ENERGY_REPORT:
       if ((btnUp && !btnUpLast) || (btnRight && !btnRightLast)) {
         enqueueKeyEvent(HID_KEY_UP, 0, true);
         enqueueKeyEvent(HID_KEY_UP, 0, false);
@@ -458,11 +605,24 @@ void renderSleepScreen() {
   int footerY = sh * 0.75; // 75% down the screen (moved up from bottom)
   renderer.drawText(FONT_SMALL, footerX, footerY, footer);
   
-  // Perform a full display refresh to ensure the sleep screen is visible
+  // Full refresh: this image stays up for hours, so no ghosting. displayBuffer() returns
+  // once the panel reports not-busy, so there's nothing more to wait for.
+  // Not cached (screen_cache.h): deep sleep clears RAM, so this runs once per boot anyway.
   renderer.displayBuffer(HalDisplay::FULL_REFRESH);
-  
-  // Small delay to ensure the display update is complete
-  delay(500);
+}
+
+// loop() polls on its own while a button is down or the sampler just saw a change
+// (debounce, long-press timers, key repeat) and while WiFi sync serves clients; otherwise
+// it sleeps until the next event or deadline (see loop_events.h).
+static constexpr uint32_t BUTTON_POLL_MS = 10;
+static constexpr uint32_t BUTTON_SETTLE_MS = 50;  // Keep polling this long after a release
+static constexpr uint32_t WIFI_POLL_MS = 10;
+
+// Milliseconds from `now` until `due` (0 if already past), folded into `wait`
+static void untilDeadline(uint32_t& wait, unsigned long now, unsigned long due) {
+  long left = static_cast<long>(due - now);
+  uint32_t ms = left > 0 ? static_cast<uint32_t>(left) : 0;
+  if (ms < wait) wait = ms;
 }
 
 void loop() {
@@ -492,10 +652,21 @@ void loop() {
   // Process WiFi sync HTTP clients when active
   if (isWifiSyncActive()) wifiSyncLoop();
 
+  // Input through render is one frame for the allocation counter; auto-save runs after it,
+  // so a keystroke reaches the screen before any SD write
+  allocFrameBegin();
+
   // CRITICAL: Process buttons BEFORE checking wasAnyPressed() to avoid consuming button states
   processPhysicalButtons();
   int inputEventsProcessed = processAllInput(); // Assuming this returns number of events processed
 
+  // Leaving the sync screen by any route (power short press included) ends the session
+  if (currentState != UIState::WIFI_SYNC && isWifiSyncActive()) {
+    UIState target = currentState;
+    wifiSyncStop();  // Switches to the main menu — keep the screen that was picked
+    currentState = target;
+  }
+
   // Register activity AFTER button processing (don't consume button states prematurely)
   static unsigned long lastInputTime = 0;
   bool hadActivity = gpio.wasAnyPressed() || inputEventsProcessed > 0;
@@ -504,11 +675,37 @@ void loop() {
     lastInputTime = millis();
   }
 
+  // Periodically refresh sync screen to show status changes (every 2s)
+  static unsigned long lastSyncRefresh = 0;
+  if (currentState == UIState::WIFI_SYNC) {
+    if (millis() - lastSyncRefresh > 2000) {
+      screenDirty = true;
+      lastSyncRefresh = millis();
+    }
+  }
+
+  // Diagnostics screens redraw on a timer: BLE tuner stats every 5s, the energy report
+  // every 30s (each redraw is itself on its bill)
+  static unsigned long lastDiagRefresh = 0;
+  unsigned long diagPeriod = currentState == UIState::BLE_DIAGNOSTICS ? 5000
+                           : currentState == UIState::ENERGY_REPORT   ? 30000 : 0;
+  if (diagPeriod > 0 && millis() - lastDiagRefresh > diagPeriod) {
+    screenDirty = true;
+    lastDiagRefresh = millis();
+  }
+
+  // The e-ink hardware refresh (~640ms) is the natural rate limiter — no cooldown needed.
+  bool rendered = screenDirty;
+  if (screenDirty) {
+    updateScreen();
+  }
+  if (rendered || inputEventsProcessed > 0) allocFrameEnd();
+
   // Auto-save: hybrid idle + hard cap for crash protection.
   // - Saves after 10s of no keystrokes (catches natural pauses between sentences)
   // - Hard cap every 2min during continuous typing (never lose more than 2min of work)
   static unsigned long lastAutoSaveMs = 0;
-  if (currentState == UIState::TEXT_EDITOR
+  if ((currentState == UIState::TEXT_EDITOR || currentState == UIState::EDITOR_FIND)
       && editorHasUnsavedChanges()
       && editorGetCurrentFile()[0] != '\0') {
     unsigned long now = millis();
@@ -517,24 +714,10 @@ void loop() {
     bool capTrigger  = (now - lastAutoSaveMs) > AUTO_SAVE_MAX_MS;
     if (idleTrigger || capTrigger) {
       lastAutoSaveMs = now;
-      saveCurrentFile(false);  // Skip refreshFileList — file list unchanged by content update
-    }
-  }
-
-  // Periodically refresh sync screen to show status changes (every 2s)
-  if (currentState == UIState::WIFI_SYNC) {
-    static unsigned long lastSyncRefresh = 0;
-    if (millis() - lastSyncRefresh > 2000) {
-      screenDirty = true;
-      lastSyncRefresh = millis();
+      saveCurrentFile(false, false);  // Skip refreshFileList — file list unchanged by content update
     }
   }
 
-  // The e-ink hardware refresh (~640ms) is the natural rate limiter — no cooldown needed.
-  if (screenDirty) {
-    updateScreen();
-  }
-
   // Persist UI settings to NVS when they change (NVS write only on change, not every loop)
   static Orientation lastSavedOrientation = currentOrientation;
   static bool lastSavedDarkMode = darkMode;
@@ -554,12 +737,34 @@ void loop() {
     enterDeepSleep(SleepReason::IDLE_TIMEOUT);
   }
 
-  // Adaptive delay with recently-active window for button responsiveness.
-  // BLE keystrokes wake from light sleep via modem interrupt (delay value irrelevant).
-  // Physical buttons are polled, so the idle delay must be short enough to catch a
-  // quick tap (~80-150ms). 50ms idle guarantees 1-2 samples per press.
-  // Stay at fast polling for 2s after any activity for snappy consecutive presses.
-  static constexpr unsigned long ACTIVE_WINDOW_MS = 2000;
-  bool recentlyActive = (millis() - lastInputTime) < ACTIVE_WINDOW_MS;
-  delay((hadActivity || screenDirty || recentlyActive) ? 10 : 50);
+  // Sleep until the next event (BLE key or link change, button sampler, another task
+  // dirtying the screen) or the earliest deadline below. The e-ink refresh completes
+  // inside updateScreen(), so there is nothing to wait for on that side.
+  unsigned long now = millis();
+  static unsigned long buttonsChangedMs = 0;
+  if (gpio.wasAnyPressed() || gpio.wasAnyReleased()) buttonsChangedMs = now;
+  bool buttonHeld = false;
+  for (uint8_t b = HalGPIO::BTN_BACK; b <= HalGPIO::BTN_POWER; b++) buttonHeld |= gpio.isPressed(b);
+
+  uint32_t wait = bleNextDeadline(now);
+  if (screenDirty) wait = 0;
+  if (buttonHeld || now - buttonsChangedMs < BUTTON_SETTLE_MS) {
+    if (wait > BUTTON_POLL_MS) wait = BUTTON_POLL_MS;
+  }
+  if (isWifiSyncActive()) {
+    if (wait > WIFI_POLL_MS) wait = WIFI_POLL_MS;
+  } else {
+    untilDeadline(wait, now, lastActivityTime + IDLE_TIMEOUT + 1);
+  }
+  if ((currentState == UIState::TEXT_EDITOR || currentState == UIState::EDITOR_FIND)
+      && editorHasUnsavedChanges() && editorGetCurrentFile()[0] != '\0') {
+    unsigned long idleFrom = lastInputTime > lastAutoSaveMs ? lastInputTime : lastAutoSaveMs;
+    untilDeadline(wait, now, idleFrom + AUTO_SAVE_IDLE_MS + 1);
+    untilDeadline(wait, now, lastAutoSaveMs + AUTO_SAVE_MAX_MS + 1);
+  }
+  if (currentState == UIState::WIFI_SYNC) untilDeadline(wait, now, lastSyncRefresh + 2001);
+  if (diagPeriod > 0) untilDeadline(wait, now, lastDiagRefresh + diagPeriod + 1);
+
+  // At least a tick, so the idle task (light sleep, watchdog) always gets a turn
+  if (loopWait(wait > 0 ? wait : 1) & loopEventBit(LoopEvent::BUTTON)) buttonsChangedMs = millis();
 }
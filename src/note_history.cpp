@@ -0,0 +1,624 @@
+#include "note_history.h"
+
+#include <Arduino.h>
+#include <SDCardManager.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+// ---------------------------------------------------------------------------
+// Version history — one append-only file per note:
+//
+//   /notes/.hist/<note filename>.hst
+//
+// Layout (little-endian):
+//   HistoryHeader   magic 'MSHS', version, reserved
+//   HistoryRecord   type, textLen, textHash, payloadLen   + payload     × N, oldest first
+//
+// A KEYFRAME payload is the full note text. A DELTA payload rebuilds the next version
+// from the previous one with a stream of ops:
+//   varint (len << 1) | 1, varint offset   COPY len bytes from the previous version
+//   varint (len << 1),     len raw bytes   ADD literal bytes
+// Deltas come from matching 16-byte blocks of the previous version anywhere in the
+// new text (rsync-style), so scattered edits and moved paragraphs stay small.
+//
+// A keyframe is written every KEYFRAME_INTERVAL versions (or when a delta would be
+// over half the note, or there's no RAM to compute one), so rebuilding any version reads
+// at most one keyframe plus KEYFRAME_INTERVAL - 1 deltas. textHash (FNV-1a) checks every
+// rebuild and tells us whether the .bak left by the save is still the newest recorded
+// version. Records are streamed to the card with a zeroed header that is filled in last,
+// so one cut short by power loss fails the scan and is overwritten by the next append.
+// ---------------------------------------------------------------------------
+
+static constexpr const char* HISTORY_DIR = "/notes/.hist";
+
+static constexpr uint32_t HISTORY_MAGIC = 0x5348534D;  // "MSHS"
+static constexpr uint16_t HISTORY_VERSION = 1;
+
+static constexpr uint8_t REC_KEYFRAME = 1;
+static constexpr uint8_t REC_DELTA = 2;
+
+struct HistoryHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t reserved;
+};
+
+struct HistoryRecord {
+  uint8_t type;
+  uint8_t reserved[3];
+  uint32_t textLen;      // Length of the version this record produces
+  uint32_t textHash;     // FNV-1a of that version
+  uint32_t payloadLen;
+};
+
+static_assert(sizeof(HistoryHeader) == 8, "HistoryHeader layout is part of the on-SD format");
+static_assert(sizeof(HistoryRecord) == 16, "HistoryRecord layout is part of the on-SD format");
+
+static constexpr int KEYFRAME_INTERVAL = 16;
+static constexpr unsigned long HISTORY_CHECKPOINT_MS = 5UL * 60 * 1000;  // Auto-saves: one version per 5 min
+static constexpr uint32_t HISTORY_MAX_BYTES = 192 * 1024;              // Oldest keyframe group dropped past this
+
+static constexpr int MATCH_BLOCK = 16;
+static constexpr int MATCH_SLOTS = 4096;  // >= 2 × TEXT_BUFFER_SIZE / MATCH_BLOCK, power of two
+static_assert(MATCH_SLOTS * MATCH_BLOCK >= 2 * (int)TEXT_BUFFER_SIZE, "match table too small for the text buffer");
+
+static constexpr uint32_t FNV_OFFSET = 2166136261u;
+static constexpr uint32_t FNV_PRIME = 16777619u;
+
+// Newest version of the note last recorded, so back-to-back saves skip the file scan
+struct HistoryTip {
+  char filename[MAX_FILENAME_LEN];
+  bool valid;
+  uint32_t offset;       // Record offset of the newest version
+  uint32_t keyOffset;
+  uint32_t end;          // End of the last complete record (anything after is a torn write)
+  uint32_t textLen;
+  uint32_t textHash;
+  int chain;             // Deltas since keyOffset
+  unsigned long recordedMs;
+};
+
+static HistoryTip tip = {};
+
+static uint32_t hashText(const char* text, size_t len) {
+  uint32_t h = FNV_OFFSET;
+  for (size_t i = 0; i < len; i++) h = (h ^ static_cast<uint8_t>(text[i])) * FNV_PRIME;
+  return h;
+}
+
+static void historyPath(const char* filename, char* out, size_t outSize) {
+  snprintf(out, outSize, "%s/%s.hst", HISTORY_DIR, filename);
+}
+
+// ---------------------------------------------------------------------------
+// Scanning
+// ---------------------------------------------------------------------------
+
+// Walk the record headers, calling `visit(recordOffset, keyOffset, record)` for each
+// complete record. Returns the end offset of the last complete record, 0 if the file
+// isn't a history file.
+template <typename Visit>
+static uint32_t scanHistory(SdBlockReader& reader, Visit visit) {
+  HistoryHeader hdr;
+  if (reader.read(&hdr, sizeof(hdr)) != (int)sizeof(hdr)
+      || hdr.magic != HISTORY_MAGIC || hdr.version != HISTORY_VERSION) {
+    return 0;
+  }
+
+  uint32_t fileSize = reader.size();
+  uint32_t pos = sizeof(hdr);
+  uint32_t keyOffset = 0;
+  HistoryRecord rec;
+  while (pos + sizeof(rec) <= fileSize) {
+    if (!reader.seek(pos) || reader.read(&rec, sizeof(rec)) != (int)sizeof(rec)) break;
+    bool sane = (rec.type == REC_KEYFRAME || (rec.type == REC_DELTA && keyOffset != 0))
+             && rec.textLen < TEXT_BUFFER_SIZE
+             && rec.payloadLen <= fileSize - pos - sizeof(rec);
+    if (!sane) break;
+    if (rec.type == REC_KEYFRAME) keyOffset = pos;
+    visit(pos, keyOffset, rec);
+    pos += sizeof(rec) + rec.payloadLen;
+  }
+  return pos;
+}
+
+static bool loadTip(const char* filename) {
+  bool sameNote = strcmp(tip.filename, filename) == 0;
+  if (tip.valid && sameNote) return true;
+
+  // Rescans of the same note (after a prune or failed write) keep the checkpoint clock
+  unsigned long recordedMs = sameNote ? tip.recordedMs : 0;
+  tip = {};
+  strncpy(tip.filename, filename, MAX_FILENAME_LEN - 1);
+  tip.recordedMs = recordedMs;
+
+  char path[320];
+  historyPath(filename, path, sizeof(path));
+  SdBlockReader reader;
+  if (!SdMan.exists(path) || !reader.open(path, false)) return false;
+
+  tip.end = scanHistory(reader, [](uint32_t offset, uint32_t keyOffset, const HistoryRecord& rec) {
+    tip.chain = (rec.type == REC_KEYFRAME) ? 0 : tip.chain + 1;
+    tip.offset = offset;
+    tip.keyOffset = keyOffset;
+    tip.textLen = rec.textLen;
+    tip.textHash = rec.textHash;
+    tip.valid = true;
+  });
+  return tip.valid;
+}
+
+// ---------------------------------------------------------------------------
+// Delta encode / apply
+// ---------------------------------------------------------------------------
+
+static inline uint32_t blockHash(const uint8_t* p) {
+  uint32_t h = FNV_OFFSET;
+  for (int i = 0; i < MATCH_BLOCK; i++) h = (h ^ p[i]) * FNV_PRIME;
+  return h;
+}
+
+// A record being appended: payload bytes go through a small stage to the card, and the
+// header is written by endRecord() once the payload is complete
+struct RecordWriter {
+  FsFile file;
+  uint32_t offset;  // Of the record header
+  uint32_t len;     // Payload bytes so far
+  uint32_t cap;     // putBytes() fails past this
+  uint32_t staged;
+  bool failed;      // Card error (as opposed to running into cap)
+  uint8_t stage[256];
+};
+
+static bool flushStage(RecordWriter& w) {
+  if (w.staged && w.file.write(w.stage, w.staged) != w.staged) w.failed = true;
+  w.staged = 0;
+  return !w.failed;
+}
+
+static bool putBytes(RecordWriter& w, const uint8_t* bytes, uint32_t len) {
+  if (w.failed || w.len + len > w.cap) return false;
+  w.len += len;
+  if (w.staged + len > sizeof(w.stage)) {
+    if (!flushStage(w)) return false;
+    if (len >= sizeof(w.stage)) {
+      if (w.file.write(bytes, len) != len) w.failed = true;
+      return !w.failed;
+    }
+  }
+  memcpy(w.stage + w.staged, bytes, len);
+  w.staged += len;
+  return true;
+}
+
+static bool putVarint(RecordWriter& w, uint32_t v) {
+  uint8_t bytes[5];
+  uint32_t n = 0;
+  do {
+    uint8_t b = v & 0x7F;
+    v >>= 7;
+    bytes[n++] = v ? (b | 0x80) : b;
+  } while (v);
+  return putBytes(w, bytes, n);
+}
+
+static bool putAdd(RecordWriter& w, const uint8_t* bytes, uint32_t len) {
+  return len == 0 || (putVarint(w, len << 1) && putBytes(w, bytes, len));
+}
+
+static bool putCopy(RecordWriter& w, uint32_t offset, uint32_t len) {
+  return putVarint(w, (len << 1) | 1) && putVarint(w, offset);
+}
+
+// Encode `text` as ops against `base`. Returns false if the delta would exceed out.cap
+// (the caller then stores a keyframe instead). `slots` is MATCH_SLOTS scratch entries.
+static bool encodeDelta(const uint8_t* base, uint32_t baseLen, const uint8_t* text, uint32_t textLen,
+                        uint16_t* slots, RecordWriter& out) {
+  // Index the base at block-aligned offsets (slot value = block number + 1, 0 = empty)
+  memset(slots, 0, MATCH_SLOTS * sizeof(uint16_t));
+  for (uint32_t off = 0; off + MATCH_BLOCK <= baseLen; off += MATCH_BLOCK) {
+    uint32_t i = blockHash(base + off) & (MATCH_SLOTS - 1);
+    while (slots[i]) i = (i + 1) & (MATCH_SLOTS - 1);
+    slots[i] = static_cast<uint16_t>(off / MATCH_BLOCK + 1);
+  }
+
+  // Slide over the new text; at each position look for a base block starting there
+  uint32_t pending = 0;  // Start of literal bytes not yet emitted
+  uint32_t pos = 0;
+  while (pos + MATCH_BLOCK <= textLen) {
+    uint32_t matchOff = UINT32_MAX;
+    for (uint32_t i = blockHash(text + pos) & (MATCH_SLOTS - 1); slots[i]; i = (i + 1) & (MATCH_SLOTS - 1)) {
+      uint32_t off = (slots[i] - 1) * MATCH_BLOCK;
+      if (memcmp(base + off, text + pos, MATCH_BLOCK) == 0) {
+        matchOff = off;
+        break;
+      }
+    }
+    if (matchOff == UINT32_MAX) {
+      pos++;
+      continue;
+    }
+
+    // Grow the match forward, then backward into the pending literals
+    uint32_t len = MATCH_BLOCK;
+    while (matchOff + len < baseLen && pos + len < textLen && base[matchOff + len] == text[pos + len]) len++;
+    while (pos > pending && matchOff > 0 && base[matchOff - 1] == text[pos - 1]) {
+      pos--;
+      matchOff--;
+      len++;
+    }
+
+    if (!putAdd(out, text + pending, pos - pending) || !putCopy(out, matchOff, len)) return false;
+    pos += len;
+    pending = pos;
+  }
+  return putAdd(out, text + pending, textLen - pending);
+}
+
+static bool readVarint(SdBlockReader& reader, uint32_t& v, uint32_t& consumed) {
+  v = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    uint8_t b;
+    if (reader.read(&b, 1) != 1) return false;
+    consumed++;
+    v |= static_cast<uint32_t>(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+// Apply one delta record (reader positioned at its payload) from `base` into `out`
+static bool applyDelta(SdBlockReader& reader, const HistoryRecord& rec,
+                       const char* base, uint32_t baseLen, char* out) {
+  uint32_t produced = 0;
+  uint32_t consumed = 0;
+  while (consumed < rec.payloadLen) {
+    uint32_t op;
+    if (!readVarint(reader, op, consumed)) return false;
+    uint32_t len = op >> 1;
+    if (produced + len > rec.textLen) return false;
+
+    if (op & 1) {
+      uint32_t off;
+      if (!readVarint(reader, off, consumed) || off + len > baseLen) return false;
+      memcpy(out + produced, base + off, len);
+    } else {
+      if (reader.read(out + produced, len) != (int)len) return false;
+      consumed += len;
+    }
+    produced += len;
+  }
+  return produced == rec.textLen && consumed == rec.payloadLen;
+}
+
+// Rebuild the version recorded at `target` by replaying from its keyframe. `a` and `b`
+// are two TEXT_BUFFER_SIZE buffers; returns whichever holds the result (nullptr on error).
+static char* rebuildVersion(SdBlockReader& reader, uint32_t keyOffset, uint32_t target,
+                            char* a, char* b, uint32_t& outLen) {
+  char* cur = a;
+  char* next = b;
+  uint32_t curLen = 0;
+  uint32_t pos = keyOffset;
+
+  while (pos <= target) {
+    HistoryRecord rec;
+    if (!reader.seek(pos) || reader.read(&rec, sizeof(rec)) != (int)sizeof(rec)) return nullptr;
+    if (rec.textLen >= TEXT_BUFFER_SIZE) return nullptr;
+
+    if (rec.type == REC_KEYFRAME) {
+      if (pos != keyOffset || rec.payloadLen != rec.textLen) return nullptr;
+      if (reader.read(cur, rec.textLen) != (int)rec.textLen) return nullptr;
+    } else {
+      if (pos == keyOffset || !applyDelta(reader, rec, cur, curLen, next)) return nullptr;
+      std::swap(cur, next);
+    }
+    curLen = rec.textLen;
+    if (hashText(cur, curLen) != rec.textHash) return nullptr;
+    pos += sizeof(rec) + rec.payloadLen;
+  }
+  outLen = curLen;
+  return cur;
+}
+
+// ---------------------------------------------------------------------------
+// Recording
+// ---------------------------------------------------------------------------
+
+// Start a record at the end of the history file, creating it (and the directory) if
+// needed. A torn record from an interrupted append is cut off first so the chain stays
+// readable.
+static bool beginRecord(RecordWriter& w, const char* path, uint32_t cap) {
+  if (!SdMan.exists(HISTORY_DIR)) SdMan.mkdir(HISTORY_DIR);
+
+  bool fresh = !tip.valid;
+  w.file = SdMan.open(path, fresh ? (O_WRONLY | O_CREAT | O_TRUNC) : O_RDWR);
+  w.len = 0;
+  w.cap = cap;
+  w.staged = 0;
+  w.failed = !w.file;
+  if (w.failed) return false;
+
+  if (fresh) {
+    HistoryHeader hdr = {HISTORY_MAGIC, HISTORY_VERSION, 0};
+    w.offset = sizeof(hdr);
+    w.failed = w.file.write(&hdr, sizeof(hdr)) != sizeof(hdr);
+  } else {
+    w.offset = tip.end;
+    w.failed = (w.file.size() != w.offset && !w.file.truncate(w.offset)) || !w.file.seekSet(w.offset);
+  }
+  HistoryRecord placeholder = {};
+  w.failed = w.failed || w.file.write(&placeholder, sizeof(placeholder)) != sizeof(placeholder);
+  if (w.failed) {
+    w.file.close();
+    tip.valid = false;  // Rescan next time; the torn tail gets truncated then
+  }
+  return !w.failed;
+}
+
+// Leave a record unfinished: its zeroed header keeps it out of the history
+static void abandonRecord(RecordWriter& w) {
+  w.file.close();
+  if (w.failed) tip.valid = false;
+}
+
+// Write the payload's tail and the header, and make the record the newest version
+static bool endRecord(RecordWriter& w, uint8_t type, uint32_t textLen, uint32_t textHash) {
+  HistoryRecord rec = {};
+  rec.type = type;
+  rec.textLen = textLen;
+  rec.textHash = textHash;
+  rec.payloadLen = w.len;
+  bool ok = flushStage(w) && w.file.seekSet(w.offset) && w.file.write(&rec, sizeof(rec)) == sizeof(rec);
+  ok = w.file.close() && ok;
+  if (!ok) {
+    tip.valid = false;
+    return false;
+  }
+
+  if (type == REC_KEYFRAME) {
+    tip.keyOffset = w.offset;
+    tip.chain = 0;
+  } else {
+    tip.chain++;
+  }
+  tip.offset = w.offset;
+  tip.end = w.offset + sizeof(rec) + w.len;
+  tip.textLen = textLen;
+  tip.textHash = textHash;
+  tip.valid = true;
+  tip.recordedMs = millis();
+  return true;
+}
+
+static bool appendKeyframe(const char* path, const char* text, uint32_t len, uint32_t hash) {
+  RecordWriter w;
+  if (!beginRecord(w, path, len)) return false;
+  if (!putBytes(w, reinterpret_cast<const uint8_t*>(text), len)) {
+    abandonRecord(w);
+    return false;
+  }
+  return endRecord(w, REC_KEYFRAME, len, hash);
+}
+
+// Keyframe straight from a file (the note before its first recorded save), no scratch
+static bool appendFileKeyframe(const char* path, const char* srcPath) {
+  SdBlockReader reader;
+  if (!reader.open(srcPath)) return false;
+  uint32_t len = reader.size();
+  if (len == 0 || len >= TEXT_BUFFER_SIZE) return true;  // Nothing a version can hold
+
+  RecordWriter w;
+  if (!beginRecord(w, path, len)) return false;
+  uint32_t hash = FNV_OFFSET;
+  const uint8_t* data;
+  int n;
+  while ((n = reader.next(data)) > 0) {
+    for (int i = 0; i < n; i++) hash = (hash ^ data[i]) * FNV_PRIME;
+    if (!putBytes(w, data, n)) break;
+  }
+  if (n != 0 || w.len != len) {
+    abandonRecord(w);
+    return false;
+  }
+  return endRecord(w, REC_KEYFRAME, len, hash);
+}
+
+// Append `text` as a delta against `base`. False if it would be over half the note or
+// couldn't be written; the caller stores a keyframe instead.
+static bool appendDelta(const char* path, const char* base, uint32_t baseLen, const char* text, uint32_t len,
+                        uint32_t hash, uint16_t* slots) {
+  RecordWriter w;
+  if (!beginRecord(w, path, len / 2)) return false;
+  if (!encodeDelta(reinterpret_cast<const uint8_t*>(base), baseLen, reinterpret_cast<const uint8_t*>(text), len,
+                   slots, w)) {
+    abandonRecord(w);
+    return false;
+  }
+  return endRecord(w, REC_DELTA, len, hash);
+}
+
+// The newest recorded version, into `base`: the .bak left by this save when it is that
+// version (checked by hash), otherwise rebuilt from the history file with a second,
+// temporary text buffer
+static bool loadNewestVersion(const char* path, const char* prevPath, char* base, uint32_t& baseLen) {
+  if (prevPath) {
+    SdBlockReader reader;
+    int r = reader.open(prevPath) ? reader.read(base, TEXT_BUFFER_SIZE - 1) : -1;
+    if (r >= 0 && (uint32_t)r == tip.textLen && hashText(base, r) == tip.textHash) {
+      baseLen = r;
+      return true;
+    }
+  }
+
+  char* spare = static_cast<char*>(malloc(TEXT_BUFFER_SIZE));
+  if (!spare) return false;
+  SdBlockReader reader;
+  char* rebuilt = reader.open(path, false) ? rebuildVersion(reader, tip.keyOffset, tip.offset, base, spare, baseLen)
+                                           : nullptr;
+  if (rebuilt && rebuilt != base) memcpy(base, rebuilt, baseLen);
+  free(spare);
+  return rebuilt != nullptr;
+}
+
+// Drop the oldest keyframe group once the file outgrows HISTORY_MAX_BYTES
+static void pruneHistory(const char* path) {
+  if (tip.end <= HISTORY_MAX_BYTES) return;
+
+  SdBlockReader reader;
+  if (!reader.open(path)) return;
+  uint32_t cut = 0;
+  scanHistory(reader, [&cut](uint32_t offset, uint32_t, const HistoryRecord& rec) {
+    if (rec.type == REC_KEYFRAME && offset > sizeof(HistoryHeader) && cut == 0) cut = offset;
+  });
+  if (cut == 0 || !reader.seek(cut)) return;
+
+  char tmpPath[336];
+  snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+  SdBlockWriter writer;
+  if (!writer.open(tmpPath)) return;
+
+  HistoryHeader hdr = {HISTORY_MAGIC, HISTORY_VERSION, 0};
+  writer.write(&hdr, sizeof(hdr));
+  const uint8_t* data;
+  int n;
+  while ((n = reader.next(data)) > 0) writer.write(data, n);
+  reader.close();
+
+  if (!writer.close() || n < 0) {
+    SdMan.remove(tmpPath);
+    return;
+  }
+  SdMan.remove(path);
+  SdMan.rename(tmpPath, path);
+  tip.valid = false;
+  DBG_PRINTF("[HIST] Pruned %lu bytes of oldest versions\n", (unsigned long)(cut - sizeof(HistoryHeader)));
+}
+
+void noteHistoryRecord(const char* filename, const char* prevPath,
+                       const char* text, size_t length, bool checkpoint) {
+  SdLock card;
+  bool haveHistory = loadTip(filename);
+  uint32_t hash = hashText(text, length);
+  if (haveHistory && tip.textHash == hash && tip.textLen == length) return;  // Nothing new
+  if (!checkpoint && haveHistory && millis() - tip.recordedMs < HISTORY_CHECKPOINT_MS) return;
+
+  [[maybe_unused]] unsigned long startMs = millis();
+  char path[320];
+  historyPath(filename, path, sizeof(path));
+
+  // First recorded save: keep the note as it was before this edit session too
+  if (!haveHistory && prevPath && !appendFileKeyframe(path, prevPath)) {
+    DBG_PRINTF("[HIST] Could not keep the previous version of %s\n", filename);
+  }
+
+  // A delta needs the previous version and the block index (28 KB, plus 20 KB more while
+  // rebuilding the previous version). Short of RAM, e.g. with WiFi up, the version is
+  // stored as a keyframe instead: larger, but never dropped.
+  bool delta = false;
+  [[maybe_unused]] bool lowMemory = false;
+  if (tip.valid && tip.chain + 1 < KEYFRAME_INTERVAL) {
+    char* base = static_cast<char*>(malloc(TEXT_BUFFER_SIZE));
+    uint32_t baseLen = 0;
+    bool haveBase = base && loadNewestVersion(path, prevPath, base, baseLen);
+    uint16_t* slots = haveBase ? static_cast<uint16_t*>(malloc(MATCH_SLOTS * sizeof(uint16_t))) : nullptr;
+    lowMemory = !base || (haveBase && !slots);
+    if (slots) delta = appendDelta(path, base, baseLen, text, length, hash, slots);
+    free(slots);
+    free(base);
+  }
+  if (!delta && !appendKeyframe(path, text, length, hash)) {
+    DBG_PRINTF("[HIST] Could not record version of %s\n", filename);
+    return;
+  }
+  DBG_PRINTF("[HIST] %s: %s %lu bytes for %u-byte note%s, history %lu bytes (%lums)\n",
+             filename, delta ? "delta" : "keyframe", (unsigned long)(tip.end - tip.offset - sizeof(HistoryRecord)),
+             (unsigned)length, lowMemory ? " (low memory)" : "", (unsigned long)tip.end, millis() - startMs);
+  pruneHistory(path);
+}
+
+void noteHistoryRemove(const char* filename) {
+  SdLock card;
+  char path[320];
+  historyPath(filename, path, sizeof(path));
+  SdMan.remove(path);
+  if (strcmp(tip.filename, filename) == 0) tip.valid = false;
+}
+
+void noteHistoryRename(const char* oldFilename, const char* newFilename) {
+  SdLock card;
+  char oldPath[320], newPath[320];
+  historyPath(oldFilename, oldPath, sizeof(oldPath));
+  historyPath(newFilename, newPath, sizeof(newPath));
+  if (!SdMan.exists(oldPath)) return;
+  SdMan.remove(newPath);
+  SdMan.rename(oldPath, newPath);
+  if (strcmp(tip.filename, oldFilename) == 0) {
+    strncpy(tip.filename, newFilename, MAX_FILENAME_LEN - 1);
+    tip.filename[MAX_FILENAME_LEN - 1] = '\0';
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Browsing / restore
+// ---------------------------------------------------------------------------
+
+int noteHistoryList(const char* filename, HistoryVersion* out, int maxVersions) {
+  SdLock card;
+  char path[320];
+  historyPath(filename, path, sizeof(path));
+  SdBlockReader reader;
+  if (maxVersions <= 0 || !SdMan.exists(path) || !reader.open(path, false)) return 0;
+
+  // Keep the newest maxVersions in a ring while walking oldest → newest
+  int total = 0;
+  scanHistory(reader, [&](uint32_t offset, uint32_t keyOffset, const HistoryRecord& rec) {
+    HistoryVersion& v = out[total % maxVersions];
+    v.offset = offset;
+    v.keyOffset = keyOffset;
+    v.textLen = rec.textLen;
+    v.storedLen = rec.payloadLen;
+    v.number = static_cast<uint16_t>(total + 1);
+    v.keyframe = rec.type == REC_KEYFRAME;
+    total++;
+  });
+  reader.close();
+  SdMan.sleep();
+
+  // Unroll the ring to newest first
+  int count = total < maxVersions ? total : maxVersions;
+  if (total > maxVersions) std::rotate(out, out + total % maxVersions, out + maxVersions);
+  std::reverse(out, out + count);
+  return count;
+}
+
+int noteHistoryRestore(const char* filename, const HistoryVersion& version, char* buffer, size_t bufferSize) {
+  SdLock card;
+  if (bufferSize < TEXT_BUFFER_SIZE) return -1;
+  [[maybe_unused]] unsigned long startMs = millis();
+
+  char path[320];
+  historyPath(filename, path, sizeof(path));
+  char* spare = static_cast<char*>(malloc(TEXT_BUFFER_SIZE));
+  SdBlockReader reader;
+  if (!spare || !reader.open(path, false)) {
+    free(spare);
+    return -1;
+  }
+
+  uint32_t len = 0;
+  char* result = rebuildVersion(reader, version.keyOffset, version.offset, buffer, spare, len);
+  if (result && result != buffer) memcpy(buffer, result, len);
+  free(spare);
+  reader.close();
+  SdMan.sleep();
+
+  if (!result) {
+    DBG_PRINTF("[HIST] Rebuild of %s v%u failed\n", filename, version.number);
+    return -1;
+  }
+  buffer[len] = '\0';
+  DBG_PRINTF("[HIST] Rebuilt %s v%u (%lu bytes) in %lums\n",
+             filename, version.number, (unsigned long)len, millis() - startMs);
+  return static_cast<int>(len);
+}
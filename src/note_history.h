@@ -0,0 +1,31 @@
+#pragma once
+
+#include "config.h"
+
+// --- Per-note version history ---
+// Append-only history file per note: binary deltas against the previous version with a
+// full keyframe every few versions (see note_history.cpp for the file format).
+
+static constexpr int MAX_HISTORY_VERSIONS = 40;  // Newest versions listed in the browser
+
+struct HistoryVersion {
+  uint32_t offset;      // Record offset in the history file
+  uint32_t keyOffset;   // Keyframe this version is rebuilt from
+  uint32_t textLen;     // Size of the note at this version
+  uint32_t storedLen;   // Bytes the record takes on the card (delta or keyframe payload)
+  uint16_t number;      // 1 = oldest version still in the file
+  bool keyframe;
+};
+
+// Called from saveCurrentFile after the new content is on disk. `prevPath` is the
+// rotated .bak (the version before this save) or nullptr for a brand-new note.
+// `checkpoint` = explicit save; auto-saves are only recorded every HISTORY_CHECKPOINT_MS.
+void noteHistoryRecord(const char* filename, const char* prevPath,
+                       const char* text, size_t length, bool checkpoint);
+void noteHistoryRemove(const char* filename);
+void noteHistoryRename(const char* oldFilename, const char* newFilename);
+
+// Fill `out` with the newest versions, newest first. Returns count (0 = no history).
+int noteHistoryList(const char* filename, HistoryVersion* out, int maxVersions);
+// Rebuild `version` into `buffer`. Returns its length, -1 on error (buffer contents undefined).
+int noteHistoryRestore(const char* filename, const HistoryVersion& version, char* buffer, size_t bufferSize);
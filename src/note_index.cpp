@@ -0,0 +1,1056 @@
+#include "note_index.h"
+
+#include <Arduino.h>
+#include <SDCardManager.h>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+// ---------------------------------------------------------------------------
+// On-SD inverted index: each term maps to its postings (note id, first offset, count).
+//
+//   /notes/.idx/notes.tbl           NoteEntry per note id (filename hash, generation, flags)
+//   /notes/.idx/names.tbl           NoteName per note id
+//   /notes/.idx/sSS_L.pst           postings, sharded by the top bits of the term hash,
+//                                   one file per merge level
+//   /notes/.idx/delta.pst           postings saved since the last flush, unsorted
+//   /notes/.idx/.complete3          (marker: written after a full rebuild)
+//
+// Every file starts with an IndexHeader (magic 'MSIX', version). A level file is a list of
+// runs, each a RunHeader then postings sorted by (termHash, noteId).
+//
+// A save tokenizes the note, bumps its generation and appends its postings to the delta:
+// one append, however large the index. Postings of an older generation are stale; queries
+// skip them and merges drop them. (Diffing against the old postings would save little: an
+// edit moves the first offset of every later term.) At DELTA_MAX_POSTINGS the delta is
+// sorted, in RAM-sized chunks, into a new run per shard, and runs are merged MERGE_FAN at
+// a time up through the levels. A rebuild ends with each shard merged down to one run.
+//
+// A query looks each word up in its shard only: a binary search per run, a sequential read
+// of the term's postings, and a pass over the delta. No note is opened, except "partial"
+// ones: notes whose term table ran out of RAM while indexing get no postings and are
+// scanned at query time instead, so a word is never missed.
+//
+// Terms are ASCII words (letters/digits, case-folded, >= 2 chars), hashed with
+// 32-bit FNV-1a over their first MAX_TERM_LEN chars.
+// ---------------------------------------------------------------------------
+
+static constexpr const char* INDEX_DIR = "/notes/.idx";
+static constexpr const char* COMPLETE_MARKER = "/notes/.idx/.complete3";  // Per format version
+static constexpr const char* NOTES_PATH = "/notes/.idx/notes.tbl";
+static constexpr const char* NAMES_PATH = "/notes/.idx/names.tbl";
+static constexpr const char* DELTA_PATH = "/notes/.idx/delta.pst";
+
+static constexpr int SHARD_BITS = 4;
+static constexpr int MERGE_FAN = 4;              // Runs per level before they merge into the next
+static constexpr int MAX_LEVELS = 10;
+static constexpr uint32_t BIG_MERGE_POSTINGS = 16384;  // 256 KB; one merge this big per flushed chunk
+static constexpr int DELTA_MAX_POSTINGS = 2048;  // 32 KB; flushed into the shards past this
+static constexpr int FLUSH_CHUNK = 1024;         // Postings sorted in RAM at a time (16 KB)
+static constexpr int REBUILD_CHUNK = 4096;       // Longer runs during a rebuild, so fewer merges
+static constexpr int MIN_CHUNK = 64;
+static constexpr int CURSOR_POSTINGS = 32;       // Read buffer per run while merging (one sector)
+static constexpr int MAX_NOTES = 0xFFFF;         // Note ids are 16-bit
+
+static constexpr uint32_t INDEX_MAGIC = 0x5849534D;  // "MSIX"
+static constexpr uint16_t INDEX_VERSION = 3;
+static constexpr uint16_t NOTE_PARTIAL = 0x0001;     // Terms didn't fit in RAM: no postings, scanned instead
+
+struct IndexHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t reserved16;
+  uint32_t reserved;
+};
+
+struct NoteEntry {
+  uint32_t nameHash;    // FNV-1a of the filename, never 0 (0 = free id)
+  uint32_t generation;  // Bumped on every change; postings of another generation are stale
+  uint32_t digest;      // FNV-1a over the note's terms, so a save that changes none writes nothing
+  uint16_t flags;
+  uint16_t reserved;
+};
+
+struct NoteName {
+  char filename[MAX_FILENAME_LEN];  // NUL-terminated
+};
+
+struct RunHeader {
+  uint32_t count;
+  uint32_t reserved;
+};
+
+struct IndexPosting {
+  uint32_t termHash;     // FNV-1a of the folded term (never 0)
+  uint32_t firstOffset;  // Byte offset of the first occurrence in the note
+  uint32_t generation;   // The note's generation when written
+  uint16_t noteId;
+  uint16_t count;        // Occurrences (saturates at 0xFFFF)
+};
+
+static_assert(sizeof(IndexHeader) == 12, "IndexHeader layout is part of the on-SD format");
+static_assert(sizeof(NoteEntry) == 16, "NoteEntry layout is part of the on-SD format");
+static_assert(sizeof(NoteName) == MAX_FILENAME_LEN, "NoteName layout is part of the on-SD format");
+static_assert(sizeof(RunHeader) == 8, "RunHeader layout is part of the on-SD format");
+static_assert(sizeof(IndexPosting) == 16, "IndexPosting layout is part of the on-SD format");
+
+static constexpr uint32_t FNV_OFFSET = 2166136261u;
+static constexpr uint32_t FNV_PRIME = 16777619u;
+
+static constexpr int MIN_TERM_LEN = 2;
+static constexpr int MAX_TERM_LEN = 32;  // Longer words hash on their first 32 chars
+static constexpr int TERM_SLOTS = 1024;  // Initial open-addressed table (power of two), doubled at 3/4 full
+static constexpr int MAX_QUERY_TERMS = 8;
+
+static inline char foldTermChar(char c) {
+  if (c >= 'A' && c <= 'Z') return c + 32;
+  if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) return c;
+  return 0;
+}
+
+static inline uint32_t hashStep(uint32_t h, char c) {
+  return (h ^ static_cast<uint8_t>(c)) * FNV_PRIME;
+}
+
+// --- Tokenizer ---
+// State carries across calls so a note can be streamed from SD in chunks.
+
+struct TokenState {
+  uint32_t hash;
+  int len;
+  uint32_t start;
+};
+
+// Calls onTerm(hash, offset) for each term in `data`; `base` is the chunk's offset in the note
+template <typename F>
+static void tokenize(TokenState& s, const char* data, size_t n, uint32_t base, F&& onTerm) {
+  for (size_t i = 0; i < n; i++) {
+    char c = foldTermChar(data[i]);
+    if (c) {
+      if (s.len == 0) {
+        s.hash = FNV_OFFSET;
+        s.start = base + i;
+      }
+      if (s.len < MAX_TERM_LEN) s.hash = hashStep(s.hash, c);
+      s.len++;
+    } else if (s.len) {
+      if (s.len >= MIN_TERM_LEN) onTerm(s.hash ? s.hash : 1, s.start);
+      s.len = 0;
+    }
+  }
+}
+
+// Emit the term the text ended on
+template <typename F>
+static void tokenizeEnd(TokenState& s, F&& onTerm) {
+  if (s.len >= MIN_TERM_LEN) onTerm(s.hash ? s.hash : 1, s.start);
+  s.len = 0;
+}
+
+// --- Term table for one note ---
+// Heap-allocated only while indexing (save/rebuild), so the index costs no static RAM
+// while typing. Grows with the note; if it can't, the note is marked partial rather
+// than indexed with terms missing.
+
+struct TermSlot {
+  uint32_t termHash;  // 0 marks an empty slot
+  uint32_t firstOffset;
+  uint16_t count;
+  uint16_t reserved;
+};
+
+struct TermBuilder {
+  TermSlot* slots;
+  int capacity;
+  int used;
+  bool partial;  // Out of memory: some terms are missing
+  TokenState token;
+};
+
+static void resetTerms(TermBuilder& b) {
+  if (b.slots) memset(b.slots, 0, b.capacity * sizeof(TermSlot));
+  b.used = 0;
+  b.partial = b.slots == nullptr;
+  b.token.len = 0;
+}
+
+static void beginTerms(TermBuilder& b) {
+  b.capacity = TERM_SLOTS;
+  b.slots = static_cast<TermSlot*>(malloc(TERM_SLOTS * sizeof(TermSlot)));
+  if (!b.slots) DBG_PRINTLN("[IDX] Out of memory for term table");
+  resetTerms(b);
+}
+
+static void endTerms(TermBuilder& b) {
+  free(b.slots);
+  b.slots = nullptr;
+}
+
+static bool growTerms(TermBuilder& b) {
+  int capacity = b.capacity * 2;
+  auto* slots = static_cast<TermSlot*>(calloc(capacity, sizeof(TermSlot)));
+  if (!slots) {
+    DBG_PRINTF("[IDX] Out of memory growing term table past %d terms\n", b.used);
+    b.partial = true;
+    return false;
+  }
+  for (int i = 0; i < b.capacity; i++) {
+    if (b.slots[i].termHash == 0) continue;
+    uint32_t j = b.slots[i].termHash & (capacity - 1);
+    while (slots[j].termHash != 0) j = (j + 1) & (capacity - 1);
+    slots[j] = b.slots[i];
+  }
+  free(b.slots);
+  b.slots = slots;
+  b.capacity = capacity;
+  return true;
+}
+
+static void addTerm(TermBuilder& b, uint32_t h, uint32_t offset) {
+  if (b.partial) return;
+  if (b.used >= b.capacity * 3 / 4 && !growTerms(b)) return;
+
+  uint32_t i = h & (b.capacity - 1);
+  while (b.slots[i].termHash != 0) {
+    if (b.slots[i].termHash == h) {
+      if (b.slots[i].count < 0xFFFF) b.slots[i].count++;
+      return;
+    }
+    i = (i + 1) & (b.capacity - 1);
+  }
+  b.slots[i].termHash = h;
+  b.slots[i].firstOffset = offset;
+  b.slots[i].count = 1;
+  b.used++;
+}
+
+static void feedTerms(TermBuilder& b, const char* data, size_t n, uint32_t base) {
+  tokenize(b.token, data, n, base, [&](uint32_t h, uint32_t offset) { addTerm(b, h, offset); });
+}
+
+// Flush the last token, compact the table and sort by hash. Returns term count (0 if partial).
+static int finishTerms(TermBuilder& b) {
+  tokenizeEnd(b.token, [&](uint32_t h, uint32_t offset) { addTerm(b, h, offset); });
+  if (b.partial) return 0;
+
+  int n = 0;
+  for (int i = 0; i < b.capacity; i++) {
+    if (b.slots[i].termHash != 0) b.slots[n++] = b.slots[i];
+  }
+  std::sort(b.slots, b.slots + n, [](const TermSlot& a, const TermSlot& c) { return a.termHash < c.termHash; });
+  return n;
+}
+
+static uint32_t termsDigest(const TermSlot* terms, int count) {
+  uint32_t h = FNV_OFFSET;
+  const auto* p = reinterpret_cast<const uint8_t*>(terms);
+  for (size_t i = 0; i < count * sizeof(TermSlot); i++) h = (h ^ p[i]) * FNV_PRIME;
+  return h;
+}
+
+static int hashQueryTerms(const char* query, uint32_t* out, int maxTerms) {
+  int count = 0;
+  TokenState s = {};
+  auto add = [&](uint32_t h, uint32_t) {
+    if (count < maxTerms) out[count++] = h;
+  };
+  tokenize(s, query, strlen(query), 0, add);
+  tokenizeEnd(s, add);
+  return count;
+}
+
+static uint32_t nameHashOf(const char* filename) {
+  uint32_t h = FNV_OFFSET;
+  for (const char* p = filename; *p; p++) h = hashStep(h, *p);
+  return h ? h : 1;
+}
+
+static inline int shardOf(uint32_t termHash) {
+  return termHash >> (32 - SHARD_BITS);
+}
+
+static inline bool postingLess(const IndexPosting& a, const IndexPosting& b) {
+  if (a.termHash != b.termHash) return a.termHash < b.termHash;
+  if (a.noteId != b.noteId) return a.noteId < b.noteId;
+  return a.generation > b.generation;  // Newest first
+}
+
+static inline bool bitTest(const uint8_t* bits, int i) {
+  return bits[i >> 3] & (1 << (i & 7));
+}
+
+static inline void bitSet(uint8_t* bits, int i) {
+  bits[i >> 3] |= 1 << (i & 7);
+}
+
+// --- Index files ---
+
+static bool readHeader(SdBlockReader& in) {
+  IndexHeader hdr;
+  return in.read(&hdr, sizeof(hdr)) == (int)sizeof(hdr)
+      && hdr.magic == INDEX_MAGIC && hdr.version == INDEX_VERSION;
+}
+
+// Open an index file for update, creating it with its header if needed
+static FsFile openForUpdate(const char* path) {
+  FsFile f = SdMan.open(path, O_RDWR | O_CREAT);
+  if (!f) return f;
+  IndexHeader hdr = {INDEX_MAGIC, INDEX_VERSION, 0, 0};
+  if (f.size() == 0) {
+    if (f.write(&hdr, sizeof(hdr)) == sizeof(hdr)) return f;
+  } else if (f.read(&hdr, sizeof(hdr)) == (int)sizeof(hdr) && hdr.magic == INDEX_MAGIC
+             && hdr.version == INDEX_VERSION) {
+    return f;
+  }
+  DBG_PRINTF("[IDX] Bad index file %s\n", path);
+  f.close();
+  return FsFile();
+}
+
+static int recordCount(const char* path, size_t recordSize) {
+  FsFile f = SdMan.open(path);
+  if (!f) return 0;
+  uint64_t size = f.size();
+  f.close();
+  return size < sizeof(IndexHeader) ? 0 : static_cast<int>((size - sizeof(IndexHeader)) / recordSize);
+}
+
+static bool readRecord(FsFile& f, const char* path, int id, void* rec, size_t size) {
+  if (!f) f = SdMan.open(path);
+  return f && f.seekSet(sizeof(IndexHeader) + (uint64_t)id * size) && f.read(rec, size) == (int)size;
+}
+
+static bool writeRecord(const char* path, int id, const void* rec, size_t size) {
+  FsFile f = openForUpdate(path);
+  bool ok = f && f.seekSet(sizeof(IndexHeader) + (uint64_t)id * size) && f.write(rec, size) == size;
+  f.close();
+  return ok;
+}
+
+static bool readNoteName(FsFile& names, int id, NoteName& name) {
+  return readRecord(names, NAMES_PATH, id, &name, sizeof(name)) && name.filename[MAX_FILENAME_LEN - 1] == '\0';
+}
+
+static void writeMarker() {
+  auto marker = SdMan.open(COMPLETE_MARKER, O_WRONLY | O_CREAT | O_TRUNC);
+  if (marker) marker.close();
+}
+
+// Last note found: saves mostly repeat the note being edited, and a hit skips the table scan
+static int lastNoteId = -1;
+
+// `filename`'s note id, or -1. Filenames are only read on a hash match. `freeId` gets the
+// first free id (-1 if none) when the table is scanned.
+static int findNote(const char* filename, NoteEntry& entry, int& freeId) {
+  uint32_t h = nameHashOf(filename);
+  freeId = -1;
+  FsFile names;
+  NoteEntry e;
+  NoteName name;
+  if (lastNoteId >= 0) {
+    FsFile table;
+    if (readRecord(table, NOTES_PATH, lastNoteId, &e, sizeof(e)) && e.nameHash == h
+        && readNoteName(names, lastNoteId, name) && strcmp(name.filename, filename) == 0) {
+      entry = e;
+      return lastNoteId;
+    }
+  }
+
+  SdBlockReader in;
+  if (!in.open(NOTES_PATH) || !readHeader(in)) return -1;
+  for (int id = 0; in.read(&e, sizeof(e)) == (int)sizeof(e); id++) {
+    if (e.nameHash == 0) {
+      if (freeId < 0) freeId = id;
+      continue;
+    }
+    if (e.nameHash == h && readNoteName(names, id, name) && strcmp(name.filename, filename) == 0) {
+      entry = e;
+      lastNoteId = id;
+      return id;
+    }
+  }
+  return -1;
+}
+
+// Current generation per note id; 0 for free and partial notes, which no posting matches.
+// Optionally a bitmap of the partial notes. Null if out of memory.
+static uint32_t* loadGenerations(int& count, uint8_t** partialBits, int* partialCount) {
+  count = recordCount(NOTES_PATH, sizeof(NoteEntry));
+  auto* gens = static_cast<uint32_t*>(calloc(count ? count : 1, sizeof(uint32_t)));
+  if (!gens) return nullptr;
+  uint8_t* partial = nullptr;
+  if (partialBits) {
+    partial = static_cast<uint8_t*>(calloc((count + 7) / 8 + 1, 1));
+    if (!partial) {
+      free(gens);
+      return nullptr;
+    }
+  }
+
+  int partials = 0;
+  SdBlockReader in;
+  if (in.open(NOTES_PATH) && readHeader(in)) {
+    NoteEntry e;
+    for (int id = 0; id < count && in.read(&e, sizeof(e)) == (int)sizeof(e); id++) {
+      if (e.nameHash == 0) continue;
+      if (e.flags & NOTE_PARTIAL) {
+        if (partial) bitSet(partial, id);
+        partials++;
+      } else {
+        gens[id] = e.generation;
+      }
+    }
+  }
+  if (partialBits) *partialBits = partial;
+  if (partialCount) *partialCount = partials;
+  return gens;
+}
+
+static IndexPosting* allocChunk(int want, int& capacity) {
+  for (capacity = want; capacity >= MIN_CHUNK; capacity /= 2) {
+    auto* chunk = static_cast<IndexPosting*>(malloc(capacity * sizeof(IndexPosting)));
+    if (chunk) return chunk;
+  }
+  DBG_PRINTLN("[IDX] Out of memory for postings chunk");
+  return nullptr;
+}
+
+// --- Shards ---
+// A shard keeps one file per level. New runs land in level 0; once a level holds
+// MERGE_FAN runs they're merged into one run appended to the next level, and the level's
+// file is removed. A posting is rewritten once per level and never copied in place.
+
+struct RunInfo {
+  uint32_t offset;  // Of the RunHeader
+  uint32_t count;
+};
+
+static constexpr int MAX_LISTED_RUNS = 2 * MERGE_FAN;  // A level past this (merges failing) is left alone
+static constexpr uint32_t RUN_WRITING = 0xFFFFFFFF;     // RunHeader count until a merge completes
+
+static void shardPath(int shard, int level, char* out, size_t outSize) {
+  snprintf(out, outSize, "%s/s%02d_%d.pst", INDEX_DIR, shard, level);
+}
+
+// List a level's runs; `end` is where the last complete one ends (a run torn by power loss
+// is ignored and overwritten by the next append)
+static int listRuns(FsFile& f, RunInfo* runs, uint32_t& end) {
+  uint64_t size = f.size();
+  uint32_t pos = sizeof(IndexHeader);
+  int n = 0;
+  RunHeader rh;
+  while (pos + sizeof(rh) <= size && f.seekSet(pos) && f.read(&rh, sizeof(rh)) == (int)sizeof(rh)) {
+    uint64_t next = pos + sizeof(rh) + (uint64_t)rh.count * sizeof(IndexPosting);
+    if (next > size) break;
+    if (n < MAX_LISTED_RUNS) runs[n] = {pos, rh.count};
+    n++;
+    pos = static_cast<uint32_t>(next);
+  }
+  end = pos;
+  return n;
+}
+
+// Open a level for appending a run, positioned at the end of its complete runs
+static FsFile openForAppend(const char* path, uint32_t& end) {
+  FsFile f = openForUpdate(path);
+  RunInfo runs[MAX_LISTED_RUNS];
+  if (f && !(listRuns(f, runs, end) >= 0 && f.truncate(end) && f.seekSet(end))) f.close();
+  return f;
+}
+
+static bool appendRun(int shard, const IndexPosting* postings, int count) {
+  char path[32];
+  shardPath(shard, 0, path, sizeof(path));
+  uint32_t end;
+  FsFile f = openForAppend(path, end);
+  if (!f) return false;
+  RunHeader rh = {static_cast<uint32_t>(count), 0};
+  size_t bytes = count * sizeof(IndexPosting);
+  bool ok = f.write(&rh, sizeof(rh)) == sizeof(rh) && f.write(postings, bytes) == bytes;
+  f.close();
+  return ok;
+}
+
+// One merge input: a run read through its own small buffer (the I/O pool has too few
+// blocks for a wide merge)
+struct RunCursor {
+  FsFile file;
+  IndexPosting* buf;
+  int len;
+  int pos;
+  uint32_t left;
+
+  bool ready() {
+    if (pos < len) return true;
+    if (left == 0) return false;
+    int n = std::min<uint32_t>(left, CURSOR_POSTINGS);
+    int bytes = n * (int)sizeof(IndexPosting);
+    if (file.read(buf, bytes) != bytes) return false;
+    len = n;
+    pos = 0;
+    left -= n;
+    return true;
+  }
+};
+
+// Merge every run of a level into one run on the next level, dropping stale postings when
+// the note generations are known, then remove the level. A power cut before the removal
+// leaves duplicates, which queries and the next merge ignore.
+static bool mergeLevel(int shard, int level, const RunInfo* runs, int k, const uint32_t* gens, int noteCount) {
+  char path[32], outPath[32];
+  shardPath(shard, level, path, sizeof(path));
+  shardPath(shard, level + 1, outPath, sizeof(outPath));
+  auto* bufs = static_cast<IndexPosting*>(malloc((k + 1) * CURSOR_POSTINGS * sizeof(IndexPosting)));
+  if (!bufs) {
+    DBG_PRINTLN("[IDX] Out of memory for merge");
+    return false;
+  }
+  RunCursor cur[MAX_LISTED_RUNS];
+  bool ok = true;
+  for (int i = 0; i < k; i++) {
+    cur[i].file = SdMan.open(path);
+    cur[i].buf = bufs + i * CURSOR_POSTINGS;
+    cur[i].len = cur[i].pos = 0;
+    cur[i].left = runs[i].count;
+    ok = ok && cur[i].file && cur[i].file.seekSet(runs[i].offset + sizeof(RunHeader));
+  }
+
+  uint32_t end = 0;
+  FsFile out;
+  if (ok) out = openForAppend(outPath, end);
+  RunHeader rh = {RUN_WRITING, 0};
+  ok = ok && out && out.write(&rh, sizeof(rh)) == sizeof(rh);
+
+  IndexPosting* outBuf = bufs + k * CURSOR_POSTINGS;
+  int outLen = 0;
+  uint32_t merged = 0;
+  IndexPosting last = {};  // No posting has termHash 0
+  while (ok) {
+    int best = -1;
+    for (int i = 0; i < k; i++) {
+      if (cur[i].ready() && (best < 0 || postingLess(cur[i].buf[cur[i].pos], cur[best].buf[cur[best].pos]))) best = i;
+    }
+    if (best < 0) break;
+    IndexPosting p = cur[best].buf[cur[best].pos++];
+    // Equal (term, note) keys arrive newest first; older copies are stale or duplicates
+    if (p.termHash == last.termHash && p.noteId == last.noteId) continue;
+    last = p;
+    if (gens && (p.noteId >= noteCount || gens[p.noteId] != p.generation)) continue;
+    outBuf[outLen++] = p;
+    merged++;
+    if (outLen == CURSOR_POSTINGS) {
+      ok = out.write(outBuf, sizeof(IndexPosting) * outLen) == sizeof(IndexPosting) * outLen;
+      outLen = 0;
+    }
+  }
+  if (ok && outLen) ok = out.write(outBuf, sizeof(IndexPosting) * outLen) == sizeof(IndexPosting) * outLen;
+  for (int i = 0; i < k; i++) {
+    ok = ok && cur[i].left == 0 && cur[i].pos == cur[i].len;  // Every input read to the end
+    cur[i].file.close();
+  }
+  free(bufs);
+
+  rh.count = merged;
+  if (ok && merged == 0) ok = out.truncate(end);
+  else if (ok) ok = out.seekSet(end) && out.write(&rh, sizeof(rh)) == sizeof(rh);
+  if (out) out.close();
+  if (!ok) {
+    DBG_PRINTF("[IDX] Merge failed in %s\n", path);
+    return false;
+  }
+  return SdMan.remove(path);
+}
+
+// Merge full levels, starting at 0 (a merge can fill the next). Big merges beyond
+// `bigMerges` wait for a later flush, until the level runs out of slack, so a save doesn't
+// pay for every shard's cascade at once.
+static bool compactShard(int shard, const uint32_t* gens, int noteCount, int& bigMerges) {
+  char path[32];
+  for (int level = 0; level < MAX_LEVELS - 1; level++) {
+    shardPath(shard, level, path, sizeof(path));
+    FsFile f = SdMan.open(path);
+    if (!f) return true;
+    RunInfo runs[MAX_LISTED_RUNS];
+    uint32_t end;
+    int n = listRuns(f, runs, end);
+    f.close();
+    if (n < MERGE_FAN || n > MAX_LISTED_RUNS) return true;
+    uint32_t postings = 0;
+    for (int i = 0; i < n; i++) postings += runs[i].count;
+    if (postings >= BIG_MERGE_POSTINGS) {
+      if (bigMerges == 0 && n < MAX_LISTED_RUNS) return true;
+      if (bigMerges > 0) bigMerges--;
+    }
+    if (!mergeLevel(shard, level, runs, n, gens, noteCount)) return false;
+  }
+  return true;
+}
+
+// Merge a shard's levels down to one run, as a rebuild ends: the merges of later flushes
+// then stay in the small levels for a long while before reaching the bulk of the postings
+static bool flattenShard(int shard) {
+  char path[32];
+  int top = -1;
+  for (int level = 0; level < MAX_LEVELS; level++) {
+    shardPath(shard, level, path, sizeof(path));
+    if (SdMan.exists(path)) top = level;
+  }
+  for (int level = 0; level <= top && level < MAX_LEVELS - 1; level++) {
+    shardPath(shard, level, path, sizeof(path));
+    FsFile f = SdMan.open(path);
+    if (!f) continue;
+    RunInfo runs[MAX_LISTED_RUNS];
+    uint32_t end;
+    int n = listRuns(f, runs, end);
+    f.close();
+    if (n > MAX_LISTED_RUNS) return false;
+    if ((level < top ? n > 0 : n > 1) && !mergeLevel(shard, level, runs, n, nullptr, 0)) return false;
+  }
+  return true;
+}
+
+// Sort `chunk` and add it to the shards as one new run each
+static bool addRuns(IndexPosting* chunk, int n, const uint32_t* gens, int noteCount, int bigMerges) {
+  std::sort(chunk, chunk + n, postingLess);
+  bool ok = true;
+  for (int i = 0; ok && i < n;) {
+    int shard = shardOf(chunk[i].termHash);
+    int j = i;
+    while (j < n && shardOf(chunk[j].termHash) == shard) j++;
+    ok = appendRun(shard, chunk + i, j - i) && compactShard(shard, gens, noteCount, bigMerges);
+    i = j;
+  }
+  return ok;
+}
+
+// --- Delta ---
+
+// Append a note's postings. Returns the delta's posting count afterwards, -1 on error.
+static int appendDelta(int noteId, uint32_t generation, const TermSlot* terms, int count) {
+  FsFile f = openForUpdate(DELTA_PATH);
+  if (!f) return -1;
+  uint32_t n = (f.size() - sizeof(IndexHeader)) / sizeof(IndexPosting);
+  bool ok = f.seekSet(sizeof(IndexHeader) + n * sizeof(IndexPosting));  // Past any torn posting
+
+  IndexPosting chunk[32];
+  for (int i = 0; ok && i < count; i += 32) {
+    int k = std::min(32, count - i);
+    for (int t = 0; t < k; t++) {
+      chunk[t] = {terms[i + t].termHash, terms[i + t].firstOffset, generation, static_cast<uint16_t>(noteId),
+                  terms[i + t].count};
+    }
+    ok = f.write(chunk, k * sizeof(IndexPosting)) == k * sizeof(IndexPosting);
+  }
+  f.close();
+  return ok ? static_cast<int>(n) + count : -1;
+}
+
+// Move the delta into the shards. On failure the delta stays and queries keep reading it.
+static void flushDelta() {
+  [[maybe_unused]] unsigned long startMs = millis();
+  FsFile f = SdMan.open(DELTA_PATH);
+  IndexHeader hdr;
+  if (!f || f.read(&hdr, sizeof(hdr)) != (int)sizeof(hdr)) return;
+
+  int capacity;
+  IndexPosting* chunk = allocChunk(FLUSH_CHUNK, capacity);
+  if (!chunk) return;
+  int noteCount;
+  uint32_t* gens = loadGenerations(noteCount, nullptr, nullptr);  // Null: merges keep stale postings
+
+  bool ok = true;
+  int r;
+  while (ok && (r = f.read(chunk, capacity * sizeof(IndexPosting))) >= (int)sizeof(IndexPosting)) {
+    ok = addRuns(chunk, r / sizeof(IndexPosting), gens, noteCount, 1);
+  }
+  f.close();
+  free(chunk);
+  free(gens);
+  // A flush cut short re-adds postings next time; duplicates are harmless and merged away
+  if (ok) SdMan.remove(DELTA_PATH);
+  DBG_PRINTF("[IDX] Flushed delta in %lums%s\n", millis() - startMs, ok ? "" : " (failed)");
+}
+
+// --- Query ---
+
+// Every posting of `termHash`, from the shard's runs and then the delta. Older generations
+// and duplicates are the visitor's to skip.
+template <typename F>
+static void forEachPosting(uint32_t termHash, F&& visit) {
+  char path[32];
+  SdBlockReader in;
+  for (int level = 0; level < MAX_LEVELS; level++) {
+    shardPath(shardOf(termHash), level, path, sizeof(path));
+    // Single-sector refills: the binary search jumps around
+    if (!in.open(path, false) || !readHeader(in)) {
+      in.close();
+      continue;
+    }
+    uint32_t size = in.size();
+    uint32_t pos = sizeof(IndexHeader);
+    RunHeader rh;
+    while (in.seek(pos) && in.read(&rh, sizeof(rh)) == (int)sizeof(rh)) {
+      uint32_t base = pos + sizeof(rh);
+      if (base + (uint64_t)rh.count * sizeof(IndexPosting) > size) break;  // Torn run
+
+      // Lower bound of termHash
+      uint32_t lo = 0, hi = rh.count;
+      while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t h;
+        if (!in.seek(base + mid * sizeof(IndexPosting)) || in.read(&h, sizeof(h)) != (int)sizeof(h)) {
+          lo = rh.count;
+          break;
+        }
+        if (h < termHash) lo = mid + 1;
+        else hi = mid;
+      }
+      IndexPosting p;
+      if (lo < rh.count && in.seek(base + lo * sizeof(IndexPosting))) {
+        for (uint32_t i = lo; i < rh.count && in.read(&p, sizeof(p)) == (int)sizeof(p) && p.termHash == termHash; i++) {
+          visit(p);
+        }
+      }
+      pos = base + rh.count * sizeof(IndexPosting);
+    }
+    in.close();
+  }
+
+  if (in.open(DELTA_PATH) && readHeader(in)) {
+    IndexPosting p;
+    while (in.read(&p, sizeof(p)) == (int)sizeof(p)) {
+      if (p.termHash == termHash) visit(p);
+    }
+  }
+}
+
+// Match the query against a note's text. False if any term is missing.
+static bool scanNote(const char* filename, const uint32_t* terms, int termCount, SearchHit& hit) {
+  char path[320];
+  snprintf(path, sizeof(path), "/notes/%s", filename);
+  SdBlockReader in;
+  if (!in.open(path)) return false;
+
+  uint32_t counts[MAX_QUERY_TERMS] = {};
+  hit.offset = 0;
+  auto onTerm = [&](uint32_t h, uint32_t offset) {
+    for (int t = 0; t < termCount; t++) {
+      if (terms[t] != h) continue;
+      if (t == 0 && counts[0] == 0) hit.offset = offset;
+      counts[t]++;
+    }
+  };
+  TokenState s = {};
+  uint32_t offset = 0;
+  const uint8_t* data;
+  int r;
+  while ((r = in.next(data)) > 0) {
+    tokenize(s, reinterpret_cast<const char*>(data), r, offset, onTerm);
+    offset += r;
+  }
+  tokenizeEnd(s, onTerm);
+
+  hit.score = 0;
+  for (int t = 0; t < termCount; t++) {
+    if (counts[t] == 0) return false;
+    hit.score += counts[t];
+  }
+  snprintf(hit.filename, sizeof(hit.filename), "%s", filename);
+  return true;
+}
+
+// Insert into a score-ranked list, dropping the lowest hit once full.
+static void insertHit(SearchHit* hits, int& hitCount, int maxHits, const SearchHit& hit) {
+  int pos = hitCount;
+  while (pos > 0 && hits[pos - 1].score < hit.score) pos--;
+  if (pos >= maxHits) return;
+
+  int last = (hitCount < maxHits) ? hitCount : maxHits - 1;
+  for (int i = last; i > pos; i--) hits[i] = hits[i - 1];
+  hits[pos] = hit;
+  if (hitCount < maxHits) hitCount++;
+}
+
+// Scan the notes in `only` (every note if null) and rank the matches into `hits`
+static void scanSearch(const uint32_t* terms, int termCount, const uint8_t* only, SearchHit* hits, int& hitCount,
+                       int maxHits) {
+  SdBlockReader in;
+  if (!in.open(NOTES_PATH) || !readHeader(in)) return;
+  FsFile names;
+  NoteEntry e;
+  for (int id = 0; in.read(&e, sizeof(e)) == (int)sizeof(e); id++) {
+    if (e.nameHash == 0 || (only && !bitTest(only, id))) continue;
+    NoteName name;
+    SearchHit hit;
+    if (readNoteName(names, id, name) && scanNote(name.filename, terms, termCount, hit)) {
+      insertHit(hits, hitCount, maxHits, hit);
+    }
+  }
+}
+
+// Record a note's terms: its entry, then its postings in the delta
+static void storeNote(const char* filename, const TermSlot* terms, int count, bool partial) {
+  uint32_t digest = partial ? 0 : termsDigest(terms, count);
+  NoteEntry entry;
+  int freeId;
+  int id = findNote(filename, entry, freeId);
+  if (id >= 0 && !(entry.flags & NOTE_PARTIAL) && !partial && entry.digest == digest) return;  // Same terms
+
+  if (id < 0) {
+    FsFile notes;
+    id = freeId >= 0 ? freeId : recordCount(NOTES_PATH, sizeof(NoteEntry));
+    if (id >= MAX_NOTES) {
+      DBG_PRINTLN("[IDX] Note table full");
+      return;
+    }
+    // A reused id keeps counting generations, so its old postings stay stale
+    if (freeId < 0 || !readRecord(notes, NOTES_PATH, id, &entry, sizeof(entry))) entry = {};
+    notes.close();
+    NoteName name = {};
+    strncpy(name.filename, filename, sizeof(name.filename) - 1);
+    if (!writeRecord(NAMES_PATH, id, &name, sizeof(name))) return;
+  }
+
+  // The new generation lands before its postings: after a power cut in between, the note
+  // is missing from results (and re-indexed on its next save), never matched on old terms
+  entry.nameHash = nameHashOf(filename);
+  entry.generation++;
+  entry.digest = 0;
+  entry.flags = partial ? NOTE_PARTIAL : 0;
+  if (!writeRecord(NOTES_PATH, id, &entry, sizeof(entry))) return;
+  lastNoteId = id;
+
+  int deltaCount = 0;
+  if (!partial && count > 0 && (deltaCount = appendDelta(id, entry.generation, terms, count)) < 0) return;
+  entry.digest = digest;
+  writeRecord(NOTES_PATH, id, &entry, sizeof(entry));
+  if (deltaCount >= DELTA_MAX_POSTINGS) flushDelta();
+}
+
+// =========================================================================
+// Public API
+// =========================================================================
+
+void noteIndexUpdate(const char* filename, const char* text, size_t length) {
+  SdLock card;
+  if (!filename || filename[0] == '\0' || strlen(filename) >= MAX_FILENAME_LEN) return;
+  if (!SdMan.exists(INDEX_DIR)) SdMan.mkdir(INDEX_DIR);
+
+  TermBuilder b;
+  beginTerms(b);
+  feedTerms(b, text, length, 0);
+  int count = finishTerms(b);
+  storeNote(filename, b.slots, count, b.partial);
+  endTerms(b);
+}
+
+void noteIndexRemove(const char* filename) {
+  SdLock card;
+  NoteEntry entry;
+  int freeId;
+  int id = findNote(filename, entry, freeId);
+  if (id < 0) return;
+  entry.nameHash = 0;
+  entry.generation++;  // Its postings are stale from here on
+  entry.digest = 0;
+  entry.flags = 0;
+  writeRecord(NOTES_PATH, id, &entry, sizeof(entry));
+}
+
+void noteIndexRename(const char* oldFilename, const char* newFilename) {
+  SdLock card;
+  if (strlen(newFilename) >= MAX_FILENAME_LEN) {
+    noteIndexRemove(oldFilename);
+    return;
+  }
+  NoteEntry entry;
+  int freeId;
+  int id = findNote(oldFilename, entry, freeId);
+  if (id < 0) return;
+  noteIndexRemove(newFilename);
+
+  // Postings refer to the id, so only the name changes
+  NoteName name = {};
+  strncpy(name.filename, newFilename, sizeof(name.filename) - 1);
+  if (!writeRecord(NAMES_PATH, id, &name, sizeof(name))) return;
+  entry.nameHash = nameHashOf(newFilename);
+  writeRecord(NOTES_PATH, id, &entry, sizeof(entry));
+}
+
+bool noteIndexIsComplete() {
+  SdLock card;
+  return SdMan.exists(COMPLETE_MARKER);
+}
+
+int noteIndexRebuild() {
+  SdLock card;
+  [[maybe_unused]] unsigned long startMs = millis();
+
+  SdMan.removeDir(INDEX_DIR);
+  if (!SdMan.mkdir(INDEX_DIR)) {
+    DBG_PRINTLN("[IDX] Could not create index directory");
+    return -1;
+  }
+
+  auto dir = SdMan.open("/notes");
+  if (!dir || !dir.isDirectory()) {
+    if (dir) dir.close();
+    return -1;
+  }
+
+  int capacity;
+  IndexPosting* chunk = allocChunk(REBUILD_CHUNK, capacity);
+  FsFile notesTable = openForUpdate(NOTES_PATH);
+  FsFile namesTable = openForUpdate(NAMES_PATH);
+  bool ok = chunk && notesTable && namesTable;
+  TermBuilder b;
+  beginTerms(b);
+
+  char name[256];
+  char path[320];
+  int notes = 0;
+  int partials = 0;
+  int pending = 0;
+  unsigned long totalBytes = 0;
+
+  dir.rewindDirectory();
+  for (auto file = dir.openNextFile(); ok && file; file = dir.openNextFile()) {
+    file.getName(name, sizeof(name));
+    int nameLen = strlen(name);
+    bool isNote = name[0] != '.' && !file.isDirectory() && nameLen > 4 && nameLen < MAX_FILENAME_LEN
+               && strcmp(name + nameLen - 4, ".txt") == 0;
+    file.close();
+    if (!isNote) continue;
+    if (notes >= MAX_NOTES) {
+      DBG_PRINTLN("[IDX] Note table full, rest of the notes not indexed");
+      ok = false;
+      break;
+    }
+
+    snprintf(path, sizeof(path), "/notes/%s", name);
+    SdBlockReader reader;
+    if (!reader.open(path)) continue;
+
+    resetTerms(b);
+    uint32_t offset = 0;
+    const uint8_t* data;
+    int r;
+    while ((r = reader.next(data)) > 0) {
+      feedTerms(b, (const char*)data, r, offset);
+      offset += r;
+    }
+    reader.close();
+    int count = finishTerms(b);
+
+    NoteEntry entry = {nameHashOf(name), 1, b.partial ? 0 : termsDigest(b.slots, count),
+                       static_cast<uint16_t>(b.partial ? NOTE_PARTIAL : 0), 0};
+    NoteName noteName = {};
+    memcpy(noteName.filename, name, nameLen + 1);  // Fits: checked above
+    ok = notesTable.write(&entry, sizeof(entry)) == sizeof(entry)
+      && namesTable.write(&noteName, sizeof(noteName)) == sizeof(noteName);
+    for (int i = 0; ok && i < count; i++) {
+      chunk[pending++] = {b.slots[i].termHash, b.slots[i].firstOffset, 1, static_cast<uint16_t>(notes),
+                          b.slots[i].count};
+      if (pending == capacity) {
+        ok = addRuns(chunk, pending, nullptr, 0, INT_MAX);
+        pending = 0;
+      }
+    }
+    if (b.partial) partials++;
+    notes++;
+    totalBytes += offset;
+  }
+  if (ok && pending > 0) ok = addRuns(chunk, pending, nullptr, 0, INT_MAX);
+  for (int shard = 0; ok && shard < (1 << SHARD_BITS); shard++) ok = flattenShard(shard);
+  dir.close();
+  notesTable.close();
+  namesTable.close();
+  endTerms(b);
+  free(chunk);
+
+  if (!ok) {
+    // Leave no marker: the next search rebuilds again
+    DBG_PRINTLN("[IDX] Rebuild failed");
+    SdMan.sleep();
+    return -1;
+  }
+  writeMarker();
+  SdMan.sleep();
+
+  DBG_PRINTF("[IDX] Rebuilt: %d notes (%d partial), %lu bytes in %lums\n", notes, partials, totalBytes,
+             millis() - startMs);
+  return notes;
+}
+
+int noteIndexSearch(const char* query, SearchHit* hits, int maxHits) {
+  SdLock card;
+  uint32_t terms[MAX_QUERY_TERMS];
+  int termCount = hashQueryTerms(query, terms, MAX_QUERY_TERMS);
+  if (termCount == 0 || maxHits <= 0) return 0;
+
+  [[maybe_unused]] unsigned long startMs = millis();
+
+  // Per note id while the query runs: generation, score, and two bitmaps (~6.3 bytes a note)
+  int noteCount;
+  int partialCount;
+  uint8_t* partial = nullptr;
+  uint32_t* gens = loadGenerations(noteCount, &partial, &partialCount);
+  auto* score = gens ? static_cast<uint16_t*>(calloc(noteCount ? noteCount : 1, sizeof(uint16_t))) : nullptr;
+  auto* seen = score ? static_cast<uint8_t*>(malloc((noteCount + 7) / 8 + 1)) : nullptr;
+  int hitCount = 0;
+
+  if (!seen) {
+    DBG_PRINTLN("[IDX] Out of memory for search tables, scanning notes");
+    scanSearch(terms, termCount, nullptr, hits, hitCount, maxHits);
+  } else {
+    auto live = [&](const IndexPosting& p) { return p.noteId < noteCount && gens[p.noteId] == p.generation; };
+
+    // AND the terms: a note keeps a score only while every term so far has matched it
+    for (int t = 0; t < termCount; t++) {
+      memset(seen, 0, (noteCount + 7) / 8 + 1);
+      forEachPosting(terms[t], [&](const IndexPosting& p) {
+        if (!live(p) || bitTest(seen, p.noteId)) return;
+        bitSet(seen, p.noteId);
+        uint16_t& s = score[p.noteId];
+        if (t == 0) s = p.count;
+        else if (s) s = std::min<uint32_t>(s + p.count, 0xFFFF);
+      });
+      if (t == 0) continue;
+      for (int id = 0; id < noteCount; id++) {
+        if (score[id] && !bitTest(seen, id)) score[id] = 0;
+      }
+    }
+
+    // Rank; `offset` holds the note id until the first term's postings fill it in
+    for (int id = 0; id < noteCount; id++) {
+      if (!score[id]) continue;
+      SearchHit hit;
+      hit.filename[0] = '\0';
+      hit.offset = id;
+      hit.score = score[id];
+      insertHit(hits, hitCount, maxHits, hit);
+    }
+    memset(score, 0, noteCount * sizeof(uint16_t));
+    FsFile names;
+    for (int i = 0; i < hitCount; i++) {
+      NoteName name;
+      if (readNoteName(names, hits[i].offset, name)) memcpy(hits[i].filename, name.filename, sizeof(name.filename));
+      score[hits[i].offset] = i + 1;
+    }
+    names.close();
+    forEachPosting(terms[0], [&](const IndexPosting& p) {
+      if (live(p) && score[p.noteId]) hits[score[p.noteId] - 1].offset = p.firstOffset;
+    });
+
+    if (partialCount > 0) scanSearch(terms, termCount, partial, hits, hitCount, maxHits);
+  }
+  free(seen);
+  free(score);
+  free(gens);
+  free(partial);
+  SdMan.sleep();
+
+  DBG_PRINTF("[IDX] Query \"%s\": %d hits / %d notes in %lums\n", query, hitCount, noteCount, millis() - startMs);
+  return hitCount;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "config.h"
+
+// --- Full-text search over all notes ---
+// Backed by an on-SD inverted index (see note_index.cpp for the file format).
+
+static constexpr int MAX_SEARCH_HITS = 10;
+static constexpr int MAX_QUERY_LEN = 40;
+
+struct SearchHit {
+  char filename[MAX_FILENAME_LEN];
+  uint32_t offset;   // Byte offset of the first query term in the note
+  uint32_t score;    // Sum of matched term occurrence counts (higher = better)
+};
+
+// Index maintenance — called from file_manager on save/rename/delete
+void noteIndexUpdate(const char* filename, const char* text, size_t length);
+void noteIndexRemove(const char* filename);
+void noteIndexRename(const char* oldFilename, const char* newFilename);
+
+// Drop the whole index and re-tokenize every note. Returns notes indexed, -1 on error.
+int noteIndexRebuild();
+// True once a full rebuild has completed (per-save updates alone don't cover old notes)
+bool noteIndexIsComplete();
+
+// AND-query over all words in `query`. Fills `hits` ranked by score, returns hit count.
+int noteIndexSearch(const char* query, SearchHit* hits, int maxHits);
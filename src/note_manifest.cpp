@@ -0,0 +1,525 @@
+#include "note_manifest.h"
+
+#include <Arduino.h>
+#include <SDCardManager.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+// ---------------------------------------------------------------------------
+// Content-hash manifest — one fixed-size file:
+//
+//   /notes/.manifest
+//
+// Layout (little-endian):
+//   ManifestHeader   magic 'MSMF', version, seq
+//   ManifestEntry    filename, hash, size, seq, FAT modify stamp      × N, unordered
+//
+// Entries are overwritten in place; a deleted note leaves a free slot (empty filename)
+// that the next new note reuses, so the file never needs rewriting. hash is FNV-1a 64
+// of the note content and doubles as the HTTP ETag. seq is a change counter: every
+// content change or rename takes the next value from the header, so "changed since
+// seq N" needs no clock.
+//
+// Saves store the hash with a zero stamp: the device has no clock, so the stamp it
+// leaves on the card is only known once the sync server sees the file. After that a
+// different size or stamp means the note was edited off-device and gets re-hashed.
+// A sync session starts by reconciling the manifest with the notes directory, after
+// which the listing is served from the manifest alone.
+// The manifest is only a cache — an unreadable one is reset and rebuilt lazily.
+// ---------------------------------------------------------------------------
+
+static constexpr const char* MANIFEST_PATH = "/notes/.manifest";
+
+static constexpr uint32_t MANIFEST_MAGIC = 0x464D534D;  // "MSMF"
+static constexpr uint16_t MANIFEST_VERSION = 2;
+
+struct ManifestHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t reserved;
+  uint32_t seq;                     // Last change counter handed out
+  uint32_t reserved2;
+};
+
+struct ManifestEntry {
+  char filename[MAX_FILENAME_LEN];  // "" = free slot
+  uint64_t hash;                    // FNV-1a 64 of the content
+  uint32_t size;
+  uint32_t seq;                     // Header seq when this entry last changed
+  uint16_t modDate;                 // FAT stamp the hash was checked against, 0 = not seen yet
+  uint16_t modTime;
+  uint32_t reserved;
+};
+
+static_assert(sizeof(ManifestHeader) == 16, "ManifestHeader layout is part of the on-SD format");
+static_assert(sizeof(ManifestEntry) == 88, "ManifestEntry layout is part of the on-SD format");
+
+static constexpr uint64_t FNV64_OFFSET = 14695981039346656037ull;
+static constexpr uint64_t FNV64_PRIME = 1099511628211ull;
+
+static constexpr int SESSION_GROW_SLOTS = 64;  // Lookup table growth step as a session adds notes
+
+// Slot of the note saved last, so back-to-back saves skip the manifest scan
+struct CachedSlot {
+  char filename[MAX_FILENAME_LEN];
+  int slot;
+};
+
+static CachedSlot cached = {"", -1};
+
+// Sync session: name hash → slot, sorted by hash. Entries present when the session
+// begins go in `loadedSlots`, sized once; notes the session adds go in `addedSlots`,
+// which grows in steps — growing never copies the big table.
+struct SessionSlot {
+  uint32_t nameHash;
+  int32_t slot;
+};
+
+struct SlotTable {
+  SessionSlot* slots;
+  int count;
+  int capacity;
+};
+
+static bool sessionOpen = false;
+static SlotTable loadedSlots = {nullptr, 0, 0};
+static SlotTable addedSlots = {nullptr, 0, 0};
+static int sessionEntries = 0;   // Slots in the file (next append goes here)
+static int sessionScanFrom = 0;  // Slots from here on may be missing from the table (out of memory)
+static uint32_t sessionSeq = 0;
+static FsFile sessionFile;
+
+static uint64_t hashBytes(uint64_t h, const uint8_t* data, size_t len) {
+  for (size_t i = 0; i < len; i++) h = (h ^ data[i]) * FNV64_PRIME;
+  return h;
+}
+
+static uint32_t nameHash(const char* name) {
+  uint32_t h = 2166136261u;
+  while (*name) h = (h ^ static_cast<uint8_t>(*name++)) * 16777619u;
+  return h;
+}
+
+static uint32_t entryOffset(int slot) {
+  return sizeof(ManifestHeader) + static_cast<uint32_t>(slot) * sizeof(ManifestEntry);
+}
+
+static bool writeSeq(FsFile& f, uint32_t seq) {
+  return f.seekSet(offsetof(ManifestHeader, seq)) && f.write(&seq, sizeof(seq)) == sizeof(seq);
+}
+
+static int entryCount(FsFile& f) {
+  // A torn trailing entry rounds down and is overwritten by the next append
+  return static_cast<int>((f.size() - sizeof(ManifestHeader)) / sizeof(ManifestEntry));
+}
+
+static bool readEntry(FsFile& f, int slot, ManifestEntry& entry) {
+  return f.seekSet(entryOffset(slot)) && f.read(&entry, sizeof(entry)) == (int)sizeof(entry);
+}
+
+static bool writeEntry(FsFile& f, int slot, const ManifestEntry& entry) {
+  return f.seekSet(entryOffset(slot)) && f.write(&entry, sizeof(entry)) == sizeof(entry);
+}
+
+// Open for update, creating or resetting the file when the header is missing or wrong
+static FsFile openManifest(ManifestHeader& hdr) {
+  FsFile f = SdMan.open(MANIFEST_PATH, O_RDWR | O_CREAT);
+  if (!f) return f;
+
+  if (f.size() >= sizeof(hdr) && f.read(&hdr, sizeof(hdr)) == (int)sizeof(hdr)
+      && hdr.magic == MANIFEST_MAGIC && hdr.version == MANIFEST_VERSION) {
+    return f;
+  }
+
+  hdr = {MANIFEST_MAGIC, MANIFEST_VERSION, 0, 0, 0};
+  if (!f.truncate(0) || !f.seekSet(0) || f.write(&hdr, sizeof(hdr)) != sizeof(hdr) || !f.sync()) {
+    f.close();
+    return FsFile();
+  }
+  cached.slot = -1;
+  DBG_PRINTLN("[MANIFEST] Reset");
+  return f;
+}
+
+// Sequential scan for `filename`. Returns its slot or -1; `freeSlot` gets the first
+// free slot, or the entry count when there is none.
+static int findSlot(const char* filename, int& freeSlot) {
+  freeSlot = -1;
+  SdBlockReader reader;
+  ManifestHeader hdr;
+  if (!reader.open(MANIFEST_PATH) || reader.read(&hdr, sizeof(hdr)) != (int)sizeof(hdr)) {
+    freeSlot = 0;
+    return -1;
+  }
+
+  ManifestEntry entry;
+  int slot = 0;
+  for (; reader.read(&entry, sizeof(entry)) == (int)sizeof(entry); slot++) {
+    if (entry.filename[0] == '\0') {
+      if (freeSlot < 0) freeSlot = slot;
+    } else if (strncmp(entry.filename, filename, MAX_FILENAME_LEN) == 0) {
+      return slot;
+    }
+  }
+  if (freeSlot < 0) freeSlot = slot;
+  return -1;
+}
+
+// Slot holding `filename` in an open manifest, -1 if none (`freeSlot` as for findSlot)
+static int locate(FsFile& f, const char* filename, int& freeSlot) {
+  ManifestEntry entry;
+  if (cached.slot >= 0 && strcmp(cached.filename, filename) == 0
+      && readEntry(f, cached.slot, entry) && strncmp(entry.filename, filename, MAX_FILENAME_LEN) == 0) {
+    return cached.slot;
+  }
+  return findSlot(filename, freeSlot);
+}
+
+static void remember(const char* filename, int slot) {
+  strncpy(cached.filename, filename, MAX_FILENAME_LEN - 1);
+  cached.filename[MAX_FILENAME_LEN - 1] = '\0';
+  cached.slot = slot;
+}
+
+static bool hashNote(const char* filename, uint64_t& hash, uint32_t& size) {
+  char path[320];
+  snprintf(path, sizeof(path), "/notes/%s", filename);
+  SdBlockReader reader;
+  if (!reader.open(path)) return false;
+
+  uint64_t h = FNV64_OFFSET;
+  uint32_t total = 0;
+  const uint8_t* data;
+  int n;
+  while ((n = reader.next(data)) > 0) {
+    h = hashBytes(h, data, n);
+    total += n;
+  }
+  if (n < 0) return false;
+  hash = h;
+  size = total;
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Maintenance (save / rename / delete)
+// ---------------------------------------------------------------------------
+
+static void sessionStore(const ManifestEntry& entry);
+
+uint64_t noteContentHash(const char* text, size_t length) {
+  return hashBytes(FNV64_OFFSET, reinterpret_cast<const uint8_t*>(text), length);
+}
+
+void noteManifestUpdate(const char* filename, const char* text, size_t length) {
+  SdLock card;
+  ManifestEntry entry = {};
+  strncpy(entry.filename, filename, MAX_FILENAME_LEN - 1);
+  entry.hash = noteContentHash(text, length);
+  entry.size = length;
+
+  // Notes written by the sync server (uploads) go through the open session
+  if (sessionOpen) {
+    sessionStore(entry);
+    return;
+  }
+
+  ManifestHeader hdr;
+  FsFile f = openManifest(hdr);
+  if (!f) {
+    DBG_PRINTLN("[MANIFEST] Could not open manifest");
+    return;
+  }
+  int freeSlot;
+  int slot = locate(f, filename, freeSlot);
+  if (slot < 0) slot = freeSlot;
+  entry.seq = hdr.seq + 1;
+  bool ok = writeEntry(f, slot, entry) && writeSeq(f, entry.seq);
+  f.close();
+
+  if (ok) {
+    remember(filename, slot);
+  } else {
+    cached.slot = -1;
+    DBG_PRINTF("[MANIFEST] Write failed: %s\n", filename);
+  }
+}
+
+void noteManifestRemove(const char* filename) {
+  SdLock card;
+  if (!SdMan.exists(MANIFEST_PATH)) return;
+  ManifestHeader hdr;
+  FsFile f = openManifest(hdr);
+  if (!f) return;
+  int freeSlot;
+  int slot = locate(f, filename, freeSlot);
+  if (slot >= 0) {
+    ManifestEntry entry = {};
+    writeEntry(f, slot, entry);
+  }
+  f.close();
+  if (strcmp(cached.filename, filename) == 0) cached.slot = -1;
+}
+
+void noteManifestRename(const char* oldFilename, const char* newFilename) {
+  SdLock card;
+  // A stale entry under the new name (note deleted off-device) would shadow ours
+  noteManifestRemove(newFilename);
+  if (!SdMan.exists(MANIFEST_PATH)) return;
+
+  ManifestHeader hdr;
+  FsFile f = openManifest(hdr);
+  if (!f) return;
+  int freeSlot;
+  int slot = locate(f, oldFilename, freeSlot);
+  ManifestEntry entry;
+  bool ok = slot >= 0 && readEntry(f, slot, entry);
+  if (ok) {
+    // A rename is a change as far as "since" listings are concerned
+    memset(entry.filename, 0, sizeof(entry.filename));
+    strncpy(entry.filename, newFilename, MAX_FILENAME_LEN - 1);
+    entry.seq = hdr.seq + 1;
+    ok = writeEntry(f, slot, entry) && writeSeq(f, entry.seq);
+  }
+  f.close();
+  if (ok) remember(newFilename, slot);
+  else if (strcmp(cached.filename, oldFilename) == 0) cached.slot = -1;
+}
+
+// ---------------------------------------------------------------------------
+// Sync session
+// ---------------------------------------------------------------------------
+
+static bool slotLess(const SessionSlot& a, const SessionSlot& b) { return a.nameHash < b.nameHash; }
+
+static int tableFind(const SlotTable& table, const char* filename, uint32_t hash, ManifestEntry& entry) {
+  SessionSlot key = {hash, 0};
+  SessionSlot* end = table.slots + table.count;
+  for (SessionSlot* it = std::lower_bound(table.slots, end, key, slotLess);
+       it != end && it->nameHash == hash; ++it) {
+    if (it->slot >= 0 && readEntry(sessionFile, it->slot, entry)
+        && strncmp(entry.filename, filename, MAX_FILENAME_LEN) == 0) {
+      return it->slot;
+    }
+  }
+  return -1;
+}
+
+static int sessionFind(const char* filename, ManifestEntry& entry) {
+  uint32_t hash = nameHash(filename);
+  int slot = tableFind(loadedSlots, filename, hash, entry);
+  if (slot < 0) slot = tableFind(addedSlots, filename, hash, entry);
+  if (slot >= 0) return slot;
+
+  // Entries the tables had no room for are still in the file — slower, but never lost
+  for (slot = sessionScanFrom; slot < sessionEntries; slot++) {
+    if (readEntry(sessionFile, slot, entry) && strncmp(entry.filename, filename, MAX_FILENAME_LEN) == 0) {
+      return slot;
+    }
+  }
+  return -1;
+}
+
+// New entry at the end of the file. Always gets a slot: the listing reads the file, and
+// sessionFind scans the slots the table couldn't take.
+static int sessionAppend(const char* filename) {
+  int slot = sessionEntries++;
+  if (addedSlots.count >= addedSlots.capacity) {
+    int capacity = addedSlots.capacity + SESSION_GROW_SLOTS;
+    auto* grown = static_cast<SessionSlot*>(realloc(addedSlots.slots, capacity * sizeof(SessionSlot)));
+    if (!grown) {
+      if (slot < sessionScanFrom) sessionScanFrom = slot;
+      DBG_PRINTF("[MANIFEST] No memory to index %s, scanning for it\n", filename);
+      return slot;
+    }
+    addedSlots.slots = grown;
+    addedSlots.capacity = capacity;
+  }
+  SessionSlot added = {nameHash(filename), slot};
+  SessionSlot* end = addedSlots.slots + addedSlots.count;
+  SessionSlot* pos = std::upper_bound(addedSlots.slots, end, added, slotLess);
+  memmove(pos + 1, pos, (end - pos) * sizeof(SessionSlot));
+  *pos = added;
+  addedSlots.count++;
+  return slot;
+}
+
+static void sessionStore(const ManifestEntry& entry) {
+  ManifestEntry current;
+  int slot = sessionFind(entry.filename, current);
+  if (slot < 0) slot = sessionAppend(entry.filename);
+  ManifestEntry stored = entry;
+  stored.seq = ++sessionSeq;
+  writeEntry(sessionFile, slot, stored);
+}
+
+// Make the session entry for a note match what is on the card. False if the note is
+// unreadable.
+static bool sessionRefresh(const char* filename, uint32_t size, uint16_t modDate, uint16_t modTime,
+                           ManifestEntry& entry, int& slot) {
+  slot = sessionFind(filename, entry);
+  if (slot >= 0 && entry.size == size) {
+    if (entry.modDate == modDate && entry.modTime == modTime) return true;
+    if (entry.modDate == 0 && entry.modTime == 0) {
+      // First sighting since the device saved it — adopt the stamp the card gave it
+      entry.modDate = modDate;
+      entry.modTime = modTime;
+      writeEntry(sessionFile, slot, entry);
+      return true;
+    }
+  }
+
+  // Missing, or edited off-device: hash the note once and repair the entry
+  ManifestEntry fresh = {};
+  strncpy(fresh.filename, filename, MAX_FILENAME_LEN - 1);
+  if (!hashNote(filename, fresh.hash, fresh.size)) return false;
+  fresh.modDate = modDate;
+  fresh.modTime = modTime;
+  fresh.seq = ++sessionSeq;
+  if (slot < 0) slot = sessionAppend(filename);
+  writeEntry(sessionFile, slot, fresh);
+  DBG_PRINTF("[MANIFEST] Re-hashed %s\n", filename);
+  entry = fresh;
+  return true;
+}
+
+// One pass over the notes directory: add or re-hash notes changed off-device and free
+// the entries of notes that are gone. Directory entries carry size and stamp, so the
+// notes themselves are only read when they changed.
+static void sessionReconcile() {
+  auto dir = SdMan.open("/notes");
+  if (!dir || !dir.isDirectory()) {
+    if (dir) dir.close();
+    return;
+  }
+
+  // One bit per slot present before the walk; appended slots are current by construction
+  int known = sessionEntries;
+  uint8_t* seen = static_cast<uint8_t*>(calloc(known / 8 + 1, 1));
+  char name[256];
+  ManifestEntry entry;
+  dir.rewindDirectory();
+  for (auto file = dir.openNextFile(); file; file = dir.openNextFile()) {
+    file.getName(name, sizeof(name));
+    int nameLen = strlen(name);
+    bool isNote = name[0] != '.' && !file.isDirectory() && nameLen > 4 && nameLen < MAX_FILENAME_LEN
+                  && strcmp(name + nameLen - 4, ".txt") == 0;
+    uint16_t modDate = 0, modTime = 0;
+    uint32_t size = file.size();
+    file.getModifyDateTime(&modDate, &modTime);
+    file.close();
+    if (!isNote) continue;
+
+    int slot;
+    if (sessionRefresh(name, size, modDate, modTime, entry, slot) && seen && slot < known) {
+      seen[slot / 8] |= 1 << (slot % 8);
+    }
+  }
+  dir.close();
+  if (!seen) return;
+
+  for (int i = 0; i < loadedSlots.count; i++) {
+    int slot = loadedSlots.slots[i].slot;
+    if (slot < 0 || slot >= known || (seen[slot / 8] & (1 << (slot % 8)))) continue;
+    ManifestEntry gone = {};
+    writeEntry(sessionFile, slot, gone);
+    loadedSlots.slots[i].slot = -1;
+  }
+  for (int slot = sessionScanFrom; slot < known; slot++) {
+    if (seen[slot / 8] & (1 << (slot % 8))) continue;
+    if (readEntry(sessionFile, slot, entry) && entry.filename[0] != '\0') {
+      ManifestEntry gone = {};
+      writeEntry(sessionFile, slot, gone);
+    }
+  }
+  free(seen);
+}
+
+bool noteManifestBegin() {
+  SdLock card;
+  noteManifestEnd();
+  [[maybe_unused]] unsigned long startMs = millis();
+
+  ManifestHeader hdr;
+  sessionFile = openManifest(hdr);
+  if (!sessionFile) return false;
+  sessionOpen = true;
+  sessionSeq = hdr.seq;
+  sessionEntries = entryCount(sessionFile);
+  sessionScanFrom = INT32_MAX;
+
+  // 8 bytes per manifest entry. Without room for it lookups scan the file instead.
+  loadedSlots.slots = static_cast<SessionSlot*>(malloc(sessionEntries * sizeof(SessionSlot)));
+  if (!loadedSlots.slots && sessionEntries > 0) {
+    DBG_PRINTF("[MANIFEST] No memory for %d slots, scanning instead\n", sessionEntries);
+    sessionScanFrom = 0;
+  } else {
+    loadedSlots.capacity = sessionEntries;
+    SdBlockReader reader;
+    if (reader.open(MANIFEST_PATH) && reader.read(&hdr, sizeof(hdr)) == (int)sizeof(hdr)) {
+      ManifestEntry entry;
+      for (int slot = 0; slot < sessionEntries && reader.read(&entry, sizeof(entry)) == (int)sizeof(entry); slot++) {
+        if (entry.filename[0] == '\0') continue;
+        entry.filename[MAX_FILENAME_LEN - 1] = '\0';
+        loadedSlots.slots[loadedSlots.count++] = {nameHash(entry.filename), slot};
+      }
+    }
+    reader.close();
+    std::sort(loadedSlots.slots, loadedSlots.slots + loadedSlots.count, slotLess);
+  }
+
+  sessionReconcile();
+  writeSeq(sessionFile, sessionSeq);
+  sessionFile.sync();
+
+  DBG_PRINTF("[MANIFEST] Session: %d entries, seq %lu in %lums\n", loadedSlots.count + addedSlots.count,
+             (unsigned long)sessionSeq, millis() - startMs);
+  return true;
+}
+
+void noteManifestEnd() {
+  SdLock card;
+  if (sessionFile) {
+    writeSeq(sessionFile, sessionSeq);
+    sessionFile.close();
+  }
+  free(loadedSlots.slots);
+  free(addedSlots.slots);
+  sessionOpen = false;
+  loadedSlots = {nullptr, 0, 0};
+  addedSlots = {nullptr, 0, 0};
+}
+
+static void toNote(const ManifestEntry& entry, ManifestNote& out) {
+  memcpy(out.filename, entry.filename, MAX_FILENAME_LEN);
+  out.filename[MAX_FILENAME_LEN - 1] = '\0';
+  out.hash = entry.hash;
+  out.size = entry.size;
+  out.seq = entry.seq;
+}
+
+bool noteManifestLookup(const char* filename, uint32_t size, uint16_t modDate, uint16_t modTime, ManifestNote& out) {
+  SdLock card;
+  if (!sessionOpen) return false;
+  ManifestEntry entry;
+  int slot;
+  if (!sessionRefresh(filename, size, modDate, modTime, entry, slot)) return false;
+  toNote(entry, out);
+  return true;
+}
+
+int noteManifestNext(int cursor, ManifestNote& out) {
+  SdLock card;
+  if (!sessionOpen || cursor < 0) return -1;
+  ManifestEntry entry;
+  for (int slot = cursor; slot < sessionEntries; slot++) {
+    if (!readEntry(sessionFile, slot, entry) || entry.filename[0] == '\0') continue;
+    toNote(entry, out);
+    return slot + 1;
+  }
+  return -1;
+}
+
+uint32_t noteManifestSeq() { return sessionSeq; }
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "config.h"
+
+// --- Content-hash manifest for WiFi sync ---
+// One entry per note with a 64-bit hash of its content, maintained at save time so the
+// sync server can report hashes / ETags without reading every note (see note_manifest.cpp).
+
+// FNV-1a 64 of a note's content — the hash the manifest stores and serves as ETag
+uint64_t noteContentHash(const char* text, size_t length);
+
+// Manifest maintenance — called from file_manager on save/rename/delete
+void noteManifestUpdate(const char* filename, const char* text, size_t length);
+void noteManifestRemove(const char* filename);
+void noteManifestRename(const char* oldFilename, const char* newFilename);
+
+struct ManifestNote {
+  char filename[MAX_FILENAME_LEN];
+  uint64_t hash;
+  uint32_t size;
+  uint32_t seq;  // Change counter value when the note last changed (see noteManifestSeq)
+};
+
+// Sync session: begin loads a small name lookup table (one pass over the manifest) so
+// each lookup is a single seek, then reconciles it with the notes directory (notes
+// added, edited or deleted off-device). Returns false if the table couldn't be built.
+bool noteManifestBegin();
+void noteManifestEnd();
+
+// Manifest entry of a note as it is on the card. `size` and the FAT modify stamp come
+// from the caller's open file; a mismatch (note changed off-device) re-hashes it once and
+// repairs the entry. Returns false if the note can't be read.
+// The entry's seq doubles as the note's version for upload conflict checks.
+bool noteManifestLookup(const char* filename, uint32_t size, uint16_t modDate, uint16_t modTime, ManifestNote& out);
+
+// Session listing, in manifest order: the first note at or after `cursor` (start at 0).
+// Returns the cursor for the next call, -1 when there are no more notes.
+int noteManifestNext(int cursor, ManifestNote& out);
+// Latest change counter handed out; notes with seq > a client's saved value changed since
+uint32_t noteManifestSeq();
@@ -0,0 +1,127 @@
+#include "screen_cache.h"
+#include "config.h"
+
+#include <Arduino.h>
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <esp_timer.h>
+
+extern bool darkMode;
+
+// PackBits-style RLE over the framebuffer bytes. Control byte c:
+//   c < 0x80:  c + 1 literal bytes follow
+//   c >= 0x80: the next byte repeats (c & 0x7F) + 2 times
+// UI frames are mostly one colour, so a screen shrinks from 48 KB to a few KB, and
+// decoding is memset/memcpy — no glyph lookups, no per-pixel rotation.
+static constexpr size_t MAX_LITERAL = 128;
+static constexpr size_t MAX_RUN = 129;
+
+struct CacheEntry {
+  uint8_t* data = nullptr;
+  ScreenCacheStats stats = {};
+};
+
+static CacheEntry entries[static_cast<int>(CachedScreen::COUNT)];
+static size_t totalBytes = 0;
+// Orientation and theme the entries were rendered in
+static int cachedOrientation = -1;
+static bool cachedDark = false;
+
+// Returns the encoded size; with dst == nullptr only measures
+static size_t rleEncode(const uint8_t* src, size_t len, uint8_t* dst) {
+  size_t out = 0;
+  size_t i = 0;
+  while (i < len) {
+    size_t run = 1;
+    while (i + run < len && run < MAX_RUN && src[i + run] == src[i]) run++;
+    if (run >= 2) {
+      if (dst) {
+        dst[out] = static_cast<uint8_t>(0x80 | (run - 2));
+        dst[out + 1] = src[i];
+      }
+      out += 2;
+      i += run;
+      continue;
+    }
+    // Literal: up to the next pair of equal bytes
+    size_t lit = 1;
+    while (i + lit < len && lit < MAX_LITERAL && !(i + lit + 1 < len && src[i + lit] == src[i + lit + 1])) lit++;
+    if (dst) {
+      dst[out] = static_cast<uint8_t>(lit - 1);
+      memcpy(dst + out + 1, src + i, lit);
+    }
+    out += 1 + lit;
+    i += lit;
+  }
+  return out;
+}
+
+static void rleDecode(const uint8_t* src, size_t srcLen, uint8_t* dst) {
+  size_t in = 0;
+  while (in < srcLen) {
+    uint8_t c = src[in++];
+    if (c & 0x80) {
+      size_t run = (c & 0x7F) + 2;
+      memset(dst, src[in++], run);
+      dst += run;
+    } else {
+      size_t lit = c + 1;
+      memcpy(dst, src + in, lit);
+      dst += lit;
+      in += lit;
+    }
+  }
+}
+
+static void dropEntry(CacheEntry& e) {
+  if (!e.data) return;
+  totalBytes -= e.stats.bytes;
+  free(e.data);
+  e.data = nullptr;
+  e.stats.bytes = 0;
+}
+
+void screenCacheClear() {
+  for (CacheEntry& e : entries) dropEntry(e);
+}
+
+// Encode the framebuffer into `e`, making room within the budget if needed
+static void store(CacheEntry& e, const uint8_t* frame) {
+  size_t size = rleEncode(frame, HalDisplay::BUFFER_SIZE, nullptr);
+  if (size > SCREEN_CACHE_BUDGET) return;
+  if (totalBytes + size > SCREEN_CACHE_BUDGET) screenCacheClear();
+  e.data = static_cast<uint8_t*>(malloc(size));
+  if (!e.data) return;  // Low on heap: draw from scratch each time instead
+  rleEncode(frame, HalDisplay::BUFFER_SIZE, e.data);
+  e.stats.bytes = static_cast<uint16_t>(size);
+  totalBytes += size;
+}
+
+void screenCacheDraw(GfxRenderer& renderer, CachedScreen screen, void (*drawBase)(GfxRenderer&)) {
+  int orientation = static_cast<int>(renderer.getOrientation());
+  if (orientation != cachedOrientation || darkMode != cachedDark) {
+    screenCacheClear();
+    cachedOrientation = orientation;
+    cachedDark = darkMode;
+  }
+
+  CacheEntry& e = entries[static_cast<int>(screen)];
+  uint8_t* frame = renderer.getFrameBuffer();
+  int64_t start = esp_timer_get_time();
+  if (e.data) {
+    rleDecode(e.data, e.stats.bytes, frame);
+    e.stats.blitUs = static_cast<uint32_t>(esp_timer_get_time() - start);
+    e.stats.hits++;
+    return;
+  }
+
+  drawBase(renderer);
+  e.stats.renderUs = static_cast<uint32_t>(esp_timer_get_time() - start);
+  store(e, frame);
+  DBG_PRINTF("[CACHE] Screen %d: drawn in %lu us, cached %u bytes (%u total)\n", static_cast<int>(screen),
+             (unsigned long)e.stats.renderUs, e.stats.bytes, static_cast<unsigned>(totalBytes));
+}
+
+const ScreenCacheStats& screenCacheStats(CachedScreen screen) {
+  return entries[static_cast<int>(screen)].stats;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+class GfxRenderer;
+
+// --- Static screen cache ---
+// The parts of a screen that never change between visits (background, titles, labels,
+// header and footer rules) are rendered once, run-length encoded from the framebuffer
+// and decoded straight back into it on later visits; the caller then draws only the
+// live parts (selection, values, battery, BLE status) on top. Entries are only valid for
+// the orientation and theme they were rendered in and are re-rendered on first use after
+// either changes. Battery and status text are always overlays, so they never invalidate.
+
+enum class CachedScreen : uint8_t {
+  MAIN_MENU,
+  SETTINGS,
+  COUNT
+};
+
+// Fill the framebuffer with the base layer of `screen`: decoded from the cache, or drawn
+// by `drawBase` (which must start from a cleared screen) and cached for next time.
+void screenCacheDraw(GfxRenderer& renderer, CachedScreen screen, void (*drawBase)(GfxRenderer&));
+// Drop every entry (frees the RAM)
+void screenCacheClear();
+
+struct ScreenCacheStats {
+  uint32_t renderUs;  // Last draw from scratch (0 = never)
+  uint32_t blitUs;    // Last decode from the cache (0 = never)
+  uint16_t bytes;     // Encoded size, 0 when not cached
+  uint16_t hits;
+};
+
+const ScreenCacheStats& screenCacheStats(CachedScreen screen);
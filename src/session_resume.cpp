@@ -0,0 +1,85 @@
+#include "session_resume.h"
+#include "config.h"
+#include "text_editor.h"
+#include "file_manager.h"
+#include "note_manifest.h"
+
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <cstring>
+
+extern UIState currentState;
+extern bool cleanMode;
+
+// RTC slow memory survives deep sleep (not power loss or a reset). The note itself is on
+// the card — the record only holds what's needed to skip the menu and the re-wrap, and
+// the content hash guards against the card having been edited elsewhere in between.
+// Line offsets fit 16 bits since the buffer does: ~2 KB of the 8 KB RTC memory.
+static_assert(TEXT_BUFFER_SIZE <= 65536, "line offsets are stored as uint16_t");
+
+static constexpr uint32_t SESSION_MAGIC = 0x4D53524Du;  // "MSRM"
+
+struct ResumeSession {
+  uint32_t magic;
+  uint64_t hash;             // noteContentHash of the note as saved
+  uint16_t length;
+  uint16_t cursor;
+  uint16_t viewportStart;
+  uint16_t visibleLines;
+  uint16_t charsPerLine;
+  uint16_t lineCount;
+  bool cleanMode;
+  char filename[MAX_FILENAME_LEN];
+  uint16_t lines[MAX_LINES];
+};
+
+RTC_DATA_ATTR static ResumeSession session;
+
+void sessionSaveForSleep() {
+  session.magic = 0;
+  bool inEditor = currentState == UIState::TEXT_EDITOR || currentState == UIState::EDITOR_FIND;
+  const char* file = editorGetCurrentFile();
+  if (!inEditor || file[0] == '\0' || editorHasUnsavedChanges()) return;  // Unsaved = save failed
+
+  size_t length = editorGetLength();
+  session.hash = noteContentHash(editorGetBuffer(), length);
+  session.length = (uint16_t)length;
+  session.cursor = (uint16_t)editorGetCursorPosition();
+  session.viewportStart = (uint16_t)editorGetViewportStart();
+  session.visibleLines = (uint16_t)editorGetStoredVisibleLines();
+  session.charsPerLine = (uint16_t)editorGetCharsPerLine();
+  session.lineCount = (uint16_t)editorGetLineCount();
+  for (int i = 0; i < session.lineCount; i++) session.lines[i] = (uint16_t)editorGetLinePosition(i);
+  session.cleanMode = cleanMode;
+  strncpy(session.filename, file, MAX_FILENAME_LEN - 1);
+  session.filename[MAX_FILENAME_LEN - 1] = '\0';
+  session.magic = SESSION_MAGIC;
+  DBG_PRINTF("[RESUME] Saved session: %s cursor %u, %u lines\n", session.filename, session.cursor,
+             session.lineCount);
+}
+
+bool sessionResumePending() {
+  return esp_reset_reason() == ESP_RST_DEEPSLEEP && session.magic == SESSION_MAGIC;
+}
+
+bool sessionResume() {
+  if (!sessionResumePending()) return false;
+  session.magic = 0;  // One shot — a later reset cold-boots as usual
+
+  if (!fileManagerMount()) return false;
+  int length = openNoteBuffer(session.filename);
+  if (length != session.length || noteContentHash(editorGetBuffer(), length) != session.hash) {
+    DBG_PRINTF("[RESUME] %s changed since sleep — cold boot\n", session.filename);
+    editorInit();
+    return false;
+  }
+
+  editorSetVisibleLines(session.visibleLines);
+  editorRestoreLayout(length, session.cursor, session.viewportStart, session.charsPerLine, session.lines,
+                      session.lineCount);
+  cleanMode = session.cleanMode;
+  currentState = UIState::TEXT_EDITOR;
+  DBG_PRINTF("[RESUME] Restored %s at cursor %u\n", session.filename, session.cursor);
+  return true;
+}
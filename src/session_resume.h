@@ -0,0 +1,14 @@
+#pragma once
+
+// --- Instant resume ---
+// The open note's editor session (file, cursor, viewport, clean mode and the wrapped line
+// index) is kept in RTC memory across deep sleep, so waking goes straight back to the
+// editor where it was instead of cold-booting into the main menu (see session_resume.cpp).
+
+// Before deep sleep, after the note has been saved. Clears the record if no note is open.
+void sessionSaveForSleep();
+// Woke from deep sleep with a session record (cheap — no card access)
+bool sessionResumePending();
+// On wake from deep sleep: reopen the note and restore the session. True if the editor is
+// ready to draw; false on a cold boot, or if the note changed or can't be read.
+bool sessionResume();
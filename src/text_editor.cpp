@@ -1,4 +1,5 @@
 #include "text_editor.h"
+#include <Arduino.h>
 #include <cstring>
 #include <algorithm>
 
@@ -13,7 +14,10 @@ static char currentTitle[MAX_TITLE_LEN] = "Untitled";
 static bool unsavedChanges = false;
 
 // --- Line management ---
-static int linePositions[MAX_LINES];  // Index into textBuffer for start of each line
+// Index into textBuffer for start of each line. 16 bits is enough for any buffer up to
+// 64 KB and halves the table (same layout session_resume keeps in RTC memory).
+static uint16_t linePositions[MAX_LINES];
+static_assert(TEXT_BUFFER_SIZE <= 65536, "linePositions holds 16-bit offsets");
 static int lineCount = 0;
 static int cursorLine = 0;
 static int cursorCol = 0;
@@ -252,6 +256,202 @@ void editorMoveCursorEnd() {
   ensureCursorVisible(storedVisibleLines);
 }
 
+void editorSetCursorPosition(int pos) {
+  if (pos < 0) pos = 0;
+  if (pos > (int)textLength) pos = (int)textLength;
+  cursorPosition = pos;
+  editorRecalculateLines();
+  ensureCursorVisible(storedVisibleLines);
+}
+
+// --- Search kernel ---
+// Needles shorter than this scan with memchr (word-at-a-time in newlib) and verify;
+// longer ones use Boyer-Moore-Horspool, where the skip table pays for itself.
+static constexpr int SHORT_NEEDLE_LEN = 4;
+
+// ASCII case-fold table, built at compile time so it lives in flash.
+// Avoids a tolower() call per haystack byte in the inner loops.
+struct FoldTable {
+  uint8_t map[256];
+  constexpr FoldTable() : map() {
+    for (int i = 0; i < 256; i++) map[i] = (i >= 'A' && i <= 'Z') ? (uint8_t)(i + 32) : (uint8_t)i;
+  }
+};
+static constexpr FoldTable caseFold;
+
+// A needle prepared once per operation and reused for every scan
+struct Needle {
+  uint8_t key[MAX_FIND_LEN];  // Needle bytes, case-folded unless matchCase
+  int len;
+  bool matchCase;
+  uint8_t skip[256];          // Horspool shift per (folded) haystack byte, long needles only
+};
+
+static void prepareNeedle(Needle& n, const char* s, bool matchCase) {
+  n.len = (int)strnlen(s, MAX_FIND_LEN);
+  n.matchCase = matchCase;
+  for (int i = 0; i < n.len; i++) {
+    uint8_t c = (uint8_t)s[i];
+    n.key[i] = matchCase ? c : caseFold.map[c];
+  }
+  if (n.len < SHORT_NEEDLE_LEN) return;
+
+  memset(n.skip, n.len, sizeof(n.skip));
+  for (int i = 0; i < n.len - 1; i++) {
+    n.skip[n.key[i]] = (uint8_t)(n.len - 1 - i);
+  }
+}
+
+static bool matchesAt(const Needle& n, const uint8_t* p) {
+  if (n.matchCase) return memcmp(p, n.key, n.len) == 0;
+  for (int i = 0; i < n.len; i++) {
+    if (caseFold.map[p[i]] != n.key[i]) return false;
+  }
+  return true;
+}
+
+// Offset of the first match in hay[0..hayLen), or -1
+static int findIn(const Needle& n, const char* hay, int hayLen) {
+  const uint8_t* h = (const uint8_t*)hay;
+  int m = n.len;
+  if (m == 0 || hayLen < m) return -1;
+  int last = hayLen - m;  // Last offset a match can start at
+
+  if (m < SHORT_NEEDLE_LEN) {
+    // Scan for the first byte; case-insensitive letters need the upper-case twin as well.
+    // Each twin keeps its own cursor and only the one just tried is advanced, so every
+    // byte is read at most once per cursor.
+    uint8_t lo = n.key[0];
+    uint8_t hi = (!n.matchCase && lo >= 'a' && lo <= 'z') ? (uint8_t)(lo - 32) : lo;
+    const uint8_t* end = h + last + 1;
+    const uint8_t* pLo = (const uint8_t*)memchr(h, lo, end - h);
+    const uint8_t* pHi = hi != lo ? (const uint8_t*)memchr(h, hi, end - h) : nullptr;
+    while (pLo || pHi) {
+      const uint8_t* p = (pLo && (!pHi || pLo < pHi)) ? pLo : pHi;
+      if (matchesAt(n, p)) return (int)(p - h);
+      const uint8_t* next = p + 1;
+      const uint8_t* found = next < end ? (const uint8_t*)memchr(next, *p, end - next) : nullptr;
+      if (p == pLo) pLo = found;
+      else pHi = found;
+    }
+    return -1;
+  }
+
+  // Horspool: compare on the last needle byte, shift by the table on mismatch
+  const uint8_t* fold = caseFold.map;
+  uint8_t tail = n.key[m - 1];
+  int i = 0;
+  while (i <= last) {
+    uint8_t c = h[i + m - 1];
+    if (!n.matchCase) c = fold[c];
+    if (c == tail && matchesAt(n, h + i)) return i;
+    i += n.skip[c];
+  }
+  return -1;
+}
+
+int editorFind(const char* needle, int from, bool matchCase) {
+  Needle n;
+  prepareNeedle(n, needle, matchCase);
+  if (n.len == 0) return -1;
+  if (from < 0 || from > (int)textLength) from = 0;
+
+  [[maybe_unused]] unsigned long startUs = micros();
+  int pos = findIn(n, textBuffer + from, (int)textLength - from);
+  if (pos >= 0) {
+    pos += from;
+  } else if (from > 0) {
+    // Wrap to the top; the head segment may end in a match straddling `from`
+    int headLen = std::min((int)textLength, from + n.len - 1);
+    pos = findIn(n, textBuffer, headLen);
+  }
+  DBG_PRINTF("[EDIT] Find (%d bytes): %d in %lu us over %u bytes\n",
+             n.len, pos, micros() - startUs, (unsigned)textLength);
+  return pos;
+}
+
+bool editorReplaceAt(int pos, const char* needle, const char* replacement, bool matchCase) {
+  Needle n;
+  prepareNeedle(n, needle, matchCase);
+  int rlen = (int)strnlen(replacement, MAX_FIND_LEN);
+  if (n.len == 0 || pos < 0 || pos + n.len > (int)textLength) return false;
+  if (!matchesAt(n, (const uint8_t*)textBuffer + pos)) return false;
+  if ((int)textLength + rlen - n.len >= (int)TEXT_BUFFER_SIZE) return false;
+
+  memmove(textBuffer + pos + rlen, textBuffer + pos + n.len, textLength - pos - n.len);
+  memcpy(textBuffer + pos, replacement, rlen);
+  textLength = textLength + rlen - n.len;
+  textBuffer[textLength] = '\0';
+  cursorPosition = pos + rlen;
+  unsavedChanges = true;
+  lineBreaksDirty = true;
+
+  editorRecalculateLines();
+  ensureCursorVisible(storedVisibleLines);
+  return true;
+}
+
+// Replace every match in one rebuild pass over the buffer, rather than
+// per-character delete/insert (which would be O(n) per character).
+int editorReplaceAll(const char* needle, const char* replacement, bool matchCase) {
+  Needle n;
+  prepareNeedle(n, needle, matchCase);
+  if (n.len == 0) return 0;
+  int rlen = (int)strnlen(replacement, MAX_FIND_LEN);
+  int len = (int)textLength;
+
+  [[maybe_unused]] unsigned long startUs = micros();
+
+  // A growing replacement needs the final size up front: count matches, then slide
+  // the text to the end of the buffer so the rebuild always reads ahead of its writes.
+  int growth = 0;
+  if (rlen > n.len) {
+    int count = 0;
+    int r = 0;
+    int f;
+    while ((f = findIn(n, textBuffer + r, len - r)) >= 0) {
+      count++;
+      r += f + n.len;
+    }
+    if (count == 0) return 0;
+    growth = count * (rlen - n.len);
+    if (len + growth >= (int)TEXT_BUFFER_SIZE) return -1;
+    memmove(textBuffer + growth, textBuffer, len);
+  }
+
+  // Rebuild: copy each gap between matches, then the replacement text
+  const char* src = textBuffer + growth;
+  int r = 0, w = 0, count = 0;
+  int newCursor = -1;
+  while (true) {
+    int f = findIn(n, src + r, len - r);
+    int end = (f < 0) ? len : r + f;
+    if (f < 0 && count == 0) return 0;  // Nothing matched (only reachable for shrinking replacements)
+
+    if (w != r + growth) memmove(textBuffer + w, src + r, end - r);
+    if (newCursor < 0 && cursorPosition <= end) newCursor = w + (cursorPosition - r);
+    w += end - r;
+    if (f < 0) break;
+
+    if (newCursor < 0 && cursorPosition < end + n.len) newCursor = w;  // Cursor was inside the match
+    memcpy(textBuffer + w, replacement, rlen);
+    w += rlen;
+    r = end + n.len;
+    count++;
+  }
+
+  textLength = w;
+  textBuffer[textLength] = '\0';
+  cursorPosition = (newCursor >= 0) ? newCursor : w;
+  unsavedChanges = true;
+  lineBreaksDirty = true;
+  DBG_PRINTF("[EDIT] Replace all: %d in %lu us over %d bytes\n", count, micros() - startUs, len);
+
+  editorRecalculateLines();
+  ensureCursorVisible(storedVisibleLines);
+  return count;
+}
+
 void editorSetCharsPerLine(int cpl) {
   if (cpl != charsPerLine) {
     charsPerLine = cpl;
@@ -283,6 +483,28 @@ int editorGetLinePosition(int lineIndex) {
   return linePositions[lineIndex];
 }
 
+int editorGetCharsPerLine() { return charsPerLine; }
+
+void editorRestoreLayout(size_t length, int cursor, int viewportStart, int cpl, const uint16_t* lines, int count) {
+  textLength = length;
+  textBuffer[textLength] = '\0';
+  cursorPosition = std::max(0, std::min(cursor, (int)textLength));
+  charsPerLine = cpl;
+
+  bool valid = count >= 1 && count <= MAX_LINES && lines[0] == 0;
+  for (int i = 1; valid && i < count; i++) {
+    valid = lines[i] > lines[i - 1] && lines[i] <= textLength;
+  }
+  if (valid) {
+    for (int i = 0; i < count; i++) linePositions[i] = lines[i];
+    lineCount = count;
+  }
+  lineBreaksDirty = !valid;
+  viewportStartLine = viewportStart;
+  editorRecalculateLines();
+  ensureCursorVisible(storedVisibleLines);
+}
+
 void editorSetCurrentFile(const char* filename) {
   strncpy(currentFile, filename, MAX_FILENAME_LEN - 1);
   currentFile[MAX_FILENAME_LEN - 1] = '\0';
@@ -23,6 +23,13 @@ void editorMoveCursorUp();
 void editorMoveCursorDown();
 void editorMoveCursorHome();
 void editorMoveCursorEnd();
+void editorSetCursorPosition(int pos);  // Jump to a byte offset (clamped), e.g. a search hit
+
+// Find / replace (ASCII case-insensitive unless matchCase)
+static constexpr int MAX_FIND_LEN = 40;
+int editorFind(const char* needle, int from, bool matchCase);  // Next match at/after `from`, wrapping; -1 if none
+bool editorReplaceAt(int pos, const char* needle, const char* replacement, bool matchCase);  // Only if `pos` still matches
+int editorReplaceAll(const char* needle, const char* replacement, bool matchCase);  // Count replaced, -1 if result won't fit
 
 // Line/viewport management
 void editorSetCharsPerLine(int cpl);
@@ -35,6 +42,11 @@ int editorGetCursorLine();
 int editorGetCursorCol();
 int editorGetLineCount();
 int editorGetLinePosition(int lineIndex);
+int editorGetCharsPerLine();
+
+// Instant resume: put back a saved layout (line index, cursor, viewport) for a buffer already
+// holding the same `length` bytes, skipping the re-wrap. An inconsistent index is rebuilt.
+void editorRestoreLayout(size_t length, int cursor, int viewportStart, int cpl, const uint16_t* lines, int count);
 
 // File metadata
 void editorSetCurrentFile(const char* filename);
@@ -2,7 +2,13 @@
 #include "config.h"
 #include "text_editor.h"
 #include "file_manager.h"
+#include "note_index.h"
+#include "note_history.h"
 #include "ble_keyboard.h"
+#include "ble_conn_tuner.h"
+#include "boot_profile.h"
+#include "energy_meter.h"
+#include "screen_cache.h"
 #include "wifi_sync.h"
 
 #include <GfxRenderer.h>
@@ -10,6 +16,7 @@
 #include <HalDisplay.h>
 #include <EpdFont.h>
 #include <EpdFontFamily.h>
+#include <algorithm>
 
 // External variables
 extern bool autoReconnectEnabled;
@@ -32,18 +39,24 @@ uint32_t getScanAgeMs();
 #include <builtinFonts/ubuntu_10_regular.h>
 #include <builtinFonts/ubuntu_10_bold.h>
 
-// Font objects (file-scoped)
-static EpdFont ns14Regular(&notosans_14_regular);
-static EpdFont ns14Bold(&notosans_14_bold);
-static EpdFontFamily ns14Family(&ns14Regular, &ns14Bold);
-
-static EpdFont ns12Regular(&notosans_12_regular);
-static EpdFont ns12Bold(&notosans_12_bold);
-static EpdFontFamily ns12Family(&ns12Regular, &ns12Bold);
-
-static EpdFont u10Regular(&ubuntu_10_regular);
-static EpdFont u10Bold(&ubuntu_10_bold);
-static EpdFontFamily u10Family(&u10Regular, &u10Bold);
+// Font registry, indexed by the FONT_* ids in config.h. Built at compile time;
+// rendererSetup() only copies it into the renderer's flat table.
+static constexpr EpdFont ns14Regular(&notosans_14_regular);
+static constexpr EpdFont ns14Bold(&notosans_14_bold);
+static constexpr EpdFont ns12Regular(&notosans_12_regular);
+static constexpr EpdFont ns12Bold(&notosans_12_bold);
+static constexpr EpdFont u10Regular(&ubuntu_10_regular);
+static constexpr EpdFont u10Bold(&ubuntu_10_bold);
+
+static constexpr EpdFontFamily FONT_FAMILIES[FONT_COUNT] = {
+    EpdFontFamily(&ns14Regular, &ns14Bold),  // FONT_BODY
+    EpdFontFamily(&ns12Regular, &ns12Bold),  // FONT_UI
+    EpdFontFamily(&u10Regular, &u10Bold),    // FONT_SMALL
+};
+static_assert(FONT_COUNT <= GfxRenderer::MAX_FONTS, "renderer font table too small");
+
+// Editor metrics, folded at compile time
+static constexpr int BODY_LINE_HEIGHT = notosans_14_regular.advanceY;
 
 // Extern shared state (defined in main.cpp)
 extern UIState currentState;
@@ -55,26 +68,37 @@ extern Orientation currentOrientation;
 extern int charsPerLine;
 extern char renameBuffer[];
 extern int renameBufferLen;
+extern char searchQuery[];
+extern SearchHit searchHits[];
+extern int searchHitCount;
+extern int searchSelection;
+extern char findBuffer[];
+extern char replaceBuffer[];
+extern bool findEditingReplace;
+extern char findStatus[];
+extern char historyFile[];
+extern HistoryVersion historyVersions[];
+extern int historyCount;
+extern int historySelection;
 
 void rendererSetup(GfxRenderer& renderer) {
-  renderer.insertFont(FONT_BODY, ns14Family);
-  renderer.insertFont(FONT_UI, ns12Family);
-  renderer.insertFont(FONT_SMALL, u10Family);
+  for (int id = 0; id < FONT_COUNT; id++) {
+    renderer.insertFont(id, FONT_FAMILIES[id]);
+  }
 }
 
 // ---------------------------------------------------------------------------
-// Clipped draw helpers — use renderer.truncatedText() so NO pixel ever
+// Clipped draw helpers — fit every string with an ellipsis so NO pixel ever
 // exceeds screen width.  This is how crosspoint-reader prevents GFX errors.
+// Each string is laid out once into textRun (glyphs + pen x) and measured,
+// truncated and drawn from there, so every glyph is looked up exactly once.
 // ---------------------------------------------------------------------------
 
-// Draw text that is guaranteed not to overflow the screen width.
-// maxW = available pixel width from x to right edge (caller computes).
+static GfxRenderer::TextRun textRun;  // Reused by every helper below: one line at a time
+
+// Fit the laid-out textRun into maxW and draw it.
 // Falls back to sw - x - 5 if maxW <= 0.
-static void drawClippedText(GfxRenderer& r, int font, int x, int y,
-                            const char* text, int maxW = 0,
-                            bool black = true,
-                            EpdFontFamily::Style style = EpdFontFamily::REGULAR) {
-  if (!text || !text[0]) return;
+static void drawFittedRun(GfxRenderer& r, int x, int y, int maxW, bool black) {
   int sw = r.getScreenWidth();
   int sh = r.getScreenHeight();
   if (x < 0 || x >= sw || y < 0 || y >= sh) return;
@@ -82,10 +106,20 @@ static void drawClippedText(GfxRenderer& r, int font, int x, int y,
   if (maxW <= 0) maxW = sw - x - 5;   // 5px right margin
   if (maxW <= 0) return;
 
-  auto clipped = r.truncatedText(font, text, maxW, style);
-  if (!clipped.empty()) {
-    r.drawText(font, x, y, clipped.c_str(), black, style);
-  }
+  r.fitTextRun(textRun, maxW);
+  r.drawTextRun(textRun, x, y, black);
+}
+
+// Draw text that is guaranteed not to overflow the screen width.
+// maxW = available pixel width from x to right edge (caller computes).
+static void drawClippedText(GfxRenderer& r, int font, int x, int y,
+                            const char* text, int maxW = 0,
+                            bool black = true,
+                            EpdFontFamily::Style style = EpdFontFamily::REGULAR) {
+  if (!text || !text[0]) return;
+  if (x < 0 || y < 0) return;
+  if (!r.layoutText(textRun, font, text, style)) return;
+  drawFittedRun(r, x, y, maxW, black);
 }
 
 // Draw right-aligned text (e.g. battery %, RSSI, settings values).
@@ -94,13 +128,14 @@ static void drawRightText(GfxRenderer& r, int font, int rightEdge, int y,
                           const char* text, bool black = true,
                           EpdFontFamily::Style style = EpdFontFamily::REGULAR) {
   if (!text || !text[0]) return;
-  // Use getTextWidth (bounding box) — same measurement truncatedText uses —
-  // so the allocated space always matches what the truncation check expects.
-  int tw = r.getTextWidth(font, text, style);
+  // The run's bounding box is the same measurement the fit uses, so the
+  // allocated space always matches what the truncation check expects.
+  if (!r.layoutText(textRun, font, text, style)) return;
+  int tw = textRun.width();
   if (tw <= 0) tw = 30;                    // safe fallback
   int x = rightEdge - tw;
   if (x < 5) x = 5;                        // don't go off left edge
-  drawClippedText(r, font, x, y, text, rightEdge - x, black, style);
+  drawFittedRun(r, x, y, rightEdge - x, black);
 }
 
 // Safe line — just clamp to screen
@@ -155,7 +190,23 @@ static void drawBleStatus(GfxRenderer& renderer, int x, int y) {
 // Screen drawing functions
 // ===========================================================================
 
-void drawMainMenu(GfxRenderer& renderer, HalGPIO& gpio) {
+static bool fullRefreshNext = false;
+
+void requestFullRefresh() {
+  fullRefreshNext = true;
+}
+
+static HalDisplay::RefreshMode takeRefreshMode() {
+  if (!fullRefreshNext) return HalDisplay::FAST_REFRESH;
+  fullRefreshNext = false;
+  return HalDisplay::FULL_REFRESH;
+}
+
+static const char* const MAIN_MENU_ITEMS[] = {"Browse Files", "New Note", "Settings", "Sync"};
+static constexpr int MAIN_MENU_FOOTER = 60;
+
+// Everything on the main menu except the selection, BLE status and battery
+static void drawMainMenuBase(GfxRenderer& renderer) {
   renderer.clearScreen();
   int sw = renderer.getScreenWidth();
   int sh = renderer.getScreenHeight();
@@ -167,27 +218,34 @@ void drawMainMenu(GfxRenderer& renderer, HalGPIO& gpio) {
   renderer.drawCenteredText(FONT_BODY, 30, "MicroSlate", tc, EpdFontFamily::BOLD);
 
   // Menu items
-  static const char* menuItems[] = {"Browse Files", "New Note", "Settings", "Sync"};
   for (int i = 0; i < 4; i++) {
-    int yPos = 90 + (i * 45);
-    if (i == mainMenuSelection) {
-      clippedFillRect(renderer, 5, yPos - 5, sw - 10, 35, tc);
-      drawClippedText(renderer, FONT_UI, 20, yPos, menuItems[i], sw - 40, !tc);
-    } else {
-      drawClippedText(renderer, FONT_UI, 20, yPos, menuItems[i], sw - 40, tc);
-    }
+    drawClippedText(renderer, FONT_UI, 20, 90 + (i * 45), MAIN_MENU_ITEMS[i], sw - 40, tc);
   }
 
   // Footer
-  constexpr int bm = 60;
+  constexpr int bm = MAIN_MENU_FOOTER;
   if (sh > bm + 40) {
     clippedLine(renderer, 10, sh - bm, sw - 10, sh - bm, tc);
     drawClippedText(renderer, FONT_SMALL, 20, sh - bm + 12, "Arrows: Navigate  Enter: Select", 0, tc);
-    drawBleStatus(renderer, 20, sh - bm + 28);
   }
+}
+
+void drawMainMenu(GfxRenderer& renderer, HalGPIO& gpio) {
+  screenCacheDraw(renderer, CachedScreen::MAIN_MENU, drawMainMenuBase);
+  int sw = renderer.getScreenWidth();
+  int sh = renderer.getScreenHeight();
+  bool tc = !darkMode;
+
+  // Un-draw the cached label first: its descenders reach below the highlight
+  int yPos = 90 + (mainMenuSelection * 45);
+  drawClippedText(renderer, FONT_UI, 20, yPos, MAIN_MENU_ITEMS[mainMenuSelection], sw - 40, !tc);
+  clippedFillRect(renderer, 5, yPos - 5, sw - 10, 35, tc);
+  drawClippedText(renderer, FONT_UI, 20, yPos, MAIN_MENU_ITEMS[mainMenuSelection], sw - 40, !tc);
+
+  if (sh > MAIN_MENU_FOOTER + 40) drawBleStatus(renderer, 20, sh - MAIN_MENU_FOOTER + 28);
   drawBattery(renderer, gpio);
 
-  renderer.displayBuffer(HalDisplay::FAST_REFRESH);
+  renderer.displayBuffer(takeRefreshMode());
 }
 
 void drawFileBrowser(GfxRenderer& renderer, HalGPIO& gpio) {
@@ -219,14 +277,16 @@ void drawFileBrowser(GfxRenderer& renderer, HalGPIO& gpio) {
   }
 
   FileInfo* files = getFileList();
+  char title[MAX_TITLE_LEN];
   for (int i = startIdx; i < fc && (i - startIdx) < maxVisible; i++) {
     int yPos = listTop + (i - startIdx) * lineH;
+    filenameToTitle(files[i].filename, title, MAX_TITLE_LEN);
 
     if (i == selectedFileIndex) {
       clippedFillRect(renderer, 5, yPos - 3, sw - 10, lineH - 1, tc);
-      drawClippedText(renderer, FONT_UI, 15, yPos, files[i].title, sw - 30, !tc);
+      drawClippedText(renderer, FONT_UI, 15, yPos, title, sw - 30, !tc);
     } else {
-      drawClippedText(renderer, FONT_UI, 15, yPos, files[i].title, sw - 30, tc);
+      drawClippedText(renderer, FONT_UI, 15, yPos, title, sw - 30, tc);
     }
   }
 
@@ -295,10 +355,43 @@ static const char* getModeIndicator() {
   }
 }
 
+// One labelled field of the find bar; the focused field is bold and shows a cursor
+static void drawFindField(GfxRenderer& renderer, int x, int w, const char* label,
+                          const char* text, bool focused, bool tc) {
+  auto style = focused ? EpdFontFamily::BOLD : EpdFontFamily::REGULAR;
+  drawClippedText(renderer, FONT_SMALL, x, 5, label, w, tc, style);
+  int tx = x + renderer.getTextWidth(FONT_SMALL, label, style) + 6;
+  if (tx >= x + w) return;
+  drawClippedText(renderer, FONT_SMALL, tx, 5, text, x + w - tx, tc);
+  if (focused) {
+    int cursorX = tx + renderer.getTextAdvanceX(FONT_SMALL, text);
+    if (cursorX + 2 < x + w) renderer.fillRect(cursorX, 7, 2, 18, tc);
+  }
+}
+
+// Find/replace bar — replaces the editor header while UIState::EDITOR_FIND is active
+static void drawFindBar(GfxRenderer& renderer, int sw, bool tc) {
+  int statusW = findStatus[0] ? renderer.getTextWidth(FONT_SMALL, findStatus) + 10 : 0;
+  int fieldW = (sw - 20 - statusW) / 2;
+  drawFindField(renderer, 10, fieldW - 5, "Find:", findBuffer, !findEditingReplace, tc);
+  drawFindField(renderer, 10 + fieldW, fieldW - 5, "Repl:", replaceBuffer, findEditingReplace, tc);
+  if (findStatus[0]) drawRightText(renderer, FONT_SMALL, sw - 10, 5, findStatus, tc);
+  clippedLine(renderer, 5, 32, sw - 5, 32, tc);
+}
+
+// Header is hidden in clean mode, but the find bar always needs its row
+static bool editorHeaderShown() {
+  return !cleanMode || currentState == UIState::EDITOR_FIND;
+}
+
 // Helper: draw the standard editor header, returns textAreaTop
 // centerText is optional text drawn centered in the header (e.g. "Page 1/3")
 static int drawEditorHeader(GfxRenderer& renderer, HalGPIO& gpio, int sw, bool tc,
                             const char* centerText = nullptr) {
+  if (currentState == UIState::EDITOR_FIND) {
+    drawFindBar(renderer, sw, tc);
+    return 38;
+  }
   if (cleanMode) return 8;
 
   const char* title = editorGetCurrentTitle();
@@ -335,15 +428,14 @@ void drawTextEditor(GfxRenderer& renderer, HalGPIO& gpio) {
 
   if (darkMode) clippedFillRect(renderer, 0, 0, sw, sh, true);
 
-  int lineHeight = renderer.getLineHeight(FONT_BODY);
-  if (lineHeight <= 0) lineHeight = 20;
+  int lineHeight = BODY_LINE_HEIGHT;
   int totalLines = editorGetLineCount();
   int curLine = editorGetCursorLine();
 
   // --- TYPEWRITER MODE ---
   if (writingMode == WritingMode::TYPEWRITER) {
     // In clean mode (Ctrl+Z): just text on blank screen, no header
-    int textAreaTop = cleanMode ? 0 : drawEditorHeader(renderer, gpio, sw, tc);
+    int textAreaTop = editorHeaderShown() ? drawEditorHeader(renderer, gpio, sw, tc) : 0;
 
     // Center the current line vertically
     int textAreaHeight = sh - textAreaTop;
@@ -359,7 +451,7 @@ void drawTextEditor(GfxRenderer& renderer, HalGPIO& gpio) {
 
     editorSetVisibleLines(1);
 
-    renderer.displayBuffer(HalDisplay::FAST_REFRESH);
+    renderer.displayBuffer(takeRefreshMode());
     return;
   }
 
@@ -367,7 +459,7 @@ void drawTextEditor(GfxRenderer& renderer, HalGPIO& gpio) {
   if (writingMode == WritingMode::PAGINATION) {
     // Pre-compute page info for the header
     // Use a temporary linesPerPage estimate (will be exact since header height is fixed)
-    int tempTextTop = cleanMode ? 8 : 38;
+    int tempTextTop = editorHeaderShown() ? 38 : 8;
     int tempLinesPerPage = (sh - 5 - tempTextTop) / lineHeight;
     if (tempLinesPerPage < 1) tempLinesPerPage = 1;
     int currentPage = curLine / tempLinesPerPage;
@@ -401,7 +493,7 @@ void drawTextEditor(GfxRenderer& renderer, HalGPIO& gpio) {
       drawEditorCursor(renderer, cursorY, lineHeight, sw, tc);
     }
 
-    renderer.displayBuffer(HalDisplay::FAST_REFRESH);
+    renderer.displayBuffer(takeRefreshMode());
     return;
   }
 
@@ -430,7 +522,7 @@ void drawTextEditor(GfxRenderer& renderer, HalGPIO& gpio) {
     drawEditorCursor(renderer, cursorY, lineHeight, sw, tc);
   }
 
-  renderer.displayBuffer(HalDisplay::FAST_REFRESH);
+  renderer.displayBuffer(takeRefreshMode());
 }
 
 void drawRenameScreen(GfxRenderer& renderer, HalGPIO& gpio) {
@@ -463,7 +555,27 @@ void drawRenameScreen(GfxRenderer& renderer, HalGPIO& gpio) {
   renderer.displayBuffer(HalDisplay::FAST_REFRESH);
 }
 
-void drawSettingsMenu(GfxRenderer& renderer, HalGPIO& gpio) {
+// Setting items: Orientation, Dark Mode, Writing Mode, Bluetooth, Keyboard, Clear Paired, Rebuild Index,
+// BLE Diagnostics, Boot Profile, Energy
+static const char* const SETTINGS_LABELS[] = {
+  "Orientation", "Dark Mode", "Writing Mode", "Bluetooth", "Keyboard", "Clear Paired", "Rebuild Index",
+  "BLE Diagnostics", "Boot Profile", "Energy"
+};
+static constexpr int SETTINGS_COUNT = 10;
+static constexpr int SETTINGS_LIST_TOP = 50;
+
+// Compute line height to fit all items — use smaller spacing if needed
+static int settingsLineHeight(int sh) {
+  int lineH = 38;
+  if (SETTINGS_LIST_TOP + SETTINGS_COUNT * lineH > sh - 70) {
+    lineH = (sh - 70 - SETTINGS_LIST_TOP) / SETTINGS_COUNT;
+    if (lineH < 24) lineH = 24;
+  }
+  return lineH;
+}
+
+// Header, labels and footer; the selection, values and battery go on top
+static void drawSettingsBase(GfxRenderer& renderer) {
   renderer.clearScreen();
   int sw = renderer.getScreenWidth();
   int sh = renderer.getScreenHeight();
@@ -471,32 +583,39 @@ void drawSettingsMenu(GfxRenderer& renderer, HalGPIO& gpio) {
   if (darkMode) clippedFillRect(renderer, 0, 0, sw, sh, true);
 
   drawClippedText(renderer, FONT_SMALL, 10, 5, "Settings", 0, !darkMode, EpdFontFamily::BOLD);
-  drawBattery(renderer, gpio);
   clippedLine(renderer, 5, 32, sw - 5, 32, !darkMode);
 
-  // Setting items: Orientation, Dark Mode, Writing Mode, Bluetooth, Clear Paired
-  static const char* labels[] = {
-    "Orientation", "Dark Mode", "Writing Mode", "Bluetooth", "Clear Paired"
-  };
-  const int SETTINGS_COUNT = 5;
+  int lineH = settingsLineHeight(sh);
+  for (int i = 0; i < SETTINGS_COUNT; i++) {
+    drawClippedText(renderer, FONT_UI, 15, SETTINGS_LIST_TOP + (i * lineH), SETTINGS_LABELS[i], sw / 2 - 15,
+                    !darkMode);
+  }
 
-  // Compute line height to fit all items — use smaller spacing if needed
-  int lineH = 38;
-  int listTop = 50;
-  if (listTop + SETTINGS_COUNT * lineH > sh - 70) {
-    lineH = (sh - 70 - listTop) / SETTINGS_COUNT;
-    if (lineH < 24) lineH = 24;
+  // Footer
+  constexpr int bm = 60;
+  if (sh > bm + 30) {
+    clippedLine(renderer, 10, sh - bm, sw - 10, sh - bm, !darkMode);
+    drawClippedText(renderer, FONT_SMALL, 20, sh - bm + 12,
+                    "Arrows:Navigate  Enter:Change  Esc:Back", 0, !darkMode);
   }
+}
+
+void drawSettingsMenu(GfxRenderer& renderer, HalGPIO& gpio) {
+  screenCacheDraw(renderer, CachedScreen::SETTINGS, drawSettingsBase);
+  int sw = renderer.getScreenWidth();
+  int sh = renderer.getScreenHeight();
+
+  drawBattery(renderer, gpio);
 
+  int lineH = settingsLineHeight(sh);
   for (int i = 0; i < SETTINGS_COUNT; i++) {
-    int yPos = listTop + (i * lineH);
+    int yPos = SETTINGS_LIST_TOP + (i * lineH);
     bool sel = (i == settingsSelection);
 
     if (sel) {
+      drawClippedText(renderer, FONT_UI, 15, yPos, SETTINGS_LABELS[i], sw / 2 - 15, darkMode);  // Un-draw cached label
       clippedFillRect(renderer, 5, yPos - 5, sw - 10, lineH - 6, !darkMode);
-      drawClippedText(renderer, FONT_UI, 15, yPos, labels[i], sw / 2 - 15, darkMode);
-    } else {
-      drawClippedText(renderer, FONT_UI, 15, yPos, labels[i], sw / 2 - 15, !darkMode);
+      drawClippedText(renderer, FONT_UI, 15, yPos, SETTINGS_LABELS[i], sw / 2 - 15, darkMode);
     }
 
     // Value on the right
@@ -517,12 +636,36 @@ void drawSettingsMenu(GfxRenderer& renderer, HalGPIO& gpio) {
         case WritingMode::PAGINATION: strcpy(val, "Pagination"); break;
       }
     } else if (i == 4) {
-      std::string storedAddr, storedName;
-      if (getStoredDevice(storedAddr, storedName)) {
-        snprintf(val, sizeof(val), "%s", storedName.c_str());
-      } else {
+      // Keyboard in use (or the one reconnects try first), and its place among the saved ones
+      int count = getKeyboardProfileCount();
+      std::string current = getCurrentDeviceAddress();
+      std::string addr, name;
+      int index = 0;
+      for (int k = 0; k < count; k++) {
+        if (getKeyboardProfile(k, addr, name) && addr == current) {
+          index = k;
+          break;
+        }
+      }
+      if (count == 0) {
         strcpy(val, "None");
+      } else if (getKeyboardProfile(index, addr, name)) {
+        snprintf(val, sizeof(val), count > 1 ? "%.20s (%d/%d)" : "%.20s", name.c_str(), index + 1, count);
       }
+    } else if (i == 5) {
+      int count = getKeyboardProfileCount();
+      if (count > 0) snprintf(val, sizeof(val), "%d saved", count);
+    } else if (i == 7 && getConnectionState() == BLEState::CONNECTED) {
+      const ConnTunerStats& ts = connTunerStats();
+      snprintf(val, sizeof(val), "%s", ts.idle ? "Idle" : "Active");
+    } else if (i == 8) {
+      snprintf(val, sizeof(val), "%lu ms",
+               static_cast<unsigned long>(bootPhaseTiming(BootPhase::FIRST_FRAME).endMs));
+    } else if (i == 9) {
+      EnergyReport er;
+      energyReport(er);
+      unsigned long uah = static_cast<unsigned long>(er.mahPerHour * 1000.0f);
+      snprintf(val, sizeof(val), "%lu.%02lu mAh/h", uah / 1000, uah % 1000 / 10);
     }
 
     if (val[0] != '\0') {
@@ -530,14 +673,6 @@ void drawSettingsMenu(GfxRenderer& renderer, HalGPIO& gpio) {
     }
   }
 
-  // Footer
-  constexpr int bm = 60;
-  if (sh > bm + 30) {
-    clippedLine(renderer, 10, sh - bm, sw - 10, sh - bm, !darkMode);
-    drawClippedText(renderer, FONT_SMALL, 20, sh - bm + 12,
-                    "Arrows:Navigate  Enter:Change  Esc:Back", 0, !darkMode);
-  }
-
   renderer.displayBuffer(HalDisplay::FAST_REFRESH);
 }
 
@@ -674,6 +809,237 @@ void drawBluetoothSettings(GfxRenderer& renderer, HalGPIO& gpio) {
   renderer.displayBuffer(HalDisplay::FAST_REFRESH);
 }
 
+void drawBleDiagnostics(GfxRenderer& renderer, HalGPIO& gpio) {
+  int sw = renderer.getScreenWidth();
+  int sh = renderer.getScreenHeight();
+
+  renderer.clearScreen();
+  bool tc = !darkMode;
+
+  if (darkMode) clippedFillRect(renderer, 0, 0, sw, sh, true);
+
+  // Header
+  drawClippedText(renderer, FONT_SMALL, 10, 5, "BLE Diagnostics", 0, tc, EpdFontFamily::BOLD);
+  drawBattery(renderer, gpio);
+  clippedLine(renderer, 5, 32, sw - 5, 32, tc);
+
+  const ConnTunerStats& ts = connTunerStats();
+  bool connected = getConnectionState() == BLEState::CONNECTED;
+  char line[64];
+  int y = 45;
+  constexpr int lineH = 22;
+
+  if (!connected) {
+    drawClippedText(renderer, FONT_SMALL, 10, y, "Not connected (showing last session)", 0, tc);
+    y += lineH;
+  }
+
+  // Mode and intervals (1.25 ms units → ms)
+  snprintf(line, sizeof(line), "Mode: %s   Interval: %u.%02u ms", ts.idle ? "Idle" : "Active",
+           ts.actualInterval * 125 / 100, ts.actualInterval * 125 % 100);
+  drawClippedText(renderer, FONT_SMALL, 10, y, line, 0, tc);
+  y += lineH;
+  snprintf(line, sizeof(line), "Requested: %u-%u ms, latency %u", ts.requested.intervalMin * 125 / 100,
+           ts.requested.intervalMax * 125 / 100, ts.requested.latency);
+  drawClippedText(renderer, FONT_SMALL, 10, y, line, 0, tc);
+  y += lineH;
+
+  // Chosen policy
+  snprintf(line, sizeof(line), "Typing: %u ms, latency %u", ts.activeParams.intervalMax * 125 / 100,
+           ts.activeParams.latency);
+  drawClippedText(renderer, FONT_SMALL, 10, y, line, 0, tc);
+  y += lineH;
+  if (ts.idleThresholdMs == 0) {
+    snprintf(line, sizeof(line), "Idle after: never (misses latency target)");
+  } else {
+    snprintf(line, sizeof(line), "Idle after: %lu ms at %u ms", static_cast<unsigned long>(ts.idleThresholdMs),
+             ts.idleParams.intervalMax * 125 / 100);
+  }
+  drawClippedText(renderer, FONT_SMALL, 10, y, line, 0, tc);
+  y += lineH;
+  snprintf(line, sizeof(line), "Typing gap p50 %lu ms, p90 %lu ms", static_cast<unsigned long>(ts.gapP50Ms),
+           static_cast<unsigned long>(ts.gapP90Ms));
+  drawClippedText(renderer, FONT_SMALL, 10, y, line, 0, tc);
+  y += lineH;
+  snprintf(line, sizeof(line), "Switch back: %lu ms   Updates: %lu", static_cast<unsigned long>(ts.switchBackMs),
+           static_cast<unsigned long>(ts.updates));
+  drawClippedText(renderer, FONT_SMALL, 10, y, line, 0, tc);
+  y += lineH + 8;
+
+  // Measured: how long after its connection event each report reached us
+  snprintf(line, sizeof(line), "Notify delay (%lu reports, %lu keys)", static_cast<unsigned long>(ts.notifies),
+           static_cast<unsigned long>(ts.keystrokes));
+  drawClippedText(renderer, FONT_SMALL, 10, y, line, 0, tc, EpdFontFamily::BOLD);
+  y += lineH;
+  snprintf(line, sizeof(line), "p50 %lu.%lu ms, p95 %lu.%lu ms, jitter %lu.%lu ms",
+           static_cast<unsigned long>(ts.delayP50Us / 1000), static_cast<unsigned long>(ts.delayP50Us % 1000 / 100),
+           static_cast<unsigned long>(ts.delayP95Us / 1000), static_cast<unsigned long>(ts.delayP95Us % 1000 / 100),
+           static_cast<unsigned long>(ts.jitterUs / 1000), static_cast<unsigned long>(ts.jitterUs % 1000 / 100));
+  drawClippedText(renderer, FONT_SMALL, 10, y, line, 0, tc);
+  y += lineH;
+  static const char* bucketLabels[TUNER_DELAY_BUCKETS] = {
+    "<=1ms", "<=2ms", "<=4ms", "<=8ms", "<=16ms", ">16ms"
+  };
+  int barX = 90;
+  int barMaxW = sw - barX - 60;
+  for (int i = 0; i < TUNER_DELAY_BUCKETS && y < sh - 80; i++) {
+    uint32_t pct = ts.notifies ? ts.delayCounts[i] * 100 / ts.notifies : 0;
+    drawClippedText(renderer, FONT_SMALL, 10, y, bucketLabels[i], barX - 15, tc);
+    int w = barMaxW * static_cast<int>(pct) / 100;
+    if (w > 0) clippedFillRect(renderer, barX, y + 3, w, 12, tc);
+    snprintf(line, sizeof(line), "%lu%%", static_cast<unsigned long>(pct));
+    drawRightText(renderer, FONT_SMALL, sw - 10, y, line, tc);
+    y += lineH;
+  }
+
+  // Footer
+  constexpr int bm = 60;
+  if (sh > bm + 30) {
+    clippedLine(renderer, 10, sh - bm, sw - 10, sh - bm, tc);
+    drawClippedText(renderer, FONT_SMALL, 20, sh - bm + 12, "Esc:Back", 0, tc);
+  }
+
+  renderer.displayBuffer(HalDisplay::FAST_REFRESH);
+}
+
+void drawBootProfile(GfxRenderer& renderer, HalGPIO& gpio) {
+  int sw = renderer.getScreenWidth();
+  int sh = renderer.getScreenHeight();
+
+  renderer.clearScreen();
+  bool tc = !darkMode;
+
+  if (darkMode) clippedFillRect(renderer, 0, 0, sw, sh, true);
+
+  // Header
+  drawClippedText(renderer, FONT_SMALL, 10, 5, "Boot Profile", 0, tc, EpdFontFamily::BOLD);
+  drawBattery(renderer, gpio);
+  clippedLine(renderer, 5, 32, sw - 5, 32, tc);
+
+  // Timeline scale: everything up to the end of boot (the lazy file list can come much later)
+  uint32_t span = 1;
+  for (int p = 0; p < static_cast<int>(BootPhase::FILE_LIST); p++) {
+    span = std::max(span, bootPhaseTiming(static_cast<BootPhase>(p)).endMs);
+  }
+
+  char line[64];
+  snprintf(line, sizeof(line), "First frame on screen at %lu ms",
+           static_cast<unsigned long>(bootPhaseTiming(BootPhase::FIRST_FRAME).endMs));
+  drawClippedText(renderer, FONT_SMALL, 10, 45, line, 0, tc);
+
+  constexpr int lineH = 30;
+  constexpr int nameW = 100;
+  constexpr int durW = 70;
+  int barX = 10 + nameW;
+  int barW = sw - barX - durW - 10;
+  int y = 80;
+  for (int p = 0; p < static_cast<int>(BootPhase::COUNT) && y < sh - 80; p++, y += lineH) {
+    BootPhase phase = static_cast<BootPhase>(p);
+    const BootPhaseTiming& t = bootPhaseTiming(phase);
+    drawClippedText(renderer, FONT_SMALL, 10, y, bootPhaseName(phase), nameW - 5, tc);
+    if (t.endMs == 0) {
+      drawRightText(renderer, FONT_SMALL, sw - 10, y, phase == BootPhase::FILE_LIST ? "not yet" : "-", tc);
+      continue;
+    }
+    if (phase != BootPhase::FILE_LIST) {
+      // Bar from start to end on the boot timeline (at least 2px so short phases show)
+      int x0 = barX + static_cast<int>(static_cast<uint64_t>(t.startMs) * barW / span);
+      int x1 = barX + static_cast<int>(static_cast<uint64_t>(t.endMs) * barW / span);
+      clippedFillRect(renderer, x0, y + 3, std::max(2, x1 - x0), 12, tc);
+    } else {
+      snprintf(line, sizeof(line), "at %lu ms", static_cast<unsigned long>(t.startMs));
+      drawClippedText(renderer, FONT_SMALL, barX, y, line, barW, tc);
+    }
+    snprintf(line, sizeof(line), "%lu ms", static_cast<unsigned long>(t.endMs - t.startMs));
+    drawRightText(renderer, FONT_SMALL, sw - 10, y, line, tc);
+  }
+
+  // Footer
+  constexpr int bm = 60;
+  if (sh > bm + 30) {
+    clippedLine(renderer, 10, sh - bm, sw - 10, sh - bm, tc);
+    drawClippedText(renderer, FONT_SMALL, 20, sh - bm + 12, "Esc:Back", 0, tc);
+  }
+
+  renderer.displayBuffer(HalDisplay::FAST_REFRESH);
+}
+
+// mAh with three decimals, without pulling float formatting into printf
+static void formatMah(char* out, size_t size, float mah) {
+  unsigned long uah = static_cast<unsigned long>(mah * 1000.0f + 0.5f);
+  snprintf(out, size, "%lu.%03lu mAh", uah / 1000, uah % 1000);
+}
+
+void drawEnergyReport(GfxRenderer& renderer, HalGPIO& gpio) {
+  int sw = renderer.getScreenWidth();
+  int sh = renderer.getScreenHeight();
+
+  renderer.clearScreen();
+  bool tc = !darkMode;
+
+  if (darkMode) clippedFillRect(renderer, 0, 0, sw, sh, true);
+
+  // Header
+  drawClippedText(renderer, FONT_SMALL, 10, 5, "Energy", 0, tc, EpdFontFamily::BOLD);
+  drawBattery(renderer, gpio);
+  clippedLine(renderer, 5, 32, sw - 5, 32, tc);
+
+  EnergyReport er;
+  energyReport(er);
+  char line[64];
+  char mah[24];
+  int y = 45;
+  constexpr int lineH = 22;
+
+  unsigned long minutes = er.elapsedMs / 60000;
+  snprintf(line, sizeof(line), "Since boot: %luh %02lum, %lu keystrokes", minutes / 60, minutes % 60,
+           static_cast<unsigned long>(er.keystrokes));
+  drawClippedText(renderer, FONT_SMALL, 10, y, line, 0, tc);
+  y += lineH;
+  formatMah(mah, sizeof(mah), er.mahPerHour);
+  snprintf(line, sizeof(line), "Average: %s per hour", mah);
+  drawClippedText(renderer, FONT_SMALL, 10, y, line, 0, tc);
+  y += lineH;
+  if (er.keystrokes > 0) {
+    formatMah(mah, sizeof(mah), er.mahPerKiloKeys);
+    snprintf(line, sizeof(line), "Per 1000 keystrokes: %s", mah);
+  } else {
+    snprintf(line, sizeof(line), "Per 1000 keystrokes: no typing yet");
+  }
+  drawClippedText(renderer, FONT_SMALL, 10, y, line, 0, tc);
+  y += lineH + 8;
+
+  // Share of the total by subsystem
+  formatMah(mah, sizeof(mah), er.totalMah);
+  snprintf(line, sizeof(line), "Estimated use: %s", mah);
+  drawClippedText(renderer, FONT_SMALL, 10, y, line, 0, tc, EpdFontFamily::BOLD);
+  y += lineH;
+  constexpr int nameW = 120;
+  constexpr int valW = 100;
+  int barX = 10 + nameW;
+  int barMaxW = sw - barX - valW - 10;
+  for (int i = 0; i < static_cast<int>(EnergyRail::COUNT) && y < sh - 80; i++, y += lineH) {
+    drawClippedText(renderer, FONT_SMALL, 10, y, energyRailName(static_cast<EnergyRail>(i)), nameW - 5, tc);
+    int w = er.totalMah > 0 ? static_cast<int>(barMaxW * er.railMah[i] / er.totalMah) : 0;
+    if (w > 0) clippedFillRect(renderer, barX, y + 3, w, 12, tc);
+    formatMah(mah, sizeof(mah), er.railMah[i]);
+    drawRightText(renderer, FONT_SMALL, sw - 10, y, mah, tc);
+  }
+  if (y < sh - 80) {
+    snprintf(line, sizeof(line), "BLE: %lu connection events", static_cast<unsigned long>(er.bleEvents));
+    drawClippedText(renderer, FONT_SMALL, 10, y + 8, line, 0, tc);
+  }
+
+  // Footer
+  constexpr int bm = 60;
+  if (sh > bm + 30) {
+    clippedLine(renderer, 10, sh - bm, sw - 10, sh - bm, tc);
+    drawClippedText(renderer, FONT_SMALL, 20, sh - bm + 12, "Esc:Back", 0, tc);
+  }
+
+  renderer.displayBuffer(HalDisplay::FAST_REFRESH);
+}
+
 // Helper: draw signal strength indicator (1-4 bars)
 static void drawSignalBars(GfxRenderer& r, int x, int y, int rssi, bool color) {
   // RSSI to bars: > -50 = 4, > -65 = 3, > -75 = 2, else 1
@@ -857,3 +1223,130 @@ void drawSyncScreen(GfxRenderer& renderer, HalGPIO& gpio) {
 
   renderer.displayBuffer(HalDisplay::FAST_REFRESH);
 }
+
+// Helper: display title for a note filename, written to `out` (falls back to the
+// filename itself for notes not in the list)
+static const char* titleForFile(const char* filename, char* out) {
+  FileInfo* files = getFileList();
+  int fc = getFileCount();
+  for (int i = 0; i < fc; i++) {
+    if (strcmp(files[i].filename, filename) == 0) {
+      filenameToTitle(filename, out, MAX_TITLE_LEN);
+      return out;
+    }
+  }
+  return filename;
+}
+
+void drawSearchScreen(GfxRenderer& renderer, HalGPIO& gpio) {
+  renderer.clearScreen();
+  int sw = renderer.getScreenWidth();
+  int sh = renderer.getScreenHeight();
+  bool tc = !darkMode;
+
+  if (darkMode) clippedFillRect(renderer, 0, 0, sw, sh, true);
+
+  // Header
+  drawClippedText(renderer, FONT_SMALL, 10, 5, "Search Notes", 0, tc, EpdFontFamily::BOLD);
+  drawBattery(renderer, gpio);
+  clippedLine(renderer, 5, 32, sw - 5, 32, tc);
+
+  // Query box (same layout as the title edit screen)
+  int boxY = 42, boxH = 36;
+  int textY = boxY + 8;
+  renderer.drawRect(15, boxY, sw - 30, boxH, tc);
+  drawClippedText(renderer, FONT_UI, 20, textY, searchQuery, sw - 50, tc);
+  int cursorX = 20 + renderer.getTextAdvanceX(FONT_UI, searchQuery);
+  if (cursorX + 2 < sw - 15)
+    renderer.fillRect(cursorX, textY, 2, 16, tc);
+
+  int lineH = 30;
+  int listTop = boxY + boxH + 14;
+  int footerH = 28;
+
+  if (searchHitCount == 0) {
+    drawClippedText(renderer, FONT_UI, 20, listTop, "No matching notes.", 0, tc);
+  } else if (searchHitCount > 0) {
+    int maxVisible = (sh - listTop - footerH) / lineH;
+    int startIdx = 0;
+    if (searchHitCount > maxVisible && searchSelection >= maxVisible) {
+      startIdx = searchSelection - maxVisible + 1;
+    }
+
+    char title[MAX_TITLE_LEN];
+    for (int i = startIdx; i < searchHitCount && (i - startIdx) < maxVisible; i++) {
+      int yPos = listTop + (i - startIdx) * lineH;
+      bool sel = (i == searchSelection);
+      char countStr[16];
+      snprintf(countStr, sizeof(countStr), "x%lu", (unsigned long)searchHits[i].score);
+
+      if (sel) clippedFillRect(renderer, 5, yPos - 3, sw - 10, lineH - 1, tc);
+      drawClippedText(renderer, FONT_UI, 15, yPos, titleForFile(searchHits[i].filename, title), sw - 80,
+                      sel ? !tc : tc);
+      drawRightText(renderer, FONT_SMALL, sw - 15, yPos + 2, countStr, sel ? !tc : tc);
+    }
+  }
+
+  // Footer
+  clippedLine(renderer, 5, sh - footerH - 2, sw - 5, sh - footerH - 2, tc);
+  drawClippedText(renderer, FONT_SMALL, 10, sh - footerH + 4,
+                  "Enter:Search/Open  Esc:Back", 0, tc);
+
+  renderer.displayBuffer(HalDisplay::FAST_REFRESH);
+}
+
+void drawHistoryScreen(GfxRenderer& renderer, HalGPIO& gpio) {
+  renderer.clearScreen();
+  int sw = renderer.getScreenWidth();
+  int sh = renderer.getScreenHeight();
+  bool tc = !darkMode;
+
+  if (darkMode) clippedFillRect(renderer, 0, 0, sw, sh, true);
+
+  // Header
+  char header[64];
+  char title[MAX_TITLE_LEN];
+  snprintf(header, sizeof(header), "History: %s", titleForFile(historyFile, title));
+  drawClippedText(renderer, FONT_SMALL, 10, 5, header, sw - 80, tc, EpdFontFamily::BOLD);
+  drawBattery(renderer, gpio);
+  clippedLine(renderer, 5, 32, sw - 5, 32, tc);
+
+  int lineH = 30;
+  int listTop = 42;
+  int footerH = 28;
+
+  if (historyCount == 0) {
+    drawClippedText(renderer, FONT_UI, 20, listTop, "No saved versions yet.", 0, tc);
+  } else {
+    int maxVisible = (sh - listTop - footerH) / lineH;
+    int startIdx = 0;
+    if (historyCount > maxVisible && historySelection >= maxVisible) {
+      startIdx = historySelection - maxVisible + 1;
+    }
+
+    for (int i = startIdx; i < historyCount && (i - startIdx) < maxVisible; i++) {
+      const HistoryVersion& v = historyVersions[i];
+      int yPos = listTop + (i - startIdx) * lineH;
+      bool sel = (i == historySelection);
+
+      char label[24];
+      snprintf(label, sizeof(label), i == 0 ? "v%u (latest)" : "v%u", v.number);
+      char detail[32];
+      if (v.keyframe) {
+        snprintf(detail, sizeof(detail), "%lu B, full", (unsigned long)v.textLen);
+      } else {
+        snprintf(detail, sizeof(detail), "%lu B, +%lu", (unsigned long)v.textLen, (unsigned long)v.storedLen);
+      }
+
+      if (sel) clippedFillRect(renderer, 5, yPos - 3, sw - 10, lineH - 1, tc);
+      drawClippedText(renderer, FONT_UI, 15, yPos, label, sw / 2 - 15, sel ? !tc : tc);
+      drawRightText(renderer, FONT_SMALL, sw - 15, yPos + 2, detail, sel ? !tc : tc);
+    }
+  }
+
+  // Footer
+  clippedLine(renderer, 5, sh - footerH - 2, sw - 5, sh - footerH - 2, tc);
+  drawClippedText(renderer, FONT_SMALL, 10, sh - footerH + 4, "Enter:Restore  Esc:Back", 0, tc);
+
+  renderer.displayBuffer(HalDisplay::FAST_REFRESH);
+}
@@ -7,7 +7,14 @@ void rendererSetup(GfxRenderer& renderer);
 void drawMainMenu(GfxRenderer& renderer, HalGPIO& gpio);
 void drawFileBrowser(GfxRenderer& renderer, HalGPIO& gpio);
 void drawTextEditor(GfxRenderer& renderer, HalGPIO& gpio);
+// Next main menu / editor frame uses a full refresh (first frame after power-on)
+void requestFullRefresh();
 void drawRenameScreen(GfxRenderer& renderer, HalGPIO& gpio);
 void drawSettingsMenu(GfxRenderer& renderer, HalGPIO& gpio);
 void drawBluetoothSettings(GfxRenderer& renderer, HalGPIO& gpio);
+void drawBleDiagnostics(GfxRenderer& renderer, HalGPIO& gpio);
+void drawBootProfile(GfxRenderer& renderer, HalGPIO& gpio);
+void drawEnergyReport(GfxRenderer& renderer, HalGPIO& gpio);
 void drawSyncScreen(GfxRenderer& renderer, HalGPIO& gpio);
+void drawSearchScreen(GfxRenderer& renderer, HalGPIO& gpio);
+void drawHistoryScreen(GfxRenderer& renderer, HalGPIO& gpio);
@@ -1,6 +1,10 @@
 #include "wifi_sync.h"
 #include "config.h"
 #include "file_manager.h"
+#include "note_manifest.h"
+#include "gzip_stream.h"
+#include "energy_meter.h"
+#include "loop_events.h"
 
 #include <Arduino.h>
 #include <WiFi.h>
@@ -44,9 +48,25 @@ static void saveCredential(const char* ssid, const char* pass);
 static void forgetCredential(const char* ssid);
 static bool getFirstSavedCredential(char* ssidBuf, int ssidBufSize, char* passBuf, int passBufSize);
 
+// Last successful association per saved network ("wifi_fast_<slot>"), so reconnecting can
+// skip the channel scan. Addressing still comes from DHCP: a reused lease could collide
+// with another host once it has expired. Rewritten by a full connect whenever it goes stale.
+struct FastConnectInfo {
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t reserved;
+};
+static bool loadFastConnect(const char* ssid, FastConnectInfo& info);
+static void saveFastConnect(const char* ssid);
+
 // --- Connecting state ---
 static unsigned long connectStartMs = 0;
+static unsigned long syncPressedMs = 0;
 static char connectingSSID[33] = "";
+static char connectingPass[MAX_PASSWORD_LEN + 1] = "";  // Kept for the fast-connect fallback
+static bool fastConnecting = false;  // Trying the cached BSSID / channel
+static constexpr unsigned long FAST_CONNECT_TIMEOUT_MS = 6000;  // Association plus DHCP
+static constexpr unsigned long CONNECT_TIMEOUT_MS = 15000;
 static bool usedSavedPassword = false;
 static bool autoConnectAttempted = false;  // True if we tried auto-connect with saved creds
 
@@ -56,11 +76,23 @@ static int filesReceived = 0;   // Files uploaded by PC (POST)
 
 static constexpr int MAX_LOG_LINES = 6;
 static char syncLog[MAX_LOG_LINES][48];
+static portMUX_TYPE syncLogMux = portMUX_INITIALIZER_UNLOCKED;  // Written by the server task, drawn by loop()
 static int syncLogCount = 0;
 
-static unsigned long lastHttpActivityMs = 0;
+static volatile unsigned long lastHttpActivityMs = 0;
+static bool manifestOpen = false;  // Manifest lookup session, held until the server stops
 static constexpr unsigned long SYNC_TIMEOUT_MS = 60000;  // 60s no HTTP → auto-disconnect
 
+// --- Server task ---
+// The HTTP server runs on its own task so transfers aren't paced by loop() (BLE, input,
+// rendering and its 10-50 ms delay). The task owns `server`. The SD card is shared with
+// loop() one operation at a time (see SDCardManager::lock), so neither side waits on the
+// other's network I/O. serverTaskStop is a plain flag: a transfer sees a cancel at its
+// next chunk however busy the card is.
+static TaskHandle_t serverTaskHandle = nullptr;
+static volatile bool serverTaskStop = false;
+static volatile bool syncCompleteRequested = false;  // Set by the task, acted on by loop()
+
 // --- DONE state ---
 static unsigned long doneStartMs = 0;
 static constexpr unsigned long DONE_DISPLAY_MS = 3000;  // 3s before returning to menu
@@ -85,17 +117,20 @@ static void resetSyncTracking() {
 }
 
 static void addSyncLogEntry(const char* fmt, const char* filename) {
+  char line[sizeof(syncLog[0])];
+  snprintf(line, sizeof(line), fmt, filename);
+
+  taskENTER_CRITICAL(&syncLogMux);
   // Shift entries up if full
   if (syncLogCount >= MAX_LOG_LINES) {
-    for (int i = 0; i < MAX_LOG_LINES - 1; i++) {
-      strncpy(syncLog[i], syncLog[i + 1], sizeof(syncLog[i]) - 1);
-      syncLog[i][sizeof(syncLog[i]) - 1] = '\0';
-    }
+    memmove(syncLog[0], syncLog[1], sizeof(syncLog) - sizeof(syncLog[0]));
     syncLogCount = MAX_LOG_LINES - 1;
   }
-  snprintf(syncLog[syncLogCount], sizeof(syncLog[syncLogCount]), fmt, filename);
+  memcpy(syncLog[syncLogCount], line, sizeof(line));
   syncLogCount++;
+  taskEXIT_CRITICAL(&syncLogMux);
   screenDirty = true;
+  loopPost(LoopEvent::SCREEN);
 }
 
 // =========================================================================
@@ -153,6 +188,60 @@ static bool getFirstSavedCredential(char* ssidBuf, int ssidBufSize, char* passBu
   return true;
 }
 
+static int findSavedSlot(const char* ssid) {
+  int count = wifiPrefs.getInt("wifi_count", 0);
+  for (int i = 0; i < count && i < MAX_SAVED_NETWORKS; i++) {
+    char sKey[16];
+    snprintf(sKey, sizeof(sKey), "wifi_ssid_%d", i);
+    String savedSSID = wifiPrefs.getString(sKey, "");
+    if (savedSSID.length() > 0 && strcmp(savedSSID.c_str(), ssid) == 0) return i;
+  }
+  return -1;
+}
+
+// Move slot `src`'s fast-connect record to slot `dst`; src -1 just clears dst
+static void moveFastConnect(int dst, int src) {
+  char srcKey[16], dstKey[16];
+  snprintf(srcKey, sizeof(srcKey), "wifi_fast_%d", src);
+  snprintf(dstKey, sizeof(dstKey), "wifi_fast_%d", dst);
+  FastConnectInfo info;
+  if (src >= 0 && wifiPrefs.isKey(srcKey) && wifiPrefs.getBytes(srcKey, &info, sizeof(info)) == sizeof(info)) {
+    wifiPrefs.putBytes(dstKey, &info, sizeof(info));
+  } else if (wifiPrefs.isKey(dstKey)) {
+    wifiPrefs.remove(dstKey);
+  }
+}
+
+static bool loadFastConnect(const char* ssid, FastConnectInfo& info) {
+  int slot = findSavedSlot(ssid);
+  if (slot < 0) return false;
+  char key[16];
+  snprintf(key, sizeof(key), "wifi_fast_%d", slot);
+  return wifiPrefs.isKey(key) && wifiPrefs.getBytes(key, &info, sizeof(info)) == sizeof(info) &&
+         info.channel > 0;
+}
+
+// Record the current association for a saved network. NVS is only written on change.
+static void saveFastConnect(const char* ssid) {
+  int slot = findSavedSlot(ssid);
+  if (slot < 0) return;
+  FastConnectInfo info = {};
+  const uint8_t* bssid = WiFi.BSSID();
+  if (!bssid) return;
+  memcpy(info.bssid, bssid, sizeof(info.bssid));
+  info.channel = WiFi.channel();
+
+  char key[16];
+  snprintf(key, sizeof(key), "wifi_fast_%d", slot);
+  FastConnectInfo old;
+  if (wifiPrefs.isKey(key) && wifiPrefs.getBytes(key, &old, sizeof(old)) == sizeof(old) &&
+      memcmp(&old, &info, sizeof(info)) == 0) {
+    return;
+  }
+  wifiPrefs.putBytes(key, &info, sizeof(info));
+  DBG_PRINTF("[SYNC] Fast-connect record saved: channel %d\n", info.channel);
+}
+
 static void saveCredential(const char* ssid, const char* pass) {
   int count = wifiPrefs.getInt("wifi_count", 0);
 
@@ -175,6 +264,7 @@ static void saveCredential(const char* ssid, const char* pass) {
   snprintf(pKey, sizeof(pKey), "wifi_pass_%d", slot);
   wifiPrefs.putString(sKey, ssid);
   wifiPrefs.putString(pKey, pass);
+  moveFastConnect(slot, -1);  // Drop the replaced network's record
   if (count < MAX_SAVED_NETWORKS) {
     wifiPrefs.putInt("wifi_count", count + 1);
   }
@@ -196,6 +286,7 @@ static void forgetCredential(const char* ssid) {
         snprintf(dstP, sizeof(dstP), "wifi_pass_%d", j);
         wifiPrefs.putString(dstS, wifiPrefs.getString(srcS, ""));
         wifiPrefs.putString(dstP, wifiPrefs.getString(srcP, ""));
+        moveFastConnect(j, j + 1);
       }
       // Clear last slot
       int lastIdx = count - 1;
@@ -205,6 +296,7 @@ static void forgetCredential(const char* ssid) {
       wifiPrefs.remove(lastS);
       wifiPrefs.remove(lastP);
       wifiPrefs.putInt("wifi_count", count - 1);
+      moveFastConnect(lastIdx, -1);
       return;
     }
   }
@@ -300,25 +392,52 @@ static void processScanResults() {
 // Connection
 // =========================================================================
 
+// Full association: channel scan, then DHCP
+static void beginFullConnect() {
+  fastConnecting = false;
+  WiFi.begin(connectingSSID, connectingPass);
+}
+
 static void beginConnect(const char* ssid, const char* pass) {
   strncpy(connectingSSID, ssid, 32);
   connectingSSID[32] = '\0';
+  if (pass != connectingPass) {
+    strncpy(connectingPass, pass, MAX_PASSWORD_LEN);
+    connectingPass[MAX_PASSWORD_LEN] = '\0';
+  }
   syncState = SyncState::CONNECTING;
   snprintf(statusText, sizeof(statusText), "Connecting to %s...", ssid);
   connectStartMs = millis();
 
   WiFi.disconnect(true);
   delay(50);
-  WiFi.begin(ssid, pass);
+  // Saved network with a cached association: join the known AP on its channel (no scan),
+  // then DHCP as usual. Falls back to the full path.
+  FastConnectInfo fast;
+  if (usedSavedPassword && loadFastConnect(ssid, fast)) {
+    fastConnecting = true;
+    WiFi.begin(ssid, pass, fast.channel, fast.bssid);
+    DBG_PRINTF("[SYNC] Fast-connecting to %s (channel %d)\n", ssid, fast.channel);
+  } else {
+    beginFullConnect();
+    DBG_PRINTF("[SYNC] Connecting to %s\n", ssid);
+  }
   screenDirty = true;
-  DBG_PRINTF("[SYNC] Connecting to %s\n", ssid);
 }
 
 static void enterSyncingState() {
   resetSyncTracking();
+  if (!fastConnecting) saveFastConnect(connectingSSID);
   startHttpServer();
-  snprintf(statusText, sizeof(statusText), "%s",
-           WiFi.localIP().toString().c_str());
+  // Sync pressed → server listening, shown when no prompt was in between
+  if (autoConnectAttempted) {
+    unsigned long readyMs = millis() - syncPressedMs;
+    snprintf(statusText, sizeof(statusText), "%s  (%lu.%lus%s)", WiFi.localIP().toString().c_str(),
+             readyMs / 1000, (readyMs % 1000) / 100, fastConnecting ? ", fast" : "");
+  } else {
+    snprintf(statusText, sizeof(statusText), "%s",
+             WiFi.localIP().toString().c_str());
+  }
   syncState = SyncState::SYNCING;
   lastHttpActivityMs = millis();
   screenDirty = true;
@@ -329,6 +448,7 @@ static void enterDoneState() {
   stopHttpServer();
   WiFi.disconnect(true);
   WiFi.mode(WIFI_OFF);
+  energyWifi(false);
 
   syncState = SyncState::DONE;
   doneStartMs = millis();
@@ -357,7 +477,17 @@ static void pollConnection() {
     return;
   }
 
-  if (millis() - connectStartMs > 15000) {
+  if (fastConnecting && millis() - connectStartMs > FAST_CONNECT_TIMEOUT_MS) {
+    // AP moved channel, was replaced, or is out of range: scan like a first connect
+    DBG_PRINTLN("[SYNC] Fast connect timed out — falling back to full connect");
+    WiFi.disconnect(true);
+    delay(50);
+    connectStartMs = millis();
+    beginFullConnect();
+    return;
+  }
+
+  if (millis() - connectStartMs > CONNECT_TIMEOUT_MS) {
     WiFi.disconnect(true);
     strcpy(statusText, "Connection failed");
 
@@ -379,45 +509,142 @@ static void pollConnection() {
 // HTTP Server
 // =========================================================================
 
+// A plain note filename: "<name>.txt", no path separators, not hidden
+static bool validNoteName(const char* name, size_t maxLen) {
+  size_t len = strlen(name);
+  return name[0] != '.' && len > 4 && len < maxLen && strcmp(name + len - 4, ".txt") == 0
+         && !strchr(name, '/') && !strchr(name, '\\');
+}
+
+// Content hash of a note from the manifest, as 16 hex digits. False if unavailable
+// (the client then falls back to comparing sizes) or `name` isn't a note.
+static bool noteHashHex(const char* name, uint32_t size, uint16_t modDate, uint16_t modTime, char* out) {
+  if (!validNoteName(name, MAX_FILENAME_LEN)) return false;
+  if (!manifestOpen) manifestOpen = noteManifestBegin();
+  ManifestNote note;
+  if (!manifestOpen || !noteManifestLookup(name, size, modDate, modTime, note)) return false;
+  snprintf(out, 17, "%016llx", (unsigned long long)note.hash);
+  return true;
+}
+
+// --- File listing (/api/files) ---
+// Served from the manifest and streamed in HTTP chunks from a fixed buffer, so memory
+// use doesn't grow with the number of notes.
+//   /api/files                          JSON array of every note (original format)
+//   /api/files?limit=N&cursor=C&since=S {"seq","files":[...],"next"} — one page of up to
+//                                       N notes changed after seq S, continuing at C
+// Each note is {"name","size","hash","seq"}.
+
+static char listBuf[1024];
+static size_t listLen = 0;
+
+// Heap cost of one full listing (session table plus streaming), shown in the sync log
+static uint32_t listHeapBase = 0;
+static uint32_t listHeapLow = 0;
+static int listTotal = 0;
+
+static void listFlush() {
+  if (listLen > 0) server->sendContent(listBuf, listLen);
+  listLen = 0;
+}
+
+static void listPut(const char* text) {
+  size_t len = strlen(text);
+  if (listLen + len > sizeof(listBuf)) listFlush();
+  memcpy(listBuf + listLen, text, len);
+  listLen += len;
+}
+
 static void handleFileList() {
   lastHttpActivityMs = millis();
+  [[maybe_unused]] unsigned long startMs = millis();
 
-  auto dir = SdMan.open("/notes");
-  if (!dir || !dir.isDirectory()) {
-    if (dir) dir.close();
+  uint32_t heapStart = ESP.getFreeHeap();
+  if (!manifestOpen) manifestOpen = noteManifestBegin();
+  if (!manifestOpen) {
     server->send(500, "application/json", "[]");
     return;
   }
 
-  String json = "[";
-  bool first = true;
-  char name[256];
-
-  dir.rewindDirectory();
-  for (auto file = dir.openNextFile(); file; file = dir.openNextFile()) {
-    file.getName(name, sizeof(name));
-    if (name[0] == '.') { file.close(); continue; }
-
-    int nameLen = strlen(name);
-    if (nameLen > 4 && strcmp(name + nameLen - 4, ".txt") == 0) {
-      if (!first) json += ",";
-      first = false;
-      json += "{\"name\":\"";
-      json += name;
-      json += "\",\"size\":";
-      json += String((unsigned long)file.size());
-      json += "}";
+  bool paged = server->hasArg("limit") || server->hasArg("cursor") || server->hasArg("since");
+  long limit = server->hasArg("limit") ? server->arg("limit").toInt() : 0;  // 0 = no limit
+  int cursor = server->hasArg("cursor") ? server->arg("cursor").toInt() : 0;
+  uint32_t since = server->hasArg("since") ? strtoul(server->arg("since").c_str(), nullptr, 10) : 0;
+
+  if (cursor == 0) {
+    listHeapBase = heapStart;
+    listHeapLow = ESP.getFreeHeap();
+    listTotal = 0;
+  }
+
+  server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server->send(200, "application/json", "");
+  listLen = 0;
+
+  char item[192];
+  if (paged) {
+    snprintf(item, sizeof(item), "{\"seq\":%lu,\"files\":[", (unsigned long)noteManifestSeq());
+    listPut(item);
+  } else {
+    listPut("[");
+  }
+
+  ManifestNote note;
+  int count = 0;
+  while (cursor >= 0 && (limit <= 0 || count < limit)) {
+    cursor = noteManifestNext(cursor, note);
+    if (cursor < 0 || note.seq <= since) continue;
+
+    // Names come from the card, so escape the two characters JSON can't take raw
+    char name[2 * MAX_FILENAME_LEN];
+    int n = 0;
+    for (const char* c = note.filename; *c; c++) {
+      if (*c == '"' || *c == '\\') name[n++] = '\\';
+      name[n++] = *c;
     }
-    file.close();
+    name[n] = '\0';
+
+    snprintf(item, sizeof(item), "%s{\"name\":\"%s\",\"size\":%lu,\"hash\":\"%016llx\",\"seq\":%lu}",
+             count > 0 ? "," : "", name, (unsigned long)note.size, (unsigned long long)note.hash,
+             (unsigned long)note.seq);
+    listPut(item);
+    count++;
+    uint32_t heap = ESP.getFreeHeap();
+    if (heap < listHeapLow) listHeapLow = heap;
+  }
+  listTotal += count;
+
+  if (paged) {
+    if (cursor >= 0) snprintf(item, sizeof(item), "],\"next\":%d}", cursor);
+    else snprintf(item, sizeof(item), "],\"next\":null}");
+    listPut(item);
+  } else {
+    listPut("]");
+  }
+  listFlush();
+  server->sendContent("");  // Last chunk
+
+  DBG_PRINTF("[SYNC] Listed %d notes in %lums, heap %lu low %lu\n", count, millis() - startMs,
+             (unsigned long)heapStart, (unsigned long)listHeapLow);
+  if (cursor < 0) {
+    char text[40];
+    uint32_t used = listHeapBase > listHeapLow ? listHeapBase - listHeapLow : 0;
+    snprintf(text, sizeof(text), "%d notes, %lu KB heap", listTotal, (unsigned long)(used + 1023) / 1024);
+    addSyncLogEntry("Listed %s", text);
   }
-  dir.close();
+}
 
-  json += "]";
-  server->send(200, "application/json", json);
+static constexpr size_t GZIP_MIN_SIZE = 256;
+
+// GzipStream sink / chunked-encoding writer for streamed responses
+static bool sendContentChunk(const uint8_t* data, size_t len, void*) {
+  server->sendContent(reinterpret_cast<const char*>(data), len);
+  return server->client().connected() && !serverTaskStop;  // Abort if sync is cancelled
 }
 
 static void handleFileDownload() {
   lastHttpActivityMs = millis();
+  [[maybe_unused]] unsigned long startMs = millis();
 
   String uri = server->uri();
   if (!uri.startsWith("/notes/") || uri.length() <= 7) {
@@ -425,27 +652,72 @@ static void handleFileDownload() {
     return;
   }
 
+  // Notes only: not the manifest, index, history or .bak files, and no "../"
   String filename = uri.substring(7);
+  if (!validNoteName(filename.c_str(), MAX_FILENAME_LEN)) {
+    server->send(404, "text/plain", "Not found");
+    return;
+  }
   char path[320];
   snprintf(path, sizeof(path), "/notes/%s", filename.c_str());
 
-  auto file = SdMan.open(path, O_RDONLY);
-  if (!file) {
+  SdBlockReader reader;
+  if (!reader.open(path)) {
     server->send(404, "text/plain", "Not found");
     return;
   }
 
-  size_t fileSize = file.size();
-  server->setContentLength(fileSize);
+  size_t fileSize = reader.size();
+
+  // ETag = manifest hash; a client that already has this version gets 304 and no body
+  uint16_t modDate = 0, modTime = 0;
+  char hash[17];
+  if (reader.modifyDateTime(&modDate, &modTime)
+      && noteHashHex(filename.c_str(), fileSize, modDate, modTime, hash)) {
+    char etag[20];
+    snprintf(etag, sizeof(etag), "\"%s\"", hash);
+    server->sendHeader("ETag", etag);
+    String ifNoneMatch = server->header("If-None-Match");
+    if (ifNoneMatch == "*" || strstr(ifNoneMatch.c_str(), etag) != nullptr) {
+      reader.close();
+      server->send(304, "text/plain", "");
+      DBG_PRINTF("[SYNC] Unchanged: %s\n", filename.c_str());
+      return;
+    }
+  }
+
+  // Compressed on the fly when the client accepts gzip: prose shrinks ~2x, and airtime is
+  // what limits a sync on weak WiFi. Tiny notes aren't worth the 18-byte framing.
+  GzipStream gz;
+  bool compressed = fileSize >= GZIP_MIN_SIZE && strstr(server->header("Accept-Encoding").c_str(), "gzip") &&
+                    gz.begin(sendContentChunk, nullptr);
+  server->sendHeader("Vary", "Accept-Encoding");
+  if (compressed) {
+    server->sendHeader("Content-Encoding", "gzip");
+    server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  } else {
+    server->setContentLength(fileSize);
+  }
   server->send(200, "text/plain", "");
 
-  uint8_t buf[512];
-  while (file.available()) {
-    int bytesRead = file.read(buf, sizeof(buf));
-    if (bytesRead <= 0) break;
-    server->client().write(buf, bytesRead);
+  // Pool blocks go straight to the socket (or the compressor) — no stack copy
+  const uint8_t* data;
+  int n;
+  while ((n = reader.next(data)) > 0) {
+    if (compressed) {
+      if (!gz.write(data, n)) break;
+    } else {
+      server->client().write(data, n);
+      if (!server->client().connected() || serverTaskStop) break;
+    }
+  }
+  reader.close();
+  if (compressed) {
+    gz.finish();
+    server->sendContent("");
+    DBG_PRINTF("[SYNC] %s: %u -> %lu bytes gzip in %lums\n", filename.c_str(), (unsigned)fileSize,
+               (unsigned long)gz.bytesOut(), millis() - startMs);
   }
-  file.close();
 
   // Track: PC downloaded a file from device = "sent"
   filesSent++;
@@ -453,11 +725,382 @@ static void handleFileDownload() {
   DBG_PRINTF("[SYNC] Sent file: %s\n", filename.c_str());
 }
 
+// --- Bulk archive (/api/archive) ---
+// Notes as one ustar stream in chunked transfer encoding, gzipped with ?gzip=1.
+// GET = every note, POST = the newline-separated names in the body. Nothing is built
+// in RAM: SD blocks go to the socket (or through the compressor) as they are read.
+
+struct ArchiveOut {
+  GzipStream gz;
+  bool compressed = false;
+  size_t staged = 0;
+  bool ok = true;
+};
+
+static uint8_t archiveStage[GZIP_OUT_CHUNK];  // Coalesces tar headers and small notes
+
+static void archiveFlush(ArchiveOut& out) {
+  if (out.staged > 0 && out.ok) out.ok = sendContentChunk(archiveStage, out.staged, nullptr);
+  out.staged = 0;
+}
+
+static void archivePut(ArchiveOut& out, const void* data, size_t len) {
+  if (!out.ok) return;
+  if (out.compressed) {
+    out.ok = out.gz.write(data, len);
+    return;
+  }
+  if (out.staged + len > sizeof(archiveStage)) archiveFlush(out);
+  if (len >= sizeof(archiveStage)) {
+    if (out.ok) out.ok = sendContentChunk(static_cast<const uint8_t*>(data), len, nullptr);
+    return;
+  }
+  memcpy(archiveStage + out.staged, data, len);
+  out.staged += len;
+}
+
+// FAT date/time → Unix seconds (tar mtime)
+static uint32_t fatStampToUnix(uint16_t date, uint16_t time) {
+  int y = 1980 + (date >> 9);
+  int m = (date >> 5) & 15;
+  int d = date & 31;
+  if (m < 1 || m > 12 || d < 1) return 0;
+  y -= m <= 2;
+  int era = y / 400;
+  int yoe = y - era * 400;
+  int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  uint32_t days = era * 146097 + doe - 719468;
+  return days * 86400 + (time >> 11) * 3600 + ((time >> 5) & 63) * 60 + (time & 31) * 2;
+}
+
+static void archiveHeader(ArchiveOut& out, const char* name, uint32_t size, uint32_t mtime) {
+  char h[512] = {};
+  strncpy(h, name, 99);
+  snprintf(h + 100, 8, "%07o", 0644);
+  snprintf(h + 108, 8, "%07o", 0);
+  snprintf(h + 116, 8, "%07o", 0);
+  snprintf(h + 124, 12, "%011lo", (unsigned long)size);
+  snprintf(h + 136, 12, "%011lo", (unsigned long)mtime);
+  memset(h + 148, ' ', 8);
+  h[156] = '0';
+  memcpy(h + 257, "ustar", 6);
+  memcpy(h + 263, "00", 2);
+
+  unsigned sum = 0;
+  for (char c : h) sum += static_cast<uint8_t>(c);
+  snprintf(h + 148, 8, "%06o", sum);  // Six digits, NUL, then the space already there
+  archivePut(out, h, sizeof(h));
+}
+
+static bool archiveNote(ArchiveOut& out, const char* name) {
+  if (!validNoteName(name, 100)) return false;  // ustar name field
+  char path[320];
+  snprintf(path, sizeof(path), "/notes/%s", name);
+  SdBlockReader reader;
+  if (!reader.open(path)) return false;
+
+  uint16_t modDate = 0, modTime = 0;
+  reader.modifyDateTime(&modDate, &modTime);
+  uint32_t size = reader.size();
+  archiveHeader(out, name, size, fatStampToUnix(modDate, modTime));
+
+  const uint8_t* data;
+  int n;
+  uint32_t sent = 0;
+  while (out.ok && (n = reader.next(data)) > 0) {
+    archivePut(out, data, n);
+    sent += n;
+  }
+  reader.close();
+
+  // A short read would misalign every later entry — pad with zeros to the declared size
+  static const uint8_t zeros[512] = {};
+  while (sent < size && out.ok) {
+    uint32_t k = size - sent < sizeof(zeros) ? size - sent : sizeof(zeros);
+    archivePut(out, zeros, k);
+    sent += k;
+  }
+  if (size % 512) archivePut(out, zeros, 512 - size % 512);
+  return true;
+}
+
+static void handleArchive() {
+  lastHttpActivityMs = millis();
+  [[maybe_unused]] unsigned long startMs = millis();
+
+  ArchiveOut out;
+  out.compressed = server->arg("gzip") == "1" && out.gz.begin(sendContentChunk, nullptr);
+  server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server->send(200, out.compressed ? "application/gzip" : "application/x-tar", "");
+
+  int count = 0;
+  if (server->method() == HTTP_POST) {
+    String body = server->arg("plain");
+    int start = 0;
+    while (start < (int)body.length() && out.ok) {
+      int end = body.indexOf('\n', start);
+      if (end < 0) end = body.length();
+      String name = body.substring(start, end);
+      name.trim();
+      if (name.length() > 0 && archiveNote(out, name.c_str())) count++;
+      start = end + 1;
+    }
+  } else {
+    auto dir = SdMan.open("/notes");
+    if (dir && dir.isDirectory()) {
+      char name[256];
+      dir.rewindDirectory();
+      while (out.ok) {
+        // The card is held only while stepping the directory, not while the note is sent
+        bool isDir;
+        {
+          SdLock card;
+          auto file = dir.openNextFile();
+          if (!file) break;
+          isDir = file.isDirectory();
+          file.getName(name, sizeof(name));
+          file.close();
+        }
+        if (!isDir && archiveNote(out, name)) count++;
+      }
+    }
+    if (dir) {
+      SdLock card;
+      dir.close();
+    }
+  }
+
+  // End-of-archive: two zero records
+  static const uint8_t zeros[512] = {};
+  archivePut(out, zeros, sizeof(zeros));
+  archivePut(out, zeros, sizeof(zeros));
+  if (out.compressed) out.ok = out.gz.finish() && out.ok;
+  else archiveFlush(out);
+  server->sendContent("");  // Last chunk
+
+  lastHttpActivityMs = millis();
+  filesSent += count;
+  char countText[12];
+  snprintf(countText, sizeof(countText), "%d", count);
+  addSyncLogEntry("Archive: %s notes", countText);
+  DBG_PRINTF("[SYNC] Archive: %d notes, %s, %lums%s\n", count, out.compressed ? "gzip" : "tar",
+             millis() - startMs, out.ok ? "" : " (aborted)");
+}
+
+// --- Two-way sync (/api/signature/<name>, /api/upload/<name>) ---
+// rsync-style: the PC fetches block signatures of the device's copy of a note, finds
+// those blocks in its own copy with a rolling checksum and uploads only the rest:
+//   MSD1 <block size> <new length>\n      header
+//   C<first block>,<count>\n              copy blocks from the device's current copy
+//   A<length>\n<bytes>                    literal bytes
+// ?base=<seq> is the manifest version the PC last synced (0 = new note). Any other
+// current version means the note changed on both sides: 409, and the PC keeps its copy
+// as a conflict copy instead. ?hash= must match the rebuilt note. The result is saved
+// through writeNote(), the same crash-safe path as saving in the editor.
+
+static constexpr uint32_t SIG_MIN_BLOCK = 64;
+static constexpr uint32_t SIG_MAX_BLOCK = 1024;
+
+static uint8_t sigBlock[SIG_MAX_BLOCK];
+
+// ~sqrt(size) like rsync: fewer, larger blocks for big notes keep the signature small
+static uint32_t signatureBlockSize(uint32_t size) {
+  uint32_t block = SIG_MIN_BLOCK;
+  while (block < SIG_MAX_BLOCK && block * block < size) block += 16;
+  return block;
+}
+
+// rsync's rolling checksum: a = Σ x, b = Σ (len - i) · x, 16 bits each
+static uint32_t weakChecksum(const uint8_t* p, uint32_t len) {
+  uint32_t a = 0, b = 0;
+  for (uint32_t i = 0; i < len; i++) {
+    a += p[i];
+    b += (len - i) * p[i];
+  }
+  return (a & 0xFFFF) | ((b & 0xFFFF) << 16);
+}
+
+static uint32_t strongChecksum(const uint8_t* p, uint32_t len) {
+  uint32_t h = 2166136261u;
+  for (uint32_t i = 0; i < len; i++) h = (h ^ p[i]) * 16777619u;
+  return h;
+}
+
+// Open a note and look up its manifest entry. False = missing (reader stays closed).
+static bool openSyncedNote(const char* name, SdBlockReader& reader, ManifestNote& note, bool& manifestOk) {
+  char path[320];
+  snprintf(path, sizeof(path), "/notes/%s", name);
+  manifestOk = false;
+  if (!SdMan.exists(path) || !reader.open(path, false)) return false;
+  uint16_t modDate = 0, modTime = 0;
+  reader.modifyDateTime(&modDate, &modTime);
+  if (!manifestOpen) manifestOpen = noteManifestBegin();
+  manifestOk = manifestOpen && noteManifestLookup(name, reader.size(), modDate, modTime, note);
+  return true;
+}
+
+static void handleSignature(const String& name) {
+  lastHttpActivityMs = millis();
+  if (!validNoteName(name.c_str(), MAX_FILENAME_LEN)) {
+    server->send(400, "text/plain", "Bad name");
+    return;
+  }
+
+  SdBlockReader reader;
+  ManifestNote note;
+  bool manifestOk;
+  if (!openSyncedNote(name.c_str(), reader, note, manifestOk)) {
+    server->send(404, "text/plain", "Not found");
+    return;
+  }
+  if (!manifestOk) {
+    server->send(503, "text/plain", "Manifest unavailable");
+    return;
+  }
+
+  uint32_t size = reader.size();
+  uint32_t block = signatureBlockSize(size);
+  server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server->send(200, "application/json", "");
+  listLen = 0;
+
+  char item[96];
+  snprintf(item, sizeof(item), "{\"size\":%lu,\"seq\":%lu,\"hash\":\"%016llx\",\"block\":%lu,\"blocks\":[",
+           (unsigned long)size, (unsigned long)note.seq, (unsigned long long)note.hash, (unsigned long)block);
+  listPut(item);
+  int n;
+  for (int i = 0; (n = reader.read(sigBlock, block)) > 0; i++) {
+    snprintf(item, sizeof(item), "%s[%lu,%lu]", i > 0 ? "," : "",
+             (unsigned long)weakChecksum(sigBlock, n), (unsigned long)strongChecksum(sigBlock, n));
+    listPut(item);
+  }
+  listPut("]}");
+  listFlush();
+  server->sendContent("");
+}
+
+// Rebuild the new note from the delta in `body` and the device copy in `reader`.
+// Returns its length, -1 if the delta is malformed or doesn't fit.
+static int applyDelta(const char* body, size_t bodyLen, SdBlockReader& reader, bool haveBase,
+                      char* text, uint32_t& block) {
+  const char* p = body;
+  const char* end = body + bodyLen;
+  char* q;
+  if (bodyLen < 5 || strncmp(p, "MSD1 ", 5) != 0) return -1;
+  block = strtoul(p + 5, &q, 10);
+  uint32_t newLen = strtoul(q, &q, 10);
+  if (*q != '\n' || block < SIG_MIN_BLOCK || block > SIG_MAX_BLOCK || newLen >= TEXT_BUFFER_SIZE) return -1;
+  p = q + 1;
+
+  uint32_t baseSize = haveBase ? reader.size() : 0;
+  uint32_t out = 0;
+  while (p < end) {
+    char op = *p++;
+    if (op == 'C') {
+      uint32_t first = strtoul(p, &q, 10);
+      if (*q != ',') return -1;
+      uint32_t count = strtoul(q + 1, &q, 10);
+      if (*q != '\n' || first >= baseSize / block + 1 || count > TEXT_BUFFER_SIZE / block) return -1;
+      p = q + 1;
+      uint32_t from = first * block;
+      uint32_t len = count * block;
+      if (from >= baseSize) return -1;
+      if (len > baseSize - from) len = baseSize - from;
+      if (out + len > newLen || !reader.seek(from) || reader.read(text + out, len) != (int)len) return -1;
+      out += len;
+    } else if (op == 'A') {
+      uint32_t len = strtoul(p, &q, 10);
+      if (*q != '\n') return -1;
+      p = q + 1;
+      if (len > (uint32_t)(end - p) || out + len > newLen) return -1;
+      memcpy(text + out, p, len);
+      out += len;
+      p += len;
+    } else {
+      return -1;
+    }
+  }
+  return out == newLen ? (int)out : -1;
+}
+
+static void handleUpload(const String& name) {
+  lastHttpActivityMs = millis();
+  [[maybe_unused]] unsigned long startMs = millis();
+  if (!validNoteName(name.c_str(), MAX_FILENAME_LEN) || !server->hasArg("base") || !server->hasArg("hash")) {
+    server->send(400, "text/plain", "Bad request");
+    return;
+  }
+  uint32_t base = strtoul(server->arg("base").c_str(), nullptr, 10);
+  uint64_t expectHash = strtoull(server->arg("hash").c_str(), nullptr, 16);
+
+  // Version check through save in one hold of the card, so an editor save of the same
+  // note can't land in between. The body has already arrived, so no network I/O waits here.
+  SdLock card;
+
+  // Version check: the PC's delta is against the copy it last synced
+  if (!manifestOpen) manifestOpen = noteManifestBegin();
+  SdBlockReader reader;
+  ManifestNote note;
+  bool manifestOk;
+  bool haveBase = openSyncedNote(name.c_str(), reader, note, manifestOk);
+  if (!manifestOpen || (haveBase && !manifestOk)) {
+    server->send(503, "text/plain", "Manifest unavailable");
+    return;
+  }
+  uint32_t current = haveBase ? note.seq : 0;
+  if (current != base) {
+    char reply[32];
+    snprintf(reply, sizeof(reply), "{\"seq\":%lu}", (unsigned long)current);
+    server->send(409, "application/json", reply);
+    DBG_PRINTF("[SYNC] Upload conflict: %s (base %lu, device %lu)\n", name.c_str(),
+               (unsigned long)base, (unsigned long)current);
+    return;
+  }
+
+  char* text = static_cast<char*>(malloc(TEXT_BUFFER_SIZE));
+  if (!text) {
+    server->send(503, "text/plain", "Out of memory");
+    return;
+  }
+  String body = server->arg("plain");
+  uint32_t block = 0;
+  int len = applyDelta(body.c_str(), body.length(), reader, haveBase, text, block);
+  reader.close();
+  [[maybe_unused]] size_t deltaBytes = body.length();
+  body = String();
+
+  if (len < 0 || noteContentHash(text, len) != expectHash) {
+    free(text);
+    server->send(400, "text/plain", "Bad delta");
+    DBG_PRINTF("[SYNC] Rejected delta for %s\n", name.c_str());
+    return;
+  }
+  text[len] = '\0';
+  bool saved = writeNote(name.c_str(), text, len, true);
+  free(text);
+  if (!saved) {
+    server->send(500, "text/plain", "Write failed");
+    return;
+  }
+
+  char reply[64];
+  snprintf(reply, sizeof(reply), "{\"seq\":%lu,\"hash\":\"%016llx\"}", (unsigned long)noteManifestSeq(),
+           (unsigned long long)expectHash);
+  server->send(200, "application/json", reply);
+
+  // Track: PC uploaded a file to device = "received"
+  filesReceived++;
+  addSyncLogEntry("Received: %s", name.c_str());
+  DBG_PRINTF("[SYNC] Received %s: %d bytes from a %u-byte delta in %lums\n", name.c_str(), len,
+             (unsigned)deltaBytes, millis() - startMs);
+}
+
 static void handleSyncComplete() {
   lastHttpActivityMs = millis();
   server->send(200, "text/plain", "OK");
   DBG_PRINTLN("[SYNC] PC signaled sync complete");
-  enterDoneState();
+  syncCompleteRequested = true;  // loop() stops the server — not from inside it
 }
 
 static void handleNotFound() {
@@ -467,27 +1110,59 @@ static void handleNotFound() {
     handleFileDownload();
     return;
   }
+  if (uri.startsWith("/api/signature/") && server->method() == HTTP_GET) {
+    handleSignature(uri.substring(15));
+    return;
+  }
+  if (uri.startsWith("/api/upload/") && server->method() == HTTP_POST) {
+    handleUpload(uri.substring(12));
+    return;
+  }
 
   server->send(404, "text/plain", "Not found");
 }
 
+static void serverTask(void* param) {
+  while (!serverTaskStop) {
+    server->handleClient();
+    vTaskDelay(1);  // Accept latency ~1 ms instead of one loop() pass
+  }
+  serverTaskHandle = nullptr;
+  vTaskDelete(NULL);
+}
+
 static void startHttpServer() {
   if (server) return;
   server = new WebServer(80);
+  static const char* collected[] = {"If-None-Match", "Accept-Encoding"};
+  server->collectHeaders(collected, 2);
   server->on("/api/files", HTTP_GET, handleFileList);
+  server->on("/api/archive", HTTP_GET, handleArchive);
+  server->on("/api/archive", HTTP_POST, handleArchive);
   server->on("/api/sync-complete", HTTP_POST, handleSyncComplete);
   server->onNotFound(handleNotFound);
   server->begin();
+  syncCompleteRequested = false;
+  serverTaskStop = false;
+  xTaskCreate(serverTask, "sync_http", 8192, NULL, 1, &serverTaskHandle);
   MDNS.begin("microslate");
   DBG_PRINTF("[SYNC] HTTP server started at %s\n", WiFi.localIP().toString().c_str());
 }
 
 static void stopHttpServer() {
+  // Let the task finish the request in progress (archives abort at the next chunk)
+  serverTaskStop = true;
+  while (serverTaskHandle != nullptr) delay(1);
   if (server) {
     server->stop();
     delete server;
     server = nullptr;
   }
+  if (manifestOpen) {
+    noteManifestEnd();
+    manifestOpen = false;
+  }
+  if (filesReceived > 0) refreshFileList();  // Uploads may have added notes
   MDNS.end();
 }
 
@@ -628,6 +1303,8 @@ void syncHandleKey(uint8_t keyCode, uint8_t modifiers) {
 void wifiSyncStart() {
   if (syncActive) return;
   syncActive = true;
+  syncPressedMs = millis();
+  energyWifi(true);
   wifiPrefs.begin("wifi_creds", false);
   resetSyncTracking();
 
@@ -652,12 +1329,14 @@ void wifiSyncStop() {
   stopHttpServer();
   WiFi.disconnect(true);
   WiFi.mode(WIFI_OFF);
+  energyWifi(false);
 
   wifiPrefs.end();
   syncActive = false;
   networkCount = 0;
   passwordBuf[0] = '\0';
   passwordLen = 0;
+  connectingPass[0] = '\0';
   statusText[0] = '\0';
 
   // Return to main menu
@@ -681,7 +1360,11 @@ void wifiSyncLoop() {
       break;
 
     case SyncState::SYNCING:
-      if (server) server->handleClient();
+      // Requests are served by serverTask
+      if (syncCompleteRequested) {
+        enterDoneState();
+        break;
+      }
       // Safety timeout: 60s of no HTTP activity → auto-disconnect
       if (millis() - lastHttpActivityMs > SYNC_TIMEOUT_MS) {
         DBG_PRINTLN("[SYNC] Timeout — no HTTP activity for 60s");
@@ -766,6 +1449,11 @@ int getSyncLogCount() {
 }
 
 const char* getSyncLogLine(int i) {
-  if (i < 0 || i >= syncLogCount) return "";
-  return syncLog[i];
+  // A copy, so a line being shifted by the server task is never drawn half-written
+  static char line[sizeof(syncLog[0])];
+  taskENTER_CRITICAL(&syncLogMux);
+  if (i >= 0 && i < syncLogCount) memcpy(line, syncLog[i], sizeof(line));
+  else line[0] = '\0';
+  taskEXIT_CRITICAL(&syncLogMux);
+  return line;
 }
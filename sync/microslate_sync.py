@@ -1,27 +1,50 @@
 """
-MicroSlate Sync — One-way backup from device to PC.
+MicroSlate Sync — two-way sync between the device and a PC folder.
 
-Downloads all notes from the device to a local folder.  Files on
-the PC that don't exist on the device are left untouched (they
-serve as a backup archive).  Nothing is ever uploaded or deleted.
+Notes changed on the device are downloaded; notes changed in the local
+folder are uploaded back.  Only notes whose content hash changed since
+the last sync are transferred: the device lists a hash per note, and the
+hashes of the local copies are remembered in a state file next to them.
+The first sync (and any sync with many changes) pulls notes as one
+gzipped tar stream instead of one request per note.
+
+Uploads are rsync-style deltas: the device sends block checksums of its
+copy, and only the parts of the local file that don't match are sent.
+A note edited on both sides keeps both versions: the PC's copy is saved
+(and uploaded) as "<name>_conflict.txt".
+
+Files deleted on either side are never deleted on the other — local
+files that were once synced and are gone from the device stay as a
+backup archive.
 
 Usage:
   python microslate_sync.py          (foreground, console output)
   pythonw.exe microslate_sync.py     (background, log-only)
+  python microslate_sync.py --full   (re-download every note; device copies win)
 
 Dependencies: requests  (pip install requests)
 """
 
+import json
 import os
+import re
+import socket
+import sys
+import tarfile
 import time
 import logging
+import urllib.parse
 import requests
 
 # --- Configuration ---
 DEVICE_URL = "http://microslate.local"
 POLL_INTERVAL = 5  # seconds between connection attempts
+LIST_PAGE_SIZE = 200  # notes per /api/files request
+ARCHIVE_MIN_FILES = 8  # this many changed notes or more → one archive request
 LOCAL_DIR = os.path.expanduser("~/OneDrive/Documents/MicroSlate Notes")
 LOG_FILE = os.path.join(LOCAL_DIR, "microslate_sync.log")
+STATE_FILE = os.path.join(LOCAL_DIR, ".microslate_sync_state.json")
+UPLOAD_NAME = re.compile(r"^[A-Za-z0-9_.-]{1,59}\.txt$")  # names the device accepts
 
 # --- Setup ---
 
@@ -38,25 +61,210 @@ logging.basicConfig(
 )
 log = logging.getLogger("sync")
 
+# One session for every request. The device serves one request at a time and closes
+# each connection, so downloads go one after another.
+session = requests.Session()
+
+
+def pin_device_address():
+    """Resolve the device's mDNS name once per sync, so the many short requests
+    (the device closes each connection) don't each wait on a name lookup."""
+    global DEVICE_URL
+    url = urllib.parse.urlsplit(DEVICE_URL)
+    try:
+        ip = socket.gethostbyname(url.hostname)
+    except OSError:
+        return
+    DEVICE_URL = url._replace(netloc=ip + (f":{url.port}" if url.port else "")).geturl()
+
 
 def get_device_files():
-    """Fetch the file list from the device. Returns list of {name, size} dicts or None on failure."""
+    """Fetch the file list from the device. Returns list of {name, size, hash} dicts or None on failure.
+    `hash` is missing when the device firmware predates the manifest."""
     try:
-        r = requests.get(f"{DEVICE_URL}/api/files", timeout=3)
+        r = session.get(f"{DEVICE_URL}/api/files", params={"limit": LIST_PAGE_SIZE}, timeout=3)
         r.raise_for_status()
-        return r.json()
+        page = r.json()
+        if isinstance(page, list):
+            return page  # Firmware without paging: the whole list at once
+        files = page["files"]
+        while page.get("next") is not None:
+            r = session.get(f"{DEVICE_URL}/api/files",
+                             params={"limit": LIST_PAGE_SIZE, "cursor": page["next"]}, timeout=10)
+            r.raise_for_status()
+            page = r.json()
+            files.extend(page["files"])
+        return files
     except Exception:
         return None
 
 
-def download_file(name):
-    """Download a file from the device to the local folder."""
-    r = requests.get(f"{DEVICE_URL}/notes/{name}", timeout=10)
+def download_file(name, known_hash=None):
+    """Download a file from the device to the local folder.
+    With `known_hash` the request is conditional; returns False if the device
+    answered 304 (local copy already current), True if the file was written."""
+    headers = {"Accept-Encoding": "gzip"}  # Device compresses notes on the fly; requests decodes
+    if known_hash:
+        headers["If-None-Match"] = f'"{known_hash}"'
+    r = session.get(f"{DEVICE_URL}/notes/{name}", headers=headers, timeout=10)
     r.raise_for_status()
+    if r.status_code == 304:
+        log.info("  Unchanged: %s", name)
+        return False
     path = os.path.join(LOCAL_DIR, name)
-    with open(path, "w", encoding="utf-8", newline="") as f:
-        f.write(r.text)
-    log.info("  Downloaded: %s (%d bytes)", name, len(r.text))
+    with open(path, "wb") as f:
+        f.write(r.content)  # Bytes as stored, so local hashes match the device's
+    log.info("  Downloaded: %s (%d bytes)", name, len(r.content))
+    return True
+
+
+def download_archive(names=None):
+    """Download notes as one tar stream (every note, or just `names`) into the
+    local folder. Returns the list of names written."""
+    url = f"{DEVICE_URL}/api/archive?gzip=1"
+    if names is None:
+        r = session.get(url, stream=True, timeout=30)
+    else:
+        r = session.post(url, data="\n".join(names).encode("utf-8"), stream=True, timeout=30)
+    r.raise_for_status()
+
+    mode = "r|gz" if r.headers.get("Content-Type") == "application/gzip" else "r|"
+    written = []
+    with tarfile.open(fileobj=r.raw, mode=mode) as tar:
+        for member in tar:
+            name = member.name
+            if not member.isfile() or os.path.basename(name) != name or not name.endswith(".txt"):
+                continue
+            data = tar.extractfile(member).read()
+            with open(os.path.join(LOCAL_DIR, name), "wb") as f:
+                f.write(data)
+            written.append(name)
+    log.info("  Archive: %d file(s)", len(written))
+    return written
+
+
+def fnv64(data):
+    """FNV-1a 64 — the content hash the device lists for each note."""
+    h = 0xCBF29CE484222325
+    for b in data:
+        h = ((h ^ b) * 0x100000001B3) & 0xFFFFFFFFFFFFFFFF
+    return h
+
+
+def fnv32(data):
+    """FNV-1a 32 — strong checksum of one signature block."""
+    h = 0x811C9DC5
+    for b in data:
+        h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def weak_sums(data):
+    """rsync rolling checksum parts: a = sum(x), b = sum((len - i) * x)."""
+    n = len(data)
+    a = sum(data)
+    b = sum((n - i) * x for i, x in enumerate(data))
+    return a, b
+
+
+def make_delta(data, sig):
+    """rsync-style delta turning the device copy described by `sig` into `data`.
+    Returns a list of ("C", first_block, count) and ("A", literal_bytes) ops."""
+    block, size = sig["block"], sig["size"]
+    table = {}
+    for i, (weak, strong) in enumerate(sig["blocks"]):
+        table.setdefault(weak, []).append((i, strong, min(block, size - i * block)))
+
+    def find(pos, length, weak):
+        for i, strong, blen in table.get(weak, ()):
+            if blen == length and fnv32(data[pos:pos + length]) == strong:
+                return i
+        return None
+
+    ops, literal = [], bytearray()
+
+    def copy(i):
+        if literal:
+            ops.append(("A", bytes(literal)))
+            literal.clear()
+        if ops and ops[-1][0] == "C" and ops[-1][1] + ops[-1][2] == i:
+            ops[-1] = ("C", ops[-1][1], ops[-1][2] + 1)
+        else:
+            ops.append(("C", i, 1))
+
+    n, pos = len(data), 0
+    a, b = weak_sums(data[:block]) if n >= block else (0, 0)
+    while pos < n:
+        length = min(block, n - pos)
+        if length < block:
+            # Tail shorter than a block: only the device's short last block can match
+            a, b = weak_sums(data[pos:])
+        hit = find(pos, length, (a & 0xFFFF) | ((b & 0xFFFF) << 16))
+        if hit is not None:
+            copy(hit)
+            pos += length
+            if n - pos >= block:
+                a, b = weak_sums(data[pos:pos + block])
+            continue
+        literal.append(data[pos])
+        if pos + block < n:
+            out, new = data[pos], data[pos + block]
+            a = a - out + new
+            b = b - block * out + a
+        pos += 1
+    if literal:
+        ops.append(("A", bytes(literal)))
+    return ops
+
+
+def encode_delta(ops, block, length):
+    body = bytearray(f"MSD1 {block} {length}\n".encode())
+    for op in ops:
+        if op[0] == "C":
+            body += f"C{op[1]},{op[2]}\n".encode()
+        else:
+            body += f"A{len(op[1])}\n".encode() + op[1]
+    return bytes(body)
+
+
+def upload_file(name, base_seq):
+    """Upload the local copy of `name` to the device as a delta against the device
+    copy at version `base_seq` (0 = the note is new on the device).
+    Returns the device's new hash, or None if the device copy changed meanwhile."""
+    with open(os.path.join(LOCAL_DIR, name), "rb") as f:
+        data = f.read()
+    if b"\0" in data:
+        raise ValueError("not a text file")
+
+    sig = None
+    if base_seq:
+        r = session.get(f"{DEVICE_URL}/api/signature/{name}", timeout=10)
+        r.raise_for_status()
+        sig = r.json()
+        if sig["seq"] != base_seq:
+            return None
+    if sig:
+        body = encode_delta(make_delta(data, sig), sig["block"], len(data))
+    else:
+        body = encode_delta([("A", data)] if data else [], 64, len(data))
+
+    params = {"base": base_seq, "hash": "%016x" % fnv64(data)}
+    r = session.post(f"{DEVICE_URL}/api/upload/{name}", params=params, data=body,
+                      headers={"Content-Type": "text/plain"}, timeout=15)
+    if r.status_code == 409:
+        return None
+    r.raise_for_status()
+    log.info("  Uploaded: %s (%d bytes as a %d-byte delta)", name, len(data), len(body))
+    return r.json()["hash"]
+
+
+def conflict_name(name, taken):
+    """First free "<stem>_conflict[_N].txt" not in `taken`."""
+    stem = name[:-4]
+    candidate, n = f"{stem}_conflict.txt", 2
+    while candidate in taken:
+        candidate, n = f"{stem}_conflict_{n}.txt", n + 1
+    return candidate
 
 
 def get_local_files():
@@ -69,26 +277,136 @@ def get_local_files():
     return result
 
 
-def sync_once(device_files):
-    """One-way sync: download every device file to PC. Never upload or delete."""
-    device_map = {f["name"]: f["size"] for f in device_files}
+def load_state():
+    """Return {filename: {hash, size, mtime}} recorded by the last sync ({} if none)."""
+    try:
+        with open(STATE_FILE, encoding="utf-8") as f:
+            return json.load(f)
+    except (OSError, ValueError):
+        return {}
+
+
+def save_state(state):
+    """Write the state file atomically so an interrupted sync can't corrupt it."""
+    tmp = STATE_FILE + ".tmp"
+    with open(tmp, "w", encoding="utf-8") as f:
+        json.dump(state, f, indent=1, sort_keys=True)
+    os.replace(tmp, STATE_FILE)
+
+
+def local_stamp(name):
+    """(size, mtime) of the local copy, None if it doesn't exist."""
+    try:
+        st = os.stat(os.path.join(LOCAL_DIR, name))
+    except OSError:
+        return None
+    return st.st_size, st.st_mtime
+
+
+def sync_once(device_files, full=False):
+    """Two-way sync: download notes changed on the device, upload notes changed
+    locally, keep both copies of notes changed on both sides. Never deletes.
+    `full` re-downloads every note (also implied by a missing state file)."""
     local_map = get_local_files()
-    actions = 0
+    first = not os.path.exists(STATE_FILE)
+    full = full or first
+    state = {} if full else load_state()
+    device = {f["name"]: f for f in device_files}
+    # Firmware before two-way sync lists no versions and accepts no uploads
+    two_way = all("seq" in f for f in device_files)
+
+    def untouched(name):
+        """True if the local copy is exactly what the last sync left there."""
+        known = state.get(name)
+        return known is not None and [known.get("size"), known.get("mtime")] == list(local_stamp(name))
 
-    for name in sorted(device_map.keys()):
+    pending = []   # (name, hash the local copy is known to have or None) to download
+    uploads = []   # (name, device version the local edit is based on, 0 = new)
+    for name in sorted(set(device) | set(local_map)):
+        d = device.get(name)
         on_local = name in local_map
 
-        if not on_local or device_map[name] != local_map[name]:
-            download_file(name)
-            actions += 1
+        if d is None:
+            # Only here: new on the PC, unless it was synced before (deleted on the device)
+            if two_way and not full and name not in state and UPLOAD_NAME.match(name):
+                uploads.append((name, 0))
+            continue
+
+        if d.get("hash") is None:
+            # Device without a manifest: sizes are all we can compare
+            if full or not on_local or d["size"] != local_map[name]:
+                pending.append((name, None))
+            continue
+
+        known_hash = state.get(name, {}).get("hash")
+        if not on_local or full:
+            pending.append((name, None))
+        elif untouched(name):
+            if known_hash != d["hash"]:
+                pending.append((name, known_hash))
+        elif known_hash == d["hash"] and two_way and UPLOAD_NAME.match(name):
+            uploads.append((name, d["seq"]))
+        else:
+            # Changed on both sides (or never synced): keep both unless they're identical
+            with open(os.path.join(LOCAL_DIR, name), "rb") as f:
+                if "%016x" % fnv64(f.read()) == d["hash"]:
+                    size, mtime = local_stamp(name)
+                    state[name] = {"hash": d["hash"], "size": size, "mtime": mtime}
+                    continue
+            copy = conflict_name(name, set(device) | set(local_map))
+            os.replace(os.path.join(LOCAL_DIR, name), os.path.join(LOCAL_DIR, copy))
+            local_map[copy] = local_map.pop(name)
+            log.warning("  Conflict: %s changed on both sides — PC copy kept as %s", name, copy)
+            if two_way:
+                uploads.append((copy, 0))
+            pending.append((name, None))
+
+    fetched = None
+    if pending and (full or len(pending) >= ARCHIVE_MIN_FILES):
+        try:
+            fetched = download_archive(None if full else [name for name, _ in pending])
+        except Exception as e:
+            log.warning("Archive download failed (%s) — fetching notes one by one", e)
+
+    if fetched is None:
+        fetched = [name for name, known in pending if download_file(name, known)]
+
+    for name in fetched:
+        d = device.get(name)
+        if d is None:
+            # In the archive but not in the listing (created on the device since):
+            # record what arrived so the next sync sees it as untouched
+            with open(os.path.join(LOCAL_DIR, name), "rb") as f:
+                new_hash = "%016x" % fnv64(f.read())
+        elif d.get("hash"):
+            new_hash = d["hash"]
+        else:
+            continue
+        size, mtime = local_stamp(name)
+        state[name] = {"hash": new_hash, "size": size, "mtime": mtime}
+
+    sent = 0
+    for name, base in uploads:
+        try:
+            new_hash = upload_file(name, base)
+        except Exception as e:
+            log.warning("  Upload failed: %s (%s)", name, e)
+            continue
+        if new_hash is None:
+            log.warning("  %s changed on the device during sync — will retry next time", name)
+            continue
+        size, mtime = local_stamp(name)
+        state[name] = {"hash": new_hash, "size": size, "mtime": mtime}
+        sent += 1
 
-    return actions
+    save_state(state)
+    return len(fetched) + sent
 
 
 def signal_sync_complete():
     """Tell the device we're done syncing so it can shut off WiFi."""
     try:
-        r = requests.post(f"{DEVICE_URL}/api/sync-complete", timeout=3)
+        r = session.post(f"{DEVICE_URL}/api/sync-complete", timeout=3)
         r.raise_for_status()
         log.info("Signaled sync-complete to device")
     except Exception as e:
@@ -109,7 +427,8 @@ def main():
         time.sleep(POLL_INTERVAL)
 
     log.info("Device found — syncing...")
-    actions = sync_once(device_files)
+    pin_device_address()
+    actions = sync_once(device_files, full="--full" in sys.argv[1:])
     if actions > 0:
         log.info("Sync complete: %d file(s) transferred", actions)
     else:
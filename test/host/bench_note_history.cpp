@@ -0,0 +1,302 @@
+// Version history over an 8-hour writing day: storage overhead and restore cost.
+//
+// The trace is a writer at the keyboard from 9 to 5. They type in bursts with pauses and a
+// lunch break, mostly at the end of the note but sometimes back in earlier paragraphs.
+// They delete sentences and move paragraphs now and then, press Ctrl+S at some pauses,
+// and start a new chapter note past 16 KB. Auto-saves follow main.cpp (10 s idle, 2 min
+// cap), and every save goes through the .tmp/.bak rotation of writeNote() before
+// noteHistoryRecord().
+//
+// The day is run twice: once as normal, and once with no allocation over 16 KB allowed
+// while recording (WiFi up), where every version must still be kept, as a keyframe.
+// Card traffic is counted by the in-memory SdFat; host time is only a rough guide.
+
+#include <SDCardManager.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <map>
+#include <new>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "note_history.h"
+
+// --- Heap: a per-allocation limit for the low-memory run, and the peak in use ---
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void __libc_free(void* p);
+
+static size_t allocLimit = SIZE_MAX;
+static size_t heapInUse = 0;
+static size_t heapPeak = 0;
+
+static void* counted(void* p) {
+  if (p) heapInUse += malloc_usable_size(p);
+  heapPeak = std::max(heapPeak, heapInUse);
+  return p;
+}
+
+extern "C" void* malloc(size_t size) {
+  return size > allocLimit ? nullptr : counted(__libc_malloc(size));
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+  return count * size > allocLimit ? nullptr : counted(__libc_calloc(count, size));
+}
+
+extern "C" void free(void* p) {
+  if (p) heapInUse -= malloc_usable_size(p);
+  __libc_free(p);
+}
+
+// The in-memory card grows its files with new, which is neither limited nor counted
+void* operator new(size_t size) {
+  void* p = __libc_malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept { __libc_free(p); }
+void operator delete(void* p, size_t) noexcept { __libc_free(p); }
+
+// --- Trace ---
+
+static constexpr unsigned long DAY_S = 8 * 3600;
+static constexpr unsigned long LUNCH_AT_S = 4 * 3600;
+static constexpr unsigned long LUNCH_S = 45 * 60;
+static constexpr size_t CHAPTER_BYTES = 16 * 1024;
+
+static const char* words[] = {"the", "light", "over", "harbour", "she", "said", "nothing", "for", "a", "long",
+                              "while", "and", "then", "turned", "back", "to", "window", "where", "rain", "had",
+                              "started", "again", "quietly", "morning", "letters", "never", "sent", "kept",
+                              "in", "drawer", "beside", "bed", "remembered", "everything", "differently"};
+
+struct Writer {
+  std::string text;
+  size_t cursor = 0;
+  std::string pendingWord;
+};
+
+static void typeChars(Writer& w, int n) {
+  for (int i = 0; i < n; i++) {
+    if (w.pendingWord.empty()) {
+      w.pendingWord = words[rand() % (sizeof(words) / sizeof(words[0]))];
+      int r = rand() % 20;
+      w.pendingWord += r == 0 ? ".\n\n" : r < 3 ? ". " : r < 5 ? ", " : " ";
+    }
+    w.text.insert(w.cursor++, 1, w.pendingWord[0]);
+    w.pendingWord.erase(0, 1);
+  }
+}
+
+// Somewhere to revise: the start of a random paragraph
+static size_t randomParagraph(const std::string& text) {
+  if (text.empty()) return 0;
+  size_t p = text.rfind("\n\n", rand() % text.size());
+  return p == std::string::npos ? 0 : p + 2;
+}
+
+static void reviseSomething(Writer& w) {
+  int r = rand() % 100;
+  if (r < 20) {
+    w.cursor = randomParagraph(w.text);  // Go back and add to an earlier paragraph
+  } else if (r < 30 && w.text.size() > 400) {
+    size_t at = rand() % (w.text.size() - 200);
+    w.text.erase(at, 30 + rand() % 170);  // Cut a sentence
+    w.cursor = std::min(w.cursor, w.text.size());
+  } else if (r < 35 && w.text.size() > 2000) {
+    size_t from = randomParagraph(w.text);
+    size_t end = w.text.find("\n\n", from);
+    std::string para = w.text.substr(from, end == std::string::npos ? std::string::npos : end + 2 - from);
+    w.text.erase(from, para.size());
+    w.text.insert(randomParagraph(w.text), para);  // Move a paragraph
+    w.cursor = w.text.size();
+  } else {
+    w.cursor = w.text.size();
+  }
+}
+
+// --- Saving, as writeNote() does it ---
+
+struct Day {
+  int autoSaves = 0;
+  int explicitSaves = 0;
+  int recorded = 0;                  // Saves that added a version
+  uint64_t historyWritten = 0;
+  uint64_t historyRead = 0;
+  double recordHostMs = 0;
+  size_t scratchPeak = 0;            // Most heap noteHistoryRecord() held at once
+  std::vector<std::string> notes;
+  std::map<std::string, std::set<std::string>> saved;  // Every text saved, per note
+};
+
+static void save(Day& day, const std::string& name, const std::string& text, bool checkpoint, size_t memoryLimit) {
+  std::string path = "/notes/" + name;
+  std::string tmp = path + ".tmp", bak = path + ".bak";
+  FsFile f = SdMan.open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC);
+  f.write(text.data(), text.size());
+  f.close();
+  bool hadOriginal = SdMan.exists(path.c_str());
+  if (hadOriginal) {
+    SdMan.remove(bak.c_str());
+    SdMan.rename(path.c_str(), bak.c_str());
+  }
+  SdMan.rename(tmp.c_str(), path.c_str());
+  day.saved[name].insert(text);
+  (checkpoint ? day.explicitSaves : day.autoSaves)++;
+
+  FakeCard card0 = fakeCard();
+  auto start = std::chrono::steady_clock::now();
+  allocLimit = memoryLimit;
+  size_t heap0 = heapInUse;
+  heapPeak = heapInUse;
+  noteHistoryRecord(name.c_str(), hadOriginal ? bak.c_str() : nullptr, text.data(), text.size(), checkpoint);
+  day.scratchPeak = std::max(day.scratchPeak, heapPeak - heap0);
+  allocLimit = SIZE_MAX;
+  day.recordHostMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  uint64_t written = fakeCard().writeBytes - card0.writeBytes;
+  day.historyWritten += written;
+  day.historyRead += fakeCard().readBytes - card0.readBytes;
+  if (written > 0) day.recorded++;
+}
+
+static Day runDay(size_t memoryLimit) {
+  srand(30);
+  Day day;
+  Writer w;
+  int chapter = 1;
+  std::string name = "chapter1.txt";
+  day.notes.push_back(name);
+
+  unsigned long lastInputS = 0, lastSaveS = 0;
+  bool dirty = false;
+  unsigned long burstEndS = 0, pauseEndS = 0;
+  bool lunched = false;
+
+  for (unsigned long t = 0; t < DAY_S; t++) {
+    hostAdvanceClock(1000);
+    if (t >= pauseEndS && t < burstEndS) {
+      typeChars(w, 2 + rand() % 4);  // ~40 words a minute
+      lastInputS = t;
+      dirty = true;
+    } else if (t >= burstEndS) {
+      // Burst over: maybe Ctrl+S, then a pause, then revise or carry on
+      if (dirty && rand() % 100 < 15) {
+        save(day, name, w.text, true, memoryLimit);
+        lastSaveS = t;
+        dirty = false;
+      }
+      unsigned long pause = rand() % 100 < 10 ? 600 + rand() % 1200 : 5 + rand() % 175;
+      if (!lunched && t >= LUNCH_AT_S) {
+        pause = LUNCH_S;
+        lunched = true;
+      }
+      pauseEndS = t + pause;
+      burstEndS = pauseEndS + 30 + rand() % 210;
+      reviseSomething(w);
+    }
+
+    // main.cpp's auto-save
+    if (dirty && ((t - lastInputS > 10 && t - lastSaveS > 10) || t - lastSaveS > 120)) {
+      save(day, name, w.text, false, memoryLimit);
+      lastSaveS = t;
+      dirty = false;
+    }
+
+    // Next chapter: leaving the editor saves the note
+    if (w.text.size() > CHAPTER_BYTES) {
+      save(day, name, w.text, true, memoryLimit);
+      dirty = false;
+      w = Writer();
+      name = "chapter" + std::to_string(++chapter) + ".txt";
+      day.notes.push_back(name);
+    }
+  }
+  save(day, name, w.text, true, memoryLimit);
+  return day;
+}
+
+// --- Report ---
+
+static int report(const char* label, Day& day) {
+  static HistoryVersion versions[4096];
+  static char buffer[TEXT_BUFFER_SIZE];
+  int failures = 0;
+  int kept = 0, keyframes = 0;
+  uint64_t noteBytes = 0, fullCopies = 0;
+  std::vector<uint64_t> readBytes;
+  std::vector<double> hostUs;
+
+  for (const auto& name : day.notes) {
+    FsFile f = SdMan.open(("/notes/" + name).c_str());
+    std::string current(f.size(), '\0');
+    f.read(&current[0], current.size());
+    f.close();
+    noteBytes += current.size();
+
+    int n = noteHistoryList(name.c_str(), versions, 4096);
+    for (int i = 0; i < n; i++) {
+      fullCopies += versions[i].textLen;
+      keyframes += versions[i].keyframe;
+      FakeCard card0 = fakeCard();
+      auto start = std::chrono::steady_clock::now();
+      int len = noteHistoryRestore(name.c_str(), versions[i], buffer, sizeof(buffer));
+      hostUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+      readBytes.push_back(fakeCard().readBytes - card0.readBytes);
+      bool known = len >= 0 && day.saved[name].count(std::string(buffer, len));
+      bool newestIsNote = i > 0 || (len >= 0 && current == std::string(buffer, len));
+      if ((!known || !newestIsNote) && failures++ < 5) printf("  %s v%u did not restore\n", name.c_str(), versions[i].number);
+    }
+    kept += n;
+  }
+  uint64_t historyBytes = fakeCard().bytesUnder("/notes/.hist/");
+  std::sort(readBytes.begin(), readBytes.end());
+  std::sort(hostUs.begin(), hostUs.end());
+  double meanRead = 0, meanUs = 0;
+  for (size_t i = 0; i < readBytes.size(); i++) {
+    meanRead += readBytes[i] / (double)readBytes.size();
+    meanUs += hostUs[i] / hostUs.size();
+  }
+
+  printf("%s:\n", label);
+  printf("  saves: %d auto + %d explicit over 8 h, %d versions recorded, %zu notes (%.1f KB of text)\n",
+         day.autoSaves, day.explicitSaves, day.recorded, day.notes.size(), noteBytes / 1024.0);
+  printf("  history: %.1f KB on card for %d kept versions (%d keyframes) = %.2f x the notes, "
+         "%.1f%% of %.1f KB as full copies\n",
+         historyBytes / 1024.0, kept, keyframes, historyBytes / (double)noteBytes, 100.0 * historyBytes / fullCopies,
+         fullCopies / 1024.0);
+  printf("  recording: %.1f KB written, %.1f KB read over the day, %.1f KB heap at most, "
+         "%.2f ms host per recorded version\n",
+         day.historyWritten / 1024.0, day.historyRead / 1024.0, day.scratchPeak / 1024.0,
+         day.recordHostMs / std::max(day.recorded, 1));
+  if (!readBytes.empty()) {
+    printf("  restore: read median %.1f KB / mean %.1f KB / max %.1f KB, host median %.0f us / max %.0f us\n",
+           readBytes[readBytes.size() / 2] / 1024.0, meanRead / 1024.0, readBytes.back() / 1024.0,
+           hostUs[hostUs.size() / 2], hostUs.back());
+  }
+  return failures;
+}
+
+int main() {
+  SdMan.begin();
+  SdMan.mkdir("/notes");
+
+  Day normal = runDay(SIZE_MAX);
+  int failures = report("normal", normal);
+  int recorded = normal.recorded;
+
+  SdMan.removeDir("/notes");
+  SdMan.mkdir("/notes");
+  Day low = runDay(16 * 1024);
+  failures += report("no allocation over 16 KB", low);
+  if (low.recorded != recorded) {
+    printf("  low memory recorded %d versions, normal %d\n", low.recorded, recorded);
+    failures++;
+  }
+  printf("history: %d failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+// Search index on a 50 MB corpus: rebuild, queries, and saves against a full index.
+//
+// 5,000 notes of ~10 KB drawn from a 50,000-word Zipf vocabulary (about 1,000 distinct
+// words a note, like prose). Card traffic is counted by the in-memory SdFat; host time is
+// only a rough guide, the card is what costs on the device.
+
+#include <SDCardManager.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "note_index.h"
+
+static constexpr int NOTES = 5000;
+static constexpr int NOTE_BYTES = 10 * 1024;
+static constexpr int VOCABULARY = 50000;
+static constexpr int SAVES = 1000;
+static constexpr int SESSION_SAVES = 10;
+
+static std::vector<std::string> vocabulary;
+static std::vector<double> cumulative;
+
+static std::string makeWord(int i) {
+  static const char* syllables[] = {"ka", "ro", "mi", "tes", "lo", "van", "du", "pe", "zor", "ni", "qua", "bel"};
+  std::string w;
+  do {
+    w += syllables[i % 12];
+    i /= 12;
+  } while (i > 0);
+  return w;
+}
+
+static const std::string& randomWord() {
+  double r = (rand() / (RAND_MAX + 1.0)) * cumulative.back();
+  return vocabulary[std::lower_bound(cumulative.begin(), cumulative.end(), r) - cumulative.begin()];
+}
+
+static std::string makeText(int length) {
+  std::string s;
+  while ((int)s.size() < length) {
+    s += randomWord();
+    s += rand() % 12 == 0 ? ".\n" : " ";
+  }
+  return s;
+}
+
+static std::string noteName(int i) {
+  char name[32];
+  snprintf(name, sizeof(name), "note%04d.txt", i);
+  return name;
+}
+
+struct Probe {
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  FakeCard card0 = fakeCard();
+
+  double ms() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  }
+  uint64_t readBytes() const { return fakeCard().readBytes - card0.readBytes; }
+  uint64_t readCalls() const { return fakeCard().readCalls - card0.readCalls; }
+  uint64_t writeBytes() const { return fakeCard().writeBytes - card0.writeBytes; }
+  uint64_t writeCalls() const { return fakeCard().writeCalls - card0.writeCalls; }
+};
+
+static void query(const char* label, const std::string& q) {
+  static SearchHit hits[MAX_SEARCH_HITS];
+  Probe p;
+  int n = noteIndexSearch(q.c_str(), hits, MAX_SEARCH_HITS);
+  printf("  %-22s %-28s %2d hits  %7.1f KB read in %5llu reads  %6.2f ms host\n", label, q.c_str(), n,
+         p.readBytes() / 1024.0, (unsigned long long)p.readCalls(), p.ms());
+}
+
+static void queries() {
+  query("very common word", vocabulary[3]);
+  query("common word", vocabulary[100]);
+  query("uncommon word", vocabulary[3000]);
+  query("rare word", vocabulary[40000]);
+  query("two words", vocabulary[100] + " " + vocabulary[3000]);
+  query("three words", vocabulary[10] + " " + vocabulary[200] + " " + vocabulary[1500]);
+  query("absent word", "qqqqq");
+}
+
+int main() {
+  SdMan.begin();
+  SdMan.mkdir("/notes");
+  srand(26);
+  double sum = 0;
+  for (int i = 0; i < VOCABULARY; i++) {
+    vocabulary.push_back(makeWord(i));
+    sum += 1.0 / (i + 1);
+    cumulative.push_back(sum);
+  }
+
+  uint64_t corpus = 0;
+  for (int i = 0; i < NOTES; i++) {
+    std::string text = makeText(NOTE_BYTES / 2 + rand() % NOTE_BYTES);
+    FsFile f = SdMan.open(("/notes/" + noteName(i)).c_str(), O_WRONLY | O_CREAT | O_TRUNC);
+    f.write(text.data(), text.size());
+    f.close();
+    corpus += text.size();
+  }
+  printf("corpus: %d notes, %.1f MB\n", NOTES, corpus / 1048576.0);
+
+  {
+    Probe p;
+    int n = noteIndexRebuild();
+    printf("rebuild: %d notes, index %.1f MB, %.1f MB read, %.1f MB written, %.0f ms host\n", n,
+           fakeCard().bytesUnder("/notes/.idx/") / 1048576.0, p.readBytes() / 1048576.0, p.writeBytes() / 1048576.0,
+           p.ms());
+  }
+  printf("queries after rebuild:\n");
+  queries();
+
+  // Typing sessions: a note grows by a sentence per save, SESSION_SAVES saves a note
+  std::vector<uint64_t> written, read;
+  Probe all;
+  int i = 0;
+  for (int s = 0; s < SAVES; s++) {
+    if (s % SESSION_SAVES == 0) i = rand() % NOTES;
+    std::string path = "/notes/" + noteName(i);
+    FsFile f = SdMan.open(path.c_str());
+    std::string text(f.size(), '\0');
+    f.read(&text[0], text.size());
+    f.close();
+    text += makeText(200);
+
+    Probe p;
+    noteIndexUpdate(noteName(i).c_str(), text.data(), text.size());
+    written.push_back(p.writeBytes());
+    read.push_back(p.readBytes());
+  }
+  double allMs = all.ms();
+  std::sort(written.begin(), written.end());
+  std::sort(read.begin(), read.end());
+  uint64_t totalWritten = 0, totalRead = 0;
+  for (int s = 0; s < SAVES; s++) {
+    totalWritten += written[s];
+    totalRead += read[s];
+  }
+  printf("saves: %d, per save written median %.1f KB / mean %.1f KB / max %.1f KB, "
+         "read median %.1f KB / mean %.1f KB / max %.1f KB, %.2f ms host mean\n",
+         SAVES, written[SAVES / 2] / 1024.0, totalWritten / 1024.0 / SAVES, written.back() / 1024.0,
+         read[SAVES / 2] / 1024.0, totalRead / 1024.0 / SAVES, read.back() / 1024.0, allMs / SAVES);
+  printf("index after saves: %.1f MB\n", fakeCard().bytesUnder("/notes/.idx/") / 1048576.0);
+  printf("queries after saves:\n");
+  queries();
+  return 0;
+}
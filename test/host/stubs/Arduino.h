@@ -0,0 +1,54 @@
+#pragma once
+
+// Host stand-in for the parts of the Arduino core the tested modules use
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "WString.h"
+#include "freertos/FreeRTOS.h"
+
+using std::round;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 3
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void hostAdvanceClock(unsigned long ms);  // Host only: skip time, for traces longer than the run
+inline void noInterrupts() {}
+inline void interrupts() {}
+inline void pinMode(int, int) {}
+inline void digitalWrite(int, int) {}
+inline int digitalRead(int) { return HIGH; }
+
+template <class T>
+T min(T a, T b) {
+  return a < b ? a : b;
+}
+
+// Logging goes nowhere: the tests print their own results
+struct HardwareSerial : Print {
+  void begin(int) {}
+  int printf(const char*, ...) { return 0; }
+  void println(const char* = "") {}
+  void print(const char*) {}
+  explicit operator bool() const { return true; }
+};
+extern HardwareSerial Serial;
+
+struct EspClass {
+  uint32_t getFreeHeap() { return 200 * 1024; }
+  uint32_t getMinFreeHeap() { return 200 * 1024; }
+};
+extern EspClass ESP;
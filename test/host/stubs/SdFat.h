@@ -0,0 +1,197 @@
+#pragma once
+
+// Host stand-in for SdFat: an in-memory card. Paths map to byte vectors; directories are
+// only names. Open files share their vector, so writes are visible to every handle like
+// on the card. fakeCard() exposes the files and transfer counts to the tests.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+
+typedef int oflag_t;
+#define O_RDONLY 0
+#define O_WRONLY 1
+#define O_RDWR 2
+#define O_CREAT 0x10
+#define O_TRUNC 0x20
+#define O_APPEND 0x40
+#define O_AT_END 0x80
+
+struct FakeCard {
+  std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> files;
+  std::map<std::string, bool> dirs;
+  uint64_t readCalls = 0, readBytes = 0;
+  uint64_t writeCalls = 0, writeBytes = 0;
+
+  // Bytes stored under `prefix` (e.g. "/notes/.idx/")
+  uint64_t bytesUnder(const std::string& prefix) const {
+    uint64_t total = 0;
+    for (const auto& kv : files) {
+      if (kv.first.compare(0, prefix.size(), prefix) == 0) total += kv.second->size();
+    }
+    return total;
+  }
+};
+
+inline FakeCard& fakeCard() {
+  static FakeCard card;
+  return card;
+}
+
+class FsFile {
+ public:
+  explicit operator bool() const { return isOpen_; }
+  bool isOpen() const { return isOpen_; }
+  bool isDirectory() const { return isDir_; }
+
+  int read(void* buf, size_t n) {
+    if (!isOpen_ || !data_) return -1;
+    size_t k = pos_ >= data_->size() ? 0 : std::min(n, data_->size() - pos_);
+    memcpy(buf, data_->data() + pos_, k);
+    pos_ += k;
+    fakeCard().readCalls++;
+    fakeCard().readBytes += k;
+    return static_cast<int>(k);
+  }
+  int read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+  }
+  size_t write(const void* buf, size_t n) {
+    if (!isOpen_ || !data_) return 0;
+    if (pos_ + n > data_->size()) data_->resize(pos_ + n);
+    memcpy(data_->data() + pos_, buf, n);
+    pos_ += n;
+    fakeCard().writeCalls++;
+    fakeCard().writeBytes += n;
+    return n;
+  }
+  size_t write(uint8_t c) { return write(&c, 1); }
+  size_t print(const String&) { return 0; }
+
+  uint64_t size() const { return data_ ? data_->size() : 0; }
+  uint64_t fileSize() const { return size(); }
+  int available() { return static_cast<int>(size() - pos_); }
+  uint64_t curPosition() const { return pos_; }
+  bool seekSet(uint64_t p) {
+    if (!data_ || p > data_->size()) return false;
+    pos_ = p;
+    return true;
+  }
+  bool truncate(uint64_t n) {
+    if (!data_) return false;
+    data_->resize(n);
+    if (pos_ > n) pos_ = n;
+    return true;
+  }
+  bool sync() { return isOpen_; }
+  bool close() {
+    isOpen_ = false;
+    return true;
+  }
+  bool getModifyDateTime(uint16_t* date, uint16_t* time) {
+    *date = 0x5021;  // 2020-01-01, one fixed stamp for every file
+    *time = 0;
+    return true;
+  }
+
+  size_t getName(char* buf, size_t n) {
+    std::string name = path_.substr(path_.rfind('/') + 1);
+    snprintf(buf, n, "%s", name.c_str());
+    return name.size();
+  }
+  void rewindDirectory() { lastListed_.clear(); }
+  FsFile openNextFile();
+
+ private:
+  friend class SdFat;
+  std::shared_ptr<std::vector<uint8_t>> data_;
+  std::string path_;
+  size_t pos_ = 0;
+  std::string lastListed_;  // Directory listing position
+  bool isOpen_ = false;
+  bool isDir_ = false;
+};
+
+struct cid_t {
+  uint8_t bytes[16];
+};
+
+class SdCard {
+ public:
+  bool readCID(cid_t* cid) {
+    memset(cid, 0, sizeof(*cid));
+    return true;
+  }
+  uint8_t errorCode() const { return 0; }
+};
+
+class SdFat {
+ public:
+  bool begin(uint8_t, uint32_t) { return true; }
+  SdCard* card() { return &card_; }
+
+  FsFile open(const char* path, oflag_t flags = O_RDONLY) {
+    FakeCard& fc = fakeCard();
+    FsFile f;
+    f.path_ = path;
+    if (fc.dirs.count(path)) {
+      f.isDir_ = true;
+      f.isOpen_ = true;
+      return f;
+    }
+    auto it = fc.files.find(path);
+    if (it == fc.files.end()) {
+      if (!(flags & O_CREAT)) return FsFile();
+      it = fc.files.emplace(path, std::make_shared<std::vector<uint8_t>>()).first;
+    }
+    f.data_ = it->second;
+    if (flags & O_TRUNC) f.data_->clear();
+    if (flags & O_AT_END) f.pos_ = f.data_->size();
+    f.isOpen_ = true;
+    return f;
+  }
+  bool mkdir(const char* path, bool = true) {
+    fakeCard().dirs[path] = true;
+    return true;
+  }
+  bool exists(const char* path) { return fakeCard().files.count(path) || fakeCard().dirs.count(path); }
+  bool remove(const char* path) { return fakeCard().files.erase(path) > 0; }
+  bool rmdir(const char* path) { return fakeCard().dirs.erase(path) > 0; }
+  bool rename(const char* from, const char* to) {
+    FakeCard& fc = fakeCard();
+    auto it = fc.files.find(from);
+    if (it == fc.files.end()) return false;
+    auto data = it->second;
+    fc.files.erase(it);
+    fc.files[to] = data;
+    return true;
+  }
+
+ private:
+  SdCard card_;
+};
+
+// Files directly inside this directory, in name order. Removing files while listing is
+// fine, as on the card (FAT leaves the other entries where they are).
+inline FsFile FsFile::openNextFile() {
+  std::string prefix = path_ + "/";
+  const auto& files = fakeCard().files;
+  for (auto it = files.upper_bound(prefix + lastListed_); it != files.end(); ++it) {
+    if (it->first.compare(0, prefix.size(), prefix) != 0) break;
+    if (it->first.find('/', prefix.size()) != std::string::npos) continue;
+    lastListed_ = it->first.substr(prefix.size());
+    FsFile f;
+    f.data_ = it->second;
+    f.path_ = it->first;
+    f.isOpen_ = true;
+    return f;
+  }
+  return FsFile();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// Host stand-in for Arduino's String and Print, backed by std::string
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+class String;
+
+class Print {
+ public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t) { return 1; }
+  virtual size_t write(const uint8_t*, size_t n) { return n; }
+  size_t print(const String&) { return 0; }
+};
+
+class String {
+ public:
+  String(const char* c = "") : s(c) {}
+  String(int v) : s(std::to_string(v)) {}
+  String(unsigned long v) : s(std::to_string(v)) {}
+
+  const char* c_str() const { return s.c_str(); }
+  size_t length() const { return s.size(); }
+  bool reserve(unsigned int n) {
+    s.reserve(n);
+    return true;
+  }
+  bool concat(const char* c, unsigned int n) {
+    s.append(c, n);
+    return true;
+  }
+  String& operator+=(const char* o) {
+    s += o;
+    return *this;
+  }
+  String& operator+=(const String& o) {
+    s += o.s;
+    return *this;
+  }
+  String& operator+=(char c) {
+    s += c;
+    return *this;
+  }
+  bool operator==(const char* o) const { return s == o; }
+  bool startsWith(const char* p) const { return s.rfind(p, 0) == 0; }
+  bool endsWith(const char* p) const {
+    size_t n = strlen(p);
+    return s.size() >= n && s.compare(s.size() - n, n, p) == 0;
+  }
+  int indexOf(char c, unsigned from = 0) const {
+    size_t p = s.find(c, from);
+    return p == std::string::npos ? -1 : static_cast<int>(p);
+  }
+  String substring(size_t from) const { return String(s.substr(from).c_str()); }
+  String substring(size_t from, size_t to) const { return String(s.substr(from, to - from).c_str()); }
+  long toInt() const { return atol(s.c_str()); }
+  void trim() {}
+
+ private:
+  std::string s;
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+typedef enum { ADC1_CHANNEL_0, ADC1_CHANNEL_1, ADC1_CHANNEL_2 } adc1_channel_t;
+typedef enum { ADC_UNIT_1 } adc_unit_t;
+typedef enum { ADC_ATTEN_DB_11, ADC_ATTEN_DB_12 } adc_atten_t;
+typedef enum { ADC_WIDTH_BIT_12 } adc_bits_width_t;
+
+inline int adc1_get_raw(adc1_channel_t) { return 0; }
+inline int adc1_config_width(adc_bits_width_t) { return 0; }
+inline int adc1_config_channel_atten(adc1_channel_t, adc_atten_t) { return 0; }
@@ -0,0 +1,17 @@
+#pragma once
+
+// Host stand-in for the ESP-IDF ADC calibration API. Declarations only: a test that links
+// BatteryMonitor defines them with whatever curve it needs.
+
+#include <cstdint>
+
+#include "driver/adc.h"
+
+typedef struct {
+  uint32_t coeff_a;
+  uint32_t coeff_b;
+} esp_adc_cal_characteristics_t;
+
+int esp_adc_cal_characterize(adc_unit_t unit, adc_atten_t atten, adc_bits_width_t width, uint32_t vref,
+                             esp_adc_cal_characteristics_t* chars);
+uint32_t esp_adc_cal_raw_to_voltage(uint32_t raw, const esp_adc_cal_characteristics_t* chars);
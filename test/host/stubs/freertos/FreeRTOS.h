@@ -0,0 +1,24 @@
+#pragma once
+
+// Host stand-in: the tests run on one thread, so locks and critical sections are no-ops
+
+#include <cstdint>
+
+typedef void* TaskHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdMS_TO_TICKS(ms) (ms)
+#define portMAX_DELAY 0xffffffff
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+
+typedef struct {
+  int unused;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define taskENTER_CRITICAL(mux) ((void)(mux))
+#define taskEXIT_CRITICAL(mux) ((void)(mux))
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef struct {
+  void* unused;
+} StaticSemaphore_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutexStatic(StaticSemaphore_t* buf) { return buf; }
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t) { return pdTRUE; }
+inline SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* buf) { return buf; }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
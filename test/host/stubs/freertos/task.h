@@ -0,0 +1,5 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
@@ -0,0 +1,113 @@
+// The rest of the firmware as seen from the editor screen: main.cpp's UI state and
+// inert versions of the modules the UI tests don't link (BLE, files, sync, search...).
+#include <HalGPIO.h>
+
+#include <cstdio>
+#include <string>
+
+#include "ble_conn_tuner.h"
+#include "ble_keyboard.h"
+#include "boot_profile.h"
+#include "config.h"
+#include "energy_meter.h"
+#include "file_manager.h"
+#include "note_history.h"
+#include "note_index.h"
+#include "text_editor.h"
+#include "wifi_sync.h"
+
+// --- main.cpp state, starting in the editor ---
+UIState currentState = UIState::TEXT_EDITOR;
+int mainMenuSelection = 0;
+int selectedFileIndex = 0;
+int settingsSelection = 0;
+int bluetoothDeviceSelection = 0;
+Orientation currentOrientation = Orientation::PORTRAIT;
+int charsPerLine = 40;
+bool screenDirty = true;
+char renameBuffer[MAX_FILENAME_LEN] = "";
+int renameBufferLen = 0;
+char searchQuery[MAX_QUERY_LEN] = "";
+int searchQueryLen = 0;
+SearchHit searchHits[MAX_SEARCH_HITS];
+int searchHitCount = -1;
+int searchSelection = 0;
+char findBuffer[MAX_FIND_LEN] = "";
+int findBufferLen = 0;
+char replaceBuffer[MAX_FIND_LEN] = "";
+int replaceBufferLen = 0;
+bool findEditingReplace = false;
+char findStatus[24] = "";
+char historyFile[MAX_FILENAME_LEN] = "";
+HistoryVersion historyVersions[MAX_HISTORY_VERSIONS];
+int historyCount = 0;
+int historySelection = 0;
+bool darkMode = false;
+bool cleanMode = false;
+bool deleteConfirmPending = false;
+WritingMode writingMode = WritingMode::NORMAL;
+
+// --- Hardware ---
+int HalGPIO::getBatteryPercentage() const { return 87; }
+
+// --- BLE: one keyboard, connected ---
+bool isKeyboardConnected() { return true; }
+BLEState getConnectionState() { return BLEState::CONNECTED; }
+void startDeviceScan() {}
+bool isDeviceScanning() { return false; }
+int getDiscoveredDeviceCount() { return 0; }
+BleDeviceInfo* getDiscoveredDevices() { return nullptr; }
+void connectToDevice(int) {}
+void disconnectCurrentDevice() {}
+std::string getCurrentDeviceAddress() { return ""; }
+bool getStoredDevice(std::string&, std::string&) { return false; }
+int getKeyboardProfileCount() { return 0; }
+bool getKeyboardProfile(int, std::string&, std::string&) { return false; }
+void stepKeyboardProfile(int) {}
+uint32_t getCurrentPasskey() { return 0; }
+void clearAllBluetoothBonds() {}
+
+static ConnTunerStats tunerStats;
+const ConnTunerStats& connTunerStats() { return tunerStats; }
+
+// --- Diagnostics ---
+static BootPhaseTiming phaseTiming;
+const BootPhaseTiming& bootPhaseTiming(BootPhase) { return phaseTiming; }
+const char* bootPhaseName(BootPhase) { return ""; }
+void energyReport(EnergyReport& report) { report = {}; }
+const char* energyRailName(EnergyRail) { return ""; }
+
+// --- Files, history, search: an empty card ---
+static FileInfo noFiles[1];
+int getFileCount() { return 0; }
+FileInfo* getFileList() { return noFiles; }
+void loadFile(const char*) {}
+void saveCurrentFile(bool, bool) {}
+void createNewFile() {}
+void deriveUniqueFilename(const char*, char* out, int) { out[0] = '\0'; }
+void updateFileTitle(const char*, const char*) {}
+void deleteFile(const char*) {}
+void filenameToTitle(const char* filename, char* out, int maxLen) { snprintf(out, maxLen, "%s", filename); }
+int noteHistoryList(const char*, HistoryVersion*, int) { return 0; }
+int noteHistoryRestore(const char*, const HistoryVersion&, char*, size_t) { return 0; }
+bool noteIndexIsComplete() { return true; }
+int noteIndexRebuild() { return 0; }
+int noteIndexSearch(const char*, SearchHit*, int) { return 0; }
+
+// --- WiFi sync: idle ---
+void wifiSyncStart() {}
+SyncState getSyncState() { return SyncState::SCANNING; }
+int getNetworkCount() { return 0; }
+const char* getNetworkSSID(int) { return ""; }
+int getNetworkRSSI(int) { return 0; }
+bool isNetworkEncrypted(int) { return false; }
+bool isNetworkSaved(int) { return false; }
+int getSelectedNetwork() { return 0; }
+const char* getPasswordBuffer() { return ""; }
+int getPasswordLen() { return 0; }
+const char* getSyncStatusText() { return ""; }
+int getSyncFilesSent() { return 0; }
+int getSyncFilesReceived() { return 0; }
+int getSyncLogCount() { return 0; }
+const char* getSyncLogLine(int) { return ""; }
+void syncHandleKey(uint8_t, uint8_t) {}
@@ -0,0 +1,27 @@
+// HalDisplay drawing into a RAM frame buffer; refreshes do nothing
+#include <Bitmap.h>
+#include <HalDisplay.h>
+
+#include <cstring>
+
+static uint8_t frameBuffer[HalDisplay::BUFFER_SIZE];
+
+EInkDisplay::EInkDisplay(int8_t, int8_t, int8_t, int8_t, int8_t, int8_t) {}
+
+HalDisplay::HalDisplay() : einkDisplay(0, 0, 0, 0, 0, 0) {}
+HalDisplay::~HalDisplay() {}
+void HalDisplay::begin() {}
+void HalDisplay::clearScreen(uint8_t color) const { memset(frameBuffer, color, sizeof(frameBuffer)); }
+uint8_t* HalDisplay::getFrameBuffer() const { return frameBuffer; }
+void HalDisplay::drawImage(const uint8_t*, uint16_t, uint16_t, uint16_t, uint16_t, bool) const {}
+void HalDisplay::displayBuffer(RefreshMode, bool) {}
+void HalDisplay::refreshDisplay(RefreshMode, bool) {}
+void HalDisplay::deepSleep() {}
+void HalDisplay::copyGrayscaleBuffers(const uint8_t*, const uint8_t*) {}
+void HalDisplay::copyGrayscaleLsbBuffers(const uint8_t*) {}
+void HalDisplay::copyGrayscaleMsbBuffers(const uint8_t*) {}
+void HalDisplay::cleanupGrayscaleBuffers(const uint8_t*) {}
+void HalDisplay::displayGrayBuffer(bool) {}
+
+// GfxRenderer links the BMP path; no test draws bitmaps
+BmpReaderError Bitmap::readNextRow(uint8_t*, uint8_t*) const { return BmpReaderError{}; }
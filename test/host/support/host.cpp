@@ -0,0 +1,25 @@
+// Definitions behind the stub headers: clocks and the Arduino globals
+#include <Arduino.h>
+#include <SPI.h>
+#include <esp_timer.h>
+
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+SPIClass SPI;
+
+static const auto startTime = std::chrono::steady_clock::now();
+static int64_t skippedUs = 0;
+
+int64_t esp_timer_get_time() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count()
+       + skippedUs;
+}
+
+void hostAdvanceClock(unsigned long ms) { skippedUs += static_cast<int64_t>(ms) * 1000; }
+
+unsigned long micros() { return static_cast<unsigned long>(esp_timer_get_time()); }
+unsigned long millis() { return static_cast<unsigned long>(esp_timer_get_time() / 1000); }
+void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
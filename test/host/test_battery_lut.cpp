@@ -0,0 +1,74 @@
+// Battery percentage lookup table matches the discharge polynomial.
+//
+// percentageFromMillivolts() interpolates a table built at compile time from
+// BatteryMonitor::percentageCurve(). Every millivolt from 3.0 V to 4.4 V must stay within
+// 1% of the clamped, rounded polynomial (0% below the table, where the curve turns back up),
+// never decrease as the voltage rises, and the ADC must be characterized once, not per read.
+
+#include <BatteryMonitor.h>
+#include <esp_adc_cal.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// The polynomial is constexpr, so its shape is checked at compile time too
+static_assert(BatteryMonitor::percentageCurve(3.2) < 0.5, "3.2 V must read empty");
+static_assert(BatteryMonitor::percentageCurve(3.7) > 35 && BatteryMonitor::percentageCurve(3.7) < 45,
+              "3.7 V must read about 40%");
+static_assert(BatteryMonitor::percentageCurve(4.2) >= 100, "4.2 V must read full");
+
+// --- ADC calibration stand-in: linear 0-3300 mV over 12 bits ---
+static int characterizeCalls = 0;
+
+int esp_adc_cal_characterize(adc_unit_t, adc_atten_t, adc_bits_width_t, uint32_t, esp_adc_cal_characteristics_t* chars) {
+  characterizeCalls++;
+  chars->coeff_a = 3300;
+  chars->coeff_b = 0;
+  return 0;
+}
+
+uint32_t esp_adc_cal_raw_to_voltage(uint32_t raw, const esp_adc_cal_characteristics_t* chars) {
+  return raw * chars->coeff_a / 4095 + chars->coeff_b;
+}
+
+static constexpr int LUT_FIRST_MV = 3200;  // Below this the table reads its first entry
+
+static int polynomialPercent(int millivolts) {
+  if (millivolts < LUT_FIRST_MV) return 0;
+  double y = BatteryMonitor::percentageCurve(millivolts / 1000.0);
+  y = y < 0.0 ? 0.0 : (y > 100.0 ? 100.0 : y);
+  return static_cast<int>(std::lround(y));
+}
+
+int main() {
+  int failures = 0;
+  int worst = 0, worstMv = 0;
+  int previous = -1;
+  for (int mv = 3000; mv <= 4400; mv++) {
+    int lut = BatteryMonitor::percentageFromMillivolts(mv);
+    int diff = std::abs(lut - polynomialPercent(mv));
+    if (diff > worst) {
+      worst = diff;
+      worstMv = mv;
+    }
+    if (diff > 1) {
+      if (failures++ < 10) printf("  %d mV: table %d%%, polynomial %d%%\n", mv, lut, polynomialPercent(mv));
+    }
+    if (lut < previous) {
+      if (failures++ < 10) printf("  %d mV: table drops from %d%% to %d%%\n", mv, previous, lut);
+    }
+    previous = lut;
+  }
+
+  BatteryMonitor battery(0);
+  for (int i = 0; i < 100; i++) battery.readMillivolts();
+  if (characterizeCalls != 1) {
+    printf("  ADC characterized %d times for 100 reads\n", characterizeCalls);
+    failures++;
+  }
+
+  printf("battery: table vs polynomial 3000-4400 mV, max difference %d%% at %d mV, %d failures\n", worst, worstMv,
+         failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,378 @@
+// Connection parameter tuner against simulated keystroke traces.
+//
+// A simulated link runs connection events at the interval in effect. A report goes out at
+// the first event after its key press or release and reaches the host after a random
+// delivery delay. A parameter update takes effect 6 events after the event that carries
+// it, plus the events the keyboard skips under slave latency (the controller takes the
+// top of the requested range). The loop is woken by each report and by the tuner's poll
+// deadline, as bleLoop() is. Each trace runs in its own process, so nothing learned
+// carries over.
+//
+// The tuner must use no more connection events than the fixed policy it replaced (20 ms
+// while typing, 200 ms latency 4 after 3 s idle) on every trace, keep 95% of the keys
+// typed on the active interval within the 50 ms target, keep every key within the 250 ms
+// limit, and measure a delivery delay distribution that matches the simulated one.
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "ble_conn_tuner.h"
+
+static constexpr uint64_t HOUR_US = 3600ull * 1000000;
+static constexpr uint64_t TARGET_US = 50000;
+static constexpr uint64_t LIMIT_US = 250000;
+static constexpr uint64_t RELEASE_US = 80000;  // Key held this long
+
+struct Report {
+  uint64_t us;
+  bool press;
+};
+
+// --- Traces: key press times over an hour ---
+
+static std::mt19937 rng;
+
+static uint64_t uniformMs(uint32_t lo, uint32_t hi) {
+  return std::uniform_int_distribution<uint32_t>(lo, hi)(rng) * 1000ull;
+}
+
+static void burst(std::vector<uint64_t>& keys, uint64_t& t, int n, uint32_t gapLo, uint32_t gapHi) {
+  for (int i = 0; i < n && t < HOUR_US; i++) {
+    keys.push_back(t);
+    t += uniformMs(gapLo, gapHi);
+  }
+}
+
+// Steady prose: words at ~170 ms a key, sentence pauses, a paragraph pause now and then
+static std::vector<uint64_t> fastTyping() {
+  std::vector<uint64_t> keys;
+  uint64_t t = 1000000;
+  while (t < HOUR_US) {
+    burst(keys, t, 40 + rng() % 80, 100, 250);
+    t += rng() % 8 == 0 ? uniformMs(10000, 60000) : uniformMs(800, 3000);
+  }
+  return keys;
+}
+
+// Bursts of a sentence or two, pauses of a few seconds to half a minute to think
+static std::vector<uint64_t> burstyTyping() {
+  std::vector<uint64_t> keys;
+  uint64_t t = 1000000;
+  while (t < HOUR_US) {
+    burst(keys, t, 5 + rng() % 40, 120, 300);
+    t += uniformMs(2000, 30000);
+  }
+  return keys;
+}
+
+// Editing: cursor keys and single fixes seconds apart, a short burst now and then
+static std::vector<uint64_t> slowEditing() {
+  std::vector<uint64_t> keys;
+  uint64_t t = 1000000;
+  while (t < HOUR_US) {
+    if (rng() % 6 == 0) {
+      burst(keys, t, 3 + rng() % 10, 150, 350);
+    } else {
+      keys.push_back(t);
+    }
+    t += uniformMs(1000, 5000);
+  }
+  return keys;
+}
+
+// A few words every couple of minutes
+static std::vector<uint64_t> mostlyIdle() {
+  std::vector<uint64_t> keys;
+  uint64_t t = 1000000;
+  while (t < HOUR_US) {
+    burst(keys, t, 5 + rng() % 15, 120, 300);
+    t += uniformMs(60000, 300000);
+  }
+  return keys;
+}
+
+// --- Link ---
+
+struct Link {
+  uint64_t anchor = 0;          // A connection event
+  uint16_t interval = 12;       // 1.25 ms units
+  uint16_t latency = 0;
+  bool pending = false;
+  uint64_t instant = 0;
+  ConnParams next{};
+  uint64_t countedTo = 0;
+  double events = 0;
+
+  uint64_t periodUs() const { return interval * 1250ull; }
+
+  void countTo(uint64_t t) {
+    if (t > countedTo) events += double(t - countedTo) / periodUs();
+    countedTo = std::max(countedTo, t);
+  }
+
+  // Apply an update whose instant has passed
+  void settle(uint64_t t) {
+    if (!pending || instant > t) return;
+    countTo(instant);
+    anchor = instant;
+    interval = next.intervalMax;
+    latency = next.latency;
+    pending = false;
+  }
+
+  uint64_t eventAtOrAfter(uint64_t t) const {
+    if (t <= anchor) return anchor;
+    uint64_t n = (t - anchor + periodUs() - 1) / periodUs();
+    uint64_t e = anchor + n * periodUs();
+    return pending && instant >= t && instant < e ? instant : e;
+  }
+
+  void request(const ConnParams& p, uint64_t t) {
+    settle(t);
+    if (pending) return;  // One procedure at a time, as the controller does
+    uint64_t sent = eventAtOrAfter(t);
+    instant = sent + (6 + latency) * periodUs();
+    next = p;
+    pending = true;
+  }
+};
+
+// --- Policies ---
+
+struct FixedPolicy {
+  static constexpr ConnParams ACTIVE = {12, 16, 0};
+  static constexpr ConnParams IDLE = {80, 160, 4};
+  bool idle = false;
+  uint64_t lastKey = 0;
+
+  ConnParams reset(uint64_t) { return ACTIVE; }
+  void observed(uint16_t, uint64_t) {}
+  void notify(uint64_t) {}
+  bool keystroke(uint64_t t, ConnParams& out) {
+    lastKey = t;
+    if (!idle) return false;
+    idle = false;
+    out = ACTIVE;
+    return true;
+  }
+  bool poll(uint64_t t, ConnParams& out) {
+    if (idle || t - lastKey < 3000000) return false;
+    idle = true;
+    out = IDLE;
+    return true;
+  }
+  uint64_t nextPoll(uint64_t t) const { return idle ? UINT64_MAX : lastKey + 3000000 > t ? lastKey + 3000000 - t : 0; }
+};
+
+struct TunerPolicy {
+  ConnParams reset(uint64_t t) { return connTunerReset(t / 1000); }
+  void observed(uint16_t interval, uint64_t t) { connTunerObserved(interval, t / 1000); }
+  void notify(uint64_t t) { connTunerNotify(static_cast<uint32_t>(t)); }
+  bool keystroke(uint64_t t, ConnParams& out) { return connTunerKeystroke(t / 1000, out); }
+  bool poll(uint64_t t, ConnParams& out) { return connTunerPoll(t / 1000, out); }
+  uint64_t nextPoll(uint64_t t) const {
+    uint32_t ms = connTunerNextPoll(t / 1000);
+    return ms == UINT32_MAX ? UINT64_MAX : ms * 1000ull;
+  }
+};
+
+struct Result {
+  double eventsPerMin;
+  uint32_t keys, activeKeys, activeOverTarget, overLimit, updates;
+  uint64_t activeP95Us, p95Us, maxUs;
+  uint32_t deliveryCounts[TUNER_DELAY_BUCKETS];  // Simulated, above the fastest delivery
+  uint32_t reports;
+};
+
+static constexpr uint64_t FASTEST_DELIVERY_US = 400;
+
+// Host delivery: 0.4-1.6 ms, 1 in 25 reports 3-10 ms late (host task busy)
+static uint64_t deliveryUs(std::mt19937& r) {
+  uint64_t d = FASTEST_DELIVERY_US + r() % 1200;
+  if (r() % 25 == 0) d += 3000 + r() % 7000;
+  return d;
+}
+
+static uint64_t percentile(std::vector<uint64_t> v, int pct) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[(v.size() - 1) * pct / 100];
+}
+
+template <typename Policy>
+static Result run(const std::vector<uint64_t>& keys) {
+  Policy policy;
+  Link link;
+  std::mt19937 r(42);
+  std::vector<Report> reports;
+  for (uint64_t k : keys) {
+    reports.push_back({k, true});
+    reports.push_back({k + RELEASE_US, false});
+  }
+  std::sort(reports.begin(), reports.end(), [](const Report& a, const Report& b) { return a.us < b.us; });
+
+  Result res{};
+  std::vector<uint64_t> latency, activeLatency;
+  uint32_t updates = 1;
+  ConnParams p = policy.reset(0);
+  link.interval = p.intervalMax;
+  link.latency = p.latency;
+  uint64_t lastArrival = 0;
+
+  uint64_t deadline = policy.nextPoll(0);
+  auto wake = [&](uint64_t t) {
+    link.settle(t);
+    policy.observed(link.interval, t);
+  };
+  auto pollUntil = [&](uint64_t until) {
+    while (deadline != UINT64_MAX && deadline <= until) {
+      uint64_t t = deadline;
+      wake(t);
+      ConnParams out;
+      if (policy.poll(t, out)) {
+        link.request(out, t);
+        updates++;
+      }
+      uint64_t next = policy.nextPoll(t);
+      deadline = next == UINT64_MAX ? UINT64_MAX : t + std::max<uint64_t>(next, 1000);
+    }
+  };
+
+  for (const Report& rep : reports) {
+    pollUntil(rep.us);
+    link.settle(rep.us);
+    bool fast = link.interval <= 40 && !link.pending;
+    uint64_t event = link.eventAtOrAfter(rep.us);
+    // Reports are delivered in order: one behind a late one is late too
+    uint64_t arrival = std::max(event + deliveryUs(r), lastArrival);
+    lastArrival = arrival;
+    uint64_t d = arrival - event - FASTEST_DELIVERY_US;
+    int b = 0;
+    while (b < TUNER_DELAY_BUCKETS - 1 && d > (1000u << b)) b++;
+    res.deliveryCounts[b]++;
+    res.reports++;
+    pollUntil(arrival);
+
+    wake(arrival);
+    policy.notify(arrival);
+    if (rep.press) {
+      uint64_t l = arrival - rep.us;
+      latency.push_back(l);
+      if (fast) activeLatency.push_back(l);
+      if (fast && l > TARGET_US) res.activeOverTarget++;
+      if (l > LIMIT_US) res.overLimit++;
+      ConnParams out;
+      if (policy.keystroke(arrival, out)) {
+        link.request(out, arrival);
+        updates++;
+      }
+    }
+    uint64_t next = policy.nextPoll(arrival);
+    deadline = next == UINT64_MAX ? UINT64_MAX : arrival + next;
+  }
+  pollUntil(HOUR_US);
+  link.settle(HOUR_US);
+  link.countTo(HOUR_US);
+
+  res.eventsPerMin = link.events / 60.0;
+  res.keys = latency.size();
+  res.activeKeys = activeLatency.size();
+  res.updates = updates;
+  res.activeP95Us = percentile(activeLatency, 95);
+  res.p95Us = percentile(latency, 95);
+  res.maxUs = percentile(latency, 100);
+  return res;
+}
+
+static void print(const char* name, const Result& r) {
+  printf("    %-6s %6.0f events/min  %3u updates  keys: %5u, p95 %5.1f ms, max %5.1f ms  "
+         "on active link: %5u, p95 %4.1f ms, %4.1f%% over target\n",
+         name, r.eventsPerMin, r.updates, r.keys, r.p95Us / 1000.0, r.maxUs / 1000.0, r.activeKeys,
+         r.activeP95Us / 1000.0, r.activeKeys ? 100.0 * r.activeOverTarget / r.activeKeys : 0.0);
+}
+
+static int runTrace(const char* name, std::vector<uint64_t> (*trace)(), unsigned seed) {
+  rng.seed(seed);
+  std::vector<uint64_t> keys = trace();
+  Result fixed = run<FixedPolicy>(keys);
+  Result tuned = run<TunerPolicy>(keys);
+  const ConnTunerStats& ts = connTunerStats();
+
+  printf("  %s (%zu keys)\n", name, keys.size());
+  print("fixed", fixed);
+  print("tuned", tuned);
+  printf("    tuner chose %u ms typing / latency %u, idle after %lu ms at %u ms; measured delay p50 %.1f ms, "
+         "p95 %.1f ms, jitter %.1f ms\n",
+         ts.activeParams.intervalMax * 5 / 4, ts.activeParams.latency, (unsigned long)ts.idleThresholdMs,
+         ts.idleParams.intervalMax * 5 / 4, ts.delayP50Us / 1000.0, ts.delayP95Us / 1000.0, ts.jitterUs / 1000.0);
+  // Delay is measured from the fastest report seen, which sits a little above the true
+  // floor: the 1 ms bound is within that slack, so shares are compared from 2 ms up, to
+  // within 1% plus three standard errors of the measured sample
+  printf("    delay <=1/2/4/8/16 ms, simulated vs measured (%u reports measured):", ts.notifies);
+  uint32_t simulated = 0, measured = 0;
+  bool off = ts.notifies == 0;
+  for (int b = 0; b < TUNER_DELAY_BUCKETS - 1 && !off; b++) {
+    simulated += tuned.deliveryCounts[b];
+    measured += ts.delayCounts[b];
+    double simShare = double(simulated) / tuned.reports;
+    double measuredShare = double(measured) / ts.notifies;
+    printf(" %.1f/%.1f%%", simShare * 100, measuredShare * 100);
+    double tolerance = 0.01 + 3 * std::sqrt(simShare * (1 - simShare) / ts.notifies);
+    if (b > 0 && std::fabs(simShare - measuredShare) > tolerance) off = true;
+  }
+  printf("\n");
+
+  int failures = 0;
+  if (tuned.eventsPerMin > fixed.eventsPerMin) {
+    printf("    FAIL: more connection events than the fixed policy\n");
+    failures++;
+  }
+  // 5% of keys may miss the target, give or take two standard errors on short traces
+  double missShare = tuned.activeKeys ? double(tuned.activeOverTarget) / tuned.activeKeys : 0;
+  if (missShare > 0.05 + 2 * std::sqrt(0.05 * 0.95 / std::max<uint32_t>(tuned.activeKeys, 1))) {
+    printf("    FAIL: over 5%% of keys on the active link miss the target\n");
+    failures++;
+  }
+  if (tuned.overLimit > 0) {
+    printf("    FAIL: %u keys over the limit\n", tuned.overLimit);
+    failures++;
+  }
+  if (off) {
+    printf("    FAIL: measured delay distribution doesn't match the simulated one\n");
+    failures++;
+  }
+  return failures;
+}
+
+int main() {
+  struct {
+    const char* name;
+    std::vector<uint64_t> (*trace)();
+  } traces[] = {
+    {"fast typing", fastTyping},
+    {"bursty typing", burstyTyping},
+    {"slow editing", slowEditing},
+    {"mostly idle", mostlyIdle},
+  };
+
+  int failures = 0;
+  unsigned seed = 39;
+  for (const auto& t : traces) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) exit(runTrace(t.name, t.trace, seed));
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failures++;
+    seed++;
+  }
+  printf("%s\n", failures ? "conn tuner: FAILED" : "conn tuner: ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,206 @@
+// Search index answers like a scan of the notes.
+//
+// Builds notes on the in-memory card, then checks noteIndexSearch() against a naive word
+// scan: the same notes, scores and first offsets. Covered along the way: an index built
+// by rebuild and one built by saves alone, 1,500 random saves/deletes/renames (enough for
+// many delta flushes and run merges), a match past 64 KB, a note with 6,000 distinct words
+// (the old table kept 1,536), and a note saved while the term table can't grow, which
+// must still be found.
+
+#include <SDCardManager.h>
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "note_index.h"
+
+// --- Allocation limit, to run the indexer out of memory ---
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+
+static size_t allocLimit = SIZE_MAX;
+
+extern "C" void* malloc(size_t size) {
+  return size > allocLimit ? nullptr : __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+  return count * size > allocLimit ? nullptr : __libc_calloc(count, size);
+}
+
+// --- Notes and the reference search ---
+
+static std::map<std::string, std::string> notes;
+static std::vector<std::string> vocabulary;
+static int failures = 0;
+
+static std::string makeWord(int i) {
+  static const char* syllables[] = {"ka", "ro", "mi", "tes", "lo", "van", "du", "pe", "zor", "ni", "qua", "bel"};
+  std::string w;
+  do {
+    w += syllables[i % 12];
+    i /= 12;
+  } while (i > 0);
+  return w;
+}
+
+static std::string makeNote(int length) {
+  std::string s;
+  while ((int)s.size() < length) {
+    // Skewed toward the first words, like prose
+    int r = rand() % 1000;
+    const std::string& w = vocabulary[(r * r / 1000) * vocabulary.size() / 1000];
+    s += rand() % 7 == 0 ? std::string(1, toupper(w[0])) + w.substr(1) : w;
+    s += rand() % 9 == 0 ? ".\n" : " ";
+  }
+  return s;
+}
+
+static void put(const std::string& name, const std::string& text, bool index = true) {
+  FsFile f = SdMan.open(("/notes/" + name).c_str(), O_WRONLY | O_CREAT | O_TRUNC);
+  f.write(text.data(), text.size());
+  f.close();
+  notes[name] = text;
+  if (index) noteIndexUpdate(name.c_str(), text.data(), text.size());
+}
+
+struct Expected {
+  uint32_t score = 0;
+  uint32_t offset = 0;
+};
+
+// Whole-word, case-folded matches of every query word, as the index defines terms
+static bool naiveMatch(const std::string& text, const std::vector<std::string>& words, Expected& out) {
+  std::vector<uint32_t> counts(words.size(), 0);
+  size_t i = 0;
+  while (i < text.size()) {
+    if (!isalnum((unsigned char)text[i])) {
+      i++;
+      continue;
+    }
+    size_t start = i;
+    std::string token;
+    while (i < text.size() && isalnum((unsigned char)text[i])) token += tolower(text[i++]);
+    for (size_t w = 0; w < words.size(); w++) {
+      if (token != words[w]) continue;
+      if (w == 0 && counts[0] == 0) out.offset = start;
+      counts[w]++;
+    }
+  }
+  out.score = 0;
+  for (uint32_t c : counts) {
+    if (c == 0) return false;
+    out.score += c;
+  }
+  return true;
+}
+
+static void check(const std::vector<std::string>& words, const char* when) {
+  std::string query;
+  for (const auto& w : words) query += w + " ";
+  static SearchHit hits[100];
+  int n = noteIndexSearch(query.c_str(), hits, 100);
+
+  std::map<std::string, Expected> expected;
+  for (const auto& kv : notes) {
+    Expected e;
+    if (naiveMatch(kv.second, words, e)) expected[kv.first] = e;
+  }
+  bool ok = (int)std::min<size_t>(expected.size(), 100) == n;
+  for (int i = 0; ok && i < n; i++) {
+    auto it = expected.find(hits[i].filename);
+    ok = it != expected.end() && it->second.offset == hits[i].offset
+      && std::min<uint32_t>(it->second.score, 0xFFFF) == hits[i].score && (i == 0 || hits[i - 1].score >= hits[i].score);
+  }
+  if (!ok && failures++ < 10) printf("  %s: \"%s\" gave %d hits, expected %zu\n", when, query.c_str(), n, expected.size());
+}
+
+static void checkQueries(const char* when) {
+  for (int q = 0; q < 40; q++) {
+    std::vector<std::string> words;
+    int count = 1 + q % 3;
+    for (int w = 0; w < count; w++) words.push_back(vocabulary[rand() % (q < 20 ? 60 : vocabulary.size())]);
+    check(words, when);
+  }
+}
+
+static std::string noteName(int i) {
+  char name[32];
+  snprintf(name, sizeof(name), "note%04d.txt", i);
+  return name;
+}
+
+int main() {
+  SdMan.begin();
+  SdMan.mkdir("/notes");
+  srand(26);
+  for (int i = 0; i < 2000; i++) vocabulary.push_back(makeWord(i));
+
+  // Built by a rebuild
+  for (int i = 0; i < 150; i++) put(noteName(i), makeNote(200 + rand() % 4000), false);
+  put("big.txt", makeNote(90000) + " zulu yankee " + makeNote(100), false);
+  if (noteIndexRebuild() != (int)notes.size()) {
+    printf("  rebuild indexed the wrong number of notes\n");
+    failures++;
+  }
+  if (!noteIndexIsComplete()) failures++;
+  checkQueries("after rebuild");
+  check({"zulu"}, "past 64 KB");
+  check({"zulu", "yankee"}, "past 64 KB");
+
+  // Random saves, deletes and renames
+  int next = 150;
+  for (int op = 0; op < 1500; op++) {
+    int r = rand() % 100;
+    auto it = notes.begin();
+    std::advance(it, rand() % notes.size());
+    std::string name = it->first;
+    if (r < 70) {
+      put(name, r < 35 ? it->second + makeNote(100) : makeNote(200 + rand() % 4000));
+    } else if (r < 80) {
+      put(noteName(next++), makeNote(200 + rand() % 4000));
+    } else if (r < 90 && name != "big.txt") {
+      SdMan.remove(("/notes/" + name).c_str());
+      notes.erase(name);
+      noteIndexRemove(name.c_str());
+    } else if (name != "big.txt") {
+      std::string to = noteName(next++);
+      SdMan.rename(("/notes/" + name).c_str(), ("/notes/" + to).c_str());
+      notes[to] = notes[name];
+      notes.erase(name);
+      noteIndexRename(name.c_str(), to.c_str());
+    }
+    if (op % 100 == 99) checkQueries("after saves");
+  }
+  check({"zulu"}, "past 64 KB after saves");
+
+  // Many distinct words in one note
+  std::string wide;
+  for (int i = 0; i < 6000; i++) wide += "w" + std::to_string(i) + " ";
+  put("wide.txt", wide);
+  check({"w5999"}, "word 6000 of a note");
+  check({"w0", "w4000"}, "word 6000 of a note");
+
+  // Term table can't grow: the note is still found
+  std::string wider = wide + "omega";
+  notes["wide.txt"] = wider;
+  allocLimit = 16 * 1024;
+  noteIndexUpdate("wide.txt", wider.data(), wider.size());
+  allocLimit = SIZE_MAX;
+  put("wide.txt", wider, false);
+  check({"w5999", "omega"}, "out of memory");
+  checkQueries("out of memory");
+  put("wide.txt", wider);
+  check({"w5999", "omega"}, "after out of memory");
+
+  // The same answers from a fresh rebuild
+  noteIndexRebuild();
+  checkQueries("second rebuild");
+
+  printf("note index: %zu notes, %d failures\n", notes.size(), failures);
+  return failures == 0 ? 0 : 1;
+}
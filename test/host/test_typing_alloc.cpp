@@ -0,0 +1,121 @@
+// Typing path makes no heap allocations.
+//
+// 10,000 scripted keystrokes go through the real key queue, input handler, editor and
+// renderer (enqueueKeyEvent -> processAllInput -> drawTextEditor -> displayBuffer), with
+// malloc/calloc/realloc and operator new hooked. Any allocation after the warm-up frame
+// fails the test. The script mixes letters, shifted letters, spaces, Enter, Backspace,
+// arrows and punctuation, and toggles typewriter, pagination and clean mode.
+
+#include <GfxRenderer.h>
+#include <HalGPIO.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "config.h"
+#include "input_handler.h"
+#include "text_editor.h"
+#include "ui_renderer.h"
+
+// --- Allocation hook ---
+// glibc's own entry points stay reachable under these names, so the hook can forward.
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+
+static bool armed = false;
+static unsigned long allocations = 0;
+static size_t firstSize = 0;
+
+static void noteAllocation(size_t size) {
+  if (!armed) return;
+  if (allocations == 0) firstSize = size;
+  allocations++;
+}
+
+extern "C" void* malloc(size_t size) {
+  noteAllocation(size);
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+  noteAllocation(count * size);
+  return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* p, size_t size) {
+  noteAllocation(size);
+  return __libc_realloc(p, size);
+}
+
+void* operator new(size_t size) {
+  noteAllocation(size);
+  void* p = __libc_malloc(size ? size : 1);
+  if (!p) abort();
+  return p;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// --- Main loop stand-in ---
+
+extern bool screenDirty;
+
+static HalDisplay display;
+static GfxRenderer renderer(display);
+alignas(HalGPIO) static unsigned char gpioStorage[sizeof(HalGPIO)];  // Never touched by the editor screen
+static HalGPIO& gpio = *reinterpret_cast<HalGPIO*>(gpioStorage);
+
+static constexpr int KEYSTROKES = 10000;
+static constexpr uint8_t MOD_CTRL = 0x01;
+static constexpr uint8_t MOD_SHIFT = 0x02;
+
+// One loop() pass: drain the key queue, redraw if anything changed
+static void frame() {
+  processAllInput();
+  if (!screenDirty) return;
+  screenDirty = false;
+  int avgWidth = renderer.getTextAdvanceX(FONT_BODY, "abcdefghijklmnopqrstuvwxyz") / 26;
+  if (avgWidth > 0) editorSetCharsPerLine((renderer.getScreenWidth() - 20) / avgWidth);
+  drawTextEditor(renderer, gpio);
+}
+
+static void key(uint8_t code, uint8_t modifiers = 0) {
+  enqueueKeyEvent(code, modifiers, true);
+  enqueueKeyEvent(code, modifiers, false);
+  frame();
+}
+
+int main() {
+  rendererSetup(renderer);
+  editorInit();
+  editorSetCurrentFile("a_rather_long_note_title_for_the_header.txt");
+  frame();  // Warm-up: first draw may size static caches
+
+  srand(47);
+  armed = true;
+  for (int n = 0; n < KEYSTROKES; n++) {
+    int r = rand() % 100;
+    if (n % 2500 == 1250) key(0x17, MOD_CTRL);                                  // Ctrl+T typewriter
+    else if (n % 2500 == 2000) key(0x13, MOD_CTRL);                             // Ctrl+P pagination
+    else if (n % 3333 == 3000) key(0x1D, MOD_CTRL);                             // Ctrl+Z clean mode
+    else if (r < 70) key(0x04 + rand() % 26, rand() % 10 == 0 ? MOD_SHIFT : 0);  // Letters
+    else if (r < 85) key(0x2C);                                                 // Space
+    else if (r < 89) key(0x28);                                                 // Enter
+    else if (r < 94) key(0x2A);                                                 // Backspace
+    else if (r < 97) key(0x4F + rand() % 4);                                    // Arrows
+    else key(0x36 + rand() % 3);                                                // , . /
+  }
+  armed = false;
+
+  printf("typing: %d keystrokes, %d lines, %u bytes: %lu heap allocations", KEYSTROKES, editorGetLineCount(),
+         static_cast<unsigned>(editorGetLength()), allocations);
+  if (allocations > 0) printf(" (first %u bytes)", static_cast<unsigned>(firstSize));
+  printf("\n");
+  return allocations == 0 ? 0 : 1;
+}